@@ -51,14 +51,15 @@ void covdevReference(sFloat *res, gFloat **link, sFloat *spinorField,
     linkEven[dir] = link[dir];
     linkOdd[dir] = link[dir] + Vh * gauge_site_size;
   }
+  const auto map = stencilMap(1);
 
   for (int sid = 0; sid < Vh; sid++) {
     int offset = my_spinor_site_size * sid;
 
     sFloat gaugedSpinor[my_spinor_site_size];
 
-    gFloat *lnk    = gaugeLink(sid, mu, oddBit, linkEven, linkOdd, 1);
-    sFloat *spinor = spinorNeighbor(sid, mu, oddBit, spinorField, 1);
+    gFloat *lnk    = map->gauge(sid, mu, oddBit, linkEven, linkOdd);
+    sFloat *spinor = map->spinor(sid, mu, oddBit, spinorField, my_spinor_site_size);
 
     if (daggerBit) {
       for (int s = 0; s < 4; s++)
@@ -193,12 +194,13 @@ void covdevReference_mg4dir(sFloat *res, gFloat **link, gFloat **ghostLink, sFlo
     ghostLinkEven[dir] = ghostLink[dir];
     ghostLinkOdd[dir] = ghostLink[dir] + (faceVolume[dir] / 2) * gauge_site_size;
   }
+  const auto map = stencilMap(1);
 
   for (int sid = 0; sid < Vh; sid++) {
     int offset = my_spinor_site_size * sid;
 
-    gFloat *lnk    = gaugeLink_mg4dir(sid, mu, oddBit, linkEven, linkOdd, ghostLinkEven, ghostLinkOdd, 1, 1);
-    sFloat *spinor = spinorNeighbor_mg4dir(sid, mu, oddBit, spinorField, fwd_nbr_spinor, back_nbr_spinor, 1, 1);
+    gFloat *lnk    = map->gauge(sid, mu, oddBit, linkEven, linkOdd, ghostLinkEven, ghostLinkOdd, 1);
+    sFloat *spinor = map->spinor(sid, mu, oddBit, spinorField, fwd_nbr_spinor, back_nbr_spinor, 1, my_spinor_site_size);
 
     sFloat gaugedSpinor[my_spinor_site_size];
 
@@ -4,6 +4,7 @@
 #include <string.h>
 #include <math.h>
 #include <complex.h>
+#include <vector>
 
 #include <quda.h>
 #include <host_utils.h>
@@ -15,154 +16,6 @@
 
 using namespace quda;
 
-// i represents a "half index" into an even or odd "half lattice".
-// when oddBit={0,1} the half lattice is {even,odd}.
-// 
-// the displacements, such as dx, refer to the full lattice coordinates. 
-//
-// neighborIndex() takes a "half index", displaces it, and returns the
-// new "half index", which can be an index into either the even or odd lattices.
-// displacements of magnitude one always interchange odd and even lattices.
-//
-//
-int neighborIndex_4d(int i, int oddBit, int dx4, int dx3, int dx2, int dx1) {
-  // On input i should be in the range [0 , ... , Z[0]*Z[1]*Z[2]*Z[3]/2-1].
-  if (i < 0 || i >= (Z[0]*Z[1]*Z[2]*Z[3]/2))
-    { printf("i out of range in neighborIndex_4d\n"); exit(-1); }
-  // Compute the linear index.  Then dissect.
-  // fullLatticeIndex_4d is in util_quda.cpp.
-  // The gauge fields live on a 4d sublattice.
-  int X = fullLatticeIndex_4d(i, oddBit);
-  int x4 = X/(Z[2]*Z[1]*Z[0]);
-  int x3 = (X/(Z[1]*Z[0])) % Z[2];
-  int x2 = (X/Z[0]) % Z[1];
-  int x1 = X % Z[0];
-
-  x4 = (x4+dx4+Z[3]) % Z[3];
-  x3 = (x3+dx3+Z[2]) % Z[2];
-  x2 = (x2+dx2+Z[1]) % Z[1];
-  x1 = (x1+dx1+Z[0]) % Z[0];
-
-  return (x4*(Z[2]*Z[1]*Z[0]) + x3*(Z[1]*Z[0]) + x2*(Z[0]) + x1) / 2;
-}
-
-
-
-//#ifndef MULTI_GPU
-// This is just a copy of gaugeLink() from the quda code, except
-// that neighborIndex() is replaced by the renamed version
-// neighborIndex_4d().
-//ok
-template <typename Float>
-Float *gaugeLink_sgpu(int i, int dir, int oddBit, Float **gaugeEven,
-                Float **gaugeOdd) {
-  Float **gaugeField;
-  int j;
-  
-  // If going forward, just grab link at site, U_\mu(x).
-  if (dir % 2 == 0) {
-    j = i;
-    // j will get used in the return statement below.
-    gaugeField = (oddBit ? gaugeOdd : gaugeEven);
-  } else {
-    // If going backward, a shift must occur, U_\mu(x-\muhat)^\dagger;
-    // dagger happens elsewhere, here we're just doing index gymnastics.
-    switch (dir) {
-    case 1: j = neighborIndex_4d(i, oddBit, 0, 0, 0, -1); break;
-    case 3: j = neighborIndex_4d(i, oddBit, 0, 0, -1, 0); break;
-    case 5: j = neighborIndex_4d(i, oddBit, 0, -1, 0, 0); break;
-    case 7: j = neighborIndex_4d(i, oddBit, -1, 0, 0, 0); break;
-    default: j = -1; break;
-    }
-    gaugeField = (oddBit ? gaugeEven : gaugeOdd);
-  }
-  
-  return &gaugeField[dir/2][j*(3*3*2)];
-}
-
-
-//#else
-
-//Standard 4d version (nothing to change)
-template <typename Float>
-Float *gaugeLink_mgpu(int i, int dir, int oddBit, Float **gaugeEven, Float **gaugeOdd, Float** ghostGaugeEven, Float** ghostGaugeOdd, int n_ghost_faces, int nbr_distance) {
-  Float **gaugeField;
-  int j;
-  int d = nbr_distance;
-  if (dir % 2 == 0) {
-    j = i;
-    gaugeField = (oddBit ? gaugeOdd : gaugeEven);
-  }
-  else {
-
-    int Y = fullLatticeIndex(i, oddBit);
-    int x4 = Y/(Z[2]*Z[1]*Z[0]);
-    int x3 = (Y/(Z[1]*Z[0])) % Z[2];
-    int x2 = (Y/Z[0]) % Z[1];
-    int x1 = Y % Z[0];
-    int X1= Z[0];
-    int X2= Z[1];
-    int X3= Z[2];
-    int X4= Z[3];
-    Float* ghostGaugeField;
-
-    switch (dir) {
-    case 1:
-      { //-X direction
-        int new_x1 = (x1 - d + X1 )% X1;
-        if (x1 -d < 0 && comm_dim_partitioned(0)){
-	  ghostGaugeField = (oddBit?ghostGaugeEven[0]: ghostGaugeOdd[0]);
-	  int offset = (n_ghost_faces + x1 -d)*X4*X3*X2/2 + (x4*X3*X2 + x3*X2+x2)/2;
-	  return &ghostGaugeField[offset*(3*3*2)];
-        }
-        j = (x4*X3*X2*X1 + x3*X2*X1 + x2*X1 + new_x1) / 2;
-        break;
-      }
-    case 3:
-      { //-Y direction
-        int new_x2 = (x2 - d + X2 )% X2;
-        if (x2 -d < 0 && comm_dim_partitioned(1)){
-          ghostGaugeField = (oddBit?ghostGaugeEven[1]: ghostGaugeOdd[1]);
-          int offset = (n_ghost_faces + x2 -d)*X4*X3*X1/2 + (x4*X3*X1 + x3*X1+x1)/2;
-          return &ghostGaugeField[offset*(3*3*2)];
-        }
-        j = (x4*X3*X2*X1 + x3*X2*X1 + new_x2*X1 + x1) / 2;
-        break;
-
-      }
-    case 5:
-      { //-Z direction
-        int new_x3 = (x3 - d + X3 )% X3;
-        if (x3 -d < 0 && comm_dim_partitioned(2)){
-          ghostGaugeField = (oddBit?ghostGaugeEven[2]: ghostGaugeOdd[2]);
-          int offset = (n_ghost_faces + x3 -d)*X4*X2*X1/2 + (x4*X2*X1 + x2*X1+x1)/2;
-          return &ghostGaugeField[offset*(3*3*2)];
-        }
-        j = (x4*X3*X2*X1 + new_x3*X2*X1 + x2*X1 + x1) / 2;
-        break;
-      }
-    case 7:
-      { //-T direction
-        int new_x4 = (x4 - d + X4)% X4;
-        if (x4 -d < 0 && comm_dim_partitioned(3)){
-          ghostGaugeField = (oddBit?ghostGaugeEven[3]: ghostGaugeOdd[3]);
-          int offset = (n_ghost_faces + x4 -d)*X1*X2*X3/2 + (x3*X2*X1 + x2*X1+x1)/2;
-          return &ghostGaugeField[offset*(3*3*2)];
-        }
-        j = (new_x4*(X3*X2*X1) + x3*(X2*X1) + x2*(X1) + x1) / 2;
-        break;
-      }//7
-
-    default: j = -1; printf("ERROR: wrong dir \n"); exit(1);
-    }
-    gaugeField = (oddBit ? gaugeEven : gaugeOdd);
-
-  }
-
-  return &gaugeField[dir/2][j*(3*3*2)];
-}
-
-
 //J  Directions 0..7 were used in the 4d code.
 //J  Directions 8,9 will be for P_- and P_+, chiral
 //J  projectors.
@@ -267,14 +120,14 @@ void multiplySpinorByDiracProjector5(Float *res, int projIdx, Float *spinorIn) {
 //
 //An "ok" will only be granted once check2.tex is deemed complete,
 //since the logic in this function is important and nontrivial.
+//
+// The operator is applied to nSrc 5-d spinor fields at once, and the
+// 4-d sites are distributed over threads: each gauge link is applied
+// to every fifth-dimension slice of every source while it is in cache.
 template <QudaPCType type, typename sFloat, typename gFloat>
-void dslashReference_4d_sgpu(sFloat *res, gFloat **gaugeFull, sFloat *spinorField, int oddBit, int daggerBit)
+void dslashReference_4d_sgpu(sFloat **res, gFloat **gaugeFull, sFloat **spinorField, int nSrc, int oddBit,
+                             int daggerBit)
 {
-
-  // Initialize the return half-spinor to zero.  Note that it is a
-  // 5d spinor, hence the use of V5h.
-  for (int i=0; i<V5h*4*3*2; i++) res[i] = 0.0;
-  
   // Some pointers that we use to march through arrays.
   gFloat *gaugeEven[4], *gaugeOdd[4];
   // Initialize to beginning of even and odd parts of
@@ -285,40 +138,43 @@ void dslashReference_4d_sgpu(sFloat *res, gFloat **gaugeFull, sFloat *spinorFiel
     // are 4-dim'l.
     gaugeOdd[dir] = gaugeFull[dir] + Vh * gauge_site_size;
   }
-  int sp_idx,gaugeOddBit;
-  for (int xs=0;xs<Ls;xs++) {
-    for (int gge_idx = 0; gge_idx < Vh; gge_idx++) {
-      for (int dir = 0; dir < 8; dir++) {
-        sp_idx=gge_idx+Vh*xs;
-        // Here is a function call to study.  It is defined near
-        // Line 90 of this file.
-        // Here we have to switch oddBit depending on the value of xs.  E.g., suppose
-        // xs=1.  Then the odd spinor site x1=x2=x3=x4=0 wants the even gauge array
-        // element 0, so that we get U_\mu(0).
-	gaugeOddBit = (xs%2 == 0 || type == QUDA_4D_PC) ? oddBit : (oddBit+1) % 2;
-        gFloat *gauge = gaugeLink_sgpu(gge_idx, dir, gaugeOddBit, gaugeEven, gaugeOdd);
-        
-        // Even though we're doing the 4d part of the dslash, we need
-        // to use a 5d neighbor function, to get the offsets right.
-        sFloat *spinor = spinorNeighbor_5d<type>(sp_idx, dir, oddBit, spinorField);
-        sFloat projectedSpinor[4*3*2], gaugedSpinor[4*3*2];
-        int projIdx = 2*(dir/2)+(dir+daggerBit)%2;
-        multiplySpinorByDiracProjector5(projectedSpinor, projIdx, spinor);
-      
-        for (int s = 0; s < 4; s++) {
-	  if (dir % 2 == 0) {
-	    su3Mul(&gaugedSpinor[s*(3*2)], gauge, &projectedSpinor[s*(3*2)]);
-#ifdef DBUG_VERBOSE            
-	    std::cout << "spinor:" << std::endl;
-	    printSpinorElement(&projectedSpinor[s*(3*2)],0,QUDA_DOUBLE_PRECISION);
-	    std::cout << "gauge:" << std::endl;
-#endif
-          } else {
-	    su3Tmul(&gaugedSpinor[s*(3*2)], gauge, &projectedSpinor[s*(3*2)]);
+  const auto gauge_map = stencilMap(1);
+  const auto spinor_map = stencilMap(1, Ls, type);
+
+#pragma omp parallel for
+  for (int gge_idx = 0; gge_idx < Vh; gge_idx++) {
+    // Initialize the return half-spinor to zero.  Note that it is a
+    // 5d spinor, hence the stride of Vh between slices.
+    for (int src = 0; src < nSrc; src++)
+      for (int xs = 0; xs < Ls; xs++)
+        for (int j = 0; j < 4 * 3 * 2; j++) res[src][(gge_idx + Vh * xs) * (4 * 3 * 2) + j] = 0.0;
+
+    for (int dir = 0; dir < 8; dir++) {
+      // Here we have to switch oddBit depending on the value of xs.  E.g., suppose
+      // xs=1.  Then the odd spinor site x1=x2=x3=x4=0 wants the even gauge array
+      // element 0, so that we get U_\mu(0).
+      gFloat *gauge[2] = {gauge_map->gauge(gge_idx, dir, oddBit, gaugeEven, gaugeOdd),
+                          gauge_map->gauge(gge_idx, dir, (oddBit + 1) % 2, gaugeEven, gaugeOdd)};
+      int projIdx = 2*(dir/2)+(dir+daggerBit)%2;
+
+      for (int src = 0; src < nSrc; src++) {
+        for (int xs = 0; xs < Ls; xs++) {
+          int sp_idx = gge_idx + Vh * xs;
+          gFloat *link = (xs % 2 == 0 || type == QUDA_4D_PC) ? gauge[0] : gauge[1];
+
+          // Even though we're doing the 4d part of the dslash, we need
+          // to use a 5d neighbor function, to get the offsets right.
+          sFloat *spinor = spinor_map->spinor(sp_idx, dir, oddBit, spinorField[src], spinor_site_size);
+          sFloat projectedSpinor[4*3*2], gaugedSpinor[4*3*2];
+          multiplySpinorByDiracProjector5(projectedSpinor, projIdx, spinor);
+
+          for (int s = 0; s < 4; s++) {
+            if (dir % 2 == 0) su3Mul(&gaugedSpinor[s*(3*2)], link, &projectedSpinor[s*(3*2)]);
+            else su3Tmul(&gaugedSpinor[s*(3*2)], link, &projectedSpinor[s*(3*2)]);
           }
+
+          sum(&res[src][sp_idx*(4*3*2)], &res[src][sp_idx*(4*3*2)], gaugedSpinor, 4*3*2);
         }
-      
-        sum(&res[sp_idx*(4*3*2)], &res[sp_idx*(4*3*2)], gaugedSpinor, 4*3*2);
       }
     }
   }
@@ -326,12 +182,9 @@ void dslashReference_4d_sgpu(sFloat *res, gFloat **gaugeFull, sFloat *spinorFiel
 
 #ifdef MULTI_GPU
 template <QudaPCType type, typename sFloat, typename gFloat>
-void dslashReference_4d_mgpu(sFloat *res, gFloat **gaugeFull, gFloat **ghostGauge, sFloat *spinorField,
-    sFloat **fwdSpinor, sFloat **backSpinor, int oddBit, int daggerBit)
+void dslashReference_4d_mgpu(sFloat **res, gFloat **gaugeFull, gFloat **ghostGauge, sFloat **spinorField,
+                             SpinorGhostBatch &ghost, int nSrc, int oddBit, int daggerBit)
 {
-  // int my_spinor_site_size = 24;
-  for (int i = 0; i < V5h * spinor_site_size; i++) res[i] = 0.0;
-
   gFloat *gaugeEven[4], *gaugeOdd[4];
   gFloat *ghostGaugeEven[4], *ghostGaugeOdd[4];
   
@@ -343,30 +196,40 @@ void dslashReference_4d_mgpu(sFloat *res, gFloat **gaugeFull, gFloat **ghostGaug
     ghostGaugeEven[dir] = ghostGauge[dir];
     ghostGaugeOdd[dir] = ghostGauge[dir] + (faceVolume[dir] / 2) * gauge_site_size;
   }
-  for (int xs=0;xs<Ls;xs++) 
-  {  
-    int sp_idx;
-    for (int i = 0; i < Vh; i++) 
-    {
-      sp_idx = i + Vh*xs;
-      for (int dir = 0; dir < 8; dir++) 
-      {
-	int gaugeOddBit = (xs%2 == 0 || type == QUDA_4D_PC) ? oddBit : (oddBit + 1) % 2;
-	
-	gFloat *gauge = gaugeLink_mgpu(i, dir, gaugeOddBit, gaugeEven, gaugeOdd, ghostGaugeEven, ghostGaugeOdd, 1, 1);//this is unchanged from MPi version
-	sFloat *spinor = spinorNeighbor_5d_mgpu<type>(sp_idx, dir, oddBit, spinorField, fwdSpinor, backSpinor, 1, 1);
-
-        sFloat projectedSpinor[spinor_site_size], gaugedSpinor[spinor_site_size];
-        int projIdx = 2 * (dir / 2) + (dir + daggerBit) % 2;
-        multiplySpinorByDiracProjector5(projectedSpinor, projIdx, spinor);
-
-        for (int s = 0; s < 4; s++) {
-          if (dir % 2 == 0)
-            su3Mul(&gaugedSpinor[s * (3 * 2)], gauge, &projectedSpinor[s * (3 * 2)]);
-          else
-            su3Tmul(&gaugedSpinor[s * (3 * 2)], gauge, &projectedSpinor[s * (3 * 2)]);
+  const auto gauge_map = stencilMap(1);
+  const auto spinor_map = stencilMap(1, Ls, type);
+
+  // see the single-GPU variant for the thread decomposition
+#pragma omp parallel for
+  for (int i = 0; i < Vh; i++) {
+    for (int src = 0; src < nSrc; src++)
+      for (int xs = 0; xs < Ls; xs++)
+        for (int j = 0; j < spinor_site_size; j++) res[src][(i + Vh * xs) * spinor_site_size + j] = 0.0;
+
+    for (int dir = 0; dir < 8; dir++) {
+      gFloat *gauge[2]
+        = {gauge_map->gauge(i, dir, oddBit, gaugeEven, gaugeOdd, ghostGaugeEven, ghostGaugeOdd, 1),
+           gauge_map->gauge(i, dir, (oddBit + 1) % 2, gaugeEven, gaugeOdd, ghostGaugeEven, ghostGaugeOdd, 1)};
+      int projIdx = 2 * (dir / 2) + (dir + daggerBit) % 2;
+
+      for (int src = 0; src < nSrc; src++) {
+        for (int xs = 0; xs < Ls; xs++) {
+          int sp_idx = i + Vh * xs;
+          gFloat *link = (xs % 2 == 0 || type == QUDA_4D_PC) ? gauge[0] : gauge[1];
+          sFloat *spinor = spinor_map->spinor(sp_idx, dir, oddBit, spinorField[src], (sFloat **)ghost.fwd(src),
+                                             (sFloat **)ghost.back(src), 1, spinor_site_size);
+
+          sFloat projectedSpinor[spinor_site_size], gaugedSpinor[spinor_site_size];
+          multiplySpinorByDiracProjector5(projectedSpinor, projIdx, spinor);
+
+          for (int s = 0; s < 4; s++) {
+            if (dir % 2 == 0)
+              su3Mul(&gaugedSpinor[s * (3 * 2)], link, &projectedSpinor[s * (3 * 2)]);
+            else
+              su3Tmul(&gaugedSpinor[s * (3 * 2)], link, &projectedSpinor[s * (3 * 2)]);
+          }
+          sum(&res[src][sp_idx * (4 * 3 * 2)], &res[src][sp_idx * (4 * 3 * 2)], gaugedSpinor, 4 * 3 * 2);
         }
-        sum(&res[sp_idx * (4 * 3 * 2)], &res[sp_idx * (4 * 3 * 2)], gaugedSpinor, 4 * 3 * 2);
       }
     }
   }
@@ -411,13 +274,14 @@ void mdw_eofa_m5_ref(sFloat *res, sFloat *spinorField, int oddBit, int daggerBit
   sFloat kappa = 0.5 * (c * (4. + m5) - 1.) / (b * (4. + m5) + 1.);
 
   constexpr int spinor_size = 4 * 3 * 2;
+  const auto map = stencilMap(1, Ls, QUDA_4D_PC);
   for (int i = 0; i < V5h; i++) {
     for (int one_site = 0; one_site < 24; one_site++) { res[i * spinor_size + one_site] = 0.; }
     for (int dir = 8; dir < 10; dir++) {
       // Calls for an extension of the original function.
       // 8 is forward hop, which wants P_+, 9 is backward hop,
       // which wants P_-.  Dagger reverses these.
-      sFloat *spinor = spinorNeighbor_5d<QUDA_4D_PC>(i, dir, oddBit, spinorField);
+      sFloat *spinor = map->spinor(i, dir, oddBit, spinorField, spinor_size);
       sFloat projectedSpinor[spinor_size];
       int projIdx = 2 * (dir / 2) + (dir + daggerBit) % 2;
       multiplySpinorByDiracProjector5(projectedSpinor, projIdx, spinor);
@@ -486,6 +350,7 @@ void mdw_eofa_m5(void *res, void *spinorField, int oddBit, int daggerBit, double
 template <QudaPCType type, bool zero_initialize = false, typename sFloat>
 void dslashReference_5th(sFloat *res, sFloat *spinorField, int oddBit, int daggerBit, sFloat mferm)
 {
+  const auto map = stencilMap(1, Ls, type);
   for (int i = 0; i < V5h; i++) {
     if (zero_initialize) for(int one_site = 0 ; one_site < 24 ; one_site++)
       res[i*(4*3*2)+one_site] = 0.0;
@@ -493,7 +358,7 @@ void dslashReference_5th(sFloat *res, sFloat *spinorField, int oddBit, int dagge
       // Calls for an extension of the original function.
       // 8 is forward hop, which wants P_+, 9 is backward hop,
       // which wants P_-.  Dagger reverses these.
-      sFloat *spinor = spinorNeighbor_5d<type>(i, dir, oddBit, spinorField);
+      sFloat *spinor = map->spinor(i, dir, oddBit, spinorField, 4 * 3 * 2);
       sFloat projectedSpinor[4*3*2];
       int projIdx = 2*(dir/2)+(dir+daggerBit)%2;
       multiplySpinorByDiracProjector5(projectedSpinor, projIdx, spinor);
@@ -795,16 +660,50 @@ void mdw_eofa_m5inv(void *res, void *spinorField, int oddBit, int daggerBit, dou
   return;
 }
 
+#ifdef MULTI_GPU
+// exchange the ghost zones of nSrc 5-d parity fields
+static SpinorGhostBatch exchange5dGhost(void **in, int nSrc, int oddBit, int daggerBit, QudaPCType pc_type,
+                                        QudaPrecision precision)
+{
+  // Get spinor ghost fields
+  // First describe the input spinors as ColorSpinorFields
+  ColorSpinorParam csParam;
+  csParam.nColor = 3;
+  csParam.nSpin = 4;
+  csParam.nDim = 5; //for DW dslash
+  for (int d=0; d<4; d++) csParam.x[d] = Z[d];
+  csParam.x[4] = Ls;//5th dimention
+  csParam.setPrecision(precision);
+  csParam.pad = 0;
+  csParam.siteSubset = QUDA_PARITY_SITE_SUBSET;
+  csParam.x[0] /= 2;
+  csParam.siteOrder = QUDA_EVEN_ODD_SITE_ORDER;
+  csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
+  csParam.gammaBasis = QUDA_DEGRAND_ROSSI_GAMMA_BASIS;
+  csParam.create = QUDA_REFERENCE_FIELD_CREATE;
+  csParam.pc_type = pc_type;
+
+  // Now do the exchange
+  QudaParity otherParity = QUDA_INVALID_PARITY;
+  if (oddBit == QUDA_EVEN_PARITY) otherParity = QUDA_ODD_PARITY;
+  else if (oddBit == QUDA_ODD_PARITY) otherParity = QUDA_EVEN_PARITY;
+  else errorQuda("ERROR: full parity not supported in function %s", __FUNCTION__);
+  const int nFace = 1;
+
+  return SpinorGhostBatch(csParam, in, nSrc, otherParity, nFace, daggerBit);
+}
+#endif
+
 // this actually applies the preconditioned dslash, e.g., D_ee^{-1} D_eo or D_oo^{-1} D_oe
 void dw_dslash(void *out, void **gauge, void *in, int oddBit, int daggerBit, QudaPrecision precision,
     QudaGaugeParam &gauge_param, double mferm)
 {
 #ifndef MULTI_GPU
   if (precision == QUDA_DOUBLE_PRECISION) {
-    dslashReference_4d_sgpu<QUDA_5D_PC>((double*)out, (double**)gauge, (double*)in, oddBit, daggerBit);
+    dslashReference_4d_sgpu<QUDA_5D_PC>((double **)&out, (double **)gauge, (double **)&in, 1, oddBit, daggerBit);
     dslashReference_5th<QUDA_5D_PC>((double*)out, (double*)in, oddBit, daggerBit, mferm);
   } else {
-    dslashReference_4d_sgpu<QUDA_5D_PC>((float*)out, (float**)gauge, (float*)in, oddBit, daggerBit);
+    dslashReference_4d_sgpu<QUDA_5D_PC>((float **)&out, (float **)gauge, (float **)&in, 1, oddBit, daggerBit);
     dslashReference_5th<QUDA_5D_PC>((float*)out, (float*)in, oddBit, daggerBit, (float)mferm);
   }
 #else
@@ -813,47 +712,17 @@ void dw_dslash(void *out, void **gauge, void *in, int oddBit, int daggerBit, Qud
     gauge_field_param.ghostExchange = QUDA_GHOST_EXCHANGE_PAD;
     cpuGaugeField cpu(gauge_field_param);
     void **ghostGauge = (void**)cpu.Ghost();    
-  
-    // Get spinor ghost fields
-    // First wrap the input spinor into a ColorSpinorField
-    ColorSpinorParam csParam;
-    csParam.v = in;
-    csParam.nColor = 3;
-    csParam.nSpin = 4;
-    csParam.nDim = 5; //for DW dslash
-    for (int d=0; d<4; d++) csParam.x[d] = Z[d];
-    csParam.x[4] = Ls;//5th dimention
-    csParam.setPrecision(precision);
-    csParam.pad = 0;
-    csParam.siteSubset = QUDA_PARITY_SITE_SUBSET;
-    csParam.x[0] /= 2;
-    csParam.siteOrder = QUDA_EVEN_ODD_SITE_ORDER;
-    csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
-    csParam.gammaBasis = QUDA_DEGRAND_ROSSI_GAMMA_BASIS;
-    csParam.create = QUDA_REFERENCE_FIELD_CREATE;
-    csParam.pc_type = QUDA_5D_PC;
-
-    cpuColorSpinorField inField(csParam);
-
-    {  // Now do the exchange
-      QudaParity otherParity = QUDA_INVALID_PARITY;
-      if (oddBit == QUDA_EVEN_PARITY) otherParity = QUDA_ODD_PARITY;
-      else if (oddBit == QUDA_ODD_PARITY) otherParity = QUDA_EVEN_PARITY;
-      else errorQuda("ERROR: full parity not supported in function %s", __FUNCTION__);
-      const int nFace = 1;
-
-      inField.exchangeGhost(otherParity, nFace, daggerBit);
-    }
-    void** fwd_nbr_spinor = inField.fwdGhostFaceBuffer;
-    void** back_nbr_spinor = inField.backGhostFaceBuffer;
+
+    SpinorGhostBatch ghost = exchange5dGhost(&in, 1, oddBit, daggerBit, QUDA_5D_PC, precision);
+
   //NOTE: hopping  in 5th dimension does not use MPI. 
     if (precision == QUDA_DOUBLE_PRECISION) {
-      dslashReference_4d_mgpu<QUDA_5D_PC>((double*)out, (double**)gauge, (double**)ghostGauge, (double*)in,(double**)fwd_nbr_spinor, (double**)back_nbr_spinor, oddBit, daggerBit);
-      //dslashReference_4d_sgpu<QUDA_5D_PC>((double*)out, (double**)gauge, (double*)in, oddBit, daggerBit);
+      dslashReference_4d_mgpu<QUDA_5D_PC>((double **)&out, (double **)gauge, (double **)ghostGauge, (double **)&in,
+                                          ghost, 1, oddBit, daggerBit);
       dslashReference_5th<QUDA_5D_PC>((double*)out, (double*)in, oddBit, daggerBit, mferm);
     } else {
-      dslashReference_4d_mgpu<QUDA_5D_PC>((float*)out, (float**)gauge, (float**)ghostGauge, (float*)in,
-					  (float**)fwd_nbr_spinor, (float**)back_nbr_spinor, oddBit, daggerBit);
+      dslashReference_4d_mgpu<QUDA_5D_PC>((float **)&out, (float **)gauge, (float **)ghostGauge, (float **)&in, ghost,
+                                          1, oddBit, daggerBit);
       dslashReference_5th<QUDA_5D_PC>((float*)out, (float*)in, oddBit, daggerBit, (float)mferm);
     }
 
@@ -862,12 +731,18 @@ void dw_dslash(void *out, void **gauge, void *in, int oddBit, int daggerBit, Qud
 }
 
 void dslash_4_4d(void *out, void **gauge, void *in, int oddBit, int daggerBit, QudaPrecision precision, QudaGaugeParam &gauge_param, double mferm) 
+{
+  dslash_4_4d_multi(&out, gauge, &in, 1, oddBit, daggerBit, precision, gauge_param, mferm);
+}
+
+void dslash_4_4d_multi(void **out, void **gauge, void **in, int nSrc, int oddBit, int daggerBit,
+                       QudaPrecision precision, QudaGaugeParam &gauge_param, double mferm)
 {
 #ifndef MULTI_GPU
   if (precision == QUDA_DOUBLE_PRECISION) {
-    dslashReference_4d_sgpu<QUDA_4D_PC>((double*)out, (double**)gauge, (double*)in, oddBit, daggerBit);
+    dslashReference_4d_sgpu<QUDA_4D_PC>((double **)out, (double **)gauge, (double **)in, nSrc, oddBit, daggerBit);
   } else {
-    dslashReference_4d_sgpu<QUDA_4D_PC>((float*)out, (float**)gauge, (float*)in, oddBit, daggerBit);
+    dslashReference_4d_sgpu<QUDA_4D_PC>((float **)out, (float **)gauge, (float **)in, nSrc, oddBit, daggerBit);
   }
 #else
 
@@ -875,44 +750,15 @@ void dslash_4_4d(void *out, void **gauge, void *in, int oddBit, int daggerBit, Q
     gauge_field_param.ghostExchange = QUDA_GHOST_EXCHANGE_PAD;
     cpuGaugeField cpu(gauge_field_param);
     void **ghostGauge = (void**)cpu.Ghost();    
-  
-    // Get spinor ghost fields
-    // First wrap the input spinor into a ColorSpinorField
-    ColorSpinorParam csParam;
-    csParam.v = in;
-    csParam.nColor = 3;
-    csParam.nSpin = 4;
-    csParam.nDim = 5; //for DW dslash
-    for (int d=0; d<4; d++) csParam.x[d] = Z[d];
-    csParam.x[4] = Ls;//5th dimention
-    csParam.setPrecision(precision);
-    csParam.pad = 0;
-    csParam.siteSubset = QUDA_PARITY_SITE_SUBSET;
-    csParam.x[0] /= 2;
-    csParam.siteOrder = QUDA_EVEN_ODD_SITE_ORDER;
-    csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
-    csParam.gammaBasis = QUDA_DEGRAND_ROSSI_GAMMA_BASIS;
-    csParam.create = QUDA_REFERENCE_FIELD_CREATE;
-    csParam.pc_type = QUDA_4D_PC;
-
-    cpuColorSpinorField inField(csParam);
-
-    {  // Now do the exchange
-      QudaParity otherParity = QUDA_INVALID_PARITY;
-      if (oddBit == QUDA_EVEN_PARITY) otherParity = QUDA_ODD_PARITY;
-      else if (oddBit == QUDA_ODD_PARITY) otherParity = QUDA_EVEN_PARITY;
-      else errorQuda("ERROR: full parity not supported in function %s", __FUNCTION__);
-      const int nFace = 1;
-
-      inField.exchangeGhost(otherParity, nFace, daggerBit);
-    }
-    void** fwd_nbr_spinor = inField.fwdGhostFaceBuffer;
-    void** back_nbr_spinor = inField.backGhostFaceBuffer;
+
+    SpinorGhostBatch ghost = exchange5dGhost(in, nSrc, oddBit, daggerBit, QUDA_4D_PC, precision);
+
     if (precision == QUDA_DOUBLE_PRECISION) {
-      dslashReference_4d_mgpu<QUDA_4D_PC>((double*)out, (double**)gauge, (double**)ghostGauge, (double*)in,(double**)fwd_nbr_spinor, (double**)back_nbr_spinor, oddBit, daggerBit);
+      dslashReference_4d_mgpu<QUDA_4D_PC>((double **)out, (double **)gauge, (double **)ghostGauge, (double **)in, ghost,
+                                          nSrc, oddBit, daggerBit);
     } else {
-      dslashReference_4d_mgpu<QUDA_4D_PC>((float*)out, (float**)gauge, (float**)ghostGauge, (float*)in,
-					  (float**)fwd_nbr_spinor, (float**)back_nbr_spinor, oddBit, daggerBit);
+      dslashReference_4d_mgpu<QUDA_4D_PC>((float **)out, (float **)gauge, (float **)ghostGauge, (float **)in, ghost,
+                                          nSrc, oddBit, daggerBit);
     }
 
 #endif
@@ -1197,7 +1043,19 @@ void mdw_matpc(void *out, void **gauge, void *in, double _Complex *kappa_b, doub
     QudaMatPCType matpc_type, int dagger, QudaPrecision precision, QudaGaugeParam &gauge_param, double mferm,
     double _Complex *b5, double _Complex *c5)
 {
-  void *tmp = malloc(V5h * spinor_site_size * precision);
+  mdw_matpc_multi(&out, gauge, &in, 1, kappa_b, kappa_c, matpc_type, dagger, precision, gauge_param, mferm, b5, c5);
+}
+
+// Apply the preconditioned Mobius operator to nSrc fields at once.  Only
+// the 4-d hopping term touches the gauge field, so that is batched over
+// the sources; the fifth-dimension terms are applied source by source.
+void mdw_matpc_multi(void **out, void **gauge, void **in, int nSrc, double _Complex *kappa_b,
+    double _Complex *kappa_c, QudaMatPCType matpc_type, int dagger, QudaPrecision precision,
+    QudaGaugeParam &gauge_param, double mferm, double _Complex *b5, double _Complex *c5)
+{
+  std::vector<void *> tmp_(nSrc);
+  for (int src = 0; src < nSrc; src++) tmp_[src] = malloc(V5h * spinor_site_size * precision);
+  void **tmp = tmp_.data();
   double _Complex *kappa5 = (double _Complex *)malloc(Ls * sizeof(double _Complex));
   double _Complex *kappa2 = (double _Complex *)malloc(Ls * sizeof(double _Complex));
   double _Complex *kappa_mdwf = (double _Complex *)malloc(Ls * sizeof(double _Complex));
@@ -1212,55 +1070,67 @@ void mdw_matpc(void *out, void **gauge, void *in, double _Complex *kappa_b, doub
   bool symmetric =(matpc_type == QUDA_MATPC_EVEN_EVEN || matpc_type == QUDA_MATPC_ODD_ODD) ? true : false;
   QudaParity parity[2] = {static_cast<QudaParity>((1 + odd_bit) % 2), static_cast<QudaParity>((0 + odd_bit) % 2)};
 
-  if (symmetric && !dagger) {
-    mdw_dslash_4_pre(tmp, gauge, in, parity[1], dagger, precision, gauge_param, mferm, b5, c5, true);
-    dslash_4_4d(out, gauge, tmp, parity[0], dagger, precision, gauge_param, mferm);
-    mdw_dslash_5_inv(tmp, gauge, out, parity[1], dagger, precision, gauge_param, mferm, kappa_mdwf);
-    mdw_dslash_4_pre(out, gauge, tmp, parity[0], dagger, precision, gauge_param, mferm, b5, c5, true);
-    dslash_4_4d(tmp, gauge, out, parity[1], dagger, precision, gauge_param, mferm);
-    mdw_dslash_5_inv(out, gauge, tmp, parity[0], dagger, precision, gauge_param, mferm, kappa_mdwf);
-    for(int xs = 0 ; xs < Ls ; xs++) {
-      cxpay((char *)in + precision * Vh * spinor_site_size * xs, kappa2[xs],
-            (char *)out + precision * Vh * spinor_site_size * xs, Vh * spinor_site_size, precision);
+  auto dslash_4 = [&](void **res, void **x, int p) {
+    dslash_4_4d_multi(res, gauge, x, nSrc, p, dagger, precision, gauge_param, mferm);
+  };
+  auto dslash_4_pre = [&](void **res, void **x, int p) {
+    for (int src = 0; src < nSrc; src++)
+      mdw_dslash_4_pre(res[src], gauge, x[src], p, dagger, precision, gauge_param, mferm, b5, c5, true);
+  };
+  auto dslash_5_inv = [&](void **res, void **x, int p) {
+    for (int src = 0; src < nSrc; src++)
+      mdw_dslash_5_inv(res[src], gauge, x[src], p, dagger, precision, gauge_param, mferm, kappa_mdwf);
+  };
+  auto dslash_5 = [&](void **res, void **x, int p) {
+    for (int src = 0; src < nSrc; src++)
+      mdw_dslash_5(res[src], gauge, x[src], p, dagger, precision, gauge_param, mferm, kappa5, true);
+  };
+  auto xpay_5 = [&](void **x, void **y) {
+    for (int src = 0; src < nSrc; src++) {
+      for (int xs = 0; xs < Ls; xs++) {
+        cxpay((char *)x[src] + precision * Vh * spinor_site_size * xs, kappa2[xs],
+              (char *)y[src] + precision * Vh * spinor_site_size * xs, Vh * spinor_site_size, precision);
+      }
     }
+  };
+
+  if (symmetric && !dagger) {
+    dslash_4_pre(tmp, in, parity[1]);
+    dslash_4(out, tmp, parity[0]);
+    dslash_5_inv(tmp, out, parity[1]);
+    dslash_4_pre(out, tmp, parity[0]);
+    dslash_4(tmp, out, parity[1]);
+    dslash_5_inv(out, tmp, parity[0]);
+    xpay_5(in, out);
   } else if (symmetric && dagger) {
-    mdw_dslash_5_inv(tmp, gauge, in, parity[1], dagger, precision, gauge_param, mferm, kappa_mdwf);
-    dslash_4_4d(out, gauge, tmp, parity[0], dagger, precision, gauge_param, mferm);
-    mdw_dslash_4_pre(tmp, gauge, out, parity[0], dagger, precision, gauge_param, mferm, b5, c5, true);
-    mdw_dslash_5_inv(out, gauge, tmp, parity[0], dagger, precision, gauge_param, mferm, kappa_mdwf);
-    dslash_4_4d(tmp, gauge, out, parity[1], dagger, precision, gauge_param, mferm);
-    mdw_dslash_4_pre(out, gauge, tmp, parity[1], dagger, precision, gauge_param, mferm, b5, c5, true);
-    for(int xs = 0 ; xs < Ls ; xs++) {
-      cxpay((char *)in + precision * Vh * spinor_site_size * xs, kappa2[xs],
-            (char *)out + precision * Vh * spinor_site_size * xs, Vh * spinor_site_size, precision);
-    }
+    dslash_5_inv(tmp, in, parity[1]);
+    dslash_4(out, tmp, parity[0]);
+    dslash_4_pre(tmp, out, parity[0]);
+    dslash_5_inv(out, tmp, parity[0]);
+    dslash_4(tmp, out, parity[1]);
+    dslash_4_pre(out, tmp, parity[1]);
+    xpay_5(in, out);
   } else if (!symmetric && !dagger) {
-    mdw_dslash_4_pre(out, gauge, in, parity[1], dagger, precision, gauge_param, mferm, b5, c5, true);
-    dslash_4_4d(tmp, gauge, out, parity[0], dagger, precision, gauge_param, mferm);
-    mdw_dslash_5_inv(out, gauge, tmp, parity[1], dagger, precision, gauge_param, mferm, kappa_mdwf);
-    mdw_dslash_4_pre(tmp, gauge, out, parity[0], dagger, precision, gauge_param, mferm, b5, c5, true);
-    dslash_4_4d(out, gauge, tmp, parity[1], dagger, precision, gauge_param, mferm);
-    mdw_dslash_5(tmp, gauge, in, parity[0], dagger, precision, gauge_param, mferm, kappa5, true);
-    for(int xs = 0 ; xs < Ls ; xs++) {
-      cxpay((char *)tmp + precision * Vh * spinor_site_size * xs, kappa2[xs],
-            (char *)out + precision * Vh * spinor_site_size * xs, Vh * spinor_site_size, precision);
-    }
+    dslash_4_pre(out, in, parity[1]);
+    dslash_4(tmp, out, parity[0]);
+    dslash_5_inv(out, tmp, parity[1]);
+    dslash_4_pre(tmp, out, parity[0]);
+    dslash_4(out, tmp, parity[1]);
+    dslash_5(tmp, in, parity[0]);
+    xpay_5(tmp, out);
   } else if (!symmetric && dagger) {
-    dslash_4_4d(out, gauge, in, parity[0], dagger, precision, gauge_param, mferm);
-    mdw_dslash_4_pre(tmp, gauge, out, parity[1], dagger, precision, gauge_param, mferm, b5, c5, true);
-    mdw_dslash_5_inv(out, gauge, tmp, parity[0], dagger, precision, gauge_param, mferm, kappa_mdwf);
-    dslash_4_4d(tmp, gauge, out, parity[1], dagger, precision, gauge_param, mferm);
-    mdw_dslash_4_pre(out, gauge, tmp, parity[0], dagger, precision, gauge_param, mferm, b5, c5, true);
-    mdw_dslash_5(tmp, gauge, in, parity[0], dagger, precision, gauge_param, mferm, kappa5, true);
-    for(int xs = 0 ; xs < Ls ; xs++) {
-      cxpay((char *)tmp + precision * Vh * spinor_site_size * xs, kappa2[xs],
-            (char *)out + precision * Vh * spinor_site_size * xs, Vh * spinor_site_size, precision);
-    }
+    dslash_4(out, in, parity[0]);
+    dslash_4_pre(tmp, out, parity[1]);
+    dslash_5_inv(out, tmp, parity[0]);
+    dslash_4(tmp, out, parity[1]);
+    dslash_4_pre(out, tmp, parity[0]);
+    dslash_5(tmp, in, parity[0]);
+    xpay_5(tmp, out);
   } else {
     errorQuda("Unsupported matpc_type=%d dagger=%d", matpc_type, dagger);
   }
 
-  free(tmp);
+  for (int src = 0; src < nSrc; src++) free(tmp[src]);
   free(kappa5);
   free(kappa2);
   free(kappa_mdwf);
@@ -14,6 +14,9 @@ void dw_dslash(void *res, void **gaugeFull, void *spinorField, int oddBit, int d
 void dslash_4_4d(void *res, void **gaugeFull, void *spinorField, int oddBit, int dagger, QudaPrecision precision,
     QudaGaugeParam &param, double mferm);
 
+void dslash_4_4d_multi(void **res, void **gaugeFull, void **spinorField, int nSrc, int oddBit, int dagger,
+    QudaPrecision precision, QudaGaugeParam &param, double mferm);
+
 void dw_dslash_5_4d(void *res, void **gaugeFull, void *spinorField, int oddBit, int dagger, QudaPrecision precision,
     QudaGaugeParam &param, double mferm, bool zero_initialize);
 
@@ -51,6 +54,10 @@ void mdw_matpc(void *out, void **gauge, void *in, double _Complex *kappa_b, doub
     QudaMatPCType matpc_type, int dagger, QudaPrecision precision, QudaGaugeParam &gauge_param, double mferm,
     double _Complex *b5, double _Complex *c5);
 
+void mdw_matpc_multi(void **out, void **gauge, void **in, int nSrc, double _Complex *kappa_b,
+    double _Complex *kappa_c, QudaMatPCType matpc_type, int dagger, QudaPrecision precision,
+    QudaGaugeParam &gauge_param, double mferm, double _Complex *b5, double _Complex *c5);
+
 void mdw_mdagm_local(void *out, void **gauge, void *in, double _Complex *kappa_b, double _Complex *kappa_c,
                      QudaMatPCType matpc_type, QudaPrecision precision, QudaGaugeParam &gauge_param, double mferm,
                      double _Complex *b5, double _Complex *c5);
@@ -10,6 +10,34 @@
 #include <staggered_dslash_reference.h>
 #include <command_line_params.h>
 
+#ifdef MULTI_GPU
+SpinorGhostBatch::SpinorGhostBatch(quda::ColorSpinorParam param, void **in, int nSrc, QudaParity parity, int nFace,
+                                   int dagger) :
+  buffer(8 * nSrc), fwd_ptr(4 * nSrc), back_ptr(4 * nSrc)
+{
+  param.create = QUDA_REFERENCE_FIELD_CREATE;
+  for (int src = 0; src < nSrc; src++) {
+    param.v = in[src];
+    quda::cpuColorSpinorField field(param);
+    field.exchangeGhost(parity, nFace, dagger);
+
+    for (int d = 0; d < 4; d++) {
+      const size_t bytes = quda::cpuColorSpinorField::ghostFaceBytes[d];
+      std::vector<char> &fwd_buf = buffer[8 * src + 2 * d + 0];
+      std::vector<char> &back_buf = buffer[8 * src + 2 * d + 1];
+      fwd_buf.resize(bytes);
+      back_buf.resize(bytes);
+      if (bytes) {
+        memcpy(fwd_buf.data(), quda::cpuColorSpinorField::fwdGhostFaceBuffer[d], bytes);
+        memcpy(back_buf.data(), quda::cpuColorSpinorField::backGhostFaceBuffer[d], bytes);
+      }
+      fwd_ptr[4 * src + d] = fwd_buf.data();
+      back_ptr[4 * src + d] = back_buf.data();
+    }
+  }
+}
+#endif
+
 // Overload for workflows without multishift
 void verifyInversion(void *spinorOut, void *spinorIn, void *spinorCheck, QudaGaugeParam &gauge_param,
                      QudaInvertParam &inv_param, void **gauge, void *clover, void *clover_inv)
@@ -36,6 +64,83 @@ void verifyInversion(void *spinorOut, void **spinorOutMulti, void *spinorIn, voi
   }
 }
 
+void verifyInversionMultiSrc(void **spinorOut, void **spinorIn, void *spinorCheck, QudaGaugeParam &gauge_param,
+                             QudaInvertParam &inv_param, void **gauge, void *clover, void *clover_inv)
+{
+  const int nSrc = inv_param.num_src;
+  const bool batched = multishift == 1 && (dslash_type == QUDA_WILSON_DSLASH || dslash_type == QUDA_MOBIUS_DWF_DSLASH)
+    && (inv_param.solution_type == QUDA_MATPC_SOLUTION || inv_param.solution_type == QUDA_MATPCDAG_MATPC_SOLUTION);
+
+  if (!batched) {
+    for (int i = 0; i < nSrc; i++)
+      verifyInversion(spinorOut[i], spinorIn[i], spinorCheck, gauge_param, inv_param, gauge, clover, clover_inv);
+    return;
+  }
+
+  if (inv_param.solution_type == QUDA_MATPCDAG_MATPC_SOLUTION
+      && inv_param.mass_normalization == QUDA_MASS_NORMALIZATION) {
+    errorQuda("Mass normalization %s not implemented", get_mass_normalization_str(inv_param.mass_normalization));
+  }
+
+  const size_t bytes = V * spinor_site_size * host_spinor_data_type_size * inv_param.Ls;
+  std::vector<void *> check(nSrc), tmp(nSrc);
+  for (int i = 0; i < nSrc; i++) {
+    check[i] = malloc(bytes);
+    tmp[i] = malloc(bytes);
+  }
+
+  double _Complex *kappa_b = nullptr;
+  double _Complex *kappa_c = nullptr;
+  if (dslash_type == QUDA_MOBIUS_DWF_DSLASH) {
+    kappa_b = (double _Complex *)malloc(Lsdim * sizeof(double _Complex));
+    kappa_c = (double _Complex *)malloc(Lsdim * sizeof(double _Complex));
+    for (int xs = 0; xs < Lsdim; xs++) {
+      kappa_b[xs] = 1.0 / (2 * (inv_param.b_5[xs] * (4.0 + inv_param.m5) + 1.0));
+      kappa_c[xs] = 1.0 / (2 * (inv_param.c_5[xs] * (4.0 + inv_param.m5) - 1.0));
+    }
+  }
+
+  auto matpc = [&](void **out, void **in, int dagger) {
+    if (dslash_type == QUDA_WILSON_DSLASH) {
+      wil_matpc_multi(out, gauge, in, nSrc, inv_param.kappa, inv_param.matpc_type, dagger, inv_param.cpu_prec,
+                      gauge_param);
+    } else {
+      mdw_matpc_multi(out, gauge, in, nSrc, kappa_b, kappa_c, inv_param.matpc_type, dagger, inv_param.cpu_prec,
+                      gauge_param, inv_param.mass, inv_param.b_5, inv_param.c_5);
+    }
+  };
+
+  if (inv_param.solution_type == QUDA_MATPC_SOLUTION) {
+    matpc(check.data(), spinorOut, 0);
+  } else {
+    matpc(tmp.data(), spinorOut, 0);
+    matpc(check.data(), tmp.data(), 1);
+  }
+
+  const int length = Vh * spinor_site_size * inv_param.Ls;
+  for (int i = 0; i < nSrc; i++) {
+    if (inv_param.solution_type == QUDA_MATPC_SOLUTION && inv_param.mass_normalization == QUDA_MASS_NORMALIZATION) {
+      double k = dslash_type == QUDA_WILSON_DSLASH ? inv_param.kappa : kappa5;
+      ax(0.25 / (k * k), check[i], length, inv_param.cpu_prec);
+    }
+
+    mxpy(spinorIn[i], check[i], length, inv_param.cpu_prec);
+    double nrm2 = norm_2(check[i], length, inv_param.cpu_prec);
+    double src2 = norm_2(spinorIn[i], length, inv_param.cpu_prec);
+    double l2r = sqrt(nrm2 / src2);
+
+    printfQuda("Source %d residuals: (L2 relative) tol %g, QUDA = %g, host = %g; (heavy-quark) tol %g, QUDA = %g\n", i,
+               inv_param.tol, inv_param.true_res, l2r, inv_param.tol_hq, inv_param.true_res_hq);
+  }
+
+  free(kappa_b);
+  free(kappa_c);
+  for (int i = 0; i < nSrc; i++) {
+    free(check[i]);
+    free(tmp[i]);
+  }
+}
+
 void verifyDomainWallTypeInversion(void *spinorOut, void **spinorOutMulti, void *spinorIn, void *spinorCheck,
                                    QudaGaugeParam &gauge_param, QudaInvertParam &inv_param, void **gauge, void *clover,
                                    void *clover_inv)
@@ -441,3 +546,49 @@ void verifyStaggeredInversion(quda::ColorSpinorField *tmp, quda::ColorSpinorFiel
     }
   }
 }
+
+int verifyStaggeredInversionMultiSrc(const std::vector<quda::ColorSpinorField *> &in,
+                                     const std::vector<quda::ColorSpinorField *> &out, double mass, void *qdp_fatlink[],
+                                     void *qdp_longlink[], void **ghost_fatlink, void **ghost_longlink,
+                                     QudaGaugeParam &gauge_param, QudaInvertParam &inv_param)
+{
+  QudaParity parity = QUDA_INVALID_PARITY;
+  if (inv_param.matpc_type == QUDA_MATPC_EVEN_EVEN) {
+    parity = QUDA_EVEN_PARITY;
+  } else if (inv_param.matpc_type == QUDA_MATPC_ODD_ODD) {
+    parity = QUDA_ODD_PARITY;
+  } else {
+    errorQuda("Unsupported matpc_type=%s", get_matpc_str(inv_param.matpc_type));
+  }
+
+  const int nSrc = in.size();
+  std::vector<quda::ColorSpinorField *> ref(nSrc);
+  quda::ColorSpinorParam param(*out[0]);
+  param.create = QUDA_ZERO_FIELD_CREATE;
+  for (auto &r : ref) r = quda::ColorSpinorField::Create(param);
+
+  staggeredMatDagMat(ref, qdp_fatlink, qdp_longlink, ghost_fatlink, ghost_longlink, out, mass, 0, inv_param.cpu_prec,
+                     gauge_param.cpu_prec, parity, dslash_type);
+
+  const int len = Vh * my_spinor_site_size;
+  int failed = 0;
+  for (int i = 0; i < nSrc; i++) {
+    mxpy(in[i]->V(), ref[i]->V(), len, inv_param.cpu_prec);
+    double nrm2 = norm_2(ref[i]->V(), len, inv_param.cpu_prec);
+    double src2 = norm_2(in[i]->V(), len, inv_param.cpu_prec);
+    double hqr = sqrt(quda::blas::HeavyQuarkResidualNorm(*out[i], *ref[i]).z);
+    double l2r = sqrt(nrm2 / src2);
+
+    printfQuda("Source %d residuals: (L2 relative) tol %g, QUDA = %g, host = %g; (heavy-quark) tol %g, QUDA = %g, "
+               "host = %g\n",
+               i, inv_param.tol, inv_param.true_res, l2r, inv_param.tol_hq, inv_param.true_res_hq, hqr);
+    // Empirical: if the cpu residue is more than 1 order the target accuracy, then it fails to converge
+    if (l2r > 10 * inv_param.tol) {
+      printfQuda("Source %d has empirically failed to converge\n", i);
+      failed++;
+    }
+  }
+
+  for (auto r : ref) delete r;
+  return failed;
+}
@@ -3,10 +3,13 @@
 #include <math.h>
 #include <string.h>
 #include <type_traits>
+#include <algorithm>
+#include <vector>
 
 #include "quda.h"
 #include "gauge_field.h"
 #include "host_utils.h"
+#include "host_su3.h"
 #include "misc.h"
 #include "gauge_force_reference.h"
 
@@ -16,36 +19,6 @@ extern int Vh;
 extern int Vh_ex;
 extern int E[4];
 
-#define CADD(a, b, c)                                                                                                  \
-  {                                                                                                                    \
-    (c).real = (a).real + (b).real;                                                                                    \
-    (c).imag = (a).imag + (b).imag;                                                                                    \
-  }
-#define CMUL(a, b, c)                                                                                                  \
-  {                                                                                                                    \
-    (c).real = (a).real * (b).real - (a).imag * (b).imag;                                                              \
-    (c).imag = (a).real * (b).imag + (a).imag * (b).real;                                                              \
-  }
-#define CSUM(a, b)                                                                                                     \
-  {                                                                                                                    \
-    (a).real += (b).real;                                                                                              \
-    (a).imag += (b).imag;                                                                                              \
-  }
-
-/* c = a* * b */
-#define CMULJ_(a, b, c)                                                                                                \
-  {                                                                                                                    \
-    (c).real = (a).real * (b).real + (a).imag * (b).imag;                                                              \
-    (c).imag = (a).real * (b).imag - (a).imag * (b).real;                                                              \
-  }
-
-/* c = a * b* */
-#define CMUL_J(a, b, c)                                                                                                \
-  {                                                                                                                    \
-    (c).real = (a).real * (b).real + (a).imag * (b).imag;                                                              \
-    (c).imag = (a).imag * (b).real - (a).real * (b).imag;                                                              \
-  }
-
 #define CONJG(a, b)                                                                                                    \
   {                                                                                                                    \
     (b).real = (a).real;                                                                                               \
@@ -162,47 +135,20 @@ static void scalar_mult_add_su3_matrix(su3_matrix *a, su3_matrix *b, Float s, su
 
 template <typename su3_matrix> static void mult_su3_nn(su3_matrix *a, su3_matrix *b, su3_matrix *c)
 {
-  typename std::remove_reference<decltype(a->e[0][0])>::type x, y;
-  for (int i = 0; i < 3; i++) {
-    for (int j = 0; j < 3; j++) {
-      x.real = x.imag = 0.0;
-      for (int k = 0; k < 3; k++) {
-        CMUL(a->e[i][k], b->e[k][j], y);
-        CSUM(x, y);
-      }
-      c->e[i][j] = x;
-    }
-  }
+  using real = decltype(a->e[0][0].real);
+  su3_mat_mat_nn(reinterpret_cast<real *>(c), reinterpret_cast<real *>(a), reinterpret_cast<real *>(b));
 }
 
 template <typename su3_matrix> static void mult_su3_an(su3_matrix *a, su3_matrix *b, su3_matrix *c)
 {
-  typename std::remove_reference<decltype(a->e[0][0])>::type x, y;
-  for (int i = 0; i < 3; i++) {
-    for (int j = 0; j < 3; j++) {
-      x.real = x.imag = 0.0;
-      for (int k = 0; k < 3; k++) {
-        CMULJ_(a->e[k][i], b->e[k][j], y);
-        CSUM(x, y);
-      }
-      c->e[i][j] = x;
-    }
-  }
+  using real = decltype(a->e[0][0].real);
+  su3_mat_mat_an(reinterpret_cast<real *>(c), reinterpret_cast<real *>(a), reinterpret_cast<real *>(b));
 }
 
 template <typename su3_matrix> static void mult_su3_na(su3_matrix *a, su3_matrix *b, su3_matrix *c)
 {
-  typename std::remove_reference<decltype(a->e[0][0])>::type x, y;
-  for (int i = 0; i < 3; i++) {
-    for (int j = 0; j < 3; j++) {
-      x.real = x.imag = 0.0;
-      for (int k = 0; k < 3; k++) {
-        CMUL_J(a->e[i][k], b->e[j][k], y);
-        CSUM(x, y);
-      }
-      c->e[i][j] = x;
-    }
-  }
+  using real = decltype(a->e[0][0].real);
+  su3_mat_mat_na(reinterpret_cast<real *>(c), reinterpret_cast<real *>(a), reinterpret_cast<real *>(b));
 }
 
 template <typename su3_matrix> void print_su3_matrix(su3_matrix *a)
@@ -266,116 +212,131 @@ int gf_neighborIndexFullLattice(int i, int dx4, int dx3, int dx2, int dx1)
   return ret;
 }
 
-// this functon compute one path for all lattice sites
+/**
+   @brief The paths of one direction of the force merged into a
+   prefix trie.  Node n applies one link to the product of its parent,
+   so the product of a path is the product at its last node, and
+   sub-products shared by several paths, e.g., the common prefixes of
+   the rectangles and chairs, are only formed once per site.  Nodes
+   are stored in insertion order, so a parent precedes its children
+   and the products can be formed in a single sweep.
+*/
+struct PathTrie {
+  struct Node {
+    int parent;  // the parent node
+    int step;    // the path step that leads here from the parent
+    int nbr[4];  // displacement of the site of the link applied
+    int pos[4];  // displacement reached after the step
+  };
+  std::vector<Node> node;     // node 0 is the root: the identity
+  std::vector<int> path_end;  // the last node of each path
+
+  PathTrie(int dir, int **path, const int *length, int num_paths)
+  {
+    Node root = {-1, -1, {0, 0, 0, 0}, {0, 0, 0, 0}};
+    root.pos[dir] = 1;
+    node.push_back(root);
+
+    for (int p = 0; p < num_paths; p++) {
+      int n = 0;
+      for (int j = 0; j < length[p]; j++) {
+        int child = 0;
+        for (int c = n + 1; c < static_cast<int>(node.size()); c++)
+          if (node[c].parent == n && node[c].step == path[p][j]) child = c;
+
+        if (!child) {
+          Node next = {n, path[p][j], {}, {}};
+          for (int d = 0; d < 4; d++) next.pos[d] = node[n].pos[d];
+          if (GOES_FORWARDS(path[p][j])) {
+            for (int d = 0; d < 4; d++) next.nbr[d] = next.pos[d];
+            next.pos[path[p][j]] += 1;
+          } else {
+            next.pos[OPP_DIR(path[p][j])] -= 1;
+            for (int d = 0; d < 4; d++) next.nbr[d] = next.pos[d];
+          }
+          node.push_back(next);
+          child = node.size() - 1;
+        }
+        n = child;
+      }
+      path_end.push_back(n);
+    }
+  }
+};
+
+// compute the staple of one site and direction from the products of
+// the trie nodes, which are summed in the order of the path list, so
+// the result is that of evaluating each path in turn
 template <typename su3_matrix, typename Float>
-static void compute_path_product(su3_matrix *staple, su3_matrix **sitelink, su3_matrix **sitelink_ex_2d, int *path,
-                                 int len, Float loop_coeff, int dir)
+static void compute_staple(su3_matrix *staple, su3_matrix *prod, const PathTrie &trie, su3_matrix **sitelink,
+                           su3_matrix **sitelink_ex_2d, const Float *loop_coeff, int i)
 {
-  su3_matrix prev_matrix, curr_matrix, tmat;
-  int dx[4];
-
-  for (int i = 0; i < V; i++) {
-    memset(dx, 0, sizeof(dx));
-    memset(&curr_matrix, 0, sizeof(curr_matrix));
-
-    curr_matrix.e[0][0].real = 1.0;
-    curr_matrix.e[1][1].real = 1.0;
-    curr_matrix.e[2][2].real = 1.0;
-
-    dx[dir] = 1;
-    for (int j = 0; j < len; j++) {
-      int lnkdir;
-
-      prev_matrix = curr_matrix;
-      if (GOES_FORWARDS(path[j])) {
-        // dx[path[j]] +=1;
-        lnkdir = path[j];
-      } else {
-        dx[OPP_DIR(path[j])] -= 1;
-        lnkdir = OPP_DIR(path[j]);
-      }
+  memset(&prod[0], 0, sizeof(prod[0]));
+  prod[0].e[0][0].real = 1.0;
+  prod[0].e[1][1].real = 1.0;
+  prod[0].e[2][2].real = 1.0;
+
+  for (size_t n = 1; n < trie.node.size(); n++) {
+    const auto &node = trie.node[n];
+    bool forwards = GOES_FORWARDS(node.step);
+    int lnkdir = forwards ? node.step : OPP_DIR(node.step);
 
-      int nbr_idx = gf_neighborIndexFullLattice(i, dx[3], dx[2], dx[1], dx[0]);
+    int nbr_idx = gf_neighborIndexFullLattice(i, node.nbr[3], node.nbr[2], node.nbr[1], node.nbr[0]);
 #ifdef MULTI_GPU
-      su3_matrix *lnk = sitelink_ex_2d[lnkdir] + nbr_idx;
+    su3_matrix *lnk = sitelink_ex_2d[lnkdir] + nbr_idx;
 #else
-      su3_matrix *lnk = sitelink[lnkdir] + nbr_idx;
+    su3_matrix *lnk = sitelink[lnkdir] + nbr_idx;
 #endif
-      if (GOES_FORWARDS(path[j])) {
-        mult_su3_nn(&prev_matrix, lnk, &curr_matrix);
-      } else {
-        mult_su3_na(&prev_matrix, lnk, &curr_matrix);
-      }
-
-      if (GOES_FORWARDS(path[j])) {
-        dx[path[j]] += 1;
-      } else {
-        // we already substract one in the code above
-      }
-
-    } // j
+    if (forwards)
+      mult_su3_nn(&prod[node.parent], lnk, &prod[n]);
+    else
+      mult_su3_na(&prod[node.parent], lnk, &prod[n]);
+  }
 
-    su3_adjoint(&curr_matrix, &tmat);
-    scalar_mult_add_su3_matrix(staple + i, &tmat, loop_coeff, staple + i);
-  } // i
+  memset(staple, 0, sizeof(*staple));
+  for (size_t p = 0; p < trie.path_end.size(); p++) {
+    su3_matrix tmat;
+    su3_adjoint(&prod[trie.path_end[p]], &tmat);
+    scalar_mult_add_su3_matrix(staple, &tmat, loop_coeff[p], staple);
+  }
 }
 
 template <typename su3_matrix, typename anti_hermitmat, typename Float>
-static void update_mom(anti_hermitmat *momentum, int dir, su3_matrix **sitelink, su3_matrix *staple, Float eb3)
+static void update_mom(anti_hermitmat *mom, su3_matrix *lnk, su3_matrix *stp, Float eb3)
 {
-  for (int i = 0; i < V; i++) {
-    su3_matrix tmat1;
-    su3_matrix tmat2;
-    su3_matrix tmat3;
-
-    su3_matrix *lnk = sitelink[dir] + i;
-    su3_matrix *stp = staple + i;
-    anti_hermitmat *mom = momentum + 4 * i + dir;
+  su3_matrix tmat1;
+  su3_matrix tmat2;
+  su3_matrix tmat3;
 
-    mult_su3_na(lnk, stp, &tmat1);
-    uncompress_anti_hermitian(mom, &tmat2);
+  mult_su3_na(lnk, stp, &tmat1);
+  uncompress_anti_hermitian(mom, &tmat2);
 
-    scalar_mult_sub_su3_matrix(&tmat2, &tmat1, eb3, &tmat3);
-    make_anti_hermitian(&tmat3, mom);
-  }
+  scalar_mult_sub_su3_matrix(&tmat2, &tmat1, eb3, &tmat3);
+  make_anti_hermitian(&tmat3, mom);
 }
 
-/* This function only computes one direction @dir
- *
- */
-void gauge_force_reference_dir(void *refMom, int dir, double eb3, void **sitelink, void **sitelink_ex_2d,
-                               QudaPrecision prec, int **path_dir, int *length, void *loop_coeff, int num_paths)
+// Each (direction, site) pair is independent: its staple is formed in
+// a thread-local buffer and applied straight to its momentum.
+template <typename su3_matrix, typename anti_hermitmat, typename Float>
+static void gauge_force(anti_hermitmat *momentum, su3_matrix **sitelink, su3_matrix **sitelink_ex_2d,
+                        const std::vector<PathTrie> &trie, const Float *loop_coeff, Float eb3)
 {
-  void *staple;
-  int gSize = prec;
-
-  staple = malloc(V * gauge_site_size * gSize);
-  if (staple == NULL) {
-    fprintf(stderr, "ERROR: malloc failed for staple in functon %s\n", __FUNCTION__);
-    exit(1);
-  }
-
-  memset(staple, 0, V * gauge_site_size * gSize);
-
-  for (int i = 0; i < num_paths; i++) {
-    if (prec == QUDA_DOUBLE_PRECISION) {
-      double *my_loop_coeff = (double *)loop_coeff;
-      compute_path_product((dsu3_matrix *)staple, (dsu3_matrix **)sitelink, (dsu3_matrix **)sitelink_ex_2d, path_dir[i],
-                           length[i], my_loop_coeff[i], dir);
-    } else {
-      float *my_loop_coeff = (float *)loop_coeff;
-      compute_path_product((fsu3_matrix *)staple, (fsu3_matrix **)sitelink, (fsu3_matrix **)sitelink_ex_2d, path_dir[i],
-                           length[i], my_loop_coeff[i], dir);
+  size_t n_node = 0;
+  for (auto &t : trie) n_node = std::max(n_node, t.node.size());
+
+#pragma omp parallel
+  {
+    std::vector<su3_matrix> prod(n_node);
+
+#pragma omp for collapse(2)
+    for (int dir = 0; dir < 4; dir++) {
+      for (int i = 0; i < V; i++) {
+        su3_matrix staple;
+        compute_staple(&staple, prod.data(), trie[dir], sitelink, sitelink_ex_2d, loop_coeff, i);
+        update_mom(momentum + 4 * i + dir, sitelink[dir] + i, &staple, eb3);
+      }
     }
   }
-
-  if (prec == QUDA_DOUBLE_PRECISION) {
-    update_mom((danti_hermitmat *)refMom, dir, (dsu3_matrix **)sitelink, (dsu3_matrix *)staple, (double)eb3);
-  } else {
-    update_mom((fanti_hermitmat *)refMom, dir, (fsu3_matrix **)sitelink, (fsu3_matrix *)staple, (float)eb3);
-  }
-
-  free(staple);
 }
 
 void gauge_force_reference(void *refMom, double eb3, void **sitelink, QudaPrecision prec, int ***path_dir, int *length,
@@ -389,10 +350,17 @@ void gauge_force_reference(void *refMom, double eb3, void **sitelink, QudaPrecis
   param.t_boundary = QUDA_PERIODIC_T;
 
   auto qdp_ex = quda::createExtendedGauge((void **)sitelink, param, R);
+  void **sitelink_ex_2d = (void **)qdp_ex->Gauge_p();
 
-  for (int dir = 0; dir < 4; dir++) {
-    gauge_force_reference_dir(refMom, dir, eb3, sitelink, (void **)qdp_ex->Gauge_p(), prec, path_dir[dir], length,
-                              loop_coeff, num_paths);
+  std::vector<PathTrie> trie;
+  for (int dir = 0; dir < 4; dir++) trie.emplace_back(dir, path_dir[dir], length, num_paths);
+
+  if (prec == QUDA_DOUBLE_PRECISION) {
+    gauge_force((danti_hermitmat *)refMom, (dsu3_matrix **)sitelink, (dsu3_matrix **)sitelink_ex_2d, trie,
+                (double *)loop_coeff, (double)eb3);
+  } else {
+    gauge_force((fanti_hermitmat *)refMom, (fsu3_matrix **)sitelink, (fsu3_matrix **)sitelink_ex_2d, trie,
+                (float *)loop_coeff, (float)eb3);
   }
 
   delete qdp_ex;
@@ -6,6 +6,7 @@
 
 #include <quda.h>
 #include <host_utils.h>
+#include <host_su3.h>
 #include <misc.h>
 #include <hisq_force_reference.h>
 
@@ -187,32 +188,15 @@ template<typename su3_matrix, typename su3_vector>
 static void
 mult_su3_mat_vec( su3_matrix *a, su3_vector *b, su3_vector *c  )
 {
-    int i,j;
-    typename std::remove_reference<decltype(a->e[0][0])>::type x,y;
-    for(i=0;i<3;i++){
-	x.real=x.imag=0.0;
-	for(j=0;j<3;j++){
-	    CMUL( a->e[i][j] , b->c[j] , y );
-	    CSUM( x , y );
-	}
-	c->c[i]=x;
-    }
+  using real = decltype(a->e[0][0].real);
+  su3_mat_vec(reinterpret_cast<real *>(c), reinterpret_cast<real *>(a), reinterpret_cast<real *>(b));
 }
 template<typename su3_matrix, typename su3_vector>
 static void
 mult_adj_su3_mat_vec( su3_matrix *a, su3_vector *b, su3_vector *c )
 {
-    int i,j;
-    typename std::remove_reference<decltype(a->e[0][0])>::type x,y,z;
-    for(i=0;i<3;i++){
-	x.real=x.imag=0.0;
-	for(j=0;j<3;j++){
-	    CONJG( a->e[j][i], z );
-	    CMUL( z , b->c[j], y );
-	    CSUM( x , y );
-	}
-	c->c[i] = x;
-    }
+  using real = decltype(a->e[0][0].real);
+  su3_adj_mat_vec(reinterpret_cast<real *>(c), reinterpret_cast<real *>(a), reinterpret_cast<real *>(b));
 }
 
 template<typename su3_vector, typename su3_matrix>
@@ -260,19 +244,8 @@ template<typename su3_matrix>
 static void
 matrix_mult_nn(su3_matrix* a, su3_matrix* b, su3_matrix* c){
   // c = a*b
-  typename std::remove_reference<decltype(c->e[0][0])>::type x;
-  for(int i=0; i<3; i++){
-    for(int j=0; j<3; j++){	
-      c->e[i][j].real = 0.;
-      c->e[i][j].imag = 0.;
-      for(int k=0; k<3; k++){	
-	CMUL(a->e[i][k],b->e[k][j],x);
-	c->e[i][j].real += x.real;
-	c->e[i][j].imag += x.imag;
-      } 	
-    }	
-  }
-  return;
+  using real = decltype(a->e[0][0].real);
+  su3_mat_mat_nn(reinterpret_cast<real *>(c), reinterpret_cast<real *>(a), reinterpret_cast<real *>(b));
 }
 
 
@@ -280,19 +253,8 @@ template<typename su3_matrix>
 static void
 matrix_mult_an(su3_matrix* a, su3_matrix* b, su3_matrix* c){
   // c = (a^{\dagger})*b
-  typename std::remove_reference<decltype(c->e[0][0])>::type x;
-  for(int i=0; i<3; i++){
-    for(int j=0; j<3; j++){	
-      c->e[i][j].real = 0.;
-      c->e[i][j].imag = 0.;
-      for(int k=0; k<3; k++){	
-	CMULJ_(a->e[k][i],b->e[k][j],x);
-	c->e[i][j].real += x.real;
-	c->e[i][j].imag += x.imag;
-      } 	
-    }	
-  }
-  return;
+  using real = decltype(a->e[0][0].real);
+  su3_mat_mat_an(reinterpret_cast<real *>(c), reinterpret_cast<real *>(a), reinterpret_cast<real *>(b));
 }
 
 
@@ -301,18 +263,8 @@ template<typename su3_matrix>
 static void
 matrix_mult_na(su3_matrix* a, su3_matrix* b, su3_matrix* c){
   // c = a*b^{\dagger}
-  typename std::remove_reference<decltype(c->e[0][0])>::type x;
-  for(int i=0; i<3; i++){
-    for(int j=0; j<3; j++){
-      c->e[i][j].real = 0.; c->e[i][j].imag = 0.;
-      for(int k=0; k<3; k++){
-        CMUL_J(a->e[i][k],b->e[j][k],x);
-	c->e[i][j].real += x.real;
-	c->e[i][j].imag += x.imag;
-      }
-    }
-  }
-  return;
+  using real = decltype(a->e[0][0].real);
+  su3_mat_mat_na(reinterpret_cast<real *>(c), reinterpret_cast<real *>(a), reinterpret_cast<real *>(b));
 }
 
 template<typename su3_matrix>
@@ -330,6 +282,7 @@ update_mom(anti_hermitmat* momentum, int dir, su3_matrix* sitelink,
 	   su3_matrix* staple, Float eb3)
 {
     int i;
+#pragma omp parallel for
     for(i=0;i <V; i++){
 	su3_matrix tmat1;
 	su3_matrix tmat2;
@@ -361,6 +314,7 @@ u_shift_hw(half_wilson_vector *src, half_wilson_vector *dest, int dir, su3_matri
     
     if(GOES_FORWARDS(dir)){	
 	dx[dir]=1;	
+#pragma omp parallel for
 	for(i=0;i < V; i++){
 	    int nbr_idx = neighborIndexFullLattice(i, dx[3], dx[2], dx[1], dx[0]);
 	    half_wilson_vector* hw = src + nbr_idx;
@@ -370,6 +324,7 @@ u_shift_hw(half_wilson_vector *src, half_wilson_vector *dest, int dir, su3_matri
 	}	
     }else{
 	dx[OPP_DIR(dir)]=-1;
+#pragma omp parallel for
 	for(i=0;i < V; i++){
 	    int nbr_idx = neighborIndexFullLattice(i, dx[3], dx[2], dx[1], dx[0]);
 	    half_wilson_vector* hw = src + nbr_idx;
@@ -396,6 +351,7 @@ shifted_outer_prod(half_wilson_vector *src, su3_matrix* dest, int dir)
 	dx[dir]=1;	
     }else{ dx[OPP_DIR(dir)]=-1; }
 
+#pragma omp parallel for
     for(i=0;i < V; i++){
       int nbr_idx = neighborIndexFullLattice(i, dx[3], dx[2], dx[1], dx[0]);
       half_wilson_vector* hw = src + nbr_idx;
@@ -418,6 +374,7 @@ forward_shifted_outer_prod(half_wilson_vector *src, su3_matrix* dest, int dir)
     dx[dir]=1;	
   }else{ dx[OPP_DIR(dir)]=-1; }
 
+#pragma omp parallel for
   for(i=0;i < V; i++){
     int nbr_idx = neighborIndexFullLattice(i, dx[3], dx[2], dx[1], dx[0]);
     half_wilson_vector* hw = src + nbr_idx;
@@ -436,9 +393,10 @@ template <typename half_wilson_vector, typename su3_matrix>
 static void
 computeLinkOrderedOuterProduct(half_wilson_vector *src, su3_matrix* dest, int gauge_order)
 {
-  int dx[4];
+#pragma omp parallel for
   for(int i=0; i<V; ++i){
     for(int dir=0; dir<4; ++dir){
+      int dx[4];
       dx[3]=dx[2]=dx[1]=dx[0]=0;
       dx[dir] = 1;
       int nbr_idx = neighborIndexFullLattice(i, dx[3], dx[2], dx[1], dx[0]);
@@ -455,9 +413,10 @@ template <typename half_wilson_vector, typename su3_matrix>
 static void
 computeLinkOrderedOuterProduct(half_wilson_vector *src, su3_matrix* dest, size_t nhops, int gauge_order)
 {
-  int dx[4];
+#pragma omp parallel for
   for(int i=0; i<V; ++i){
     for(int dir=0; dir<4; ++dir){
+      int dx[4];
       dx[3]=dx[2]=dx[1]=dx[0]=0;
       dx[dir] = nhops;
       int nbr_idx = neighborIndexFullLattice(i, dx[3], dx[2], dx[1], dx[0]);
@@ -532,6 +491,7 @@ u_shift_mat(su3_matrix *src, su3_matrix *dest, int dir, su3_matrix* sitelink)
 
   if(GOES_FORWARDS(dir)){
     dx[dir]=1;
+#pragma omp parallel for
     for(i=0; i<V; i++){
       int nbr_idx = neighborIndexFullLattice(i, dx[3], dx[2], dx[1], dx[0]);
       su3_matrix* mat = src+nbr_idx; // No need for a factor of 4 here, the colour matrices do not have a Lorentz index
@@ -540,6 +500,7 @@ u_shift_mat(su3_matrix *src, su3_matrix *dest, int dir, su3_matrix* sitelink)
     }	
   }else{
     dx[OPP_DIR(dir)]=-1;
+#pragma omp parallel for
     for(i=0; i<V; i++){
       int nbr_idx = neighborIndexFullLattice(i, dx[3], dx[2], dx[1], dx[0]);
       su3_matrix* mat = src+nbr_idx; // No need for a factor of 4 here, the colour matrices do not have a Lorentz index
@@ -563,7 +524,6 @@ add_3f_force_to_mom(half_wilson_vector *back, half_wilson_vector *forw,
 		    int dir, Real coeff[2], anti_hermitmat* momentum) 
 {
     Real my_coeff[2] ;
-    Real tmp_coeff[2] ;
     int mydir;
     int i;
     
@@ -577,7 +537,9 @@ add_3f_force_to_mom(half_wilson_vector *back, half_wilson_vector *forw,
 	my_coeff[1] = coeff[1]; 
     }
     
+#pragma omp parallel for
     for(i=0;i < V;i++){
+	Real tmp_coeff[2] ;
 	if (i < Vh){
 	    tmp_coeff[0] = my_coeff[0];
 	    tmp_coeff[1] = my_coeff[1];
@@ -640,7 +602,6 @@ add_force_to_momentum(su3_matrix *back, su3_matrix *forw,
     int dir, Real coeff, anti_hermitmat* momentum)
 {
   Real my_coeff;
-  Real tmp_coeff;
   int mydir;
   int i;
 
@@ -653,7 +614,9 @@ add_force_to_momentum(su3_matrix *back, su3_matrix *forw,
   }
 
 
+#pragma omp parallel for
   for(i=0; i<V; i++){
+    Real tmp_coeff;
     if(i<Vh){ tmp_coeff = my_coeff; }
     else{ tmp_coeff = -my_coeff; }
 
@@ -740,6 +703,7 @@ static void set_identity_matrix(su3_matrix* mat)
 
 template<typename su3_matrix> 
 static void set_identity(su3_matrix* matrices, int num_dirs){
+#pragma omp parallel for
   for(int i=0; i<V*num_dirs; i++){
     set_identity_matrix(&matrices[i]);	
   }
@@ -882,6 +846,7 @@ void do_color_matrix_hisq_force_reference(Real eps, Real weight,
              u_shift_mat(P7, P7rho, rho, sitelink);
              side_link_force(rho, sig, SevenSt, Qnumu, P7, Qrhonumu, P7rho, mom);		    
              if(FiveSt != 0)coeff = SevenSt/FiveSt ; else coeff = 0;
+#pragma omp parallel for
              for(i=0; i<V; i++){
              scalar_mult_add_su3_matrix(&P5[i], &P7rho[i], coeff, &P5[i]);
              } // end loop over volume
@@ -893,6 +858,7 @@ void do_color_matrix_hisq_force_reference(Real eps, Real weight,
         // check this!
         if(ThreeSt != 0)coeff	= FiveSt/ThreeSt; else coeff = 0;
 
+#pragma omp parallel for
         for(i=0; i<V; i++){
         scalar_mult_add_su3_matrix(&P3[i], &P5nu[i], coeff, &P3[i]);
         } // end loop over volume
@@ -913,6 +879,7 @@ void do_color_matrix_hisq_force_reference(Real eps, Real weight,
 
       if(ThreeSt != 0)coeff = Lepage/ThreeSt; else coeff = 0;
 
+#pragma omp parallel for
       for(i=0; i<V; i++){
       scalar_mult_add_su3_matrix(&P3[i], &P5nu[i], coeff, &P3[i]);
       }
@@ -962,21 +929,24 @@ void do_halfwilson_hisq_force_reference(Real eps, Real weight,
 //    DirectLinks[mu] = 0 ;
 //  }
 
+  // The temporaries are carved from one allocation: the paths, the
+  // identity, the outer product and, since Qmu = U[mu] depends on mu
+  // alone, the shifts of the identity in each direction, which are
+  // made once here rather than for every sig.
+  su3_matrix* arena = (su3_matrix *)malloc( 19*sites_on_node*sizeof(su3_matrix) );
   for(mu=0; mu<9; mu++){	
-    tempmat[mu] = (su3_matrix *)malloc( sites_on_node*sizeof(su3_matrix) );  
+    tempmat[mu] = arena + mu*sites_on_node;  
   }
 
-
-  su3_matrix* id;
-  id = (su3_matrix *)malloc(sites_on_node*sizeof(su3_matrix) ); 
-  su3_matrix* id4;
-  id4 = (su3_matrix *)malloc(sites_on_node*4*sizeof(su3_matrix) ); 
-
-  su3_matrix* temp_mat;
-  temp_mat = (su3_matrix *)malloc(sites_on_node*sizeof(su3_matrix) ); 
+  su3_matrix* id = arena + 9*sites_on_node;
+  su3_matrix* temp_mat = arena + 10*sites_on_node;
+  su3_matrix* Qdir = arena + 11*sites_on_node;
 
   // initialise id so that it is the identity matrix on each lattice site
   set_identity(id,1);
+  for(mu=0; mu<8; mu++){
+    u_shift_mat(id, Qdir + mu*sites_on_node, OPP_DIR(mu), sitelink);
+  }
 
   printf("Calling hisq reference routine\n");
   for(sig=0; sig < 8; sig++){
@@ -1002,7 +972,7 @@ void do_halfwilson_hisq_force_reference(Real eps, Real weight,
       //
       //
       u_shift_mat(temp_mat, Pmu, OPP_DIR(mu), sitelink); // temp_xx[sig] stores |X(x)><X(x-sig)|
-      u_shift_mat(id, Qmu, OPP_DIR(mu), sitelink);       // This returns the path less the outer-product of quark fields at the end 
+      Qmu = Qdir + mu*sites_on_node;                     // This is the path less the outer-product of quark fields at the end 
 						         // Qmu = U[mu]	
 	
 
@@ -1061,6 +1031,7 @@ void do_halfwilson_hisq_force_reference(Real eps, Real weight,
 	  u_shift_mat(P7, P7rho, rho, sitelink);
 	  side_link_force(rho, sig, SevenSt, Qnumu, P7, Qrhonumu, P7rho, mom);		    
 	  if(FiveSt != 0)coeff = SevenSt/FiveSt ; else coeff = 0;
+#pragma omp parallel for
 	  for(i=0; i<V; i++){
 	    scalar_mult_add_su3_matrix(&P5[i], &P7rho[i], coeff, &P5[i]);
 	  } // end loop over volume
@@ -1072,6 +1043,7 @@ void do_halfwilson_hisq_force_reference(Real eps, Real weight,
 							       // check this!
 	if(ThreeSt != 0)coeff	= FiveSt/ThreeSt; else coeff = 0;
 	
+#pragma omp parallel for
         for(i=0; i<V; i++){
 	  scalar_mult_add_su3_matrix(&P3[i], &P5nu[i], coeff, &P3[i]);
 	} // end loop over volume
@@ -1092,6 +1064,7 @@ void do_halfwilson_hisq_force_reference(Real eps, Real weight,
 
       if(ThreeSt != 0)coeff = Lepage/ThreeSt; else coeff = 0;
 
+#pragma omp parallel for
       for(i=0; i<V; i++){
 	scalar_mult_add_su3_matrix(&P3[i], &P5nu[i], coeff, &P3[i]);
       }
@@ -1103,13 +1076,7 @@ void do_halfwilson_hisq_force_reference(Real eps, Real weight,
     } // end loop over mu
   } // end loop over sig
 
-  for(mu=0; mu<9; mu++){	
-    free(tempmat[mu]);
-  }
-  
-  free(id);
-  free(id4);
-  free(temp_mat);
+  free(arena);
 }
 
 #undef Pmu
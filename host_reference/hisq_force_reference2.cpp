@@ -804,6 +804,7 @@ struct ColorMatrix
      for(int dir=0; dir<4; ++dir) volume *= dim[dir];
      const int half_volume = volume/2;
      LoadStore<Real> ls(volume);
+#pragma omp parallel for
      for(int site=0; site<half_volume; ++site){
        computeOneLinkSite<Real,0>(dim, site, 
 			   oprod, 
@@ -812,6 +813,7 @@ struct ColorMatrix
 			 
      }
      // Loop over odd lattice sites
+#pragma omp parallel for
      for(int site=0; site<half_volume; ++site){
        computeOneLinkSite<Real,1>(dim, site, 
 			   oprod, 
@@ -953,8 +955,11 @@ struct ColorMatrix
 #endif
    // loop over the lattice volume	
    // To keep the code as close to the GPU code as possible, we'll 
-   // loop over the even sites first and then the odd sites
+   // loop over the even sites first and then the odd sites.
+   // Each site of a loop writes its own entries of the output fields,
+   // so the sites are processed in parallel.
    LoadStore<Real> ls(volume);
+#pragma omp parallel for
    for(int site=0; site<loop_count; ++site){
      computeMiddleLinkSite<Real, 0>(site, dim,
 				      oprod, Qprev, link,
@@ -963,6 +968,7 @@ struct ColorMatrix
 				      Pmu, P3, Qmu, newOprod);
    }
    // Loop over odd lattice sites
+#pragma omp parallel for
    for(int site=0; site<loop_count; ++site){
      computeMiddleLinkSite<Real,1>(site, dim,
 				   oprod, Qprev, link,
@@ -1074,6 +1080,7 @@ struct ColorMatrix
 #endif
     LoadStore<Real> ls(volume);
 
+#pragma omp parallel for
     for(int site=0; site<loop_count; ++site){
       computeSideLinkSite<Real,0>(site, dim,
 			  	  P3, Qprod, link, 
@@ -1082,6 +1089,7 @@ struct ColorMatrix
 			  	  ls, shortP, newOprod);
     }
 
+#pragma omp parallel for
     for(int site=0; site<loop_count; ++site){
       computeSideLinkSite<Real,1>(site, dim,
 			  	  P3, Qprod, link, 
@@ -1213,6 +1221,7 @@ struct ColorMatrix
 #endif
 
     LoadStore<Real> ls(volume);
+#pragma omp parallel for
     for(int site=0; site<loop_count; ++site){
 
       computeAllLinkSite<Real,0>(site, dim,
@@ -1223,6 +1232,7 @@ struct ColorMatrix
 				  shortP, newOprod);
     }
     
+#pragma omp parallel for
     for(int site=0; site<loop_count; ++site){
        computeAllLinkSite<Real, 1>(site, dim,
 				   oprod, Qprev, link,
@@ -1376,13 +1386,11 @@ struct ColorMatrix
 #else
     int len = volume;
 #endif    
-    // allocate memory for temporary fields
+    // allocate memory for temporary fields, carved from one block
+    const size_t bytes = len*18*(param.cpu_prec == QUDA_DOUBLE_PRECISION ? sizeof(double) : sizeof(float));
+    char* arena = (char*)malloc(6*bytes);
     void* tempmat[6]; 
-    if(param.cpu_prec == QUDA_DOUBLE_PRECISION){
-      for(int i=0; i<6; ++i) tempmat[i] = malloc(len*18*sizeof(double));
-    }else{
-      for(int i=0; i<6; ++i) tempmat[i] = malloc(len*18*sizeof(float));
-    }
+    for(int i=0; i<6; ++i) tempmat[i] = arena + i*bytes;
 
     PathCoefficients<double> act_path_coeff;
     act_path_coeff.one    = path_coeff[0];
@@ -1413,9 +1421,7 @@ struct ColorMatrix
       errorQuda("Unsupported precision");
     }
 
-    for(int i=0; i<6; ++i){
-      free(tempmat[i]);
-    }
+    free(arena);
     return;
   }
 
@@ -1489,6 +1495,7 @@ struct ColorMatrix
      const int half_volume = volume/2;
      
      LoadStore<Real> ls(volume);
+#pragma omp parallel for
      for(int site=0; site<half_volume; ++site){
        computeLongLinkSite<Real,0>(site, 
 			   dim,
@@ -1499,6 +1506,7 @@ struct ColorMatrix
 			 
      }
      // Loop over odd lattice sites
+#pragma omp parallel for
      for(int site=0; site<half_volume; ++site){
 	computeLongLinkSite<Real,1>(site, 
 			   dim,
@@ -1578,6 +1586,7 @@ void completeForceField(const int dim[4],
   LoadStore<Real> ls(volume);
 
 
+#pragma omp parallel for
   for(int site=0; site<half_volume; ++site){
     completeForceSite<Real,0>(site,
 			      dim,
@@ -1587,6 +1596,7 @@ void completeForceField(const int dim[4],
 			      mom);
 
   }
+#pragma omp parallel for
   for(int site=0; site<half_volume; ++site){
     completeForceSite<Real,1>(site,
 			      dim,
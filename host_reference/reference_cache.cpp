@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <comm_quda.h>
+#include <util_quda.h>
+#include <host_utils.h>
+#include <host_su3.h>
+#include <reference_cache.h>
+
+namespace
+{
+
+  /**
+     Order-dependent hash combination, as used by the gauge field
+     checksums
+   */
+  inline uint64_t hashCombine(uint64_t h, uint64_t word)
+  {
+    h ^= word + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h * 0xff51afd7ed558ccdull;
+  }
+
+  /**
+     Finalizer from splitmix64
+   */
+  inline uint64_t hashFinalize(uint64_t h)
+  {
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+  }
+
+  /**
+     Hash a buffer in blocks over OpenMP threads, so hashing the
+     input fields costs little next to the references themselves
+   */
+  uint64_t hashBytes(const void *data, size_t bytes)
+  {
+    constexpr size_t block_bytes = 1 << 20;
+    const long n_block = (bytes + block_bytes - 1) / block_bytes;
+    std::vector<uint64_t> block(n_block);
+
+#pragma omp parallel for
+    for (long b = 0; b < n_block; b++) {
+      const char *p = static_cast<const char *>(data) + b * block_bytes;
+      const size_t n = std::min(block_bytes, bytes - b * block_bytes);
+      uint64_t h = hashFinalize(b);
+      size_t i = 0;
+      for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, p + i, sizeof(uint64_t));
+        h = hashCombine(h, word);
+      }
+      if (i < n) {
+        uint64_t word = 0;
+        memcpy(&word, p + i, n - i);
+        h = hashCombine(h, word);
+      }
+      block[b] = hashFinalize(h);
+    }
+
+    uint64_t h = hashFinalize(bytes);
+    for (auto b : block) h = hashCombine(h, b);
+    return hashFinalize(h);
+  }
+
+  double wallTime()
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  constexpr char magic[8] = {'Q', 'U', 'D', 'A', 'R', 'E', 'F', '1'};
+
+  /**
+     Header of a result file, followed by the size of each output
+     and then their contents
+   */
+  struct Header {
+    char magic[8];
+    uint64_t key;
+    uint64_t n_output;
+    double compute_time; // how long the result took to compute
+  };
+
+  struct Stats {
+    int hits = 0;
+    int misses = 0;
+    double saved = 0.0; // compute time saved by hits, less the time spent loading
+  } stats;
+
+  /**
+     A read-only mapping of a result file
+   */
+  class Mapping
+  {
+    void *data = MAP_FAILED;
+    size_t bytes = 0;
+
+  public:
+    Mapping(const std::string &filename)
+    {
+      int fd = open(filename.c_str(), O_RDONLY);
+      if (fd < 0) return;
+      struct stat st;
+      if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        bytes = st.st_size;
+        data = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+      }
+      close(fd);
+      if (data != MAP_FAILED) madvise(data, bytes, MADV_SEQUENTIAL);
+    }
+
+    ~Mapping()
+    {
+      if (data != MAP_FAILED) munmap(data, bytes);
+    }
+
+    Mapping(const Mapping &) = delete;
+    Mapping &operator=(const Mapping &) = delete;
+
+    const char *begin() const { return data == MAP_FAILED ? nullptr : static_cast<const char *>(data); }
+    size_t size() const { return data == MAP_FAILED ? 0 : bytes; }
+  };
+
+} // namespace
+
+ReferenceCache::ReferenceCache(const std::string &name) : name(name), key(hashBytes(name.data(), name.size()))
+{
+  const char *path = getenv("QUDA_REFERENCE_CACHE_PATH");
+  enabled = path && strlen(path) > 0;
+
+  // the reference code that computes the result, and the instruction
+  // set of its SU(3) kernels, whose rounding QUDA_HOST_SIMD changes
+  const std::string code = std::string(QUDA_REFERENCE_VERSION) + ";" + QUDA_REFERENCE_BUILD + ";" + host_su3::isa_str();
+  input(code.data(), code.size());
+
+  // the local geometry and process grid
+  int dims[8];
+  for (int d = 0; d < 4; d++) {
+    dims[d] = Z[d];
+    dims[4 + d] = comm_dim(d);
+  }
+  input(dims, sizeof(dims));
+}
+
+ReferenceCache &ReferenceCache::input(const void *data, size_t bytes)
+{
+  if (enabled) key = hashFinalize(hashCombine(key, hashBytes(data, bytes)));
+  return *this;
+}
+
+ReferenceCache &ReferenceCache::gaugeParam(const QudaGaugeParam &param)
+{
+  return input(param.X, sizeof(param.X))
+    .param(param.cpu_prec)
+    .param(param.gauge_order)
+    .param(param.anisotropy)
+    .param(param.t_boundary)
+    .param(param.type);
+}
+
+ReferenceCache &ReferenceCache::invertParam(const QudaInvertParam &param)
+{
+  // only the coefficients of the slices in use are set
+  const int Ls = std::min(std::max(param.Ls, 1), QUDA_MAX_DWF_LS);
+  return this->param(param.dslash_type)
+    .param(param.mass)
+    .param(param.kappa)
+    .param(param.m5)
+    .param(param.Ls)
+    .input(param.b_5, Ls * sizeof(param.b_5[0]))
+    .input(param.c_5, Ls * sizeof(param.c_5[0]))
+    .param(param.eofa_shift)
+    .param(param.eofa_pm)
+    .param(param.mq1)
+    .param(param.mq2)
+    .param(param.mq3)
+    .param(param.mu)
+    .param(param.epsilon)
+    .param(param.twist_flavor)
+    .param(param.matpc_type)
+    .param(param.solution_type)
+    .param(param.dagger)
+    .param(param.mass_normalization)
+    .param(param.cpu_prec)
+    .param(param.clover_cpu_prec);
+}
+
+ReferenceCache &ReferenceCache::output(void *data, size_t bytes)
+{
+  outputs.push_back({data, bytes});
+  return *this;
+}
+
+std::string ReferenceCache::filename(uint64_t global_key) const
+{
+  char file[64];
+  snprintf(file, sizeof(file), "_%016llx_%d.ref", static_cast<unsigned long long>(global_key), comm_rank());
+  return std::string(getenv("QUDA_REFERENCE_CACHE_PATH")) + "/" + name + file;
+}
+
+bool ReferenceCache::load()
+{
+  if (!enabled) return false;
+
+  // the result on each rank depends on the inputs of every rank
+  uint64_t global_key = hashFinalize(hashCombine(key, comm_rank()));
+  comm_allreduce_xor(&global_key);
+  key = global_key;
+
+  double load_start = wallTime();
+  Mapping file(filename(key));
+
+  // validate the whole file before touching the outputs, which may
+  // also be inputs that a miss on another rank still needs
+  bool found = file.size() >= sizeof(Header);
+  Header header;
+  if (found) {
+    memcpy(&header, file.begin(), sizeof(Header));
+    found = memcmp(header.magic, magic, sizeof(magic)) == 0 && header.key == key && header.n_output == outputs.size();
+  }
+  size_t offset = sizeof(Header) + outputs.size() * sizeof(uint64_t);
+  if (found) {
+    size_t total = offset;
+    for (size_t i = 0; i < outputs.size(); i++) {
+      uint64_t bytes;
+      memcpy(&bytes, file.begin() + sizeof(Header) + i * sizeof(uint64_t), sizeof(uint64_t));
+      found = found && bytes == outputs[i].second;
+      total += outputs[i].second;
+    }
+    found = found && total == file.size();
+  }
+
+  int missing = found ? 0 : 1;
+  comm_allreduce_int(&missing);
+  hit = missing == 0;
+
+  if (hit) {
+    for (auto &out : outputs) {
+      memcpy(out.first, file.begin() + offset, out.second);
+      offset += out.second;
+    }
+    double load_time = wallTime() - load_start;
+    stats.hits++;
+    stats.saved += header.compute_time - load_time;
+    if (getVerbosity() >= QUDA_SUMMARIZE)
+      printfQuda("Reference cache hit for %s: loaded in %.3f s instead of computed in %.3f s (%d hits, %d misses, "
+                 "%.3f s saved)\n",
+                 name.c_str(), load_time, header.compute_time, stats.hits, stats.misses, stats.saved);
+  } else {
+    stats.misses++;
+    compute_start = wallTime();
+  }
+
+  return hit;
+}
+
+void ReferenceCache::save()
+{
+  if (!enabled || hit) return;
+
+  double compute_time = wallTime() - compute_start;
+  std::string file = filename(key);
+
+  // write to a private file and rename it, so concurrent runs never
+  // see a partial result
+  std::string tmp = file + "." + std::to_string(getpid()) + ".tmp";
+  FILE *fp = fopen(tmp.c_str(), "wb");
+  bool written = fp != nullptr;
+  if (fp) {
+    Header header;
+    memcpy(header.magic, magic, sizeof(magic));
+    header.key = key;
+    header.n_output = outputs.size();
+    header.compute_time = compute_time;
+    written = fwrite(&header, sizeof(Header), 1, fp) == 1;
+    for (auto &out : outputs) {
+      uint64_t bytes = out.second;
+      written = written && fwrite(&bytes, sizeof(uint64_t), 1, fp) == 1;
+    }
+    for (auto &out : outputs) written = written && fwrite(out.first, 1, out.second, fp) == out.second;
+    written = fclose(fp) == 0 && written;
+  }
+  written = written && rename(tmp.c_str(), file.c_str()) == 0;
+  if (!written) {
+    warningQuda("Unable to store the %s reference result to %s", name.c_str(), file.c_str());
+    remove(tmp.c_str());
+  }
+
+  if (getVerbosity() >= QUDA_SUMMARIZE)
+    printfQuda("Reference cache miss for %s: computed in %.3f s (%d hits, %d misses, %.3f s saved)\n", name.c_str(),
+               compute_time, stats.hits, stats.misses, stats.saved);
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <quda.h>
+
+/**
+   @brief On-disk cache of host reference results.
+
+   The host references of the tests are often far slower than the
+   GPU operators they check, and tuning sweeps and CI matrices
+   recompute them for the same fields and parameters over and over.
+   When QUDA_REFERENCE_CACHE_PATH names a directory, a reference
+   result is stored there under a hash of everything it depends on:
+   the contents of the input fields, the operator parameters, the
+   lattice geometry, the version and build of the reference code and
+   the instruction set its SU(3) kernels use (see QUDA_HOST_SIMD).  A
+   later run with the same inputs memory-maps the stored result
+   instead of recomputing it.  When the variable is
+   unset, the cache is disabled and every reference is computed.
+
+   The key of each rank combines the local keys of all ranks, since
+   the result on one rank depends on its neighbors' fields through
+   the ghost zones, and a result is only loaded if every rank finds
+   it, so that the collective communication of the references stays
+   matched.  Each rank stores its own part of the result.
+
+   Usage is
+
+     ReferenceCache cache("name");
+     cache.input(field, bytes).param(kappa).output(ref, bytes);
+     if (!cache.load()) {
+       ... compute ref ...
+       cache.save();
+     }
+
+   Each load reports whether it hit or missed, along with the running
+   totals of hits, misses and compute time saved.
+*/
+class ReferenceCache
+{
+  std::string name;                                // name of the reference, the prefix of its file
+  uint64_t key;                                    // hash of the inputs, over all ranks after load()
+  std::vector<std::pair<void *, size_t>> outputs;  // the result buffers
+  bool enabled;                                    // whether QUDA_REFERENCE_CACHE_PATH is set
+  bool hit = false;                                // whether load() found the result
+  double compute_start = 0.0;                      // start of the computation after a miss
+
+  /**
+     @param[in] global_key The key combined over all ranks
+     @return The file holding the result of this rank
+  */
+  std::string filename(uint64_t global_key) const;
+
+public:
+  /**
+     @param[in] name Name of the reference result, which must differ
+     between references that share the same inputs
+  */
+  ReferenceCache(const std::string &name);
+
+  /**
+     @brief Add the contents of an input field to the key
+     @param[in] data The field
+     @param[in] bytes Size of the field in bytes
+  */
+  ReferenceCache &input(const void *data, size_t bytes);
+
+  /**
+     @brief Add an operator parameter to the key.  Parameters are
+     hashed by value, so they must not contain pointers or padding.
+     @param[in] value The parameter
+  */
+  template <typename T> ReferenceCache &param(const T &value)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "Parameters must be trivially copyable");
+    return input(&value, sizeof(T));
+  }
+
+  /**
+     @brief Add the gauge field parameters to the key: the
+     dimensions, precision, order, anisotropy and boundary condition
+  */
+  ReferenceCache &gaugeParam(const QudaGaugeParam &param);
+
+  /**
+     @brief Add the fermion operator parameters to the key: the
+     dslash type, mass, kappa, twisted mass and domain wall
+     coefficients, matpc and solution types, dagger, mass
+     normalization and precisions
+  */
+  ReferenceCache &invertParam(const QudaInvertParam &param);
+
+  /**
+     @brief Add a buffer of the result
+     @param[in] data The buffer
+     @param[in] bytes Size of the buffer in bytes
+  */
+  ReferenceCache &output(void *data, size_t bytes);
+
+  /**
+     @brief Look up the result, filling the output buffers on a hit.
+     This is collective: either every rank loads its result or none
+     does.  On a miss the computation timer starts.
+     @return Whether the result was loaded
+  */
+  bool load();
+
+  /**
+     @brief Store the result computed after a miss.  Does nothing if
+     the cache is disabled or load() hit.
+  */
+  void save();
+};
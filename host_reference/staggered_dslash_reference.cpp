@@ -63,34 +63,47 @@ void staggeredDslashReference(sFloat *res, gFloat **fatlink, gFloat **longlink,
 #endif
   }
 
-  for (int xs = 0; xs < nSrc; xs++) {
-
-    for (int i = 0; i < Vh; i++) {
-      int sid = i + xs * Vh;
-      int offset = my_spinor_site_size * sid;
+  // The links use 4-d maps and the spinors, stacked along the fifth
+  // dimension, 5-d maps of the same checkerboard; the third-neighbor
+  // maps are only built for asqtad.
+  const int long_distance = dslash_type == QUDA_ASQTAD_DSLASH ? 3 : 1;
+  const auto link_map1 = stencilMap(1);
+  const auto link_map3 = stencilMap(long_distance);
+  const auto spinor_map1 = stencilMap(1, nSrc);
+  const auto spinor_map3 = stencilMap(long_distance, nSrc);
+
+  // The sources are stacked along the fifth dimension.  Loop over the
+  // 4-d sites outermost so that each link is loaded once and applied to
+  // every source; the per-site summation order is unchanged.
+#pragma omp parallel for
+  for (int i = 0; i < Vh; i++) {
+    for (int dir = 0; dir < 8; dir++) {
+#ifdef MULTI_GPU
+      const int nFace = dslash_type == QUDA_ASQTAD_DSLASH ? 3 : 1;
+      gFloat *fatlnk = link_map1->gauge(i, dir, oddBit, fatlinkEven, fatlinkOdd, ghostFatlinkEven, ghostFatlinkOdd, 1);
+      gFloat *longlnk = dslash_type == QUDA_ASQTAD_DSLASH ?
+        link_map3->gauge(i, dir, oddBit, longlinkEven, longlinkOdd, ghostLonglinkEven, ghostLonglinkOdd, 3) :
+        nullptr;
+#else
+      gFloat *fatlnk = link_map1->gauge(i, dir, oddBit, fatlinkEven, fatlinkOdd);
+      gFloat *longlnk
+        = dslash_type == QUDA_ASQTAD_DSLASH ? link_map3->gauge(i, dir, oddBit, longlinkEven, longlinkOdd) : nullptr;
+#endif
 
-      for (int dir = 0; dir < 8; dir++) {
+      for (int xs = 0; xs < nSrc; xs++) {
+        int sid = i + xs * Vh;
+        int offset = my_spinor_site_size * sid;
 #ifdef MULTI_GPU
-        const int nFace = dslash_type == QUDA_ASQTAD_DSLASH ? 3 : 1;
-        gFloat *fatlnk
-          = gaugeLink_mg4dir(i, dir, oddBit, fatlinkEven, fatlinkOdd, ghostFatlinkEven, ghostFatlinkOdd, 1, 1);
-        gFloat *longlnk = dslash_type == QUDA_ASQTAD_DSLASH ?
-          gaugeLink_mg4dir(i, dir, oddBit, longlinkEven, longlinkOdd, ghostLonglinkEven, ghostLonglinkOdd, 3, 3) :
-          nullptr;
-        sFloat *first_neighbor_spinor = spinorNeighbor_5d_mgpu<QUDA_4D_PC>(
-          sid, dir, oddBit, spinorField, fwd_nbr_spinor, back_nbr_spinor, 1, nFace, my_spinor_site_size);
+        sFloat *first_neighbor_spinor = spinor_map1->spinor(sid, dir, oddBit, spinorField, fwd_nbr_spinor,
+                                                           back_nbr_spinor, nFace, my_spinor_site_size);
         sFloat *third_neighbor_spinor = dslash_type == QUDA_ASQTAD_DSLASH ?
-          spinorNeighbor_5d_mgpu<QUDA_4D_PC>(sid, dir, oddBit, spinorField, fwd_nbr_spinor, back_nbr_spinor, 3, nFace,
-                                             my_spinor_site_size) :
+          spinor_map3->spinor(sid, dir, oddBit, spinorField, fwd_nbr_spinor, back_nbr_spinor, nFace,
+                             my_spinor_site_size) :
           nullptr;
 #else
-        gFloat *fatlnk = gaugeLink(i, dir, oddBit, fatlinkEven, fatlinkOdd, 1);
-        gFloat *longlnk
-          = dslash_type == QUDA_ASQTAD_DSLASH ? gaugeLink(i, dir, oddBit, longlinkEven, longlinkOdd, 3) : nullptr;
-        sFloat *first_neighbor_spinor
-          = spinorNeighbor_5d<QUDA_4D_PC>(sid, dir, oddBit, spinorField, 1, my_spinor_site_size);
+        sFloat *first_neighbor_spinor = spinor_map1->spinor(sid, dir, oddBit, spinorField, my_spinor_site_size);
         sFloat *third_neighbor_spinor = dslash_type == QUDA_ASQTAD_DSLASH ?
-          spinorNeighbor_5d<QUDA_4D_PC>(sid, dir, oddBit, spinorField, 3, my_spinor_site_size) :
+          spinor_map3->spinor(sid, dir, oddBit, spinorField, my_spinor_site_size) :
           nullptr;
 #endif
         sFloat gaugedSpinor[my_spinor_site_size];
@@ -116,11 +129,12 @@ void staggeredDslashReference(sFloat *res, gFloat **fatlink, gFloat **longlink,
             sub(&res[offset], &res[offset], gaugedSpinor, my_spinor_site_size);
           }
         }
-      }
+      } // right-hand-side
+    }
 
-      if (daggerBit) negx(&res[offset], my_spinor_site_size);
-    } // 4-d volume
-  }   // right-hand-side
+    if (daggerBit)
+      for (int xs = 0; xs < nSrc; xs++) negx(&res[my_spinor_site_size * (i + xs * Vh)], my_spinor_site_size);
+  } // 4-d volume
 }
 
 void staggeredDslash(ColorSpinorField *out, void **fatlink, void **longlink, void **ghost_fatlink,
@@ -197,3 +211,26 @@ void staggeredMatDagMat(ColorSpinorField *out, void **fatlink, void **longlink,
     axmy((float *)in->V(), (float)msq_x4, (float *)out->V(), out->X(4) * Vh * my_spinor_site_size);
   }
 }
+
+void staggeredMatDagMat(const std::vector<ColorSpinorField *> &out, void **fatlink, void **longlink,
+                        void **ghost_fatlink, void **ghost_longlink, const std::vector<ColorSpinorField *> &in,
+                        double mass, int dagger_bit, QudaPrecision sPrecision, QudaPrecision gPrecision,
+                        QudaParity parity, QudaDslashType dslash_type)
+{
+  const int nSrc = in.size();
+  if (out.size() != in.size()) errorQuda("Number of outputs %lu does not match number of sources %d", out.size(), nSrc);
+  if (in[0]->X(4) != 1) errorQuda("Sources must be single fields, not %d stacked", in[0]->X(4));
+
+  ColorSpinorParam param(*in[0]);
+  param.x[4] = nSrc;
+  param.create = QUDA_ZERO_FIELD_CREATE;
+  cpuColorSpinorField in5(param), out5(param), tmp5(param);
+
+  const size_t bytes = in[0]->Bytes();
+  for (int s = 0; s < nSrc; s++) memcpy(static_cast<char *>(in5.V()) + s * bytes, in[s]->V(), bytes);
+
+  staggeredMatDagMat(&out5, fatlink, longlink, ghost_fatlink, ghost_longlink, &in5, mass, dagger_bit, sPrecision,
+                     gPrecision, &tmp5, parity, dslash_type);
+
+  for (int s = 0; s < nSrc; s++) memcpy(out[s]->V(), static_cast<char *>(out5.V()) + s * bytes, bytes);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <quda_internal.h>
 #include <color_spinor_field.h>
 
@@ -24,3 +26,15 @@ void staggeredMatDagMat(ColorSpinorField *out, void **fatlink, void **longlink,
                         void **ghost_longlink, ColorSpinorField *in, double mass, int dagger_bit,
                         QudaPrecision sPrecision, QudaPrecision gPrecision, ColorSpinorField *tmp, QudaParity parity,
                         QudaDslashType dslash_type);
+
+/**
+   @brief Apply the staggered normal operator to a batch of parity
+   fields.  The sources are stacked along the fifth dimension, so each
+   link is applied to every source while it is in cache.
+   @param[out] out The results, one per source
+   @param[in] in The sources, parity fields of a single slice each
+*/
+void staggeredMatDagMat(const std::vector<ColorSpinorField *> &out, void **fatlink, void **longlink,
+                        void **ghost_fatlink, void **ghost_longlink, const std::vector<ColorSpinorField *> &in,
+                        double mass, int dagger_bit, QudaPrecision sPrecision, QudaPrecision gPrecision,
+                        QudaParity parity, QudaDslashType dslash_type);
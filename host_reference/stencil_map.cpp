@@ -0,0 +1,96 @@
+#include <array>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <comm_quda.h>
+#include <util_quda.h>
+#include <stencil_map.h>
+
+StencilMap::StencilMap(const int *X, int Ls, QudaPCType type, int nbr_distance, const int *partitioned) :
+  volume_cb(X[0] * X[1] * X[2] * X[3] * Ls / 2), nbr_distance(nbr_distance)
+{
+  const int V4 = X[0] * X[1] * X[2] * X[3];
+  for (int d = 0; d < 4; d++) ghost_face_cb[d] = (V4 / X[d]) * Ls / 2;
+  table.resize(2 * n_dir * volume_cb);
+
+  for (int parity = 0; parity < 2; parity++) {
+#pragma omp parallel for
+    for (int i = 0; i < volume_cb; i++) {
+      // the full lexicographic index, as fullLatticeIndex_5d and
+      // fullLatticeIndex_5d_4dpc compute it
+      int crossings = i / (X[0] / 2) + i / (X[1] * X[0] / 2) + i / (X[2] * X[1] * X[0] / 2);
+      if (type == QUDA_5D_PC) crossings += i / (V4 / 2);
+      const int full = 2 * i + (crossings + parity) % 2;
+
+      int x[5] = {full % X[0], (full / X[0]) % X[1], (full / (X[1] * X[0])) % X[2], (full / (X[2] * X[1] * X[0])) % X[3],
+                  full / V4};
+
+      for (int dir = 0; dir < n_dir; dir++) {
+        const int mu = dir / 2;
+        const int hop = dir % 2 == 0 ? nbr_distance : -nbr_distance;
+        const int L = mu < 4 ? X[mu] : Ls;
+        const int y = x[mu] + hop;
+        int &entry = table[(parity * n_dir + dir) * volume_cb + i];
+
+        if (mu < 4 && partitioned[mu] && (y < 0 || y >= L)) {
+          // faces of the ghost zone counted from the boundary outwards
+          const int face = dir % 2 == 0 ? y - L : y + nbr_distance;
+          int face_idx = 0;
+          for (int d = 3; d >= 0; d--)
+            if (d != mu) face_idx = face_idx * X[d] + x[d];
+          const int F = V4 / X[mu];
+          entry = ~((face * Ls * F + x[4] * F + face_idx) >> 1);
+        } else {
+          int z[5] = {x[0], x[1], x[2], x[3], x[4]};
+          z[mu] = (y + L) % L;
+          entry = ((((z[4] * X[3] + z[3]) * X[2] + z[2]) * X[1] + z[1]) * X[0] + z[0]) >> 1;
+        }
+      }
+    }
+  }
+}
+
+std::shared_ptr<const StencilMap> stencilMap(int nbr_distance, int Ls, QudaPCType type)
+{
+  // a 4-d checkerboard of a single slice is the 5-d one
+  if (Ls == 1) type = QUDA_4D_PC;
+
+  int grid[4], partitioned[4];
+  for (int d = 0; d < 4; d++) {
+#ifdef MULTI_GPU
+    grid[d] = comm_dim(d);
+    partitioned[d] = comm_dim_partitioned(d);
+#else
+    grid[d] = 1;
+    partitioned[d] = 0;
+#endif
+  }
+
+  using Key = std::array<int, 15>;
+  static std::map<Key, std::shared_ptr<const StencilMap>> cache;
+  static std::mutex cache_mutex;
+  constexpr size_t max_maps = 8; // more than any reference operator uses at once
+
+  Key key = {Ls, type, nbr_distance};
+  for (int d = 0; d < 4; d++) {
+    key[3 + d] = Z[d];
+    key[7 + d] = grid[d];
+    key[11 + d] = partitioned[d];
+  }
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  auto &map = cache[key];
+  if (!map) {
+    // drop the maps nobody holds before adding another
+    for (auto it = cache.begin(); cache.size() > max_maps && it != cache.end();)
+      it = it->second && it->second.use_count() == 1 ? cache.erase(it) : std::next(it);
+
+    if (getVerbosity() >= QUDA_DEBUG_VERBOSE)
+      printfQuda("Building host stencil map for %dx%dx%dx%dx%d, distance %d\n", Z[0], Z[1], Z[2], Z[3], Ls,
+                 nbr_distance);
+    map = std::make_shared<const StencilMap>(Z, Ls, type, nbr_distance, partitioned);
+  }
+  return map;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <host_utils.h>
+#include <memory>
+#include <vector>
+
+/**
+   @brief Precomputed neighbor tables of the host reference stencils.
+
+   For every checkerboard site, parity and direction of a lattice,
+   the map holds the checkerboard index of the site nbr_distance hops
+   away.  Directions 0-7 are +x, -x, +y, -y, +z, -z, +t, -t as in the
+   reference operators, and 8 and 9 are +s and -s (the site itself
+   on a 4-d map).
+   Neighbors lying in the ghost zone of a partitioned dimension are
+   stored as the one's complement of their ghost-zone index, so the
+   gathers in the operator loops are plain table lookups with no
+   coordinate arithmetic.
+
+   Ghost-zone indices follow the layout of the host ghost buffers:
+   the faces are ordered from the boundary outwards, each holding the
+   fifth-dimension slices of the 4-d face in turn.  The index of a
+   backward ghost depends on the number of faces in the buffer, so
+   it is stored for nFace = nbr_distance and shifted on lookup.
+*/
+class StencilMap
+{
+  static constexpr int n_dir = 10; // +/- x, y, z, t, s
+  int volume_cb;                    // sites per parity
+  int nbr_distance;                 // the hop distance
+  int ghost_face_cb[4];             // sites per parity of one face of each ghost zone
+  std::vector<int> table;           // [parity][dir][site]
+
+public:
+  /**
+     @param[in] X Local 4-d lattice dimensions
+     @param[in] Ls Length of the fifth dimension, 1 for a 4-d map
+     @param[in] type Whether the checkerboard of a 5-d lattice is 4-d
+     or 5-d
+     @param[in] nbr_distance The hop distance
+     @param[in] partitioned Whether each dimension is partitioned
+  */
+  StencilMap(const int *X, int Ls, QudaPCType type, int nbr_distance, const int *partitioned);
+
+  /**
+     @return The neighbor table of the given parity and direction
+  */
+  const int *neighbors(int parity, int dir) const { return &table[(parity * n_dir + dir) * volume_cb]; }
+
+  /**
+     @brief Return the neighbor of a site in a spinor field
+     @param[in] i Checkerboard index of the site
+     @param[in] dir Direction of the hop
+     @param[in] oddBit Parity of the site
+     @param[in] field Spinor field of the opposite parity
+     @param[in] fwd Forward ghost zones of the field
+     @param[in] back Backward ghost zones of the field
+     @param[in] nFace Number of faces in the ghost zones
+     @param[in] site_size Reals per site of the field
+  */
+  template <typename Float>
+  Float *spinor(int i, int dir, int oddBit, Float *field, Float **fwd, Float **back, int nFace, int site_size) const
+  {
+    int j = neighbors(oddBit, dir)[i];
+    if (j >= 0) return field + j * site_size;
+    j = ~j;
+    if (dir % 2 == 0) return fwd[dir / 2] + j * site_size;
+    return back[dir / 2] + (j + (nFace - nbr_distance) * ghost_face_cb[dir / 2]) * site_size;
+  }
+
+  /**
+     @brief Return the neighbor of a site in a spinor field on an
+     unpartitioned lattice
+  */
+  template <typename Float> Float *spinor(int i, int dir, int oddBit, Float *field, int site_size) const
+  {
+    return field + neighbors(oddBit, dir)[i] * site_size;
+  }
+
+  /**
+     @brief Return the link connecting a site to its neighbor: U_mu(x)
+     for a forward hop and U_mu(x - nbr_distance mu) for a backward
+     one.  Must be called on a 4-d map.
+     @param[in] i Checkerboard index of the site
+     @param[in] dir Direction of the hop
+     @param[in] oddBit Parity of the site
+     @param[in] gaugeEven Even-parity links of each dimension
+     @param[in] gaugeOdd Odd-parity links of each dimension
+     @param[in] ghostGaugeEven Even-parity ghost links
+     @param[in] ghostGaugeOdd Odd-parity ghost links
+     @param[in] nFace Number of faces in the ghost links
+  */
+  template <typename Float>
+  Float *gauge(int i, int dir, int oddBit, Float **gaugeEven, Float **gaugeOdd, Float **ghostGaugeEven = nullptr,
+               Float **ghostGaugeOdd = nullptr, int nFace = 1) const
+  {
+    if (dir % 2 == 0) return &(oddBit ? gaugeOdd : gaugeEven)[dir / 2][i * gauge_site_size];
+    int j = neighbors(oddBit, dir)[i];
+    if (j >= 0) return &(oddBit ? gaugeEven : gaugeOdd)[dir / 2][j * gauge_site_size];
+    j = ~j + (nFace - nbr_distance) * ghost_face_cb[dir / 2];
+    return &(oddBit ? ghostGaugeEven : ghostGaugeOdd)[dir / 2][j * gauge_site_size];
+  }
+};
+
+/**
+   @brief Return the stencil map of the lattice geometry of this rank
+   (the local lattice Z, the process grid and its partitioning),
+   building it on first use.  Maps are cached, so the tables are
+   built once per geometry and hop distance.  The cache is shared by
+   the threads of the process, including the ranks of the threaded
+   communication backend, and holds at most a few maps: maps that
+   are no longer held by a caller are dropped when other geometries
+   are requested, so keep the returned pointer for as long as the
+   map is used.
+   @param[in] nbr_distance The hop distance
+   @param[in] Ls Length of the fifth dimension, 1 for a 4-d map
+   @param[in] type Checkerboarding of a 5-d lattice
+*/
+std::shared_ptr<const StencilMap> stencilMap(int nbr_distance, int Ls = 1, QudaPCType type = QUDA_4D_PC);
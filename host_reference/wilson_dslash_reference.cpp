@@ -12,81 +12,75 @@
 
 #include <dslash_reference.h>
 #include <string.h>
+#include <vector>
 
 using namespace quda;
 
-static const double projector[8][4][4][2] = {
-  {
-    {{1,0}, {0,0}, {0,0}, {0,-1}},
-    {{0,0}, {1,0}, {0,-1}, {0,0}},
-    {{0,0}, {0,1}, {1,0}, {0,0}},
-    {{0,1}, {0,0}, {0,0}, {1,0}}
-  },
-  {
-    {{1,0}, {0,0}, {0,0}, {0,1}},
-    {{0,0}, {1,0}, {0,1}, {0,0}},
-    {{0,0}, {0,-1}, {1,0}, {0,0}},
-    {{0,-1}, {0,0}, {0,0}, {1,0}}
-  },
-  {
-    {{1,0}, {0,0}, {0,0}, {1,0}},
-    {{0,0}, {1,0}, {-1,0}, {0,0}},
-    {{0,0}, {-1,0}, {1,0}, {0,0}},
-    {{1,0}, {0,0}, {0,0}, {1,0}}
-  },
-  {
-    {{1,0}, {0,0}, {0,0}, {-1,0}},
-    {{0,0}, {1,0}, {1,0}, {0,0}},
-    {{0,0}, {1,0}, {1,0}, {0,0}},
-    {{-1,0}, {0,0}, {0,0}, {1,0}}
-  },
-  {
-    {{1,0}, {0,0}, {0,-1}, {0,0}},
-    {{0,0}, {1,0}, {0,0}, {0,1}},
-    {{0,1}, {0,0}, {1,0}, {0,0}},
-    {{0,0}, {0,-1}, {0,0}, {1,0}}
-  },
-  {
-    {{1,0}, {0,0}, {0,1}, {0,0}},
-    {{0,0}, {1,0}, {0,0}, {0,-1}},
-    {{0,-1}, {0,0}, {1,0}, {0,0}},
-    {{0,0}, {0,1}, {0,0}, {1,0}}
-  },
-  {
-    {{1,0}, {0,0}, {-1,0}, {0,0}},
-    {{0,0}, {1,0}, {0,0}, {-1,0}},
-    {{-1,0}, {0,0}, {1,0}, {0,0}},
-    {{0,0}, {-1,0}, {0,0}, {1,0}}
-  },
-  {
-    {{1,0}, {0,0}, {1,0}, {0,0}},
-    {{0,0}, {1,0}, {0,0}, {1,0}},
-    {{1,0}, {0,0}, {1,0}, {0,0}},
-    {{0,0}, {1,0}, {0,0}, {1,0}}
-  }
+// The spin projectors (1 -/+ gamma_mu) in the DeGrand-Rossi basis have
+// rank two, so we only ever form the upper two spin components of the
+// projected spinor (a half spinor),
+//
+//   h_s = psi_s + i^phase[s] psi_partner[s],  s = 0, 1
+//
+// and reconstruct the lower two components after the color
+// multiplication as r_{s+2} = i^recon_phase[s] h_recon[s].  Since
+// multiplication by a power of i is exact, this gives bit-identical
+// results to applying the full 4x4 projector.
+struct HalfProjector {
+  int partner[2];
+  int phase[2];
+  int recon[2];
+  int recon_phase[2];
 };
 
+static const HalfProjector half_projector[8] = {
+  {{3, 2}, {3, 3}, {1, 0}, {1, 1}}, // 1 - gamma_x
+  {{3, 2}, {1, 1}, {1, 0}, {3, 3}}, // 1 + gamma_x
+  {{3, 2}, {0, 2}, {1, 0}, {2, 0}}, // 1 - gamma_y
+  {{3, 2}, {2, 0}, {1, 0}, {0, 2}}, // 1 + gamma_y
+  {{2, 3}, {3, 1}, {0, 1}, {1, 3}}, // 1 - gamma_z
+  {{2, 3}, {1, 3}, {0, 1}, {3, 1}}, // 1 + gamma_z
+  {{2, 3}, {2, 2}, {0, 1}, {2, 2}}, // 1 - gamma_t
+  {{2, 3}, {0, 0}, {0, 1}, {0, 0}}  // 1 + gamma_t
+};
 
-// todo pass projector
-template <typename Float>
-void multiplySpinorByDiracProjector(Float *res, int projIdx, Float *spinorIn) {
-  for (int i=0; i<4*3*2; i++) res[i] = 0.0;
-
-  for (int s = 0; s < 4; s++) {
-    for (int t = 0; t < 4; t++) {
-      Float projRe = projector[projIdx][s][t][0];
-      Float projIm = projector[projIdx][s][t][1];
-      
-      for (int m = 0; m < 3; m++) {
-	Float spinorRe = spinorIn[t*(3*2) + m*(2) + 0];
-	Float spinorIm = spinorIn[t*(3*2) + m*(2) + 1];
-	res[s*(3*2) + m*(2) + 0] += projRe*spinorRe - projIm*spinorIm;
-	res[s*(3*2) + m*(2) + 1] += projRe*spinorIm + projIm*spinorRe;
-      }
+// computes a += i^phase * b for a color vector
+template <typename Float> static inline void accumPhase(Float *a, int phase, const Float *b)
+{
+  for (int m = 0; m < 3; m++) {
+    switch (phase) {
+    case 0: a[2 * m + 0] += b[2 * m + 0]; a[2 * m + 1] += b[2 * m + 1]; break;
+    case 1: a[2 * m + 0] -= b[2 * m + 1]; a[2 * m + 1] += b[2 * m + 0]; break;
+    case 2: a[2 * m + 0] -= b[2 * m + 0]; a[2 * m + 1] -= b[2 * m + 1]; break;
+    case 3: a[2 * m + 0] += b[2 * m + 1]; a[2 * m + 1] -= b[2 * m + 0]; break;
     }
   }
 }
 
+// project a full spinor into a half spinor (2 spins x 3 colors)
+template <typename Float> static inline void projectHalfSpinor(Float *half, int projIdx, const Float *spinorIn)
+{
+  const HalfProjector &P = half_projector[projIdx];
+  for (int s = 0; s < 2; s++) {
+    for (int i = 0; i < 3 * 2; i++) half[s * (3 * 2) + i] = spinorIn[s * (3 * 2) + i];
+    accumPhase(&half[s * (3 * 2)], P.phase[s], &spinorIn[P.partner[s] * (3 * 2)]);
+  }
+}
+
+// accumulate the reconstructed full spinor from a gauged half spinor
+template <typename Float> static inline void reconstructHalfSpinor(Float *res, int projIdx, const Float *half)
+{
+  const HalfProjector &P = half_projector[projIdx];
+  for (int s = 0; s < 2; s++) {
+    for (int i = 0; i < 3 * 2; i++) res[s * (3 * 2) + i] += half[s * (3 * 2) + i];
+    accumPhase(&res[(s + 2) * (3 * 2)], P.recon_phase[s], &half[P.recon[s] * (3 * 2)]);
+  }
+}
+
+// Number of consecutive checkerboard sites handed to each thread at a
+// time: large enough that the neighboring gauge links and spinors of a
+// block are reused from cache, small enough to balance the load.
+static const int dslash_site_block = 64;
 
 //
 // dslashReference()
@@ -97,34 +91,46 @@ void multiplySpinorByDiracProjector(Float *res, int projIdx, Float *spinorIn) {
 // if daggerBit is zero: perform ordinary dslash operator
 // if daggerBit is one:  perform hermitian conjugate of dslash
 //
+// The operator is applied to nSrc spinor fields at once: each gauge
+// link is applied to every source while it is still in cache.
+//
 
 #ifndef MULTI_GPU
 
 template <typename sFloat, typename gFloat>
-void dslashReference(sFloat *res, gFloat **gaugeFull, sFloat *spinorField, int oddBit, int daggerBit) {
-  for (int i = 0; i < Vh * my_spinor_site_size; i++) res[i] = 0.0;
-
+void dslashReference(sFloat **res, gFloat **gaugeFull, sFloat **spinorField, int nSrc, int oddBit, int daggerBit) {
   gFloat *gaugeEven[4], *gaugeOdd[4];
   for (int dir = 0; dir < 4; dir++) {  
     gaugeEven[dir] = gaugeFull[dir];
     gaugeOdd[dir] = gaugeFull[dir] + Vh * gauge_site_size;
   }
-  
+  const auto map = stencilMap(1);
+
+  // each output site is owned by exactly one thread and the directions
+  // are always summed in the same order, so the result is independent
+  // of the number of threads
+#pragma omp parallel for schedule(static, dslash_site_block)
   for (int i = 0; i < Vh; i++) {
+    for (int src = 0; src < nSrc; src++)
+      for (int j = 0; j < 4 * 3 * 2; j++) res[src][i * my_spinor_site_size + j] = 0.0;
+
     for (int dir = 0; dir < 8; dir++) {
-      gFloat *gauge = gaugeLink(i, dir, oddBit, gaugeEven, gaugeOdd, 1);
-      sFloat *spinor = spinorNeighbor(i, dir, oddBit, spinorField, 1);
-      
-      sFloat projectedSpinor[4*3*2], gaugedSpinor[4*3*2];
+      gFloat *gauge = map->gauge(i, dir, oddBit, gaugeEven, gaugeOdd);
       int projIdx = 2*(dir/2)+(dir+daggerBit)%2;
-      multiplySpinorByDiracProjector(projectedSpinor, projIdx, spinor);
-      
-      for (int s = 0; s < 4; s++) {
-	if (dir % 2 == 0) su3Mul(&gaugedSpinor[s*(3*2)], gauge, &projectedSpinor[s*(3*2)]);
-	else su3Tmul(&gaugedSpinor[s*(3*2)], gauge, &projectedSpinor[s*(3*2)]);
+
+      for (int src = 0; src < nSrc; src++) {
+        sFloat *spinor = map->spinor(i, dir, oddBit, spinorField[src], my_spinor_site_size);
+
+        sFloat projectedSpinor[2*3*2], gaugedSpinor[2*3*2];
+        projectHalfSpinor(projectedSpinor, projIdx, spinor);
+
+        for (int s = 0; s < 2; s++) {
+          if (dir % 2 == 0) su3Mul(&gaugedSpinor[s*(3*2)], gauge, &projectedSpinor[s*(3*2)]);
+          else su3Tmul(&gaugedSpinor[s*(3*2)], gauge, &projectedSpinor[s*(3*2)]);
+        }
+
+        reconstructHalfSpinor(&res[src][i * my_spinor_site_size], projIdx, gaugedSpinor);
       }
-      
-      sum(&res[i*(4*3*2)], &res[i*(4*3*2)], gaugedSpinor, 4*3*2);
     }
   }
 }
@@ -132,10 +138,8 @@ void dslashReference(sFloat *res, gFloat **gaugeFull, sFloat *spinorField, int o
 #else
 
 template <typename sFloat, typename gFloat>
-void dslashReference(sFloat *res, gFloat **gaugeFull,  gFloat **ghostGauge, sFloat *spinorField, 
-		     sFloat **fwdSpinor, sFloat **backSpinor, int oddBit, int daggerBit) {
-  for (int i = 0; i < Vh * my_spinor_site_size; i++) res[i] = 0.0;
-
+void dslashReference(sFloat **res, gFloat **gaugeFull,  gFloat **ghostGauge, sFloat **spinorField, 
+		     SpinorGhostBatch &ghost, int nSrc, int oddBit, int daggerBit) {
   gFloat *gaugeEven[4], *gaugeOdd[4];
   gFloat *ghostGaugeEven[4], *ghostGaugeOdd[4];
   for (int dir = 0; dir < 4; dir++) {  
@@ -145,25 +149,33 @@ void dslashReference(sFloat *res, gFloat **gaugeFull,  gFloat **ghostGauge, sFlo
     ghostGaugeEven[dir] = ghostGauge[dir];
     ghostGaugeOdd[dir] = ghostGauge[dir] + (faceVolume[dir] / 2) * gauge_site_size;
   }
-  
+  const auto map = stencilMap(1);
+
+  // see the single-GPU variant for the thread decomposition
+#pragma omp parallel for schedule(static, dslash_site_block)
   for (int i = 0; i < Vh; i++) {
+    for (int src = 0; src < nSrc; src++)
+      for (int j = 0; j < my_spinor_site_size; j++) res[src][i * my_spinor_site_size + j] = 0.0;
 
     for (int dir = 0; dir < 8; dir++) {
-      gFloat *gauge = gaugeLink_mg4dir(i, dir, oddBit, gaugeEven, gaugeOdd, ghostGaugeEven, ghostGaugeOdd, 1, 1);
-      sFloat *spinor = spinorNeighbor_mg4dir(i, dir, oddBit, spinorField, fwdSpinor, backSpinor, 1, 1);
-
-      sFloat projectedSpinor[my_spinor_site_size], gaugedSpinor[my_spinor_site_size];
+      gFloat *gauge = map->gauge(i, dir, oddBit, gaugeEven, gaugeOdd, ghostGaugeEven, ghostGaugeOdd, 1);
       int projIdx = 2*(dir/2)+(dir+daggerBit)%2;
-      multiplySpinorByDiracProjector(projectedSpinor, projIdx, spinor);
-      
-      for (int s = 0; s < 4; s++) {
-	if (dir % 2 == 0) su3Mul(&gaugedSpinor[s*(3*2)], gauge, &projectedSpinor[s*(3*2)]);
-	else su3Tmul(&gaugedSpinor[s*(3*2)], gauge, &projectedSpinor[s*(3*2)]);
+
+      for (int src = 0; src < nSrc; src++) {
+        sFloat *spinor = map->spinor(i, dir, oddBit, spinorField[src], (sFloat **)ghost.fwd(src),
+                                    (sFloat **)ghost.back(src), 1, my_spinor_site_size);
+
+        sFloat projectedSpinor[2*3*2], gaugedSpinor[2*3*2];
+        projectHalfSpinor(projectedSpinor, projIdx, spinor);
+
+        for (int s = 0; s < 2; s++) {
+          if (dir % 2 == 0) su3Mul(&gaugedSpinor[s*(3*2)], gauge, &projectedSpinor[s*(3*2)]);
+          else su3Tmul(&gaugedSpinor[s*(3*2)], gauge, &projectedSpinor[s*(3*2)]);
+        }
+
+        reconstructHalfSpinor(&res[src][i * my_spinor_site_size], projIdx, gaugedSpinor);
       }
-      
-      sum(&res[i*(4*3*2)], &res[i*(4*3*2)], gaugedSpinor, 4*3*2);
     }
-
   }
 }
 
@@ -172,12 +184,17 @@ void dslashReference(sFloat *res, gFloat **gaugeFull,  gFloat **ghostGauge, sFlo
 // this actually applies the preconditioned dslash, e.g., D_ee^{-1} D_eo or D_oo^{-1} D_oe
 void wil_dslash(void *out, void **gauge, void *in, int oddBit, int daggerBit,
 		QudaPrecision precision, QudaGaugeParam &gauge_param) {
-  
+  wil_dslash_multi(&out, gauge, &in, 1, oddBit, daggerBit, precision, gauge_param);
+}
+
+void wil_dslash_multi(void **out, void **gauge, void **in, int nSrc, int oddBit, int daggerBit,
+                      QudaPrecision precision, QudaGaugeParam &gauge_param) {
+
 #ifndef MULTI_GPU  
   if (precision == QUDA_DOUBLE_PRECISION)
-    dslashReference((double*)out, (double**)gauge, (double*)in, oddBit, daggerBit);
+    dslashReference((double**)out, (double**)gauge, (double**)in, nSrc, oddBit, daggerBit);
   else
-    dslashReference((float*)out, (float**)gauge, (float*)in, oddBit, daggerBit);
+    dslashReference((float**)out, (float**)gauge, (float**)in, nSrc, oddBit, daggerBit);
 #else
 
   GaugeFieldParam gauge_field_param(gauge, gauge_param);
@@ -186,9 +203,8 @@ void wil_dslash(void *out, void **gauge, void *in, int oddBit, int daggerBit,
   void **ghostGauge = (void**)cpu.Ghost();
 
   // Get spinor ghost fields
-  // First wrap the input spinor into a ColorSpinorField
+  // First describe the input spinors as ColorSpinorFields
   ColorSpinorParam csParam;
-  csParam.v = in;
   csParam.nColor = 3;
   csParam.nSpin = 4;
   csParam.nDim = 4;
@@ -201,27 +217,20 @@ void wil_dslash(void *out, void **gauge, void *in, int oddBit, int daggerBit,
   csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
   csParam.gammaBasis = QUDA_DEGRAND_ROSSI_GAMMA_BASIS;
   csParam.create = QUDA_REFERENCE_FIELD_CREATE;
-  
-  cpuColorSpinorField inField(csParam);
 
-  {  // Now do the exchange
-    QudaParity otherParity = QUDA_INVALID_PARITY;
-    if (oddBit == QUDA_EVEN_PARITY) otherParity = QUDA_ODD_PARITY;
-    else if (oddBit == QUDA_ODD_PARITY) otherParity = QUDA_EVEN_PARITY;
-    else errorQuda("ERROR: full parity not supported in function %s", __FUNCTION__);
-    const int nFace = 1;
+  // Now do the exchange
+  QudaParity otherParity = QUDA_INVALID_PARITY;
+  if (oddBit == QUDA_EVEN_PARITY) otherParity = QUDA_ODD_PARITY;
+  else if (oddBit == QUDA_ODD_PARITY) otherParity = QUDA_EVEN_PARITY;
+  else errorQuda("ERROR: full parity not supported in function %s", __FUNCTION__);
+  const int nFace = 1;
 
-    inField.exchangeGhost(otherParity, nFace, daggerBit);
-  }
-  void** fwd_nbr_spinor = inField.fwdGhostFaceBuffer;
-  void** back_nbr_spinor = inField.backGhostFaceBuffer;
+  SpinorGhostBatch ghost(csParam, in, nSrc, otherParity, nFace, daggerBit);
 
   if (precision == QUDA_DOUBLE_PRECISION) {
-    dslashReference((double*)out, (double**)gauge, (double**)ghostGauge, (double*)in, 
-		    (double**)fwd_nbr_spinor, (double**)back_nbr_spinor, oddBit, daggerBit);
+    dslashReference((double**)out, (double**)gauge, (double**)ghostGauge, (double**)in, ghost, nSrc, oddBit, daggerBit);
   } else{
-    dslashReference((float*)out, (float**)gauge, (float**)ghostGauge, (float*)in, 
-		    (float**)fwd_nbr_spinor, (float**)back_nbr_spinor, oddBit, daggerBit);
+    dslashReference((float**)out, (float**)gauge, (float**)ghostGauge, (float**)in, ghost, nSrc, oddBit, daggerBit);
   }
 
 #endif
@@ -330,24 +339,33 @@ void tm_mat(void *out, void **gauge, void *in, double kappa, double mu,
 void wil_matpc(void *outEven, void **gauge, void *inEven, double kappa, 
 	       QudaMatPCType matpc_type, int daggerBit, QudaPrecision precision,
 	       QudaGaugeParam &gauge_param) {
+  wil_matpc_multi(&outEven, gauge, &inEven, 1, kappa, matpc_type, daggerBit, precision, gauge_param);
+}
 
-  void *tmp = malloc(Vh * spinor_site_size * precision);
+// Apply the even-odd preconditioned Dirac operator to nSrc fields at once
+void wil_matpc_multi(void **outEven, void **gauge, void **inEven, int nSrc, double kappa,
+                     QudaMatPCType matpc_type, int daggerBit, QudaPrecision precision,
+                     QudaGaugeParam &gauge_param) {
+
+  std::vector<void *> tmp(nSrc);
+  for (int src = 0; src < nSrc; src++) tmp[src] = malloc(Vh * spinor_site_size * precision);
 
   // FIXME: remove once reference clover is finished
   // full dslash operator
   if (matpc_type == QUDA_MATPC_EVEN_EVEN || matpc_type == QUDA_MATPC_EVEN_EVEN_ASYMMETRIC) {
-    wil_dslash(tmp, gauge, inEven, 1, daggerBit, precision, gauge_param);
-    wil_dslash(outEven, gauge, tmp, 0, daggerBit, precision, gauge_param);
+    wil_dslash_multi(tmp.data(), gauge, inEven, nSrc, 1, daggerBit, precision, gauge_param);
+    wil_dslash_multi(outEven, gauge, tmp.data(), nSrc, 0, daggerBit, precision, gauge_param);
   } else {
-    wil_dslash(tmp, gauge, inEven, 0, daggerBit, precision, gauge_param);
-    wil_dslash(outEven, gauge, tmp, 1, daggerBit, precision, gauge_param);
+    wil_dslash_multi(tmp.data(), gauge, inEven, nSrc, 0, daggerBit, precision, gauge_param);
+    wil_dslash_multi(outEven, gauge, tmp.data(), nSrc, 1, daggerBit, precision, gauge_param);
   }    
   
   // lastly apply the kappa term
   double kappa2 = -kappa*kappa;
-  xpay(inEven, kappa2, outEven, Vh * spinor_site_size, precision);
-
-  free(tmp);
+  for (int src = 0; src < nSrc; src++) {
+    xpay(inEven[src], kappa2, outEven[src], Vh * spinor_site_size, precision);
+    free(tmp[src]);
+  }
 }
 
 // Apply the even-odd preconditioned Dirac operator
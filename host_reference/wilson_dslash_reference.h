@@ -11,12 +11,18 @@ extern "C" {
   void wil_dslash(void *res, void **gauge, void *spinorField, int oddBit,
 		  int daggerBit, QudaPrecision precision, QudaGaugeParam &param);
 
+  void wil_dslash_multi(void **res, void **gauge, void **spinorField, int nSrc, int oddBit, int daggerBit,
+                        QudaPrecision precision, QudaGaugeParam &param);
+
   void wil_mat(void *out, void **gauge, void *in, double kappa, int daggerBit,
 	       QudaPrecision precision, QudaGaugeParam &param);
 
   void wil_matpc(void *out, void **gauge, void *in, double kappa,
 		 QudaMatPCType matpc_type,  int daggerBit, QudaPrecision precision, QudaGaugeParam &param);
 
+  void wil_matpc_multi(void **out, void **gauge, void **in, int nSrc, double kappa, QudaMatPCType matpc_type,
+                       int daggerBit, QudaPrecision precision, QudaGaugeParam &param);
+
   void tm_dslash(void *res, void **gauge, void *spinorField, double kappa,
 		 double mu, QudaTwistFlavorType flavor, int oddBit, QudaMatPCType matpc_type,
 		 int daggerBit, QudaPrecision sprecision, QudaGaugeParam &param);
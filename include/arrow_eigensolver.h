@@ -0,0 +1,94 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+namespace quda
+{
+
+  /**
+     @brief Divide-and-conquer eigensolver for the Hermitian matrices
+     that the thick restarted Lanczos methods solve at each restart:
+     a real diagonal in rows [0, k), an arrow of b rows [k, k + b)
+     coupling to the diagonal, and a block tridiagonal matrix of block
+     size b in rows [k, n).  TRLM uses b = 1 with T = double, BLKTRLM
+     uses its block size with T = Complex.
+
+     The block tridiagonal part is split recursively about a middle
+     block; merging the two solved halves is a block arrowhead
+     eigenproblem, which is solved as b successive rank-one arrowhead
+     problems through their secular equations, with deflation and
+     Gu-Eisenstat recomputation of the arrow for orthogonal
+     eigenvectors.  The leading diagonal and the tail are then merged
+     in the same way.  The eigenvectors of this final merge are held
+     in factored form, so that the last row of the eigenvector matrix
+     (for the Ritz residua) costs O(b n^2), and only the eigenvectors
+     that are kept need to be formed.
+
+     Only the lower triangle of the diagonal blocks is read.
+  */
+  template <typename T> class ArrowEigensolver
+  {
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+
+  public:
+    ArrowEigensolver();
+    ~ArrowEigensolver();
+
+    /**
+       @brief Set the shape of the matrix and zero its elements
+       @param[in] n The order of the matrix
+       @param[in] b The block size
+       @param[in] k The position of the arrow, a multiple of b less than n
+    */
+    void resize(int n, int b, int k);
+
+    /**
+       @return Reference to element i < k of the leading diagonal
+    */
+    double &diagonal(int i);
+
+    /**
+       @return Reference to element (k + r, i) of the arrow, r < b, i < k
+    */
+    T &arrow(int r, int i);
+
+    /**
+       @return Reference to element (r, c) of diagonal block i of the
+       block tridiagonal part, i.e. element (k + i * b + r, k + i * b + c)
+    */
+    T &block(int i, int r, int c);
+
+    /**
+       @return Reference to element (r, c) of the subdiagonal block
+       below diagonal block i, i.e. element (k + (i + 1) * b + r, k + i * b + c)
+    */
+    T &subBlock(int i, int r, int c);
+
+    /**
+       @brief Compute the eigenvalues and the factored eigenvectors
+    */
+    void compute();
+
+    /**
+       @return Eigenvalue i, in ascending order
+    */
+    double eigenvalue(int i) const;
+
+    /**
+       @brief Compute the last row of the eigenvector matrix
+       @param[out] row Array of n elements, element i belongs to eigenvector i
+    */
+    void lastRow(T *row) const;
+
+    /**
+       @brief Compute the eigenvectors of the p smallest eigenvalues
+       @param[in] p The number of eigenvectors
+       @param[out] vecs Array of n * p elements, element j of
+       eigenvector i is vecs[n * i + j]
+    */
+    void vectors(int p, T *vecs) const;
+  };
+
+} // namespace quda
@@ -947,12 +947,13 @@ namespace quda {
     friend class cudaColorSpinorField;
 
   public:
-    static void* fwdGhostFaceBuffer[QUDA_MAX_DIM]; //cpu memory
-    static void* backGhostFaceBuffer[QUDA_MAX_DIM]; //cpu memory
-    static void* fwdGhostFaceSendBuffer[QUDA_MAX_DIM]; //cpu memory
-    static void* backGhostFaceSendBuffer[QUDA_MAX_DIM]; //cpu memory
-    static int initGhostFaceBuffer;
-    static size_t ghostFaceBytes[QUDA_MAX_DIM];
+    // the ghost buffers are per rank (thread local with the threaded comms backend)
+    static QUDA_RANK_LOCAL void* fwdGhostFaceBuffer[QUDA_MAX_DIM]; //cpu memory
+    static QUDA_RANK_LOCAL void* backGhostFaceBuffer[QUDA_MAX_DIM]; //cpu memory
+    static QUDA_RANK_LOCAL void* fwdGhostFaceSendBuffer[QUDA_MAX_DIM]; //cpu memory
+    static QUDA_RANK_LOCAL void* backGhostFaceSendBuffer[QUDA_MAX_DIM]; //cpu memory
+    static QUDA_RANK_LOCAL int initGhostFaceBuffer;
+    static QUDA_RANK_LOCAL size_t ghostFaceBytes[QUDA_MAX_DIM];
 
     private:
     //void *v; // the field elements
@@ -1,6 +1,17 @@
 #pragma once
 #include <cstdint>
 
+/**
+   Storage class for state that is private to each rank.  With the
+   threaded communication backend (THREAD_COMMS) every rank is a
+   thread of the same process, so such state is thread local.
+*/
+#ifdef THREAD_COMMS
+#define QUDA_RANK_LOCAL thread_local
+#else
+#define QUDA_RANK_LOCAL
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -176,6 +187,54 @@ extern "C" {
    */
   bool comm_deterministic_reduce();
 
+  /**
+     Number of 64-bit words per element in the integer representation
+     used for reproducible sums: four 32-bit digits and a count of
+     non-finite values
+   */
+  constexpr int comm_reproducible_words = 5;
+
+  /**
+     @brief Compute the exponent of each element for a reproducible
+     sum.  The exponents must be max-reduced over all ranks before
+     encoding.
+     @param[out] exponent The exponent of each element
+     @param[in] data The local values
+     @param[in] size The number of elements
+   */
+  void comm_reproducible_exponent(int *exponent, const double *data, size_t size);
+
+  /**
+     @brief Encode values as fixed-point digits for a reproducible
+     sum.  The digits can be summed in any order with an integer
+     reduction, giving the same result on any number of ranks.
+     @param[out] digits comm_reproducible_words words per element
+     @param[in] data The local values
+     @param[in] exponent The max-reduced exponents
+     @param[in] size The number of elements
+   */
+  void comm_reproducible_encode(int64_t *digits, const double *data, const int *exponent, size_t size);
+
+  /**
+     @brief Decode the sum-reduced digits of a reproducible sum
+     @param[out] data The sums
+     @param[in,out] digits The sum-reduced digits (normalized in place)
+     @param[in] exponent The max-reduced exponents
+     @param[in] size The number of elements
+   */
+  void comm_reproducible_decode(double *data, int64_t *digits, const int *exponent, size_t size);
+
+  /**
+     @brief Reproducible sum of an array over all ranks, built on the
+     integer reductions comm_allreduce_max_array and
+     comm_allreduce_int64_array.  Every rank gets the same result,
+     independent of the number of ranks and of the order in which the
+     backend combines their contributions.
+     @param[in,out] data The local values, replaced by the sums
+     @param[in] size The number of elements
+   */
+  void comm_allreduce_reproducible(double *data, size_t size);
+
   /**
      @brief Gather all hostnames
      @param[out] hostname_recv_buf char array of length
@@ -191,6 +250,16 @@ extern "C" {
    */
   void comm_gather_gpuid(int *gpuid_recv_buf);
 
+  /**
+     @brief Gather a fixed-size buffer from every process to rank 0
+     @param[in] send_buf Buffer of nbytes to send from this process
+     @param[out] recv_buf On rank 0, buffer of nbytes*comm_size()
+     that will be filled with the data of all processes (in rank
+     order).  Not referenced on other ranks.
+     @param[in] nbytes Number of bytes contributed by each process
+   */
+  void comm_gather(const void *send_buf, void *recv_buf, size_t nbytes);
+
   /**
      Enabled peer-to-peer communication.
      @param hostname_buf Array that holds all process hostnames
@@ -303,8 +372,26 @@ extern "C" {
   void comm_allreduce_array(double* data, size_t size);
   void comm_allreduce_max_array(double* data, size_t size);
   void comm_allreduce_int(int* data);
+  void comm_allreduce_int64_array(int64_t *data, size_t size);
   void comm_allreduce_xor(uint64_t *data);
   void comm_broadcast(void *data, size_t nbytes);
+
+#ifdef THREAD_COMMS
+  /**
+     @brief Run a function on nranks logical ranks, each a thread of
+     this process, and return once all have finished.  Each rank
+     must call initCommsGridQuda (or comm_init) with a grid of
+     nranks ranks before communicating.  Only the communication
+     layer and the host fields' halo exchange are rank-local state:
+     the rest of the QUDA interface is shared by the ranks.  A
+     process that calls comm_init without launching ranks runs as a
+     single rank.
+     @param[in] nranks The number of logical ranks
+     @param[in] func The function to run, called with the rank and arg
+     @param[in] arg Argument passed to func
+  */
+  void comm_threads_launch(int nranks, void (*func)(int rank, void *arg), void *arg);
+#endif
   void comm_barrier(void);
   void comm_abort(int status);
   void comm_abort_(int status);
@@ -1257,7 +1257,10 @@ public:
 
   /**
      This class serves as a front-end to the coarse Dslash operator,
-     similar to the other dslash operators.
+     similar to the other dslash operators.  Five-dimensional fields
+     are treated as a set of right-hand sides; on a CPU coarse level
+     these are applied a block at a time so that each coarse link is
+     reused across the block.
    */
   class DiracCoarse : public Dirac {
 
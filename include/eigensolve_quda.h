@@ -4,6 +4,7 @@
 #include <quda_internal.h>
 #include <dirac_quda.h>
 #include <color_spinor_field.h>
+#include <arrow_eigensolver.h>
 
 namespace quda
 {
@@ -442,6 +443,9 @@ protected:
     // Variable size matrix
     std::vector<double> ritz_mat;
 
+    // Structured eigensolver of the arrow matrix
+    ArrowEigensolver<double> arrow_eig;
+
     // Tridiagonal/Arrow matrix, fixed size.
     double *alpha;
     double *beta;
@@ -503,6 +507,9 @@ protected:
     // Variable size matrix
     std::vector<Complex> block_ritz_mat;
 
+    // Structured eigensolver of the block arrow matrix
+    ArrowEigensolver<Complex> block_arrow_eig;
+
     /** Block Tridiagonal/Arrow matrix, fixed size. */
     Complex *block_alpha;
     Complex *block_beta;
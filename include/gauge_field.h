@@ -796,6 +796,40 @@ namespace quda {
   */
   uint64_t Checksum(const GaugeField &u, bool mini=false);
 
+  /**
+     Hierarchical checksum of a gauge field.  The local volume is
+     split into blocks of block_sites checkerboard sites per parity,
+     each with an order-dependent hash of its links, and the root
+     hash combines the block hashes of all ranks.  Unlike the XOR
+     checksum, a change to any link (including a permutation of
+     links) changes the root with overwhelming probability.
+  */
+  struct GaugeChecksum {
+    static constexpr int block_sites = 4096; // checkerboard sites per block
+    std::vector<uint64_t> block;             // hash of each local block
+    uint64_t root = 0;                       // hash over the blocks of every rank
+
+    bool operator==(const GaugeChecksum &other) const { return root == other.root; }
+    bool operator!=(const GaugeChecksum &other) const { return root != other.root; }
+
+    /**
+       @brief Return the local blocks that differ from another
+       checksum, e.g., to re-upload only those blocks after a partial
+       update.  If the block layout differs, every block is dirty.
+       @param[in] other The checksum to compare against
+       @return The indices of the dirty blocks
+    */
+    std::vector<int> dirty(const GaugeChecksum &other) const;
+  };
+
+  /**
+     Compute the hierarchical checksum of a CPU gauge field.  The
+     blocks are hashed in parallel over OpenMP threads.
+     @param[in] u The gauge field
+     @return The block and root hashes
+  */
+  GaugeChecksum BlockChecksum(const GaugeField &u);
+
   /**
      @brief Helper function for determining if the reconstruct of the fields is the same.
      @param[in] a Input field
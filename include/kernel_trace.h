@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <tune_key.h>
+
+/**
+   @file kernel_trace.h
+
+   @brief Streaming kernel trace (QUDA_ENABLE_TRACE).
+
+   Trace entries are appended to a fixed-size ring buffer
+   (QUDA_TRACE_BUFFER entries, default 65536) which a background thread
+   drains into a binary file per rank, so the memory used by the trace
+   is bounded however long the run.  If the buffer fills faster than it
+   can be written, recording blocks until there is space.
+
+   Entries refer to their TuneKey by id, and each key is written once,
+   ahead of its first entry.  The file is a header followed by a
+   sequence of chunks, each a ChunkHeader and its payload.  A file
+   truncated by an abnormal exit is read up to its last complete chunk.
+
+   The trace_convert tool converts the binary trace to the text format
+   (the format written by earlier versions) and summarizes it per
+   kernel, or converts a text trace back to binary.
+ */
+
+namespace quda
+{
+
+  namespace kernel_trace
+  {
+
+    static constexpr char binary_magic[8] = {'Q', 'U', 'D', 'A', 'T', 'R', 'C', 'E'};
+    static constexpr uint32_t binary_format_version = 1;
+    static constexpr uint32_t binary_endian_check = 0x01020304;
+
+    struct FileHeader {
+      char magic[8];
+      uint32_t format_version;
+      uint32_t endian;
+      int32_t rank;
+      uint32_t reserved;
+      int64_t created; // time_t at which the trace was opened
+      char version[64];
+      char gitversion[128];
+      char hash[256];
+    };
+
+    enum ChunkType : uint32_t {
+      CHUNK_KEYS = 0,   // count KeyDefinitions, each followed by its strings
+      CHUNK_RECORDS = 1 // count Records
+    };
+
+    struct ChunkHeader {
+      uint32_t type;
+      uint32_t count;
+    };
+
+    /**
+       Definition of a key id, followed by the volume, name and aux
+       strings (without terminators)
+     */
+    struct KeyDefinition {
+      uint32_t id;
+      uint32_t volume_length;
+      uint32_t name_length;
+      uint32_t aux_length;
+    };
+
+    struct Record {
+      uint32_t key;
+      float time;
+      int64_t device_bytes; // peak allocations at the time of the entry
+      int64_t pinned_bytes;
+      int64_t mapped_bytes;
+      int64_t host_bytes;
+    };
+
+    /**
+       @brief Open the trace file of this rank and start the background
+       flusher.  Entries recorded before the file is opened are kept,
+       as long as they fit in the ring buffer.  Only the first call has
+       an effect.
+       @param[in] path The file to write
+       @param[in] version, gitversion, hash Version strings recorded in the header
+    */
+    void open(const std::string &path, const std::string &version, const std::string &gitversion,
+              const std::string &hash);
+
+    /**
+       @brief Append an entry for key, with the current peak memory
+       allocations.  Thread safe.
+    */
+    void record(const TuneKey &key, float time);
+
+    /**
+       @brief Block until every entry recorded so far has been written
+    */
+    void flush();
+
+    /**
+       @return The path of the trace file, empty if it is not open
+    */
+    std::string path();
+
+    /**
+       @return The number of entries recorded
+    */
+    size_t size();
+
+    /**
+       @brief Sequential reader of a binary trace file
+    */
+    class Reader
+    {
+      std::ifstream in;
+      FileHeader header_ = {};
+      std::vector<TuneKey> keys;
+      std::vector<Record> records;
+      size_t next_record = 0;
+
+      bool readChunk();
+
+    public:
+      /**
+         @brief Open path and read its header
+         @return false if the file cannot be read or is not a trace
+      */
+      bool open(const std::string &path);
+
+      const FileHeader &header() const { return header_; }
+
+      /**
+         @brief Read the next entry
+         @return false at the end of the trace
+      */
+      bool next(Record &record);
+
+      /**
+         @return The key of a record returned by next()
+      */
+      const TuneKey &key(const Record &record) const { return keys[record.key]; }
+    };
+
+    /**
+       @brief Write the two header lines of the text format
+    */
+    void writeTextHeader(std::ostream &out, const FileHeader &header);
+
+    /**
+       @brief Write an entry in text format
+    */
+    void writeText(std::ostream &out, const TuneKey &key, const Record &record);
+
+    /**
+       @brief Convert the binary trace at in to text at out
+       @return false if either file cannot be opened
+    */
+    bool binaryToText(const std::string &in, const std::string &out);
+
+    /**
+       @brief Convert the text trace at in back to binary at out.  The
+       text format does not hold the rank, which is set to zero, and
+       holds the times to the precision they were printed with.
+       @return false if either file cannot be opened or in is not a
+       text trace
+    */
+    bool textToBinary(const std::string &in, const std::string &out);
+
+  } // namespace kernel_trace
+
+} // namespace quda
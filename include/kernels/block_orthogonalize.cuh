@@ -105,7 +105,7 @@ namespace quda {
   void blockOrthoCPU(Arg &arg)
   {
     // loop over geometric blocks
-#pragma omp parallel for
+#pragma omp parallel for schedule(runtime)
     for (int x_coarse=0; x_coarse<arg.coarseVolume; x_coarse++) {
 
       // first copy over raw components into the container
@@ -24,7 +24,7 @@ namespace quda
 #ifdef SHARED_ACCUMULATOR
 
 #define DECLARE_LINK(U)                                                                                                \
-  extern __shared__ int s[];                                                                                           \
+  extern __shared__ float s[];                                                                                         \
   real *U = (real *)s;                                                                                                 \
   {                                                                                                                    \
     const int tid = (threadIdx.z * blockDim.y + threadIdx.y) * blockDim.x + threadIdx.x;                               \
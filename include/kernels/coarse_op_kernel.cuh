@@ -154,7 +154,7 @@ namespace quda {
     constexpr int uvSpin = fineSpin * (from_coarse ? 2 : 1);
     constexpr int nFace = 1;
 
-    using complex = complex<typename Arg::Float>;
+    using complex = quda::complex<typename Arg::Float>;
     using TileType = typename Arg::uvTileType;
     auto &tile = arg.uvTile;
     using Ctype = decltype(make_tile_C<complex, false>(tile));
@@ -235,7 +235,7 @@ namespace quda {
   {
     using TileType = typename Arg::uvTileType;
     for (int parity=0; parity<2; parity++) {
-#pragma omp parallel for
+#pragma omp parallel for schedule(runtime)
       for (int x_cb=0; x_cb<arg.fineVolumeCB; x_cb++) {
         for (int ic = 0; ic < TileType::m; ic += TileType::M)   // fine color
           for (int jc = 0; jc < TileType::n; jc += TileType::N) // coarse color
@@ -317,7 +317,7 @@ namespace quda {
   template <typename Float, int fineSpin, int fineColor, int coarseColor, typename Arg> void ComputeAVCPU(Arg &arg)
   {
     for (int parity=0; parity<2; parity++) {
-#pragma omp parallel for
+#pragma omp parallel for schedule(runtime)
       for (int x_cb=0; x_cb<arg.fineVolumeCB; x_cb++) {
         for (int ch = 0; ch < 2; ch++) { // Loop over chiral blocks
 
@@ -376,7 +376,7 @@ namespace quda {
   template<typename Float, int fineSpin, int fineColor, int coarseColor, typename Arg>
   void ComputeTMAVCPU(Arg &arg) {
     for (int parity=0; parity<2; parity++) {
-#pragma omp parallel for
+#pragma omp parallel for schedule(runtime)
       for (int x_cb=0; x_cb<arg.fineVolumeCB; x_cb++) {
 	for (int v=0; v<coarseColor; v++) // coarse color
 	  computeTMAV<Float,fineSpin,fineColor,coarseColor,Arg>(arg, parity, x_cb, v);
@@ -447,7 +447,7 @@ namespace quda {
   {
     Float max = 0.0;
     for (int parity=0; parity<2; parity++) {
-#pragma omp parallel for reduction(max:max)
+#pragma omp parallel for schedule(runtime) reduction(max:max)
       for (int x_cb=0; x_cb<arg.fineVolumeCB; x_cb++) {
         Float max_x = computeCloverInvMax<Float, twist, Arg>(arg, parity, x_cb);
         max = max > max_x ? max : max_x;
@@ -536,7 +536,7 @@ namespace quda {
   template <typename Float, int fineSpin, int fineColor, int coarseColor, typename Arg> void ComputeTMCAVCPU(Arg &arg)
   {
     for (int parity = 0; parity < 2; parity++) {
-#pragma omp parallel for
+#pragma omp parallel for schedule(runtime)
       for (int x_cb=0; x_cb<arg.fineVolumeCB; x_cb++) {
         for (int ch = 0; ch < 2; ch++) {
           for (int ic_c = 0; ic_c < coarseColor; ic_c++) { // coarse color
@@ -604,7 +604,7 @@ namespace quda {
   template <bool from_coarse, typename Float, int dim, QudaDirection dir, int fineSpin, int coarseSpin, typename Arg, typename Gamma, typename Out>
   __device__ __host__ inline void multiplyVUV(Out &vuv, const Arg &arg, const Gamma &gamma, int parity, int x_cb, int i0, int j0)
   {
-    using complex = complex<Float>;
+    using complex = quda::complex<Float>;
     using TileType = typename Arg::vuvTileType;
     auto &tile = arg.vuvTile;
 
@@ -946,7 +946,7 @@ namespace quda {
     constexpr bool parity_flip = true;
 
     for (int parity=0; parity<2; parity++) {
-#pragma omp parallel for
+#pragma omp parallel for schedule(runtime)
       for (int x_cb=0; x_cb<arg.fineVolumeCB; x_cb++) { // Loop over fine volume
 	for (int ic=0; ic<arg.vuvTile.m; ic+=arg.vuvTile.M)
 	  for (int jc=0; jc<arg.vuvTile.n; jc+=arg.vuvTile.N)
@@ -1000,7 +1000,7 @@ namespace quda {
   template<typename Float, int nSpin, int nColor, typename Arg>
   void ComputeYReverseCPU(Arg &arg) {
     for (int parity=0; parity<2; parity++) {
-#pragma omp parallel for
+#pragma omp parallel for schedule(runtime)
       for (int x_cb=0; x_cb<arg.coarseVolumeCB; x_cb++) {
 	for (int ic_c = 0; ic_c < nColor; ic_c++) { //Color row
 	  for (int jc_c = 0; jc_c < nColor; jc_c++) { //Color col
@@ -1102,7 +1102,7 @@ namespace quda {
   template <bool from_coarse, typename Float, int fineSpin, int coarseSpin, int fineColor, int coarseColor, typename Arg>
   void ComputeCoarseCloverCPU(Arg &arg) {
     for (int parity=0; parity<2; parity++) {
-#pragma omp parallel for
+#pragma omp parallel for schedule(runtime)
       for (int x_cb=0; x_cb<arg.fineVolumeCB; x_cb++) {
         for (int jc_c=0; jc_c<coarseColor; jc_c++) {
           for (int ic_c=0; ic_c<coarseColor; ic_c++) {
@@ -1134,7 +1134,7 @@ namespace quda {
   template<typename Float, int nSpin, int nColor, typename Arg>
   void AddCoarseDiagonalCPU(Arg &arg) {
     for (int parity=0; parity<2; parity++) {
-#pragma omp parallel for
+#pragma omp parallel for schedule(runtime)
       for (int x_cb=0; x_cb<arg.coarseVolumeCB; x_cb++) {
         for(int s = 0; s < nSpin; s++) { //Spin
          for(int c = 0; c < nColor; c++) { //Color
@@ -1167,7 +1167,7 @@ namespace quda {
     const complex<Float> mu(0., arg.mu*arg.mu_factor);
 
     for (int parity=0; parity<2; parity++) {
-#pragma omp parallel for
+#pragma omp parallel for schedule(runtime)
       for (int x_cb=0; x_cb<arg.coarseVolumeCB; x_cb++) {
 	for(int s = 0; s < nSpin/2; s++) { //Spin
           for(int c = 0; c < nColor; c++) { //Color
@@ -1247,7 +1247,7 @@ namespace quda {
   template<typename Float, int nSpin, int nColor, typename Arg>
   void ConvertCPU(Arg &arg) {
     for (int parity=0; parity<2; parity++) {
-#pragma omp parallel for
+#pragma omp parallel for schedule(runtime)
       for (int x_cb=0; x_cb<arg.coarseVolumeCB; x_cb++) {
 	for(int c_row = 0; c_row < nColor; c_row++) { //Color row
 	  for(int c_col = 0; c_col < nColor; c_col++) { //Color column
@@ -1295,7 +1295,7 @@ namespace quda {
   template<typename Float, int nSpin, int nColor, typename Arg>
   void RescaleYCPU(Arg &arg) {
     for (int parity=0; parity<2; parity++) {
-#pragma omp parallel for
+#pragma omp parallel for schedule(runtime)
       for (int x_cb=0; x_cb<arg.coarseVolumeCB; x_cb++) {
 	for(int c_row = 0; c_row < nColor; c_row++) { //Color row
 	  for(int c_col = 0; c_col < nColor; c_col++) { //Color column
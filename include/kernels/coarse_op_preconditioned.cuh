@@ -43,7 +43,7 @@ namespace quda {
   inline __device__ __host__ auto computeYhat(Arg &arg, int d, int x_cb, int parity, int i0, int j0)
   {
     using real = typename Arg::Float;
-    using complex = complex<real>;
+    using complex = quda::complex<real>;
     constexpr int nDim = 4;
     int coord[nDim];
     getCoords(coord, x_cb, arg.dim, parity);
@@ -124,7 +124,7 @@ namespace quda {
     typename Arg::Float max = 0.0;
     for (int d=0; d<4; d++) {
       for (int parity=0; parity<2; parity++) {
-#pragma omp parallel for
+#pragma omp parallel for schedule(runtime) reduction(max:max)
         for (int x_cb = 0; x_cb < arg.Y.VolumeCB(); x_cb++) {
           for (int i = 0; i < Arg::yhatTileType::m; i += Arg::yhatTileType::M)
             for (int j = 0; j < Arg::yhatTileType::n; j += Arg::yhatTileType::N) {
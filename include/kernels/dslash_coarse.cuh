@@ -110,6 +110,7 @@ namespace quda {
 
 	if ( arg.commDim[d] && (coord[d] + arg.nFace >= arg.dim[d]) ) {
 	  if (doHalo<type>()) {
+            // the source index is part of the face of a five-dimensional ghost zone
             int ghost_idx = ghostFaceIndex<1, 5>(coord, arg.dim, d, arg.nFace);
 
 #pragma unroll
@@ -123,10 +124,10 @@ namespace quda {
 		  int col = s_col*Nc + c_col + color_offset;
 		  if (!dagger)
 		    out[color_local] += arg.Y(d+4, parity, x_cb, row, col)
-		      * arg.inA.Ghost(d, 1, their_spinor_parity, ghost_idx + src_idx*arg.volumeCB, s_col, c_col+color_offset);
+		      * arg.inA.Ghost(d, 1, their_spinor_parity, ghost_idx, s_col, c_col+color_offset);
 		  else
 		    out[color_local] += arg.Y(d, parity, x_cb, row, col)
-		      * arg.inA.Ghost(d, 1, their_spinor_parity, ghost_idx + src_idx*arg.volumeCB, s_col, c_col+color_offset);
+		      * arg.inA.Ghost(d, 1, their_spinor_parity, ghost_idx, s_col, c_col+color_offset);
 		}
 	      }
 	    }
@@ -176,6 +177,7 @@ namespace quda {
 	if ( arg.commDim[d] && (coord[d] - arg.nFace < 0) ) {
 	  if (doHalo<type>()) {
             const int ghost_idx = ghostFaceIndex<0, 5>(coord, arg.dim, d, arg.nFace);
+            const int gauge_ghost_idx = ghostFaceIndex<0, 4>(coord, arg.dim, d, arg.nFace);
 #pragma unroll
 	    for (int color_local=0; color_local<Mc; color_local++) {
 	      int c_row = color_block + color_local;
@@ -186,11 +188,11 @@ namespace quda {
 		for (int c_col=0; c_col<Nc; c_col+=color_stride) {
 		  int col = s_col*Nc + c_col + color_offset;
 		  if (!dagger)
-		    out[color_local] += conj(arg.Y.Ghost(d, 1-parity, ghost_idx, col, row))
-		      * arg.inA.Ghost(d, 0, their_spinor_parity, ghost_idx + src_idx*arg.volumeCB, s_col, c_col+color_offset);
+		    out[color_local] += conj(arg.Y.Ghost(d, 1-parity, gauge_ghost_idx, col, row))
+		      * arg.inA.Ghost(d, 0, their_spinor_parity, ghost_idx, s_col, c_col+color_offset);
 		  else
-		    out[color_local] += conj(arg.Y.Ghost(d+4, 1-parity, ghost_idx, col, row))
-		      * arg.inA.Ghost(d, 0, their_spinor_parity, ghost_idx + src_idx*arg.volumeCB, s_col, c_col+color_offset);
+		    out[color_local] += conj(arg.Y.Ghost(d+4, 1-parity, gauge_ghost_idx, col, row))
+		      * arg.inA.Ghost(d, 0, their_spinor_parity, ghost_idx, s_col, c_col+color_offset);
 		}
 	    }
 	  }
@@ -340,9 +342,17 @@ namespace quda {
 
   }
 
-  // CPU kernel for applying the coarse Dslash to a vector
+  /**
+     CPU kernel for applying the coarse Dslash to a vector.  Sites
+     are processed in blocks of site_block, with the source loop
+     inside the block so that the links of a block are reused across
+     all sources, and each site computes Mc colors at once so that the
+     input spinor loads are shared between them.  The site-block loop
+     uses the runtime OpenMP schedule, which the caller sets (see
+     HostLaunch).
+   */
   template <typename Float, int nDim, int Ns, int Nc, int Mc, bool dslash, bool clover, bool dagger, DslashType type, typename Arg>
-  void coarseDslash(Arg arg)
+  void coarseDslash(Arg arg, int site_block)
   {
     // the fine-grain parameters mean nothing for CPU variant
     const int color_stride = 1;
@@ -355,20 +365,175 @@ namespace quda {
       // for full fields then set parity from loop else use arg setting
       parity = (arg.nParity == 2) ? parity : arg.parity;
 
-      for (int src_idx = 0; src_idx < arg.dim[4]; src_idx++) {
-	//#pragma omp parallel for
-	for(int x_cb = 0; x_cb < arg.volumeCB; x_cb++) { // 4-d volume
-	  for (int s=0; s<2; s++) {
-	    for (int color_block=0; color_block<Nc; color_block+=Mc) { // Mc=Nc means all colors in a thread
-	      coarseDslash<Float,nDim,Ns,Nc,Mc,color_stride,dim_thread_split,dslash,clover,dagger,type,dir,dim>(arg, x_cb, src_idx, parity, s, color_block, color_offset);
-	    }
-	  }
-	} // 4-d volumeCB
-      } // src index
+#pragma omp parallel for schedule(runtime)
+      for (int x_block = 0; x_block < arg.volumeCB; x_block += site_block) { // 4-d volume
+        const int x_end = x_block + site_block < arg.volumeCB ? x_block + site_block : arg.volumeCB;
+        for (int src_idx = 0; src_idx < arg.dim[4]; src_idx++) {
+          for (int x_cb = x_block; x_cb < x_end; x_cb++) {
+            for (int s = 0; s < 2; s++) {
+              for (int color_block = 0; color_block < Nc; color_block += Mc) { // Mc=Nc means all colors in a thread
+                coarseDslash<Float,nDim,Ns,Nc,Mc,color_stride,dim_thread_split,dslash,clover,dagger,type,dir,dim>(arg, x_cb, src_idx, parity, s, color_block, color_offset);
+              }
+            }
+          }
+        } // src index
+      } // 4-d volumeCB
     } // parity
 
   }
 
+  /**
+     @brief Number of right-hand sides processed together by the
+     multi-RHS CPU coarse dslash.  This bounds the per-thread working
+     set (two blocks of nSrcBlock * Ns * Nc complex numbers).
+   */
+  constexpr int coarse_dslash_src_block = 8;
+
+  /**
+     @brief Accumulate out[src] += M * in[src] for a block of
+     right-hand sides, where M is an N x N matrix whose elements are
+     returned by link(row, col).  Each element of M is loaded once and
+     applied to all n_src vectors.
+   */
+  template <typename Float, int N, int nSrcBlock, typename Link>
+  inline void multiplyBlock(complex<Float> out[][N], const complex<Float> in[][N], int n_src, const Link &link)
+  {
+    for (int row = 0; row < N; row++) {
+      for (int col = 0; col < N; col++) {
+        const complex<Float> m = link(row, col);
+        for (int src = 0; src < n_src; src++) out[src][row] += m * in[src][col];
+      }
+    }
+  }
+
+  /**
+     @brief Apply the coarse operator at one site to the sources
+     [src_begin, src_begin + n_src) at once.  The neighbouring
+     spinors of all sources are gathered first, so that each link (and
+     clover) matrix is read once per site rather than once per source,
+     turning the matrix-vector products into small matrix-matrix
+     products.
+   */
+  template <typename Float, int nDim, int Ns, int Nc, int nSrcBlock, bool dslash, bool clover, bool dagger,
+            DslashType type, typename Arg>
+  inline void coarseDslashMultiSrc(Arg &arg, int parity, int x_cb, int src_begin, int n_src)
+  {
+    constexpr int N = Ns * Nc;
+    const int their_spinor_parity = (arg.nParity == 2) ? 1 - parity : 0;
+    const int my_spinor_parity = (arg.nParity == 2) ? parity : 0;
+
+    complex<Float> out[nSrcBlock][N];
+    complex<Float> in[nSrcBlock][N];
+    for (int src = 0; src < n_src; src++)
+      for (int i = 0; i < N; i++) out[src][i] = complex<Float>(0.0, 0.0);
+
+    int coord[5];
+    getCoordsCB(coord, x_cb, arg.dim, arg.X0h, parity);
+
+    if (dslash) {
+      for (int d = 0; d < nDim; d++) {
+        // forward gather
+        const bool fwd_ghost = arg.commDim[d] && (coord[d] + arg.nFace >= arg.dim[d]);
+        if (fwd_ghost ? doHalo<type>() : doBulk<type>()) {
+          const int fwd_idx = linkIndexP1(coord, arg.dim, d);
+          for (int src = 0; src < n_src; src++) {
+            // the ghost zone of a five-dimensional field is ordered with the source index inside the face
+            coord[4] = src_begin + src;
+            for (int s = 0; s < Ns; s++)
+              for (int c = 0; c < Nc; c++)
+                in[src][s * Nc + c] = fwd_ghost ?
+                  arg.inA.Ghost(d, 1, their_spinor_parity, ghostFaceIndex<1, 5>(coord, arg.dim, d, arg.nFace), s, c) :
+                  arg.inA(their_spinor_parity, fwd_idx + coord[4] * arg.volumeCB, s, c);
+          }
+          const int dir = dagger ? d : d + 4;
+          multiplyBlock<Float, N, nSrcBlock>(out, in, n_src,
+                                             [&](int row, int col) { return arg.Y(dir, parity, x_cb, row, col); });
+        }
+
+        // backward gather
+        const bool back_ghost = arg.commDim[d] && (coord[d] - arg.nFace < 0);
+        if (back_ghost ? doHalo<type>() : doBulk<type>()) {
+          const int back_idx = linkIndexM1(coord, arg.dim, d);
+          for (int src = 0; src < n_src; src++) {
+            coord[4] = src_begin + src;
+            for (int s = 0; s < Ns; s++)
+              for (int c = 0; c < Nc; c++)
+                in[src][s * Nc + c] = back_ghost ?
+                  arg.inA.Ghost(d, 0, their_spinor_parity, ghostFaceIndex<0, 5>(coord, arg.dim, d, arg.nFace), s, c) :
+                  arg.inA(their_spinor_parity, back_idx + coord[4] * arg.volumeCB, s, c);
+          }
+          coord[4] = 0;
+          const int ghost_idx = back_ghost ? ghostFaceIndex<0, 4>(coord, arg.dim, d, arg.nFace) : 0;
+          const int dir = dagger ? d + 4 : d;
+          if (back_ghost)
+            multiplyBlock<Float, N, nSrcBlock>(out, in, n_src, [&](int row, int col) {
+              return conj(arg.Y.Ghost(dir, 1 - parity, ghost_idx, col, row));
+            });
+          else
+            multiplyBlock<Float, N, nSrcBlock>(out, in, n_src, [&](int row, int col) {
+              return conj(arg.Y(dir, 1 - parity, back_idx, col, row));
+            });
+        }
+      }
+
+      for (int src = 0; src < n_src; src++)
+        for (int i = 0; i < N; i++) out[src][i] *= -arg.kappa;
+    }
+
+    if (doBulk<type>() && clover) {
+      for (int src = 0; src < n_src; src++) {
+        const int idx = x_cb + (src_begin + src) * arg.volumeCB;
+        for (int s = 0; s < Ns; s++)
+          for (int c = 0; c < Nc; c++) in[src][s * Nc + c] = arg.inB(my_spinor_parity, idx, s, c);
+      }
+      if (!dagger)
+        multiplyBlock<Float, N, nSrcBlock>(out, in, n_src, [&](int row, int col) { return arg.X(0, parity, x_cb, row, col); });
+      else
+        multiplyBlock<Float, N, nSrcBlock>(out, in, n_src,
+                                           [&](int row, int col) { return conj(arg.X(0, parity, x_cb, col, row)); });
+    }
+
+    for (int src = 0; src < n_src; src++) {
+      const int idx = x_cb + (src_begin + src) * arg.volumeCB;
+      for (int s = 0; s < Ns; s++) {
+        for (int c = 0; c < Nc; c++) {
+          // if not halo we just store, else we accumulate
+          if (doBulk<type>()) arg.out(my_spinor_parity, idx, s, c) = out[src][s * Nc + c];
+          else arg.out(my_spinor_parity, idx, s, c) += out[src][s * Nc + c];
+        }
+      }
+    }
+  }
+
+  /**
+     CPU kernel for applying the coarse Dslash to a multi-RHS
+     (five-dimensional) vector.  Sites are processed in blocks of
+     site_block and, within each, the sources are processed
+     coarse_dslash_src_block at a time with coarseDslashMultiSrc.
+   */
+  template <typename Float, int nDim, int Ns, int Nc, bool dslash, bool clover, bool dagger, DslashType type, typename Arg>
+  void coarseDslashMultiSrc(Arg arg, int site_block)
+  {
+    constexpr int nSrcBlock = coarse_dslash_src_block;
+
+    for (int parity = 0; parity < arg.nParity; parity++) {
+      // for full fields then set parity from loop else use arg setting
+      parity = (arg.nParity == 2) ? parity : arg.parity;
+
+#pragma omp parallel for schedule(runtime)
+      for (int x_block = 0; x_block < arg.volumeCB; x_block += site_block) {
+        const int x_end = x_block + site_block < arg.volumeCB ? x_block + site_block : arg.volumeCB;
+        for (int src_begin = 0; src_begin < arg.dim[4]; src_begin += nSrcBlock) {
+          const int n_src = src_begin + nSrcBlock < arg.dim[4] ? nSrcBlock : arg.dim[4] - src_begin;
+          for (int x_cb = x_block; x_cb < x_end; x_cb++) {
+            coarseDslashMultiSrc<Float, nDim, Ns, Nc, nSrcBlock, dslash, clover, dagger, type>(arg, parity, x_cb,
+                                                                                               src_begin, n_src);
+          }
+        }
+      }
+    }
+  }
+
   // GPU Kernel for applying the coarse Dslash to a vector
   template <typename Float, int nDim, int Ns, int Nc, int Mc, int color_stride, int dim_thread_split, bool dslash, bool clover, bool dagger, DslashType type, typename Arg>
   __global__ void coarseDslashKernel(Arg arg)
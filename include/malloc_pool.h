@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <malloc_quda.h>
+#include <util_quda.h>
+
+namespace quda
+{
+
+  namespace pool
+  {
+
+    /**
+       The pool allocator caches released allocations in size-class
+       bins so that fields can reuse them with minimal overhead.
+       Requests are rounded up to a size class: multiples of 256 bytes
+       up to 4 KiB, and sixteen classes per power of two above that,
+       so that an allocation wastes at most 255 bytes or 6.25% of its
+       size.  A request is served only from its own bin.
+
+       To stop the cache growing without bound, the pool tracks the
+       high-water mark of the bytes in use.  Whenever the bytes in use
+       plus the bytes cached exceed this mark by more than the slack
+       (QUDA_MEMORY_POOL_SLACK percent, default 25), the least recently
+       released allocations are returned to the system.  A miss
+       evicts before it allocates, so that a request is never refused
+       by the system for memory the pool is holding in other bins.
+       Cached allocations are kept in a single list in the order they
+       were released, so that both reuse and eviction take constant
+       time.
+
+       The pool is independent of the target: the underlying
+       allocation and release are the target's pinned and device
+       allocators.
+    */
+    class Pool
+    {
+
+    public:
+      using allocator_t = void *(*)(const char *, const char *, int, size_t);
+      using deallocator_t = void (*)(const char *, const char *, int, void *);
+
+      static constexpr int linear_log2 = 12;   // classes are multiples of the smallest up to 4 KiB
+      static constexpr int min_log2 = 8;       // smallest size class is 256 bytes
+      static constexpr int sub_classes = 16;   // size classes per power of two above that
+      static constexpr int n_linear = 1 << (linear_log2 - min_log2);
+
+      /**
+         Statistics of the pool, summed over the bins
+      */
+      struct Statistics {
+        size_t active_bytes;    // size-class bytes of the allocations in use
+        size_t requested_bytes; // bytes requested by the allocations in use
+        size_t cached_bytes;    // bytes in the cache
+        size_t high_water;      // peak of active_bytes
+        size_t peak_reserved;   // peak of active_bytes + cached_bytes
+        size_t hits;            // requests served from the cache
+        size_t misses;          // requests that needed a new allocation
+        size_t evictions;       // cached allocations returned to the system
+      };
+
+      static int log2_floor(size_t n)
+      {
+        int l = 0;
+        while (n >>= 1) l++;
+        return l;
+      }
+
+      /**
+         @brief Return the size-class bin for a request
+      */
+      static int bin_index(size_t nbytes)
+      {
+        if (nbytes <= (1ul << linear_log2)) return nbytes == 0 ? 0 : static_cast<int>((nbytes - 1) >> min_log2);
+
+        // nbytes is in (2^o, 2^(o+1)], split into sub_classes steps
+        const int o = log2_floor(nbytes - 1);
+        const size_t base = 1ul << o;
+        const size_t step = base / sub_classes;
+        const int q = static_cast<int>((nbytes - base + step - 1) / step);
+        return n_linear - 1 + (o - linear_log2) * sub_classes + q;
+      }
+
+      /**
+         @brief Return the size of the allocations held in a bin
+      */
+      static size_t bin_size(int bin)
+      {
+        if (bin < n_linear) return static_cast<size_t>(bin + 1) << min_log2;
+        const int k = bin - n_linear;
+        const int o = linear_log2 + k / sub_classes;
+        const int q = k % sub_classes + 1;
+        return (1ul << o) + q * ((1ul << o) / sub_classes);
+      }
+
+    private:
+      struct Block {
+        void *ptr;
+        int bin;
+      };
+
+      using lru_t = std::list<Block>;
+
+      struct Bin {
+        std::deque<lru_t::iterator> cache; // inactive allocations, least recently released first
+        size_t active = 0;                 // allocations in use
+        size_t hits = 0;                   // requests served from the cache
+        size_t misses = 0;                 // requests that needed a new allocation
+        size_t evictions = 0;              // cached allocations returned to the system
+      };
+
+      struct Allocation {
+        int bin;
+        size_t requested;
+      };
+
+      const char *label;
+      allocator_t allocate;
+      deallocator_t deallocate;
+
+      std::vector<Bin> bins;
+      lru_t lru; // every cached allocation, least recently released first
+      std::unordered_map<void *, Allocation> active;
+
+      size_t active_bytes = 0;
+      size_t requested_bytes = 0;
+      size_t cached_bytes = 0;
+      size_t high_water = 0;
+      size_t peak_reserved = 0;
+      double slack = 0.25;
+
+      std::mutex mutex;
+
+      /**
+         @brief Release the least recently cached allocations until
+         the reserved bytes are within the slack of the high-water
+         mark
+         @param[in] incoming Bytes about to be allocated, which count
+         as in use
+      */
+      void trim(const char *func, const char *file, int line, size_t incoming = 0)
+      {
+        const size_t in_use = active_bytes + incoming;
+        const size_t limit = static_cast<size_t>(std::max(high_water, in_use) * (1.0 + slack));
+        while (!lru.empty() && in_use + cached_bytes > limit) {
+          // the oldest block of the pool is also the oldest of its bin
+          auto &bin = bins[lru.front().bin];
+          deallocate(func, file, line, lru.front().ptr);
+          cached_bytes -= bin_size(lru.front().bin);
+          bin.cache.pop_front();
+          bin.evictions++;
+          lru.pop_front();
+        }
+      }
+
+    public:
+      bool enabled = true;
+
+      Pool(const char *label, allocator_t allocate, deallocator_t deallocate) :
+        label(label), allocate(allocate), deallocate(deallocate)
+      {
+      }
+
+      void set_slack(double slack_) { slack = slack_; }
+
+      void *malloc(const char *func, const char *file, int line, size_t nbytes)
+      {
+        if (!enabled) return allocate(func, file, line, nbytes);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        const int b = bin_index(nbytes);
+        if (b >= static_cast<int>(bins.size())) bins.resize(b + 1);
+        auto &bin = bins[b];
+        const size_t size = bin_size(b);
+
+        void *ptr = nullptr;
+        if (!bin.cache.empty()) { // reuse the most recently released allocation
+          ptr = bin.cache.back()->ptr;
+          lru.erase(bin.cache.back());
+          bin.cache.pop_back();
+          cached_bytes -= size;
+          bin.hits++;
+        } else {
+          // a miss while other bins hold cached allocations is where
+          // fragmentation accumulates: make room before allocating
+          trim(func, file, line, size);
+          ptr = allocate(func, file, line, size);
+          bin.misses++;
+        }
+
+        bin.active++;
+        active[ptr] = {b, nbytes};
+        active_bytes += size;
+        requested_bytes += nbytes;
+        high_water = std::max(high_water, active_bytes);
+        peak_reserved = std::max(peak_reserved, active_bytes + cached_bytes);
+        return ptr;
+      }
+
+      void free(const char *func, const char *file, int line, void *ptr)
+      {
+        if (!enabled) {
+          deallocate(func, file, line, ptr);
+          return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = active.find(ptr);
+        if (it == active.end()) { errorQuda("Attempt to free invalid pointer"); }
+        const int b = it->second.bin;
+        auto &bin = bins[b];
+        const size_t size = bin_size(b);
+
+        bin.cache.push_back(lru.insert(lru.end(), {ptr, b}));
+        bin.active--;
+        cached_bytes += size;
+        active_bytes -= size;
+        requested_bytes -= it->second.requested;
+        active.erase(it);
+
+        trim(func, file, line);
+      }
+
+      /**
+         @brief Release every cached allocation and reset the
+         high-water mark.  Statistics are kept.
+      */
+      void flush()
+      {
+        if (!enabled) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &block : lru) deallocate(__func__, quda::file_name(__FILE__), __LINE__, block.ptr);
+        lru.clear();
+        for (auto &bin : bins) bin.cache.clear();
+        cached_bytes = 0;
+        high_water = active_bytes;
+      }
+
+      Statistics statistics()
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        Statistics s = {active_bytes, requested_bytes, cached_bytes, high_water, peak_reserved, 0, 0, 0};
+        for (auto &bin : bins) {
+          s.hits += bin.hits;
+          s.misses += bin.misses;
+          s.evictions += bin.evictions;
+        }
+        return s;
+      }
+
+      void print_statistics()
+      {
+        if (!enabled) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        printfQuda("%s memory pool: high-water mark %.2f MiB, peak reserved %.2f MiB\n", label,
+                   high_water / (1024.0 * 1024.0), peak_reserved / (1024.0 * 1024.0));
+        printfQuda("%s memory pool: in use %.2f MiB (requested %.2f MiB), cached %.2f MiB\n", label,
+                   active_bytes / (1024.0 * 1024.0), requested_bytes / (1024.0 * 1024.0),
+                   cached_bytes / (1024.0 * 1024.0));
+        for (int b = 0; b < static_cast<int>(bins.size()); b++) {
+          const auto &bin = bins[b];
+          if (bin.hits + bin.misses == 0) continue;
+          printfQuda("%s memory pool: bin %12lu bytes: hits = %8lu, misses = %6lu, evictions = %6lu, active = %4lu, "
+                     "cached = %4lu\n",
+                     label, bin_size(b), bin.hits, bin.misses, bin.evictions, bin.active, bin.cache.size());
+        }
+      }
+    };
+
+  } // namespace pool
+
+} // namespace quda
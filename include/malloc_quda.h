@@ -136,6 +136,13 @@ namespace quda {
     */
     void flush_pinned();
 
+    /**
+       @brief Print the pinned- and device-memory pool statistics:
+       high-water mark, peak reserved memory, and the per-size-class
+       hit, miss and eviction counts.
+    */
+    void print_statistics();
+
   } // namespace pool
 
 }
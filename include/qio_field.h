@@ -1,5 +1,15 @@
 #pragma once
 
+/**
+   Streaming access to files holding a set of spinor fields as a
+   sequence of records, each with a subset of the fields.  A file
+   written by write_spinor_field is a single such record.  A record
+   may be read in part: read_spinor_record keeps the fields [first,
+   first + n) of a record of Nvec fields.
+*/
+struct QioSpinorInput;
+struct QioSpinorOutput;
+
 #ifdef HAVE_QIO
 void read_gauge_field(const char *filename, void *gauge[], QudaPrecision prec, const int *X,
 		      int argc, char *argv[]);
@@ -8,6 +18,17 @@ void read_spinor_field(const char *filename, void *V[], QudaPrecision precision,
                        QudaParity parity, int nColor, int nSpin, int Nvec, int argc, char *argv[]);
 void write_spinor_field(const char *filename, void *V[], QudaPrecision precision, const int *X, QudaSiteSubset subset,
                         QudaParity parity, int nColor, int nSpin, int Nvec, int argc, char *argv[]);
+QioSpinorInput *open_spinor_input(const char *filename, const int *X, QudaSiteSubset subset);
+int next_spinor_record_count(QioSpinorInput *infile,
+                             QudaPrecision *precision = nullptr); // 0 at the end of the file
+void read_spinor_record(QioSpinorInput *infile, void *V[], QudaPrecision precision, QudaSiteSubset subset,
+                        QudaParity parity, int nColor, int nSpin, int Nvec, int first = 0, int n = -1);
+void skip_spinor_record(QioSpinorInput *infile);
+void close_spinor_input(QioSpinorInput *infile);
+QioSpinorOutput *open_spinor_output(const char *filename, const int *X, QudaSiteSubset subset);
+void write_spinor_record(QioSpinorOutput *outfile, void *V[], QudaPrecision precision, QudaSiteSubset subset,
+                         QudaParity parity, int nColor, int nSpin, int Nvec);
+void close_spinor_output(QioSpinorOutput *outfile);
 #else
 inline void read_gauge_field(const char *filename, void *gauge[], QudaPrecision prec, const int *X, int argc,
                              char *argv[])
@@ -23,6 +23,8 @@ namespace quda {
 #else
 
 #include <sys/time.h>
+#include <chrono>
+#include <string>
 
 #ifdef INTERFACE_NVTX
 #if QUDA_NVTX_VERSION == 3
@@ -36,8 +38,9 @@ namespace quda {
 
   /**
    * Use this for recording a fine-grained profile of a QUDA
-   * algorithm.  This uses host-side measurement, so should be used
-   * for timing fully host-device synchronous algorithms.
+   * algorithm.  This uses host-side measurement with a monotonic
+   * clock, so should be used for timing fully host-device synchronous
+   * algorithms.
    */
   struct Timer {
     /**< The cumulative sum of time */
@@ -47,10 +50,10 @@ namespace quda {
     double last;
 
     /**< Used to store when the timer was last started */
-    timeval start;
+    std::chrono::steady_clock::time_point start;
 
     /**< Used to store when the timer was last stopped */
-    timeval stop;
+    std::chrono::steady_clock::time_point stop;
 
     /**< Are we currently timing? */
     bool running;
@@ -65,7 +68,7 @@ namespace quda {
 	printfQuda("ERROR: Cannot start an already running timer (%s:%d in %s())\n", file, line, func);
 	errorQuda("Aborting");
       }
-      gettimeofday(&start, NULL);
+      start = std::chrono::steady_clock::now();
       running = true;
     }
 
@@ -74,11 +77,9 @@ namespace quda {
 	printfQuda("ERROR: Cannot stop an unstarted timer (%s:%d in %s())\n", file, line, func);
 	errorQuda("Aborting");
       }
-      gettimeofday(&stop, NULL);
+      stop = std::chrono::steady_clock::now();
 
-      long ds = stop.tv_sec - start.tv_sec;
-      long dus = stop.tv_usec - start.tv_usec;
-      last = ds + 0.000001*dus;
+      last = std::chrono::duration<double>(stop - start).count();
       time += last;
       count++;
 
@@ -150,6 +151,82 @@ namespace quda {
     QUDA_PROFILE_COUNT  /**< The total number of timers we have.  Must be last enum type. */
   };
 
+  /**
+     Hierarchical timeline profiler, enabled with
+     QUDA_ENABLE_TIMELINE=1.  Every TimeProfile interval (and every
+     timeline::Scope) is recorded with its nesting in an event buffer
+     owned by the calling thread, so recording takes no locks.  At
+     endQuda every rank writes its timeline to its own Chrome
+     trace-event file (load in chrome://tracing or Perfetto), with the
+     rank as the pid and a common time origin, so that the files can
+     be merged offline, e.g., with
+       jq -s '{traceEvents: map(.traceEvents) | add}' profile_timeline_rank*.json
+     Only the call-path summaries are gathered to rank 0, which writes
+     and prints the summary over ranks.
+  */
+  namespace timeline
+  {
+
+    /**
+       @return Whether the timeline profiler is enabled
+    */
+    bool enabled();
+
+    /**
+       @brief Return the id of a region name, registering it on first use
+       @param[in] name The region name
+    */
+    int name_id(const std::string &name);
+
+    /**
+       @brief Open a region on the calling thread
+       @param[in] name The region name id
+       @param[in] idx The profile phase, or QUDA_PROFILE_COUNT for a plain region
+    */
+    void begin(int name, QudaProfileType idx);
+
+    /**
+       @brief Close the most recently opened matching region on the calling thread
+       @param[in] name The region name id
+       @param[in] idx The profile phase, or QUDA_PROFILE_COUNT for a plain region
+    */
+    void end(int name, QudaProfileType idx);
+
+    /**
+       @brief Write the trace of each rank, merge the call-path
+       summaries of all ranks on rank 0 and reset the recorded
+       events.  Must be called collectively.
+    */
+    void finalize();
+
+    /**
+       Region that is open for the lifetime of the object, for host
+       code that has no TimeProfile of its own
+    */
+    class Scope
+    {
+      int name = -1;
+
+    public:
+      Scope(const char *region)
+      {
+        if (enabled()) {
+          name = name_id(region);
+          begin(name, QUDA_PROFILE_COUNT);
+        }
+      }
+
+      ~Scope()
+      {
+        if (name >= 0) end(name, QUDA_PROFILE_COUNT);
+      }
+
+      Scope(const Scope &) = delete;
+      Scope &operator=(const Scope &) = delete;
+    };
+
+  } // namespace timeline
+
 #ifdef INTERFACE_NVTX
 
 #define PUSH_RANGE(name,cid) { \
@@ -182,6 +259,19 @@ namespace quda {
 
     bool switchOff;
     bool use_global;
+    int timeline_id = -1; /**< Name id of this profile in the timeline profiler */
+
+    void TimelineBegin(QudaProfileType idx)
+    {
+      if (!timeline::enabled()) return;
+      if (timeline_id < 0) timeline_id = timeline::name_id(fname);
+      timeline::begin(timeline_id, idx);
+    }
+
+    void TimelineEnd(QudaProfileType idx)
+    {
+      if (timeline::enabled() && timeline_id >= 0) timeline::end(timeline_id, idx);
+    }
 
     // global timer
     static Timer global_profile[QUDA_PROFILE_COUNT];
@@ -226,9 +316,11 @@ namespace quda {
       if (!profile[QUDA_PROFILE_TOTAL].running && idx != QUDA_PROFILE_TOTAL) {
 	profile[QUDA_PROFILE_TOTAL].Start(func,file,line);
         switchOff = true;
+        TimelineBegin(QUDA_PROFILE_TOTAL);
       }
 
       profile[idx].Start(func, file, line); 
+      TimelineBegin(idx);
       PUSH_RANGE(fname.c_str(),idx)
 	if (use_global) StartGlobal(func,file,line,idx);
     }
@@ -236,11 +328,13 @@ namespace quda {
 
     void Stop_(const char *func, const char *file, int line, QudaProfileType idx) {
       profile[idx].Stop(func, file, line); 
+      TimelineEnd(idx);
       POP_RANGE
 
       // switch off total timer if we need to
       if (switchOff && idx != QUDA_PROFILE_TOTAL) {
         profile[QUDA_PROFILE_TOTAL].Stop(func,file,line);
+        TimelineEnd(QUDA_PROFILE_TOTAL);
         switchOff = false;
       }
       if (use_global) StopGlobal(func,file,line,idx);
@@ -257,6 +351,9 @@ namespace quda {
 
     static void PrintGlobal();
 
+    /**< Name of a profile phase */
+    static const std::string &Name(QudaProfileType idx) { return pname[idx]; }
+
     bool isRunning(QudaProfileType idx) { return profile[idx].running; }
 
   };
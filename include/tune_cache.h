@@ -0,0 +1,265 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <tune_quda.h>
+
+/**
+   @file tune_cache.h
+
+   @brief Text and binary (de)serialization of the tunecache.
+
+   The text format (tunecache.tsv) is the long-standing human-readable
+   format.  The binary format (tunecache.bin) is a single versioned
+   image consisting of a header, a table of fixed-size records, an
+   open-addressing hash index over the records and a string pool.  It
+   can be memory mapped read-only and queried in place, so a job does
+   not need to parse the whole cache at startup, and ranks on the same
+   node share the mapped pages through the page cache.  The same image
+   is used as the payload when broadcasting the tunecache.  The binary
+   header records the QUDA version and build, as well as the size and
+   modification time of the text tunecache it was written alongside,
+   so that a binary tunecache is not used once the text file has been
+   edited or replaced.
+ */
+
+namespace quda
+{
+
+  typedef std::map<TuneKey, TuneParam> tune_map;
+
+  namespace tune_cache
+  {
+
+    static constexpr char binary_magic[8] = {'Q', 'U', 'D', 'A', 'T', 'U', 'N', 'E'};
+    static constexpr uint32_t binary_format_version = 3;
+    static constexpr uint32_t binary_endian_check = 0x01020304;
+
+    struct BinaryHeader {
+      char magic[8];
+      uint32_t format_version;
+      uint32_t endian;
+      char version[64];
+      char gitversion[128];
+      char hash[256];
+      uint64_t text_bytes;     // size of the text tunecache the image was written from, zero if none
+      int64_t text_mtime;      // its modification time in nanoseconds
+      uint64_t n_entry;
+      uint64_t n_bucket;       // power of two, zero if the image has no index
+      uint64_t record_offset;  // byte offset of the BinaryRecord table
+      uint64_t bucket_offset;  // byte offset of the uint32_t bucket table
+      uint64_t string_offset;  // byte offset of the string pool
+      uint64_t total_bytes;
+    };
+
+    struct BinaryRecord {
+      uint64_t hash; // TuneKey::hash
+      uint32_t volume; // offsets into the string pool
+      uint32_t name;
+      uint32_t aux;
+      uint32_t comment;
+      int32_t block[3];
+      int32_t grid[3];
+      int32_t shared_bytes;
+      int32_t aux_param[4];
+      float time;
+    };
+
+    /**
+       @brief Size and modification time of a text tunecache file
+    */
+    struct TextStamp {
+      uint64_t bytes = 0;
+      int64_t mtime = 0; // nanoseconds since the epoch
+
+      bool operator==(const TextStamp &other) const { return bytes == other.bytes && mtime == other.mtime; }
+      bool operator!=(const TextStamp &other) const { return !(*this == other); }
+    };
+
+    /**
+       @brief Stamp of the file at path, zero if it does not exist
+    */
+    TextStamp textStamp(const std::string &path);
+
+    /**
+       @brief Parse tunecache entries (without the two header lines) in
+       text format and insert them into cache
+    */
+    void readText(std::istream &in, tune_map &cache);
+
+    /**
+       @brief Write tunecache entries (without the header lines) in
+       text format
+    */
+    void writeText(std::ostream &out, const tune_map &cache);
+
+    /**
+       @brief Write the two header lines of the text format
+    */
+    void writeTextHeader(std::ostream &out, const std::string &version, const std::string &gitversion,
+                         const std::string &hash);
+
+    /**
+       @brief Serialize cache into a binary image.  The version strings
+       and the stamp of the text tunecache it corresponds to are
+       recorded in the header; the hash index is only built if index
+       is true.
+    */
+    std::vector<char> serializeBinary(const tune_map &cache, const std::string &version = "",
+                                      const std::string &gitversion = "", const std::string &hash = "",
+                                      bool index = true, const TextStamp &text = TextStamp());
+
+    /**
+       @brief Insert all entries of a binary image into cache
+       @return false if the image is malformed
+    */
+    bool deserializeBinary(const char *image, size_t bytes, tune_map &cache);
+
+    /**
+       @brief Check that an image is a well-formed binary tunecache
+    */
+    bool validBinary(const char *image, size_t bytes);
+
+    /**
+       @brief Write an image to path.  The image is written to a
+       temporary file which is then renamed into place, so that
+       processes that have the old file mapped are not disturbed.
+    */
+    bool writeBinaryFile(const std::string &path, const std::vector<char> &image);
+
+    /**
+       @brief Read-only memory-mapped view of a binary tunecache file
+    */
+    class MappedCache
+    {
+      const char *image = nullptr;
+      size_t bytes = 0;
+
+      const BinaryHeader &header() const { return *reinterpret_cast<const BinaryHeader *>(image); }
+      const BinaryRecord *records() const
+      {
+        return reinterpret_cast<const BinaryRecord *>(image + header().record_offset);
+      }
+      const uint32_t *buckets() const { return reinterpret_cast<const uint32_t *>(image + header().bucket_offset); }
+      const char *string(uint32_t offset) const { return image + header().string_offset + offset; }
+      void copy(const BinaryRecord &record, TuneKey &key, TuneParam &param) const;
+
+    public:
+      MappedCache() = default;
+      MappedCache(const MappedCache &) = delete;
+      MappedCache &operator=(const MappedCache &) = delete;
+      ~MappedCache() { close(); }
+
+      /**
+         @brief Map the file at path
+         @return false if the file does not exist or is not a valid
+         binary tunecache with an index
+      */
+      bool open(const std::string &path);
+      void close();
+      bool isOpen() const { return image != nullptr; }
+      size_t size() const { return isOpen() ? header().n_entry : 0; }
+
+      std::string version() const { return isOpen() ? header().version : ""; }
+      std::string gitversion() const { return isOpen() ? header().gitversion : ""; }
+      std::string hash() const { return isOpen() ? header().hash : ""; }
+
+      /**
+         @brief Stamp of the text tunecache the image was written from
+      */
+      TextStamp text() const
+      {
+        TextStamp stamp;
+        if (isOpen()) {
+          stamp.bytes = header().text_bytes;
+          stamp.mtime = header().text_mtime;
+        }
+        return stamp;
+      }
+
+      /**
+         @brief Look up key in the index
+         @return true if found, in which case param is set
+      */
+      bool find(const TuneKey &key, TuneParam &param) const;
+
+      /**
+         @brief Insert every entry not already present into cache
+      */
+      void materialize(tune_map &cache) const;
+    };
+
+    /**
+       @brief Open-addressing hash index over tunecache entries, keyed
+       on the precomputed TuneKey::hash.  Lookups are lock free and may
+       run concurrently with a publishing thread.  The index owns its
+       entries, and a published entry is never modified other than its
+       call count: replacing the parameters of a key publishes a new
+       entry into the slot with a release store and retires the old
+       one, as does growing the table, so in-flight readers always see
+       a complete entry that remains valid.  Publishing must be
+       serialized by the caller.
+    */
+    class Index
+    {
+    public:
+      typedef tune_map::value_type value_type;
+
+    private:
+      struct Table {
+        const size_t mask;
+        std::unique_ptr<std::atomic<value_type *>[]> slot;
+        Table(size_t size);
+      };
+
+      std::atomic<Table *> table;
+      std::vector<std::unique_ptr<Table>> tables;        // the current table and all retired tables
+      std::vector<std::unique_ptr<value_type>> entries; // the published entries and all retired entries
+      size_t n_entry = 0;
+
+      static void place(Table &table, value_type *entry);
+
+    public:
+      Index(size_t size = 1024);
+      Index(const Index &) = delete;
+      Index &operator=(const Index &) = delete;
+
+      /**
+         @brief Look up key, safe to call from any thread
+         @return Pointer to the entry, or nullptr if not present
+      */
+      value_type *find(const TuneKey &key) const;
+
+      /**
+         @brief Publish param as the entry of key, replacing any
+         existing entry.  Must not be called concurrently with another
+         publish.
+         @return Pointer to the published entry
+      */
+      value_type *publish(const TuneKey &key, const TuneParam &param);
+
+      size_t size() const { return n_entry; }
+    };
+
+    /**
+       @brief Convert a text tunecache file (including its header) into
+       the binary format, preserving the version strings and recording
+       the stamp of the text file
+    */
+    bool textToBinary(const std::string &text_path, const std::string &binary_path);
+
+    /**
+       @brief Convert a binary tunecache file into the text format,
+       preserving the version strings
+    */
+    bool binaryToText(const std::string &binary_path, const std::string &text_path);
+
+  } // namespace tune_cache
+
+} // namespace quda
@@ -1,6 +1,7 @@
 #ifndef _TUNE_KEY_H
 #define _TUNE_KEY_H
 
+#include <cstdint>
 #include <cstring>
 
 namespace quda {
@@ -13,14 +14,16 @@ namespace quda {
     char volume[volume_n];
     char name[name_n];
     char aux[aux_n];
+    uint64_t hash; // hash of volume, name and aux, used for tunecache lookup
 
-    TuneKey() { }
+    TuneKey() : hash(0) { }
     TuneKey(const char v[], const char n[], const char a[]="type=default") {
       strcpy(volume, v);
       strcpy(name, n);
       strcpy(aux, a);
+      updateHash();
     } 
-    TuneKey(const TuneKey &key) {
+    TuneKey(const TuneKey &key) : hash(key.hash) {
       strcpy(volume,key.volume);
       strcpy(name,key.name);
       strcpy(aux,key.aux);
@@ -31,10 +34,38 @@ namespace quda {
 	strcpy(volume,key.volume);
 	strcpy(name,key.name);
 	strcpy(aux,key.aux);
+	hash = key.hash;
       }
       return *this;
     }
 
+    /**
+       @brief Recompute the (64-bit FNV-1a) hash.  This must be called
+       whenever volume, name or aux are modified after construction.
+       The hash is stored in the binary tunecache, so must not be
+       changed without bumping tune_cache::binary_format_version.
+    */
+    void updateHash() {
+      uint64_t h = 0xcbf29ce484222325ull;
+      auto fnv1a = [&h](const char *s) {
+        for (; *s; s++) {
+          h ^= static_cast<unsigned char>(*s);
+          h *= 0x100000001b3ull;
+        }
+        h ^= static_cast<unsigned char>('\t');
+        h *= 0x100000001b3ull;
+      };
+      fnv1a(volume);
+      fnv1a(name);
+      fnv1a(aux);
+      hash = h;
+    }
+
+    bool operator==(const TuneKey &other) const {
+      return hash == other.hash && std::strcmp(volume, other.volume) == 0 && std::strcmp(name, other.name) == 0
+        && std::strcmp(aux, other.aux) == 0;
+    }
+
     bool operator<(const TuneKey &other) const {
       int vc = std::strcmp(volume, other.volume);
       if (vc < 0) {
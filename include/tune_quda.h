@@ -14,6 +14,10 @@
 #include <quda_internal.h>
 #include <device.h>
 
+#if defined(_OPENMP) && !defined(__CUDACC_RTC__)
+#include <omp.h>
+#endif
+
 // this file has some workarounds to allow compilation using nvrtc of kernels that include this file
 #ifdef __CUDACC_RTC__
 #define CUresult bool
@@ -84,6 +88,73 @@ namespace quda {
    * @return tunecache reference
    */
   const std::map<TuneKey, TuneParam> &getTuneCache();
+
+  /**
+   * @brief Query whether key is present in the tunecache, including
+   * any entries that are only present in the memory-mapped binary
+   * tunecache
+   * @return True if key has been tuned
+   */
+  bool tuneCacheContains(const TuneKey &key);
+#endif
+
+#ifndef __CUDACC_RTC__
+  /**
+     @brief Host launches store their parameters in the fields of
+     TuneParam so that they share the tune cache with GPU launches:
+
+     - aux.x: number of OpenMP threads
+     - aux.y: OpenMP schedule kind (static = 1, dynamic = 2, guided = 3)
+     - aux.z: OpenMP chunk size (0 = the schedule's default)
+     - block.x: site-blocking factor
+     - block.y: color-blocking factor
+
+     Kernels read the blocking factors with hostSiteBlock() and
+     hostColorBlock(), and pick up the threads and schedule by
+     instantiating a HostLaunch around their `schedule(runtime)`
+     loops.
+   */
+  inline int hostThreads(const TuneParam &param) { return param.aux.x; }
+  inline int hostSchedule(const TuneParam &param) { return param.aux.y; }
+  inline int hostChunk(const TuneParam &param) { return param.aux.z; }
+  inline int hostSiteBlock(const TuneParam &param) { return param.block.x; }
+  inline int hostColorBlock(const TuneParam &param) { return param.block.y; }
+
+  /**
+     @brief Scoped application of host launch parameters: sets the
+     OpenMP thread count and runtime schedule for the lifetime of the
+     object and restores the previous values on destruction.
+   */
+  class HostLaunch
+  {
+#ifdef _OPENMP
+    int threads;
+    omp_sched_t kind;
+    int chunk;
+#endif
+
+  public:
+    HostLaunch(const TuneParam &param)
+    {
+#ifdef _OPENMP
+      threads = omp_get_max_threads();
+      omp_get_schedule(&kind, &chunk);
+      omp_set_num_threads(hostThreads(param));
+      omp_set_schedule(static_cast<omp_sched_t>(hostSchedule(param)), hostChunk(param));
+#endif
+    }
+
+    ~HostLaunch()
+    {
+#ifdef _OPENMP
+      omp_set_num_threads(threads);
+      omp_set_schedule(kind, chunk);
+#endif
+    }
+
+    HostLaunch(const HostLaunch &) = delete;
+    HostLaunch &operator=(const HostLaunch &) = delete;
+  };
 #endif
 
   class Tunable {
@@ -259,6 +330,75 @@ namespace quda {
 
     virtual bool advanceAux(TuneParam &param) const { return false; }
 
+    /**
+       @brief Number of iterations of the outer host loop, used to
+       bound the OpenMP chunk sizes that are searched
+     */
+    virtual unsigned int hostWork() const { return minThreads(); }
+
+    /**
+       @brief Largest site-blocking factor to search (powers of two
+       from 1).  Returning 1 disables site blocking.
+     */
+    virtual unsigned int hostSiteBlockMax() const { return 1; }
+
+    /**
+       @brief Largest color-blocking factor to search (powers of two
+       from 1).  Returning 1 disables color blocking.
+     */
+    virtual unsigned int hostColorBlockMax() const { return 1; }
+
+    static int hostMaxThreads()
+    {
+#ifdef _OPENMP
+      return omp_get_max_threads();
+#else
+      return 1;
+#endif
+    }
+
+    bool advanceHostChunk(TuneParam &param) const
+    {
+      int chunk = param.aux.z == 0 ? 4 : 4 * param.aux.z;
+      if (static_cast<long>(chunk) * param.aux.x <= static_cast<long>(hostWork())) {
+        param.aux.z = chunk;
+        return true;
+      }
+      param.aux.z = 0;
+      return false;
+    }
+
+    bool advanceHostSchedule(TuneParam &param) const
+    {
+      if (param.aux.y < 3) { // static -> dynamic -> guided
+        param.aux.y++;
+        return true;
+      }
+      param.aux.y = 1;
+      return false;
+    }
+
+    bool advanceHostThreads(TuneParam &param) const
+    {
+      // halving the thread count past a quarter of the cores is never a win
+      if (param.aux.x / 2 >= std::max(hostMaxThreads() / 4, 1) && param.aux.x > 1) {
+        param.aux.x /= 2;
+        return true;
+      }
+      param.aux.x = hostMaxThreads();
+      return false;
+    }
+
+    bool advanceHostBlock(unsigned int &block, unsigned int max) const
+    {
+      if (2 * block <= max) {
+        block *= 2;
+        return true;
+      }
+      block = 1;
+      return false;
+    }
+
     char aux[TuneKey::aux_n];
 
     int writeAuxString(const char *format, ...) {
@@ -286,9 +426,12 @@ namespace quda {
       if (!getTuning()) return true;
 
       TuneKey key = tuneKey();
-      if (use_managed_memory()) strcat(key.aux, ",managed");
+      if (use_managed_memory()) {
+        strcat(key.aux, ",managed");
+        key.updateHash();
+      }
       // if key is present in cache then already tuned
-      return getTuneCache().find(key) != getTuneCache().end();
+      return tuneCacheContains(key);
 #else
       return true;
 #endif
@@ -307,7 +450,14 @@ namespace quda {
     virtual std::string paramString(const TuneParam &param) const
     {
       std::stringstream ps;
-      ps << param;
+      if (tuneHost()) {
+        static const char *schedule[] = {"auto", "static", "dynamic", "guided"};
+        ps << "threads=" << hostThreads(param) << ", schedule=" << schedule[hostSchedule(param) & 3];
+        ps << ", chunk=" << hostChunk(param);
+        ps << ", site_block=" << hostSiteBlock(param) << ", color_block=" << hostColorBlock(param);
+      } else {
+        ps << param;
+      }
       return ps.str();
     }
 
@@ -358,11 +508,44 @@ namespace quda {
       return advanceSharedBytes(param) || advanceBlockDim(param) || advanceGridDim(param) || advanceAux(param);
     }
 
+    /**
+       @brief Whether this instance executes on the host.  If so,
+       tuneLaunch searches the host launch space (see HostLaunch)
+       using initHostTuneParam, defaultHostTuneParam and
+       advanceHostTuneParam in place of their GPU counterparts, and
+       times the candidates with a host clock.
+     */
+    virtual bool tuneHost() const { return false; }
+
+    /** sets the initial host launch parameters for tuning */
+    void initHostTuneParam(TuneParam &param) const
+    {
+      param.block = dim3(1, 1, 1);
+      param.grid = dim3(1, 1, 1);
+      param.shared_bytes = 0;
+      param.aux = make_int4(hostMaxThreads(), 1, 0, 0);
+    }
+
+    /** sets the host launch parameters for when tuning is disabled */
+    void defaultHostTuneParam(TuneParam &param) const { initHostTuneParam(param); }
+
+    /**
+       @brief Advance the host launch parameters: chunk size is the
+       fastest-varying dimension, followed by the schedule, the thread
+       count, the site-blocking and the color-blocking factors
+     */
+    bool advanceHostTuneParam(TuneParam &param) const
+    {
+      return advanceHostChunk(param) || advanceHostSchedule(param) || advanceHostThreads(param)
+        || advanceHostBlock(param.block.x, hostSiteBlockMax()) || advanceHostBlock(param.block.y, hostColorBlockMax());
+    }
+
     /**
      * Check the launch parameters of the kernel to ensure that they are
      * valid for the current device.
      */
     void checkLaunchParam(TuneParam &param) {
+      if (tuneHost()) return; // no hardware limits apply to host launches
 
       if (param.block.x*param.block.y*param.block.z > (unsigned)deviceProp.maxThreadsPerBlock)
         errorQuda("Requested block size %dx%dx%d=%d greater than hardware limit %d",
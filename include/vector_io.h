@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 namespace quda
 {
@@ -8,6 +9,16 @@ namespace quda
   /**
      @brief VectorIO is a simple wrapper class for loading and saving
      sets of vector fields using QIO.
+
+     Vectors are moved in chunks.  The file I/O and the device
+     transfers of a chunk run on the calling thread, overlapped with
+     the precision conversion and parity inflation of the neighbouring
+     chunk on a worker thread.  Saving writes the whole set as a
+     single record, the format of earlier versions, unless
+     QUDA_VECTOR_IO_CHUNK sets a number of vectors per record.
+     Loading reads files of either form, staging at most a chunk of
+     QUDA_VECTOR_IO_CHUNK vectors, or 1 GiB when this is unset, at a
+     time: a larger record is read in passes over the file.
    */
   class VectorIO
   {
@@ -0,0 +1,552 @@
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <arrow_eigensolver.h>
+#include <util_quda.h>
+#include <eigen_helper.h>
+
+namespace quda
+{
+
+  template <typename T> using Mat = Matrix<T, Dynamic, Dynamic>;
+
+  // number of columns of an arrowhead eigenvector matrix generated at a time
+  static constexpr int column_chunk = 256;
+
+  // block tridiagonal matrices up to this order are solved densely
+  static constexpr int leaf_size = 64;
+
+  // iterations of the secular equation solver, which halves the bracket at least every fourth iteration
+  static constexpr int max_root_iter = 200;
+
+  static inline double phaseOf(double z) { return z < 0.0 ? -1.0 : 1.0; }
+  static inline std::complex<double> phaseOf(const std::complex<double> &z)
+  {
+    double a = std::abs(z);
+    return a > 0.0 ? z / a : std::complex<double>(1.0);
+  }
+
+  /**
+     Eigendecomposition of the arrowhead matrix [[diag(delta), z], [z^H, mu]]
+     of order s + 1 with the vertex last.  The phases of z are factored
+     out so that the secular equation is real; the eigenvectors are
+     kept in compact form (the arrow recomputed from the roots, the
+     roots and the deflating rotations) and formed a chunk of columns
+     at a time.
+   */
+  template <typename T> class Arrowhead
+  {
+    struct Rotation {
+      int p, i;
+      double c, s;
+    };
+
+    int s = 0;
+    std::vector<T> phase;       // phase of each arrow element
+    std::vector<int> kept;      // non-deflated indices, by ascending diagonal
+    std::vector<double> dk;     // diagonal of the non-deflated indices
+    std::vector<double> zhat;   // recomputed arrow of the non-deflated indices
+    std::vector<int> origin;    // per root, the pole it is computed relative to
+    std::vector<double> tau;    // per root, the offset from its origin
+    std::vector<double> norm;   // per root, the norm of its eigenvector
+    std::vector<Rotation> rotations;
+    std::vector<int> column;    // eigenvector j is root column[j] >= 0, or unit vector -1 - column[j]
+
+    // dk[l] - lambda_j, accurate when lambda_j is close to dk[l]
+    double gap(int l, int j) const { return (dk[l] - dk[origin[j]]) - tau[j]; }
+
+    void solveRoot(int j, double mu, double znorm)
+    {
+      const int K = dk.size();
+      const double eps = std::numeric_limits<double>::epsilon();
+      int o;
+      double lo, hi;
+      std::vector<double> d(K);
+
+      auto secular = [&](double t, double &psi, double &dpsi, double &phi, double &dphi) {
+        psi = dpsi = phi = dphi = 0.0;
+        double bound = std::abs(dk[o]) + std::abs(mu) + std::abs(t);
+        for (int l = 0; l < K; l++) {
+          double r = 1.0 / (d[l] - t);
+          double term = zhat[l] * zhat[l] * r;
+          if (l < j) {
+            psi += term;
+            dpsi += term * r;
+          } else {
+            phi += term;
+            dphi += term * r;
+          }
+          bound += std::abs(term);
+        }
+        return std::make_pair((dk[o] - mu) + t + psi + phi, bound);
+      };
+      auto setOrigin = [&](int o_) {
+        o = o_;
+        for (int l = 0; l < K; l++) d[l] = dk[l] - dk[o];
+      };
+
+      double psi, dpsi, phi, dphi;
+      if (j == 0) {
+        setOrigin(0);
+        lo = (std::min(mu, dk[0]) - dk[0]) - 2.0 * znorm;
+        hi = 0.0;
+      } else if (j == K) {
+        setOrigin(K - 1);
+        lo = 0.0;
+        hi = (std::max(mu, dk[K - 1]) - dk[K - 1]) + 2.0 * znorm;
+      } else {
+        // compute relative to the pole closest to the root
+        setOrigin(j - 1);
+        double width = d[j];
+        if (secular(0.5 * width, psi, dpsi, phi, dphi).first >= 0.0) {
+          lo = 0.0;
+          hi = 0.5 * width;
+        } else {
+          setOrigin(j);
+          lo = -0.5 * width;
+          hi = 0.0;
+        }
+      }
+
+      double t = 0.5 * (lo + hi);
+      double last_width = hi - lo;
+      bool converged = false;
+      for (int iter = 0; iter < max_root_iter; iter++) {
+        auto g = secular(t, psi, dpsi, phi, dphi);
+        if (g.first == 0.0 || std::abs(g.first) <= 8.0 * eps * g.second) {
+          converged = true;
+          break;
+        }
+        if (g.first > 0.0)
+          hi = t;
+        else
+          lo = t;
+        if (hi - lo <= 2.0 * eps * std::max(std::abs(lo), std::abs(hi))) {
+          converged = true;
+          break;
+        }
+
+        // Rational model of the secular function about its poles either side of the root
+        double next;
+        if (j == 0 || j == K) {
+          // C + x + S / (0 - x) = 0
+          double S = t * t * (j == 0 ? dphi : dpsi);
+          double C = g.first - t + S / t;
+          double q = std::sqrt(C * C + 4.0 * S);
+          if (j == 0)
+            next = C >= 0.0 ? -0.5 * (C + q) : -2.0 * S / (q - C);
+          else
+            next = C <= 0.0 ? 0.5 * (q - C) : 2.0 * S / (C + q);
+        } else {
+          // C + S / (pl - x) + R / (ph - x) = 0
+          double pl = d[j - 1], ph = d[j];
+          double S = (pl - t) * (pl - t) * dpsi;
+          double R = (ph - t) * (ph - t) * dphi;
+          double C = g.first - S / (pl - t) - R / (ph - t);
+          if (C == 0.0) {
+            next = (S * ph + R * pl) / (S + R);
+          } else {
+            double bq = -(C * (pl + ph) + S + R);
+            double cq = C * pl * ph + S * ph + R * pl;
+            double q = -0.5 * (bq + std::copysign(std::sqrt(std::max(bq * bq - 4.0 * C * cq, 0.0)), bq));
+            next = q / C;
+            if (!(next > pl && next < ph) && q != 0.0) next = cq / q;
+          }
+        }
+
+        // fall back to bisection when the model step leaves the bracket or stalls
+        bool stalled = iter % 4 == 3 && hi - lo > 0.5 * last_width;
+        if (iter % 4 == 3) last_width = hi - lo;
+        t = (std::isfinite(next) && next > lo && next < hi && !stalled) ? next : 0.5 * (lo + hi);
+      }
+
+      // the root is still bracketed, so report how far from resolved it is
+      if (!converged)
+        warningQuda("Arrowhead root %d of %d did not converge in %d iterations: bracket width %e about %e", j, K + 1,
+                    max_root_iter, hi - lo, dk[o] + t);
+
+      origin[j] = o;
+      tau[j] = t;
+    }
+
+  public:
+    std::vector<double> lambda; // ascending
+
+    int size() const { return s + 1; }
+
+    void compute(const std::vector<double> &delta_in, const std::vector<T> &z_in, double mu)
+    {
+      s = delta_in.size();
+      const double eps = std::numeric_limits<double>::epsilon();
+
+      std::vector<double> delta(delta_in);
+      std::vector<double> z(s);
+      phase.resize(s);
+      double scale = std::abs(mu);
+      for (int i = 0; i < s; i++) {
+        phase[i] = phaseOf(z_in[i]);
+        z[i] = std::abs(z_in[i]);
+        scale = std::max(scale, std::max(std::abs(delta[i]), z[i]));
+      }
+      const double tol = 8.0 * eps * scale;
+
+      std::vector<int> order(s);
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return delta[a] < delta[b]; });
+
+      // Deflate negligible arrow elements, and rotate out one of each pair of close poles
+      kept.clear();
+      rotations.clear();
+      std::vector<int> deflated;
+      for (auto i : order) {
+        if (z[i] <= tol) {
+          deflated.push_back(i);
+          continue;
+        }
+        if (!kept.empty()) {
+          int p = kept.back();
+          double r = std::hypot(z[p], z[i]);
+          double c = z[p] / r, sn = z[i] / r;
+          if (std::abs(c * sn * (delta[i] - delta[p])) <= tol) {
+            rotations.push_back({p, i, c, sn});
+            double dp = c * c * delta[p] + sn * sn * delta[i];
+            delta[i] = sn * sn * delta[p] + c * c * delta[i];
+            delta[p] = dp;
+            z[p] = r;
+            z[i] = 0.0;
+            deflated.push_back(i);
+            continue;
+          }
+        }
+        kept.push_back(i);
+      }
+
+      const int K = kept.size();
+      dk.resize(K);
+      zhat.resize(K);
+      double znorm = 0.0;
+      for (int l = 0; l < K; l++) {
+        dk[l] = delta[kept[l]];
+        zhat[l] = z[kept[l]];
+        znorm += zhat[l] * zhat[l];
+      }
+      znorm = std::sqrt(znorm);
+
+      const int roots = K > 0 ? K + 1 : 0;
+      origin.resize(roots);
+      tau.resize(roots);
+      norm.resize(roots);
+      for (int j = 0; j < roots; j++) solveRoot(j, mu, znorm);
+
+      // Recompute the arrow from the roots (Gu-Eisenstat) so the eigenvectors are orthogonal
+      for (int l = 0; l < K; l++) {
+        double prod = -gap(l, l) * gap(l, l + 1);
+        for (int m = 0; m < l; m++) prod *= gap(l, m) / (dk[l] - dk[m]);
+        for (int m = l + 1; m < K; m++) prod *= gap(l, m + 1) / (dk[l] - dk[m]);
+        zhat[l] = prod > 0.0 ? std::sqrt(prod) : zhat[l];
+      }
+
+      for (int j = 0; j < roots; j++) {
+        double sum = 1.0;
+        for (int l = 0; l < K; l++) {
+          double x = zhat[l] / gap(l, j);
+          sum += x * x;
+        }
+        norm[j] = std::sqrt(sum);
+      }
+
+      // Order the roots and the deflated eigenvalues together
+      std::vector<std::pair<double, int>> eig;
+      eig.reserve(s + 1);
+      for (int j = 0; j < roots; j++) eig.push_back({dk[origin[j]] + tau[j], j});
+      for (auto i : deflated) eig.push_back({delta[i], -1 - i});
+      if (K == 0) eig.push_back({mu, -1 - s});
+      std::stable_sort(eig.begin(), eig.end(),
+                       [](const std::pair<double, int> &a, const std::pair<double, int> &b) { return a.first < b.first; });
+
+      lambda.resize(s + 1);
+      column.resize(s + 1);
+      for (int j = 0; j <= s; j++) {
+        lambda[j] = eig[j].first;
+        column[j] = eig[j].second;
+      }
+    }
+
+    /**
+       Form columns [c0, c0 + nc) of the eigenvector matrix
+     */
+    void columns(int c0, int nc, Mat<T> &out) const
+    {
+      out.resize(s + 1, nc);
+      std::vector<double> y(s + 1);
+      for (int c = 0; c < nc; c++) {
+        std::fill(y.begin(), y.end(), 0.0);
+        int j = column[c0 + c];
+        if (j >= 0) {
+          for (int l = 0; l < static_cast<int>(kept.size()); l++) y[kept[l]] = zhat[l] / gap(l, j) / norm[j];
+          y[s] = -1.0 / norm[j];
+        } else {
+          y[-1 - j] = 1.0;
+        }
+        for (auto r = rotations.rbegin(); r != rotations.rend(); r++) {
+          double yp = y[r->p], yi = y[r->i];
+          y[r->p] = r->c * yp - r->s * yi;
+          y[r->i] = r->s * yp + r->c * yi;
+        }
+        for (int i = 0; i < s; i++) out(i, c) = phase[i] * y[i];
+        out(s, c) = y[s];
+      }
+    }
+
+    /**
+       @return X * U, where U is the eigenvector matrix
+     */
+    Mat<T> rightMultiply(const Mat<T> &X) const
+    {
+      Mat<T> out(X.rows(), s + 1);
+      Mat<T> U;
+      for (int c0 = 0; c0 <= s; c0 += column_chunk) {
+        int nc = std::min(column_chunk, s + 1 - c0);
+        columns(c0, nc, U);
+        out.middleCols(c0, nc).noalias() = X * U;
+      }
+      return out;
+    }
+
+    /**
+       @return U * S, where U is the eigenvector matrix
+     */
+    Mat<T> leftMultiply(const Mat<T> &S) const
+    {
+      Mat<T> out = Mat<T>::Zero(s + 1, S.cols());
+      Mat<T> U;
+      for (int c0 = 0; c0 <= s; c0 += column_chunk) {
+        int nc = std::min(column_chunk, s + 1 - c0);
+        columns(c0, nc, U);
+        out.noalias() += U * S.middleRows(c0, nc);
+      }
+      return out;
+    }
+  };
+
+  /**
+     Eigendecomposition of the block arrowhead matrix [[diag(delta), W^H], [W, V]]
+     with a b x b vertex block V.  The vertex block is diagonalized,
+     after which each of its b rows is an arrow coupling to the
+     diagonal only; these are absorbed one at a time, each a rank-one
+     arrowhead problem in the eigenbasis of the previous ones.
+   */
+  template <typename T> class BlockArrowhead
+  {
+    int N = 0;
+    int b = 0;
+    Mat<T> Y; // eigenvectors of the vertex block
+    std::vector<Arrowhead<T>> steps;
+
+  public:
+    std::vector<double> lambda; // ascending
+
+    void compute(const std::vector<double> &delta, const Mat<T> &W, const Mat<T> &V)
+    {
+      N = delta.size();
+      b = V.rows();
+
+      SelfAdjointEigenSolver<Mat<T>> vertex(V);
+      Y = vertex.eigenvectors();
+      Mat<T> Wv = Y.adjoint() * W;
+
+      steps.resize(b);
+      lambda = delta;
+      for (int j = 0; j < b; j++) {
+        // arrow of vertex j in the eigenbasis of the previous steps
+        Mat<T> row = Mat<T>::Zero(1, N + j);
+        row.leftCols(N) = Wv.row(j);
+        for (int i = 0; i < j; i++) {
+          Mat<T> ext(1, N + i + 1);
+          ext << row.leftCols(N + i + 1);
+          row.leftCols(N + i + 1) = steps[i].rightMultiply(ext);
+        }
+        std::vector<T> z(N + j);
+        for (int i = 0; i < N + j; i++) z[i] = numext::conj(row(0, i));
+
+        steps[j].compute(lambda, z, vertex.eigenvalues()[j]);
+        lambda = steps[j].lambda;
+      }
+    }
+
+    /**
+       @return X * U, where X has N + b columns, the last b of which
+       are the vertex rows in their original basis
+     */
+    Mat<T> rightMultiply(const Mat<T> &X) const
+    {
+      Mat<T> Xv = X.rightCols(b) * Y;
+      Mat<T> cur = X.leftCols(N);
+      for (int j = 0; j < b; j++) {
+        Mat<T> aug(X.rows(), N + j + 1);
+        aug << cur, Xv.col(j);
+        cur = steps[j].rightMultiply(aug);
+      }
+      return cur;
+    }
+
+    /**
+       @return The first p columns of U, with the vertex rows in their original basis
+     */
+    Mat<T> leftColumns(int p) const
+    {
+      Mat<T> S;
+      steps[b - 1].columns(0, p, S);
+      for (int j = b - 2; j >= 0; j--) {
+        Mat<T> top = S.topRows(N + j + 1);
+        S.topRows(N + j + 1) = steps[j].leftMultiply(top);
+      }
+      Mat<T> vertex = Y * S.bottomRows(b);
+      S.bottomRows(b) = vertex;
+      return S;
+    }
+  };
+
+  template <typename T> struct ArrowEigensolver<T>::Impl {
+    int n = 0;
+    int b = 1;
+    int k = 0;
+    std::vector<double> diagonal;
+    std::vector<T> arrow;
+    std::vector<Mat<T>> blocks;
+    std::vector<Mat<T>> sub_blocks;
+
+    BlockArrowhead<T> top;
+    Mat<T> tail; // eigenvectors of the block tridiagonal part below the arrow block
+
+    /**
+       Solve the block tridiagonal matrix of blocks [b0, b1), returning
+       its eigenvalues and eigenvectors
+     */
+    void solveTridiagonal(int b0, int b1, std::vector<double> &lambda, Mat<T> &Q) const
+    {
+      const int nb = b1 - b0;
+      if (nb * b <= leaf_size || nb < 3) {
+        Mat<T> A = Mat<T>::Zero(nb * b, nb * b);
+        for (int i = 0; i < nb; i++) {
+          A.block(i * b, i * b, b, b) = blocks[b0 + i].template triangularView<Lower>();
+          if (i < nb - 1) A.block((i + 1) * b, i * b, b, b) = sub_blocks[b0 + i];
+        }
+        SelfAdjointEigenSolver<Mat<T>> eigensolver(A);
+        lambda.assign(eigensolver.eigenvalues().data(), eigensolver.eigenvalues().data() + nb * b);
+        Q = eigensolver.eigenvectors();
+        return;
+      }
+
+      const int mid = (b0 + b1) / 2;
+      std::vector<double> lambda_l, lambda_r;
+      Mat<T> Ql, Qr;
+      solveTridiagonal(b0, mid, lambda_l, Ql);
+      solveTridiagonal(mid + 1, b1, lambda_r, Qr);
+      const int nl = Ql.rows(), nr = Qr.rows();
+
+      std::vector<double> delta(lambda_l);
+      delta.insert(delta.end(), lambda_r.begin(), lambda_r.end());
+      Mat<T> W(b, nl + nr);
+      W.leftCols(nl) = sub_blocks[mid - 1] * Ql.bottomRows(b);
+      W.rightCols(nr) = sub_blocks[mid].adjoint() * Qr.topRows(b);
+      Mat<T> V = blocks[mid].template selfadjointView<Lower>();
+
+      BlockArrowhead<T> merge;
+      merge.compute(delta, W, V);
+      lambda = merge.lambda;
+
+      Mat<T> U = merge.leftColumns(nl + nr + b);
+      Q.resize(nl + nr + b, nl + nr + b);
+      Q.topRows(nl).noalias() = Ql * U.topRows(nl);
+      Q.middleRows(nl, b) = U.bottomRows(b);
+      Q.bottomRows(nr).noalias() = Qr * U.middleRows(nl, nr);
+    }
+  };
+
+  template <typename T> ArrowEigensolver<T>::ArrowEigensolver() : impl(new Impl) { }
+
+  template <typename T> ArrowEigensolver<T>::~ArrowEigensolver() = default;
+
+  template <typename T> void ArrowEigensolver<T>::resize(int n, int b, int k)
+  {
+    if (b < 1 || k % b != 0 || (n - k) % b != 0 || k >= n)
+      errorQuda("Invalid arrow matrix shape n = %d, b = %d, k = %d", n, b, k);
+    impl->n = n;
+    impl->b = b;
+    impl->k = k;
+    impl->diagonal.assign(k, 0.0);
+    impl->arrow.assign(b * k, 0.0);
+    const int nb = (n - k) / b;
+    impl->blocks.assign(nb, Mat<T>::Zero(b, b));
+    impl->sub_blocks.assign(nb - 1, Mat<T>::Zero(b, b));
+  }
+
+  template <typename T> double &ArrowEigensolver<T>::diagonal(int i) { return impl->diagonal[i]; }
+
+  template <typename T> T &ArrowEigensolver<T>::arrow(int r, int i) { return impl->arrow[r * impl->k + i]; }
+
+  template <typename T> T &ArrowEigensolver<T>::block(int i, int r, int c) { return impl->blocks[i](r, c); }
+
+  template <typename T> T &ArrowEigensolver<T>::subBlock(int i, int r, int c) { return impl->sub_blocks[i](r, c); }
+
+  template <typename T> void ArrowEigensolver<T>::compute()
+  {
+    Impl &p = *impl;
+    const int nb = p.blocks.size();
+
+    // the arrow block is the vertex, merging the leading diagonal and the solved tail
+    std::vector<double> delta(p.diagonal);
+    if (nb > 1) {
+      std::vector<double> lambda;
+      p.solveTridiagonal(1, nb, lambda, p.tail);
+      delta.insert(delta.end(), lambda.begin(), lambda.end());
+    } else {
+      p.tail.resize(0, 0);
+    }
+
+    const int m = p.tail.rows();
+    Mat<T> W(p.b, p.k + m);
+    for (int r = 0; r < p.b; r++)
+      for (int i = 0; i < p.k; i++) W(r, i) = p.arrow[r * p.k + i];
+    if (m > 0) W.rightCols(m) = p.sub_blocks[0].adjoint() * p.tail.topRows(p.b);
+    Mat<T> V = p.blocks[0].template selfadjointView<Lower>();
+
+    p.top.compute(delta, W, V);
+  }
+
+  template <typename T> double ArrowEigensolver<T>::eigenvalue(int i) const { return impl->top.lambda[i]; }
+
+  template <typename T> void ArrowEigensolver<T>::lastRow(T *row) const
+  {
+    const Impl &p = *impl;
+    const int m = p.tail.rows();
+    Mat<T> X = Mat<T>::Zero(1, p.n);
+    if (m > 0)
+      X.middleCols(p.k, m) = p.tail.bottomRows(1);
+    else
+      X(0, p.n - 1) = 1.0;
+    Mat<T> R = p.top.rightMultiply(X);
+    for (int i = 0; i < p.n; i++) row[i] = R(0, i);
+  }
+
+  template <typename T> void ArrowEigensolver<T>::vectors(int count, T *vecs) const
+  {
+    const Impl &p = *impl;
+    const int m = p.tail.rows();
+    Mat<T> S = p.top.leftColumns(count);
+
+    Map<Mat<T>> out(vecs, p.n, count);
+    out.topRows(p.k) = S.topRows(p.k);
+    out.middleRows(p.k, p.b) = S.bottomRows(p.b);
+    if (m > 0) out.bottomRows(m).noalias() = p.tail * S.middleRows(p.k, m);
+  }
+
+  template class ArrowEigensolver<double>;
+  template class ArrowEigensolver<std::complex<double>>;
+
+} // namespace quda
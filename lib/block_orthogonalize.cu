@@ -124,6 +124,7 @@ namespace quda {
     void apply(const qudaStream_t &stream) {
       TuneParam tp = tuneLaunch(*this, getTuning(), getVerbosity());
       if (V.Location() == QUDA_CPU_FIELD_LOCATION) {
+        HostLaunch launch(tp);
         if (V.FieldOrder() == QUDA_SPACE_SPIN_COLOR_FIELD_ORDER && B[0]->FieldOrder() == QUDA_SPACE_SPIN_COLOR_FIELD_ORDER) {
           typedef FieldOrderCB<RegType,nSpin,nColor,nVec,QUDA_SPACE_SPIN_COLOR_FIELD_ORDER,vFloat,vFloat,DISABLE_GHOST> Rotator;
           typedef FieldOrderCB<RegType,nSpin,nColor,1,QUDA_SPACE_SPIN_COLOR_FIELD_ORDER,bFloat,bFloat,DISABLE_GHOST> Vector;
@@ -165,6 +166,9 @@ namespace quda {
       }
     }
 
+    bool tuneHost() const { return V.Location() == QUDA_CPU_FIELD_LOCATION; }
+    unsigned int hostWork() const { return V.Volume() / geoBlockSize; }
+
     TuneKey tuneKey() const { return TuneKey(V.VolString(), typeid(*this).name(), aux); }
 
     void initTuneParam(TuneParam &param) const { defaultTuneParam(param); }
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <gauge_field_order.h>
 
 namespace quda {
@@ -15,72 +16,153 @@ namespace quda {
   template <typename Arg>
   __device__ __host__ inline uint64_t siteChecksum(const Arg &arg, int d, int parity, int x_cb) {
     const Matrix<complex<typename Arg::real>,Arg::nColor> u = arg.U(d, x_cb, parity);
-    return u.checksum(); 
+    return u.checksum();
   }
 
   template <typename Arg>
   uint64_t ChecksumCPU(const Arg &arg)
   {
     uint64_t checksum_ = 0;
-    for (int parity=0; parity<2; parity++)
+    for (int parity=0; parity<2; parity++) {
+#pragma omp parallel for reduction(^ : checksum_)
       for (int x_cb=0; x_cb<arg.volumeCB; x_cb++)
 	for (int d=0; d<arg.U.geometry; d++)
 	  checksum_ ^= siteChecksum(arg, d, parity, x_cb);
+    }
     return checksum_;
   }
 
-  template <typename T, int Nc>
-  uint64_t Checksum(const GaugeField &u, bool mini)
+  /**
+     Order-dependent hash combination: unlike XOR, this detects
+     permuted and pairwise-cancelling changes
+   */
+  inline uint64_t hashCombine(uint64_t h, uint64_t word)
+  {
+    h ^= word + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h * 0xff51afd7ed558ccdull;
+  }
+
+  /**
+     Finalizer from splitmix64, applied to each block and root hash
+   */
+  inline uint64_t hashFinalize(uint64_t h)
+  {
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+  }
+
+  template <typename Arg>
+  inline uint64_t siteHash(const Arg &arg, int d, int parity, int x_cb, uint64_t h)
+  {
+    const Matrix<complex<typename Arg::real>,Arg::nColor> u = arg.U(d, x_cb, parity);
+    constexpr int length = (sizeof(u.data) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    uint64_t word[length] = { };
+    memcpy(word, u.data, sizeof(u.data));
+    for (int i=0; i<length; i++) h = hashCombine(h, word[i]);
+    return h;
+  }
+
+  template <typename Arg>
+  GaugeChecksum BlockChecksumCPU(const Arg &arg)
+  {
+    const int blocks_per_parity = (arg.volumeCB + GaugeChecksum::block_sites - 1) / GaugeChecksum::block_sites;
+    GaugeChecksum checksum;
+    checksum.block.resize(2 * blocks_per_parity);
+
+#pragma omp parallel for collapse(2) schedule(dynamic)
+    for (int parity=0; parity<2; parity++) {
+      for (int b=0; b<blocks_per_parity; b++) {
+        const int begin = b * GaugeChecksum::block_sites;
+        const int end = std::min(begin + GaugeChecksum::block_sites, arg.volumeCB);
+        uint64_t h = hashFinalize(parity * blocks_per_parity + b);
+        for (int x_cb=begin; x_cb<end; x_cb++)
+          for (int d=0; d<arg.U.geometry; d++) h = siteHash(arg, d, parity, x_cb, h);
+        checksum.block[parity * blocks_per_parity + b] = hashFinalize(h);
+      }
+    }
+
+    uint64_t root = 0;
+    for (auto h : checksum.block) root = hashCombine(root, h);
+    checksum.root = hashFinalize(root);
+    return checksum;
+  }
+
+  template <typename T, int Nc, typename Compute>
+  void Checksum(const GaugeField &u, bool mini, Compute compute)
   {
-    uint64_t checksum = 0;
     if (u.Order() == QUDA_QDP_GAUGE_ORDER) {
-      ChecksumArg<T,QUDA_QDP_GAUGE_ORDER,Nc> arg(u,mini);
-      checksum = ChecksumCPU(arg);
+      compute(ChecksumArg<T,QUDA_QDP_GAUGE_ORDER,Nc>(u,mini));
     } else if (u.Order() == QUDA_QDPJIT_GAUGE_ORDER) {
-      ChecksumArg<T,QUDA_QDPJIT_GAUGE_ORDER,Nc> arg(u,mini);
-      checksum = ChecksumCPU(arg);
+      compute(ChecksumArg<T,QUDA_QDPJIT_GAUGE_ORDER,Nc>(u,mini));
     } else if (u.Order() == QUDA_MILC_GAUGE_ORDER) {
-      ChecksumArg<T,QUDA_MILC_GAUGE_ORDER,Nc> arg(u,mini);
-      checksum = ChecksumCPU(arg);
+      compute(ChecksumArg<T,QUDA_MILC_GAUGE_ORDER,Nc>(u,mini));
     } else if (u.Order() == QUDA_BQCD_GAUGE_ORDER) {
-      ChecksumArg<T,QUDA_BQCD_GAUGE_ORDER,Nc> arg(u,mini);
-      checksum = ChecksumCPU(arg);
+      compute(ChecksumArg<T,QUDA_BQCD_GAUGE_ORDER,Nc>(u,mini));
     } else if (u.Order() == QUDA_TIFR_GAUGE_ORDER) {
-      ChecksumArg<T,QUDA_TIFR_GAUGE_ORDER,Nc> arg(u,mini);
-      checksum = ChecksumCPU(arg);
+      compute(ChecksumArg<T,QUDA_TIFR_GAUGE_ORDER,Nc>(u,mini));
     } else if (u.Order() == QUDA_TIFR_PADDED_GAUGE_ORDER) {
-      ChecksumArg<T,QUDA_TIFR_PADDED_GAUGE_ORDER,Nc> arg(u,mini);
-      checksum = ChecksumCPU(arg);
+      compute(ChecksumArg<T,QUDA_TIFR_PADDED_GAUGE_ORDER,Nc>(u,mini));
     } else {
       errorQuda("Checksum not implemented");
-    }    
-
-    return checksum;
+    }
   }
 
-  template <typename T>
-  uint64_t Checksum(const GaugeField &u, bool mini)
+  template <typename T, typename Compute>
+  void Checksum(const GaugeField &u, bool mini, Compute compute)
   {
-    uint64_t checksum = 0;
     switch (u.Ncolor()) {
-    case 3: checksum = Checksum<T,3>(u,mini); break;
+    case 3: Checksum<T,3>(u,mini,compute); break;
     default: errorQuda("Unsupported nColor = %d", u.Ncolor());
     }
-    return checksum;
   }
 
-  uint64_t Checksum(const GaugeField &u, bool mini)
+  template <typename Compute>
+  void Checksum(const GaugeField &u, bool mini, Compute compute)
   {
-    uint64_t checksum = 0;
     switch (u.Precision()) {
-    case QUDA_DOUBLE_PRECISION: checksum = Checksum<double>(u,mini); break;
-    case QUDA_SINGLE_PRECISION: checksum = Checksum<float>(u,mini); break;
+    case QUDA_DOUBLE_PRECISION: Checksum<double>(u,mini,compute); break;
+    case QUDA_SINGLE_PRECISION: Checksum<float>(u,mini,compute); break;
     default: errorQuda("Unsupported precision = %d", u.Precision());
     }
+  }
+
+  uint64_t Checksum(const GaugeField &u, bool mini)
+  {
+    uint64_t checksum = 0;
+    Checksum(u, mini, [&](const auto &arg) { checksum = ChecksumCPU(arg); });
 
     comm_allreduce_xor(&checksum);
 
     return checksum;
   }
 
+  GaugeChecksum BlockChecksum(const GaugeField &u)
+  {
+    if (u.Location() != QUDA_CPU_FIELD_LOCATION) errorQuda("Block checksum requires a CPU field");
+
+    GaugeChecksum checksum;
+    Checksum(u, false, [&](const auto &arg) { checksum = BlockChecksumCPU(arg); });
+
+    // salt each rank's root with its rank so identical local fields do not cancel
+    uint64_t root = hashFinalize(hashCombine(checksum.root, comm_rank()));
+    comm_allreduce_xor(&root);
+    checksum.root = root;
+
+    return checksum;
+  }
+
+  std::vector<int> GaugeChecksum::dirty(const GaugeChecksum &other) const
+  {
+    std::vector<int> blocks;
+    if (block.size() != other.block.size()) {
+      blocks.resize(block.size());
+      for (auto i = 0u; i < block.size(); i++) blocks[i] = i;
+    } else {
+      for (auto i = 0u; i < block.size(); i++)
+        if (block[i] != other.block[i]) blocks.push_back(i);
+    }
+    return blocks;
+  }
+
 }
@@ -612,12 +612,20 @@ namespace quda {
       arg.dir = dir;
       if (type == COMPUTE_VUV || type == COMPUTE_CONVERT || type == COMPUTE_RESCALE) arg.dim_index = 4*(dir==QUDA_BACKWARDS ? 0 : 1) + dim;
 
-      if (type == COMPUTE_VUV) tp.shared_bytes -= sharedBytesPerBlock(tp); // shared memory is static so don't include it in launch
-      Launch<location, from_coarse, Float, fineSpin, fineColor, coarseSpin, coarseColor, Arg>(arg, jitify_error, tp,
-                                                                                              type, use_mma, stream);
-      if (type == COMPUTE_VUV) tp.shared_bytes += sharedBytesPerBlock(tp); // restore shared memory
+      if (location == QUDA_CPU_FIELD_LOCATION) {
+        HostLaunch launch(tp);
+        Launch<location, from_coarse, Float, fineSpin, fineColor, coarseSpin, coarseColor, Arg>(arg, jitify_error, tp,
+                                                                                                type, use_mma, stream);
+      } else {
+        if (type == COMPUTE_VUV) tp.shared_bytes -= sharedBytesPerBlock(tp); // shared memory is static so don't include it in launch
+        Launch<location, from_coarse, Float, fineSpin, fineColor, coarseSpin, coarseColor, Arg>(arg, jitify_error, tp,
+                                                                                                type, use_mma, stream);
+        if (type == COMPUTE_VUV) tp.shared_bytes += sharedBytesPerBlock(tp); // restore shared memory
+      }
     };
 
+    bool tuneHost() const { return location == QUDA_CPU_FIELD_LOCATION; }
+
     /**
        Set which dimension we are working on (where applicable)
     */
@@ -125,9 +125,16 @@ namespace quda
     void apply(const qudaStream_t &stream)
     {
       TuneParam tp = tuneLaunch(*this, getTuning(), getVerbosity());
-      Launch<location, Arg>(arg, jitify_error, compute_max_only, tp, use_mma, stream);
+      if (location == QUDA_CPU_FIELD_LOCATION) {
+        HostLaunch launch(tp);
+        Launch<location, Arg>(arg, jitify_error, compute_max_only, tp, use_mma, stream);
+      } else {
+        Launch<location, Arg>(arg, jitify_error, compute_max_only, tp, use_mma, stream);
+      }
     }
 
+    bool tuneHost() const { return location == QUDA_CPU_FIELD_LOCATION; }
+
     /**
        Set if we're doing a max-only compute (fixed point only)
     */
@@ -1,3 +1,5 @@
+#include <memory>
+
 #include <transfer.h>
 #include <color_spinor_field.h>
 #include <gauge_field.h>
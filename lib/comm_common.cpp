@@ -1,6 +1,8 @@
 #include <unistd.h> // for gethostname()
 #include <assert.h>
 #include <limits>
+#include <cmath>
+#include <vector>
 
 #include <quda_internal.h>
 #include <comm_quda.h>
@@ -65,8 +67,8 @@ static inline bool advance_coords(int ndim, const int *dims, int *x)
 
 char *comm_hostname(void)
 {
-  static bool cached = false;
-  static char hostname[128];
+  static QUDA_RANK_LOCAL bool cached = false;
+  static QUDA_RANK_LOCAL char hostname[128];
 
   if (!cached) {
     gethostname(hostname, 128);
@@ -78,7 +80,7 @@ char *comm_hostname(void)
 }
 
 
-static unsigned long int rand_seed = 137;
+static QUDA_RANK_LOCAL unsigned long int rand_seed = 137;
 
 /**
  * We provide our own random number generator to avoid re-seeding
@@ -149,26 +151,26 @@ void comm_destroy_topology(Topology *topo)
   host_free(topo);
 }
 
-static int gpuid = -1;
+static QUDA_RANK_LOCAL int gpuid = -1;
 
 int comm_gpuid(void) { return gpuid; }
 
-static bool peer2peer_enabled[2][4] = { {false,false,false,false},
+static QUDA_RANK_LOCAL bool peer2peer_enabled[2][4] = { {false,false,false,false},
                                         {false,false,false,false} };
-static bool peer2peer_init = false;
+static QUDA_RANK_LOCAL bool peer2peer_init = false;
 
-static bool intranode_enabled[2][4] = { {false,false,false,false},
+static QUDA_RANK_LOCAL bool intranode_enabled[2][4] = { {false,false,false,false},
 					{false,false,false,false} };
 
 /** this records whether there is any peer-2-peer capability
     (regardless whether it is enabled or not) */
-static bool peer2peer_present = false;
+static QUDA_RANK_LOCAL bool peer2peer_present = false;
 
 /** by default enable both copy engines and load/store access */
-static int enable_peer_to_peer = 3;
+static QUDA_RANK_LOCAL int enable_peer_to_peer = 3;
 
 /** sets whether we cap which peers can use peer-to-peer */
-static int enable_p2p_max_access_rank = std::numeric_limits<int>::max();
+static QUDA_RANK_LOCAL int enable_p2p_max_access_rank = std::numeric_limits<int>::max();
 
 void comm_peer2peer_init(const char* hostname_recv_buf)
 {
@@ -302,7 +304,7 @@ void comm_peer2peer_init(const char* hostname_recv_buf)
 
 bool comm_peer2peer_present() { return peer2peer_present; }
 
-static bool enable_p2p = true;
+static QUDA_RANK_LOCAL bool enable_p2p = true;
 
 bool comm_peer2peer_enabled(int dir, int dim){
   return enable_p2p ? peer2peer_enabled[dir][dim] : false;
@@ -311,8 +313,8 @@ bool comm_peer2peer_enabled(int dir, int dim){
 int comm_peer2peer_enabled_global() {
   if (!enable_p2p) return false;
 
-  static bool init = false;
-  static bool p2p_global = false;
+  static QUDA_RANK_LOCAL bool init = false;
+  static QUDA_RANK_LOCAL bool p2p_global = false;
 
   if (!init) {
     int p2p = 0;
@@ -331,7 +333,7 @@ void comm_enable_peer2peer(bool enable) {
   enable_p2p = enable;
 }
 
-static bool enable_intranode = true;
+static QUDA_RANK_LOCAL bool enable_intranode = true;
 
 bool comm_intranode_enabled(int dir, int dim){
   return enable_intranode ? intranode_enabled[dir][dim] : false;
@@ -392,7 +394,7 @@ int comm_rank_displaced(const Topology *topo, const int displacement[])
 // FIXME: The following routines rely on a "default" topology.
 // They should probably be reworked or eliminated eventually.
 
-Topology *default_topo = NULL;
+QUDA_RANK_LOCAL Topology *default_topo = NULL;
 
 void comm_set_default_topology(Topology *topo)
 {
@@ -408,10 +410,10 @@ Topology *comm_default_topology(void)
   return default_topo;
 }
 
-static int neighbor_rank[2][4] = { {-1,-1,-1,-1},
+static QUDA_RANK_LOCAL int neighbor_rank[2][4] = { {-1,-1,-1,-1},
                                           {-1,-1,-1,-1} };
 
-static bool neighbors_cached = false;
+static QUDA_RANK_LOCAL bool neighbors_cached = false;
 
 void comm_set_neighbor_ranks(Topology *topo)
 {
@@ -610,11 +612,11 @@ void comm_finalize(void)
   comm_set_default_topology(NULL);
 }
 
-static char partition_string[16];          /** string that contains the job partitioning */
-static char topology_string[128];          /** string that contains the job topology */
-static char partition_override_string[16]; /** string that contains any overridden partitioning */
+static QUDA_RANK_LOCAL char partition_string[16];          /** string that contains the job partitioning */
+static QUDA_RANK_LOCAL char topology_string[128];          /** string that contains the job topology */
+static QUDA_RANK_LOCAL char partition_override_string[16]; /** string that contains any overridden partitioning */
 
-static int manual_set_partition[QUDA_MAX_DIM] = {0};
+static QUDA_RANK_LOCAL int manual_set_partition[QUDA_MAX_DIM] = {0};
 
 void comm_dim_partitioned_set(int dim)
 { 
@@ -648,9 +650,9 @@ int comm_partitioned()
 }
 
 bool comm_gdr_enabled() {
-  static bool gdr_enabled = false;
+  static QUDA_RANK_LOCAL bool gdr_enabled = false;
 #ifdef MULTI_GPU
-  static bool gdr_init = false;
+  static QUDA_RANK_LOCAL bool gdr_init = false;
 
   if (!gdr_init) {
     char *enable_gdr_env = getenv("QUDA_ENABLE_GDR");
@@ -664,8 +666,8 @@ bool comm_gdr_enabled() {
 }
 
 bool comm_gdr_blacklist() {
-  static bool blacklist = false;
-  static bool blacklist_init = false;
+  static QUDA_RANK_LOCAL bool blacklist = false;
+  static QUDA_RANK_LOCAL bool blacklist_init = false;
 
   if (!blacklist_init) {
     char *blacklist_env = getenv("QUDA_ENABLE_GDR_BLACKLIST");
@@ -696,7 +698,7 @@ bool comm_gdr_blacklist() {
   return blacklist;
 }
 
-static bool deterministic_reduce = false;
+static QUDA_RANK_LOCAL bool deterministic_reduce = false;
 
 void comm_init_common(int ndim, const int *dims, QudaCommsMap rank_from_coords, void *map_data)
 {
@@ -716,6 +718,10 @@ void comm_init_common(int ndim, const int *dims, QudaCommsMap rank_from_coords,
   cudaGetDeviceCount(&device_count);
   if (device_count == 0) { errorQuda("No CUDA devices found"); }
   if (gpuid >= device_count) {
+#ifdef THREAD_COMMS
+    // the logical ranks of the threaded backend share the devices of the process
+    gpuid = gpuid % device_count;
+#else
     char *enable_mps_env = getenv("QUDA_ENABLE_MPS");
     if (enable_mps_env && strcmp(enable_mps_env, "1") == 0) {
       gpuid = gpuid % device_count;
@@ -723,6 +729,7 @@ void comm_init_common(int ndim, const int *dims, QudaCommsMap rank_from_coords,
     } else {
       errorQuda("Too few GPUs available on %s", comm_hostname());
     }
+#endif
   }
 
   comm_peer2peer_init(hostname_recv_buf);
@@ -766,8 +773,8 @@ void comm_init_common(int ndim, const int *dims, QudaCommsMap rank_from_coords,
 
 const char *comm_config_string()
 {
-  static char config_string[64];
-  static bool config_init = false;
+  static QUDA_RANK_LOCAL char config_string[64];
+  static QUDA_RANK_LOCAL bool config_init = false;
 
   if (!config_init) {
     strcpy(config_string, ",p2p=");
@@ -803,8 +810,131 @@ const char *comm_dim_topology_string() { return topology_string; }
 
 bool comm_deterministic_reduce() { return deterministic_reduce; }
 
-static bool globalReduce = true;
-static bool asyncReduce = false;
+/*
+  Reproducible sums: every value is truncated to a fixed-point grid
+  whose spacing is set by the global maximum exponent of that
+  element, and represented as signed 32-bit digits stored in 64-bit
+  words.  Integer addition is exact and associative, so the digits
+  can be summed with any reduction tree (i.e., a native allreduce
+  with O(log P) latency) and every rank decodes the same result,
+  independent of the number of ranks and the order of the
+  contributions.  Infinities and NaNs are counted in a separate word,
+  in three 21-bit fields, so that they propagate as they would in a
+  floating-point sum.  These counts limit a sum to 2^21 - 1 ranks;
+  the headroom of the digits alone would allow 2^31.  The window is
+  128 bits wide, so the truncation error is below 2^-106 relative to
+  the largest term.
+*/
+
+static constexpr int reproducible_digits = comm_reproducible_words - 1;
+static constexpr int reproducible_digit_bits = 32;
+static constexpr int reproducible_special_bits = 21;
+static constexpr int64_t reproducible_digit_base = int64_t(1) << reproducible_digit_bits;
+
+// the exponent of an all-zero or non-finite element
+static constexpr int reproducible_exponent_zero = std::numeric_limits<int>::min();
+
+void comm_reproducible_exponent(int *exponent, const double *data, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    exponent[i] = (std::isfinite(data[i]) && data[i] != 0.0) ? std::ilogb(data[i]) : reproducible_exponent_zero;
+}
+
+/**
+   The scale that maps |x| < 2^(exponent + 1) into [0, 2^128)
+ */
+static int reproducible_scale(int exponent)
+{
+  return reproducible_digits * reproducible_digit_bits - (exponent + 1);
+}
+
+void comm_reproducible_encode(int64_t *digits, const double *data, const int *exponent, size_t size)
+{
+  for (size_t i = 0; i < size; i++) {
+    int64_t *d = digits + i * comm_reproducible_words;
+    for (int k = 0; k < comm_reproducible_words; k++) d[k] = 0;
+
+    const double x = data[i];
+    if (std::isnan(x)) {
+      d[reproducible_digits] = int64_t(1) << (2 * reproducible_special_bits);
+      continue;
+    } else if (std::isinf(x)) {
+      d[reproducible_digits] = int64_t(1) << (x > 0 ? 0 : reproducible_special_bits);
+      continue;
+    } else if (x == 0.0 || exponent[i] == reproducible_exponent_zero) {
+      continue;
+    }
+
+    // peel off the digits from the most significant down: each step is exact
+    double y = std::ldexp(std::fabs(x), reproducible_scale(exponent[i]) - (reproducible_digits - 1) * reproducible_digit_bits);
+    for (int k = reproducible_digits - 1; k >= 0; k--) {
+      const double digit = std::floor(y);
+      d[k] = static_cast<int64_t>(digit);
+      y = std::ldexp(y - digit, reproducible_digit_bits);
+    }
+    if (x < 0)
+      for (int k = 0; k < reproducible_digits; k++) d[k] = -d[k];
+  }
+}
+
+void comm_reproducible_decode(double *data, int64_t *digits, const int *exponent, size_t size)
+{
+  const int64_t special_mask = (int64_t(1) << reproducible_special_bits) - 1;
+
+  for (size_t i = 0; i < size; i++) {
+    int64_t *d = digits + i * comm_reproducible_words;
+
+    const int64_t special = d[reproducible_digits];
+    const int64_t pos_inf = special & special_mask;
+    const int64_t neg_inf = (special >> reproducible_special_bits) & special_mask;
+    const int64_t nan = (special >> (2 * reproducible_special_bits)) & special_mask;
+    if (nan || (pos_inf && neg_inf)) {
+      data[i] = std::numeric_limits<double>::quiet_NaN();
+      continue;
+    } else if (pos_inf || neg_inf) {
+      data[i] = pos_inf ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity();
+      continue;
+    } else if (exponent[i] == reproducible_exponent_zero) {
+      data[i] = 0.0;
+      continue;
+    }
+
+    // normalize so that all but the leading digit are in [0, 2^32)
+    for (int k = 0; k < reproducible_digits - 1; k++) {
+      const int64_t carry = d[k] >> reproducible_digit_bits; // arithmetic shift rounds toward -infinity
+      d[k] -= carry * reproducible_digit_base;
+      d[k + 1] += carry;
+    }
+
+    // accumulate from the most significant digit so that only the last additions round, in
+    // units of the leading digit so that a carry into it cannot overflow before the scaling
+    double sum = 0.0;
+    for (int k = reproducible_digits - 1; k >= 0; k--)
+      sum += std::ldexp(static_cast<double>(d[k]), (k - reproducible_digits + 1) * reproducible_digit_bits);
+    data[i] = std::ldexp(sum, (reproducible_digits - 1) * reproducible_digit_bits - reproducible_scale(exponent[i]));
+  }
+}
+
+void comm_allreduce_reproducible(double *data, size_t size)
+{
+  if (comm_size() >= (1 << reproducible_special_bits))
+    errorQuda("Reproducible sums support at most %d ranks", (1 << reproducible_special_bits) - 1);
+
+  // the exponents are small integers, so their maximum is exact in double precision
+  std::vector<int> exponent(size);
+  comm_reproducible_exponent(exponent.data(), data, size);
+  std::vector<double> max_exponent(exponent.begin(), exponent.end());
+  comm_allreduce_max_array(max_exponent.data(), size);
+  for (size_t i = 0; i < size; i++) exponent[i] = static_cast<int>(max_exponent[i]);
+
+  std::vector<int64_t> digits(size * comm_reproducible_words);
+  comm_reproducible_encode(digits.data(), data, exponent.data(), size);
+  comm_allreduce_int64_array(digits.data(), digits.size());
+  comm_reproducible_decode(data, digits.data(), exponent.data(), size);
+}
+
+static QUDA_RANK_LOCAL bool globalReduce = true;
+static QUDA_RANK_LOCAL bool asyncReduce = false;
 
 void reduceMaxDouble(double &max) { comm_allreduce_max(&max); }
 
@@ -3,6 +3,7 @@
 #include <cstring>
 #include <algorithm>
 #include <numeric>
+#include <limits>
 #include <mpi.h>
 #include <quda_internal.h>
 #include <comm_quda.h>
@@ -53,6 +54,12 @@ void comm_gather_gpuid(int *gpuid_recv_buf) {
   MPI_CHECK(MPI_Allgather(&gpuid, 1, MPI_INT, gpuid_recv_buf, 1, MPI_INT, MPI_COMM_HANDLE));
 }
 
+void comm_gather(const void *send_buf, void *recv_buf, size_t nbytes)
+{
+  if (nbytes > std::numeric_limits<int>::max()) errorQuda("Gather of %lu bytes per rank is too large", nbytes);
+  MPI_CHECK(MPI_Gather(send_buf, nbytes, MPI_BYTE, recv_buf, nbytes, MPI_BYTE, 0, MPI_COMM_HANDLE));
+}
+
 void comm_init(int ndim, const int *dims, QudaCommsMap rank_from_coords, void *map_data)
 {
   int initialized;
@@ -231,12 +238,6 @@ int comm_query(MsgHandle *mh)
   return query;
 }
 
-template <typename T> T deterministic_reduce(T *array, int n)
-{
-  std::sort(array, array + n); // sort reduction into ascending order for deterministic reduction
-  return std::accumulate(array, array + n, 0.0);
-}
-
 void comm_allreduce(double* data)
 {
   if (!comm_deterministic_reduce()) {
@@ -244,11 +245,7 @@ void comm_allreduce(double* data)
     MPI_CHECK(MPI_Allreduce(data, &recvbuf, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_HANDLE));
     *data = recvbuf;
   } else {
-    const size_t n = comm_size();
-    double *recv_buf = (double *)safe_malloc(n * sizeof(double));
-    MPI_CHECK(MPI_Allgather(data, 1, MPI_DOUBLE, recv_buf, 1, MPI_DOUBLE, MPI_COMM_HANDLE));
-    *data = deterministic_reduce(recv_buf, n);
-    host_free(recv_buf);
+    comm_allreduce_reproducible(data, 1);
   }
 }
 
@@ -275,19 +272,7 @@ void comm_allreduce_array(double* data, size_t size)
     memcpy(data, recvbuf, size * sizeof(double));
     delete[] recvbuf;
   } else {
-    size_t n = comm_size();
-    double *recv_buf = new double[size * n];
-    MPI_CHECK(MPI_Allgather(data, size, MPI_DOUBLE, recv_buf, size, MPI_DOUBLE, MPI_COMM_HANDLE));
-
-    double *recv_trans = new double[size * n];
-    for (size_t i = 0; i < n; i++) {
-      for (size_t j = 0; j < size; j++) { recv_trans[j * n + i] = recv_buf[i * size + j]; }
-    }
-
-    for (size_t i = 0; i < size; i++) { data[i] = deterministic_reduce(recv_trans + i * n, n); }
-
-    delete[] recv_buf;
-    delete[] recv_trans;
+    comm_allreduce_reproducible(data, size);
   }
 }
 
@@ -306,6 +291,11 @@ void comm_allreduce_int(int* data)
   *data = recvbuf;
 }
 
+void comm_allreduce_int64_array(int64_t *data, size_t size)
+{
+  MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, data, size, MPI_INT64_T, MPI_SUM, MPI_COMM_HANDLE));
+}
+
 void comm_allreduce_xor(uint64_t *data)
 {
   if (sizeof(uint64_t) != sizeof(unsigned long)) errorQuda("unsigned long is not 64-bit");
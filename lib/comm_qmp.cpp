@@ -1,6 +1,7 @@
 #include <qmp.h>
 #include <algorithm>
 #include <numeric>
+#include <limits>
 #include <quda_internal.h>
 #include <comm_quda.h>
 #include <mpi_comm_handle.h>
@@ -82,6 +83,15 @@ void comm_gather_gpuid(int *gpuid_recv_buf) {
 #endif
 }
 
+void comm_gather(const void *send_buf, void *recv_buf, size_t nbytes)
+{
+#ifdef USE_MPI_GATHER
+  if (nbytes > std::numeric_limits<int>::max()) errorQuda("Gather of %lu bytes per rank is too large", nbytes);
+  MPI_CHECK(MPI_Gather(send_buf, nbytes, MPI_BYTE, recv_buf, nbytes, MPI_BYTE, 0, MPI_COMM_HANDLE));
+#else
+  errorQuda("comm_gather requires USE_MPI_GATHER");
+#endif
+}
 
 void comm_init(int ndim, const int *dims, QudaCommsMap rank_from_coords, void *map_data)
 {
@@ -220,23 +230,13 @@ int comm_query(MsgHandle *mh)
   return (QMP_is_complete(mh->handle) == QMP_TRUE);
 }
 
-template <typename T> T deterministic_reduce(T *array, int n)
-{
-  std::sort(array, array + n); // sort reduction into ascending order for deterministic reduction
-  return std::accumulate(array, array + n, 0.0);
-}
-
 void comm_allreduce(double* data)
 {
   if (!comm_deterministic_reduce()) {
     QMP_CHECK(QMP_sum_double(data));
   } else {
     // we need to break out of QMP for the deterministic floating point reductions
-    const size_t n = comm_size();
-    double *recv_buf = (double *)safe_malloc(n * sizeof(double));
-    MPI_CHECK(MPI_Allgather(data, 1, MPI_DOUBLE, recv_buf, 1, MPI_DOUBLE, MPI_COMM_HANDLE));
-    *data = deterministic_reduce(recv_buf, n);
-    host_free(recv_buf);
+    comm_allreduce_reproducible(data, 1);
   }
 }
 
@@ -258,19 +258,7 @@ void comm_allreduce_array(double* data, size_t size)
     QMP_CHECK(QMP_sum_double_array(data, size));
   } else {
     // we need to break out of QMP for the deterministic floating point reductions
-    size_t n = comm_size();
-    double *recv_buf = new double[size * n];
-    MPI_CHECK(MPI_Allgather(data, size, MPI_DOUBLE, recv_buf, size, MPI_DOUBLE, MPI_COMM_HANDLE));
-
-    double *recv_trans = new double[size * n];
-    for (size_t i = 0; i < n; i++) {
-      for (size_t j = 0; j < size; j++) { recv_trans[j * n + i] = recv_buf[i * size + j]; }
-    }
-
-    for (size_t i = 0; i < size; i++) { data[i] = deterministic_reduce(recv_trans + i * n, n); }
-
-    delete[] recv_buf;
-    delete[] recv_trans;
+    comm_allreduce_reproducible(data, size);
   }
 }
 
@@ -285,6 +273,12 @@ void comm_allreduce_int(int* data)
   QMP_CHECK( QMP_sum_int(data) );
 }
 
+void comm_allreduce_int64_array(int64_t *data, size_t size)
+{
+  // QMP has no 64-bit integer reduction
+  MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, data, size, MPI_INT64_T, MPI_SUM, MPI_COMM_HANDLE));
+}
+
 void comm_allreduce_xor(uint64_t *data)
 {
   if (sizeof(uint64_t) != sizeof(unsigned long)) errorQuda("unsigned long is not 64-bit");
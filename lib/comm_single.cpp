@@ -23,6 +23,8 @@ void comm_gather_gpuid(int *gpuid_recv_buf) {
   gpuid_recv_buf[0] = comm_gpuid();
 }
 
+void comm_gather(const void *send_buf, void *recv_buf, size_t nbytes) { memcpy(recv_buf, send_buf, nbytes); }
+
 MsgHandle *comm_declare_send_displaced(void *buffer, const int displacement[], size_t nbytes)
 { return NULL; }
 
@@ -57,6 +59,8 @@ void comm_allreduce_max_array(double* data, size_t size) {}
 
 void comm_allreduce_int(int* data) {}
 
+void comm_allreduce_int64_array(int64_t *data, size_t size) {}
+
 void comm_allreduce_xor(uint64_t *data) {}
 
 void comm_broadcast(void *data, size_t nbytes) {}
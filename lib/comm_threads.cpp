@@ -0,0 +1,360 @@
+/**
+ * In-process communications layer: the logical ranks are threads of a
+ * single process (see comm_threads_launch), so that the multi-GPU
+ * code paths can be run and benchmarked without an MPI launcher.
+ *
+ * Point-to-point messages go through shared-memory mailboxes, one
+ * per (source, destination, tag) triple.  Sends are buffered: the
+ * message is packed into the mailbox when it is started, so it
+ * completes immediately.  A receive completes when a message is
+ * available, and unpacks it into the receive buffer.
+ *
+ * Collectives publish a pointer to each rank's data and combine the
+ * contributions in rank order, so that their results are identical
+ * on every rank and reproducible from run to run.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <quda_internal.h>
+#include <comm_quda.h>
+
+struct Mailbox {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<std::vector<char>> messages;
+};
+
+struct MsgHandle_s {
+  bool send;
+  Mailbox *mailbox;
+  char *buffer;
+  size_t blksize;
+  int nblocks;
+  size_t stride;
+};
+
+namespace
+{
+
+  struct World {
+    int size = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
+    int arrived = 0;
+    unsigned long generation = 0;
+    std::map<std::tuple<int, int, int>, Mailbox> mailbox;
+    std::vector<const void *> slot; // data published by each rank for a collective
+  };
+
+  World world;
+
+} // namespace
+
+static thread_local int rank = 0;
+
+/**
+   Block until every rank has arrived
+ */
+static void barrier()
+{
+  std::unique_lock<std::mutex> lock(world.mutex);
+  const auto generation = world.generation;
+  if (++world.arrived == world.size) {
+    world.arrived = 0;
+    world.generation++;
+    world.cv.notify_all();
+  } else {
+    world.cv.wait(lock, [&] { return world.generation != generation; });
+  }
+}
+
+/**
+   Publish this rank's data, and apply f to the published data of
+   every rank.  The second barrier stops any rank modifying its data
+   before all ranks have read it.
+ */
+template <typename F> static void collective(const void *data, F f)
+{
+  world.slot[rank] = data;
+  barrier();
+  f(world.slot);
+  barrier();
+}
+
+template <typename T, typename Reduce> static void allreduce(T *data, size_t size, Reduce reduce)
+{
+  std::vector<T> result(size);
+  collective(data, [&](const std::vector<const void *> &slot) {
+    const T *first = static_cast<const T *>(slot[0]);
+    std::copy(first, first + size, result.begin());
+    for (int r = 1; r < world.size; r++) {
+      const T *src = static_cast<const T *>(slot[r]);
+      for (size_t i = 0; i < size; i++) result[i] = reduce(result[i], src[i]);
+    }
+  });
+  std::copy(result.begin(), result.end(), data);
+}
+
+static void allgather(const void *data, void *recv, size_t nbytes)
+{
+  collective(data, [&](const std::vector<const void *> &slot) {
+    for (int r = 0; r < world.size; r++) memcpy(static_cast<char *>(recv) + r * nbytes, slot[r], nbytes);
+  });
+}
+
+void comm_threads_launch(int nranks, void (*func)(int rank, void *arg), void *arg)
+{
+  if (world.size) errorQuda("comm_threads_launch cannot be nested");
+  if (nranks < 1) errorQuda("Invalid number of ranks %d", nranks);
+
+  world.size = nranks;
+  world.slot.assign(nranks, nullptr);
+
+  std::vector<std::thread> threads;
+  for (int r = 0; r < nranks; r++) {
+    threads.emplace_back([=]() {
+      rank = r;
+      func(r, arg);
+    });
+  }
+  for (auto &thread : threads) thread.join();
+
+  world.mailbox.clear();
+  world.size = 0;
+}
+
+void comm_gather_hostname(char *hostname_recv_buf) { allgather(comm_hostname(), hostname_recv_buf, 128); }
+
+void comm_gather_gpuid(int *gpuid_recv_buf)
+{
+  int gpuid = comm_gpuid();
+  allgather(&gpuid, gpuid_recv_buf, sizeof(int));
+}
+
+void comm_gather(const void *send_buf, void *recv_buf, size_t nbytes)
+{
+  collective(send_buf, [&](const std::vector<const void *> &slot) {
+    if (rank != 0) return;
+    for (int r = 0; r < world.size; r++) memcpy(static_cast<char *>(recv_buf) + r * nbytes, slot[r], nbytes);
+  });
+}
+
+void comm_init(int ndim, const int *dims, QudaCommsMap rank_from_coords, void *map_data)
+{
+  int grid_size = 1;
+  for (int i = 0; i < ndim; i++) { grid_size *= dims[i]; }
+
+  if (!world.size) {
+    // a process that launched no ranks, e.g., a test harness, is the only rank
+    if (grid_size != 1)
+      errorQuda("A grid of %d ranks requires the ranks to be started by comm_threads_launch", grid_size);
+    world.size = 1;
+    world.slot.assign(1, nullptr);
+  }
+  if (grid_size != world.size) {
+    errorQuda("Communication grid size declared via initCommsGridQuda() does not match"
+              " total number of threaded ranks (%d != %d)",
+              grid_size, world.size);
+  }
+
+  comm_init_common(ndim, dims, rank_from_coords, map_data);
+}
+
+int comm_rank(void) { return rank; }
+
+int comm_size(void) { return world.size ? world.size : 1; }
+
+static const int max_displacement = 4;
+
+static void check_displacement(const int displacement[], int ndim)
+{
+  for (int i = 0; i < ndim; i++) {
+    if (abs(displacement[i]) > max_displacement) {
+      errorQuda("Requested displacement[%d] = %d is greater than maximum allowed", i, displacement[i]);
+    }
+  }
+}
+
+/**
+   Return the mailbox for messages to or from the rank displaced
+   according to "displacement".  As with MPI, the tag encodes the
+   displacement of the sender, so a receive from the -1 neighbor
+   matches the +1 send of that neighbor.
+ */
+static Mailbox *mailbox(const int displacement[], bool send)
+{
+  Topology *topo = comm_default_topology();
+  int ndim = comm_ndim(topo);
+  check_displacement(displacement, ndim);
+
+  int peer = comm_rank_displaced(topo, displacement);
+
+  int tag = 0;
+  for (int i = ndim - 1; i >= 0; i--)
+    tag = tag * 4 * max_displacement + (send ? displacement[i] : -displacement[i]) + max_displacement;
+
+  std::lock_guard<std::mutex> lock(world.mutex);
+  return &world.mailbox[send ? std::make_tuple(rank, peer, tag) : std::make_tuple(peer, rank, tag)];
+}
+
+static MsgHandle *declare(void *buffer, const int displacement[], size_t blksize, int nblocks, size_t stride, bool send)
+{
+  MsgHandle *mh = (MsgHandle *)safe_malloc(sizeof(MsgHandle));
+  mh->send = send;
+  mh->mailbox = mailbox(displacement, send);
+  mh->buffer = static_cast<char *>(buffer);
+  mh->blksize = blksize;
+  mh->nblocks = nblocks;
+  mh->stride = stride;
+  return mh;
+}
+
+/**
+ * Declare a message handle for sending to a node displaced in (x,y,z,t) according to "displacement"
+ */
+MsgHandle *comm_declare_send_displaced(void *buffer, const int displacement[], size_t nbytes)
+{
+  return declare(buffer, displacement, nbytes, 1, nbytes, true);
+}
+
+/**
+ * Declare a message handle for receiving from a node displaced in (x,y,z,t) according to "displacement"
+ */
+MsgHandle *comm_declare_receive_displaced(void *buffer, const int displacement[], size_t nbytes)
+{
+  return declare(buffer, displacement, nbytes, 1, nbytes, false);
+}
+
+/**
+ * Declare a message handle for sending to a node displaced in (x,y,z,t) according to "displacement"
+ */
+MsgHandle *comm_declare_strided_send_displaced(void *buffer, const int displacement[], size_t blksize, int nblocks,
+                                               size_t stride)
+{
+  return declare(buffer, displacement, blksize, nblocks, stride, true);
+}
+
+/**
+ * Declare a message handle for receiving from a node displaced in (x,y,z,t) according to "displacement"
+ */
+MsgHandle *comm_declare_strided_receive_displaced(void *buffer, const int displacement[], size_t blksize,
+                                                  int nblocks, size_t stride)
+{
+  return declare(buffer, displacement, blksize, nblocks, stride, false);
+}
+
+void comm_free(MsgHandle *&mh)
+{
+  host_free(mh);
+  mh = nullptr;
+}
+
+void comm_start(MsgHandle *mh)
+{
+  if (!mh->send) return; // receives complete in comm_wait or comm_query
+
+  std::vector<char> message(mh->blksize * mh->nblocks);
+  for (int i = 0; i < mh->nblocks; i++)
+    memcpy(message.data() + i * mh->blksize, mh->buffer + i * mh->stride, mh->blksize);
+
+  std::lock_guard<std::mutex> lock(mh->mailbox->mutex);
+  mh->mailbox->messages.emplace_back(std::move(message));
+  mh->mailbox->cv.notify_one();
+}
+
+static void unpack(MsgHandle *mh, const std::vector<char> &message)
+{
+  if (message.size() != mh->blksize * mh->nblocks)
+    errorQuda("Received message of %lu bytes, expected %lu", message.size(), mh->blksize * mh->nblocks);
+  for (int i = 0; i < mh->nblocks; i++)
+    memcpy(mh->buffer + i * mh->stride, message.data() + i * mh->blksize, mh->blksize);
+}
+
+void comm_wait(MsgHandle *mh)
+{
+  if (mh->send) return;
+
+  std::vector<char> message;
+  {
+    std::unique_lock<std::mutex> lock(mh->mailbox->mutex);
+    mh->mailbox->cv.wait(lock, [&] { return !mh->mailbox->messages.empty(); });
+    message = std::move(mh->mailbox->messages.front());
+    mh->mailbox->messages.pop_front();
+  }
+  unpack(mh, message);
+}
+
+int comm_query(MsgHandle *mh)
+{
+  if (mh->send) return 1;
+
+  std::vector<char> message;
+  {
+    std::lock_guard<std::mutex> lock(mh->mailbox->mutex);
+    if (mh->mailbox->messages.empty()) return 0;
+    message = std::move(mh->mailbox->messages.front());
+    mh->mailbox->messages.pop_front();
+  }
+  unpack(mh, message);
+  return 1;
+}
+
+void comm_allreduce(double *data) { comm_allreduce_array(data, 1); }
+
+void comm_allreduce_max(double *data) { comm_allreduce_max_array(data, 1); }
+
+void comm_allreduce_min(double *data)
+{
+  allreduce(data, 1, [](double a, double b) { return std::min(a, b); });
+}
+
+void comm_allreduce_array(double *data, size_t size)
+{
+  if (!comm_deterministic_reduce()) {
+    allreduce(data, size, [](double a, double b) { return a + b; });
+  } else {
+    comm_allreduce_reproducible(data, size);
+  }
+}
+
+void comm_allreduce_max_array(double *data, size_t size)
+{
+  allreduce(data, size, [](double a, double b) { return std::max(a, b); });
+}
+
+void comm_allreduce_int(int *data)
+{
+  allreduce(data, 1, [](int a, int b) { return a + b; });
+}
+
+void comm_allreduce_int64_array(int64_t *data, size_t size)
+{
+  allreduce(data, size, [](int64_t a, int64_t b) { return a + b; });
+}
+
+void comm_allreduce_xor(uint64_t *data)
+{
+  allreduce(data, 1, [](uint64_t a, uint64_t b) { return a ^ b; });
+}
+
+/**  broadcast from rank 0 */
+void comm_broadcast(void *data, size_t nbytes)
+{
+  collective(data, [&](const std::vector<const void *> &slot) {
+    if (rank != 0) memcpy(data, slot[0], nbytes);
+  });
+}
+
+void comm_barrier(void) { barrier(); }
+
+void comm_abort_(int status) { exit(status); }
@@ -8,13 +8,13 @@
 
 namespace quda {
 
-  int cpuColorSpinorField::initGhostFaceBuffer =0;
-  void* cpuColorSpinorField::fwdGhostFaceBuffer[QUDA_MAX_DIM]; 
-  void* cpuColorSpinorField::backGhostFaceBuffer[QUDA_MAX_DIM];
-  void* cpuColorSpinorField::fwdGhostFaceSendBuffer[QUDA_MAX_DIM]; 
-  void* cpuColorSpinorField::backGhostFaceSendBuffer[QUDA_MAX_DIM];
+  QUDA_RANK_LOCAL int cpuColorSpinorField::initGhostFaceBuffer =0;
+  QUDA_RANK_LOCAL void* cpuColorSpinorField::fwdGhostFaceBuffer[QUDA_MAX_DIM]; 
+  QUDA_RANK_LOCAL void* cpuColorSpinorField::backGhostFaceBuffer[QUDA_MAX_DIM];
+  QUDA_RANK_LOCAL void* cpuColorSpinorField::fwdGhostFaceSendBuffer[QUDA_MAX_DIM]; 
+  QUDA_RANK_LOCAL void* cpuColorSpinorField::backGhostFaceSendBuffer[QUDA_MAX_DIM];
 
-  size_t cpuColorSpinorField::ghostFaceBytes[QUDA_MAX_DIM] = { };
+  QUDA_RANK_LOCAL size_t cpuColorSpinorField::ghostFaceBytes[QUDA_MAX_DIM] = { };
 
   cpuColorSpinorField::cpuColorSpinorField(const ColorSpinorParam &param) :
     ColorSpinorField(param), init(false), reference(false) {
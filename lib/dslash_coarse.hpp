@@ -138,6 +138,11 @@ namespace quda {
       }
     }
 
+    bool tuneHost() const { return out.Location() == QUDA_CPU_FIELD_LOCATION; }
+    unsigned int hostWork() const { return out.VolumeCB(); }
+    unsigned int hostSiteBlockMax() const { return 16; }
+    unsigned int hostColorBlockMax() const { return nSrc > 1 ? 1 : Nc % 4 == 0 ? 4 : 2; }
+
     void initTuneParam(TuneParam &param) const
     {
       param.aux = make_int4(1,1,1,1);
@@ -185,6 +190,7 @@ namespace quda {
       strcat(aux, compile_type_str(out));
       strcat(aux, out.AuxString());
       strcat(aux, comm_dim_partitioned_string());
+      if (out.Location() == QUDA_CPU_FIELD_LOCATION) strcat(aux, getOmpThreadStr());
 
       switch(type) {
       case DSLASH_INTERIOR: strcat(aux,",interior"); break;
@@ -216,8 +222,21 @@ namespace quda {
         if (out.FieldOrder() != QUDA_SPACE_SPIN_COLOR_FIELD_ORDER || Y.FieldOrder() != QUDA_QDP_GAUGE_ORDER)
           errorQuda("Unsupported field order colorspinor=%d gauge=%d combination\n", inA.FieldOrder(), Y.FieldOrder());
 
+        const TuneParam &tp = tuneLaunch(*this, getTuning(), getVerbosity());
+        HostLaunch launch(tp);
+
         DslashCoarseArg<Float,yFloat,ghostFloat,Ns,Nc,QUDA_SPACE_SPIN_COLOR_FIELD_ORDER,QUDA_QDP_GAUGE_ORDER> arg(out, inA, inB, Y, X, (Float)kappa, parity);
-        coarseDslash<Float,nDim,Ns,Nc,Mc,dslash,clover,dagger,type>(arg);
+        if (nSrc > 1) {
+          // block the right-hand sides so that each link is applied to several vectors at once
+          coarseDslashMultiSrc<Float,nDim,Ns,Nc,dslash,clover,dagger,type>(arg, hostSiteBlock(tp));
+        } else {
+          switch (hostColorBlock(tp)) {
+          case 1: coarseDslash<Float,nDim,Ns,Nc,1,dslash,clover,dagger,type>(arg, hostSiteBlock(tp)); break;
+          case 2: coarseDslash<Float,nDim,Ns,Nc,2,dslash,clover,dagger,type>(arg, hostSiteBlock(tp)); break;
+          case 4: coarseDslash<Float,nDim,Ns,Nc,4,dslash,clover,dagger,type>(arg, hostSiteBlock(tp)); break;
+          default: errorQuda("Color blocking factor %d not instantiated", hostColorBlock(tp));
+          }
+        }
       } else {
 
         const TuneParam &tp = tuneLaunch(*this, getTuning(), getVerbosity());
@@ -314,12 +333,14 @@ namespace quda {
 
     void preTune() {
       saveOut = new char[out.Bytes()];
-      qudaMemcpy(saveOut, out.V(), out.Bytes(), cudaMemcpyDeviceToHost);
+      if (out.Location() == QUDA_CPU_FIELD_LOCATION) memcpy(saveOut, out.V(), out.Bytes());
+      else qudaMemcpy(saveOut, out.V(), out.Bytes(), cudaMemcpyDeviceToHost);
     }
 
     void postTune()
     {
-      qudaMemcpy(out.V(), saveOut, out.Bytes(), cudaMemcpyHostToDevice);
+      if (out.Location() == QUDA_CPU_FIELD_LOCATION) memcpy(out.V(), saveOut, out.Bytes());
+      else qudaMemcpy(out.V(), saveOut, out.Bytes(), cudaMemcpyHostToDevice);
       delete[] saveOut;
     }
 
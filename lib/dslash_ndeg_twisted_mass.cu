@@ -16,7 +16,7 @@ namespace quda
 
   template <typename Arg> class NdegTwistedMass : public Dslash<nDegTwistedMass, Arg>
   {
-    using Dslash = Dslash<nDegTwistedMass, Arg>;
+    using Dslash = quda::Dslash<nDegTwistedMass, Arg>;
     using Dslash::arg;
     using Dslash::in;
 
@@ -24,7 +24,7 @@ namespace quda
 
   template <typename Arg> class NdegTwistedMassPreconditioned : public Dslash<nDegTwistedMassPreconditioned, Arg>
   {
-    using Dslash = Dslash<nDegTwistedMassPreconditioned, Arg>;
+    using Dslash = quda::Dslash<nDegTwistedMassPreconditioned, Arg>;
     using Dslash::arg;
     using Dslash::in;
 
@@ -18,7 +18,7 @@ namespace quda
   template <typename Arg>
   class WilsonCloverHasenbuschTwistPCNoClovInv : public Dslash<cloverHasenbuschPreconditioned, Arg>
   {
-    using Dslash = Dslash<cloverHasenbuschPreconditioned, Arg>;
+    using Dslash = quda::Dslash<cloverHasenbuschPreconditioned, Arg>;
     using Dslash::arg;
     using Dslash::in;
 
@@ -166,7 +166,7 @@ namespace quda
   template <typename Arg>
   class WilsonCloverHasenbuschTwistPCClovInv : public Dslash<cloverHasenbuschPreconditioned, Arg>
   {
-    using Dslash = Dslash<cloverHasenbuschPreconditioned, Arg>;
+    using Dslash = quda::Dslash<cloverHasenbuschPreconditioned, Arg>;
     using Dslash::arg;
     using Dslash::in;
 
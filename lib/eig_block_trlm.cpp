@@ -390,9 +390,11 @@ namespace quda
     int block_arrow_pos = arrow_pos / block_size;
     int num_locked_offset = (num_locked / block_size) * block_data_length;
 
-    // Eigen objects
-    MatrixXcd T = MatrixXcd::Zero(dim, dim);
-    block_ritz_mat.resize(dim * dim);
+    // Invert the spectrum due to Chebyshev (except the arrow diagonal)
+    double sign = reverse ? -1.0 : 1.0;
+    double arrow_sign = (reverse && restart_iter == 0) ? -1.0 : 1.0;
+
+    block_arrow_eig.resize(dim, block_size, arrow_pos);
     int idx = 0;
 
     // Populate the r and eblocks
@@ -400,13 +402,12 @@ namespace quda
       for (int b = 0; b < block_size; b++) {
         // E block
         idx = i * block_size + b;
-        T(idx, idx) = alpha[idx + num_locked];
+        block_arrow_eig.diagonal(idx) = arrow_sign * alpha[idx + num_locked];
 
         for (int c = 0; c < block_size; c++) {
           // r blocks
           idx = num_locked_offset + b * block_size + c;
-          T(arrow_pos + c, i * block_size + b) = block_beta[i * block_data_length + idx];
-          T(i * block_size + b, arrow_pos + c) = conj(block_beta[i * block_data_length + idx]);
+          block_arrow_eig.arrow(c, i * block_size + b) = sign * block_beta[i * block_data_length + idx];
         }
       }
     }
@@ -416,7 +417,7 @@ namespace quda
       for (int b = 0; b < block_size; b++) {
         for (int c = 0; c < block_size; c++) {
           idx = num_locked_offset + b * block_size + c;
-          T(i * block_size + b, i * block_size + c) = block_alpha[i * block_data_length + idx];
+          block_arrow_eig.block(i - block_arrow_pos, b, c) = sign * block_alpha[i * block_data_length + idx];
         }
       }
     }
@@ -427,40 +428,26 @@ namespace quda
         for (int c = 0; c < b + 1; c++) {
           idx = num_locked_offset + b * block_size + c;
           // Sub diag
-          T((i + 1) * block_size + c, i * block_size + b) = block_beta[i * block_data_length + idx];
-          // Super diag
-          T(i * block_size + b, (i + 1) * block_size + c) = conj(block_beta[i * block_data_length + idx]);
+          block_arrow_eig.subBlock(i - block_arrow_pos, c, b) = sign * block_beta[i * block_data_length + idx];
         }
       }
     }
 
-    // Invert the spectrum due to Chebyshev (except the arrow diagonal)
-    if (reverse) {
-      for (int b = 0; b < dim; b++) {
-        for (int c = 0; c < dim; c++) {
-          T(c, b) *= -1.0;
-          if (restart_iter > 0)
-            if (b == c && b < arrow_pos && c < arrow_pos) T(c, b) *= -1.0;
-        }
-      }
-    }
-
-    // Eigensolve the arrow matrix
-    SelfAdjointEigenSolver<MatrixXcd> eigensolver;
-    eigensolver.compute(T);
+    // Eigensolve the arrow matrix.  Only the last row of the
+    // eigenvectors is needed for the residua; the kept Ritz vectors are
+    // formed in computeBlockKeptRitz
+    block_arrow_eig.compute();
 
     // Populate the alpha array with eigenvalues
-    for (int i = 0; i < dim; i++) alpha[i + num_locked] = eigensolver.eigenvalues()[i];
-
-    // Repopulate ritz matrix: COLUMN major
-    for (int i = 0; i < dim; i++)
-      for (int j = 0; j < dim; j++) block_ritz_mat[dim * i + j] = eigensolver.eigenvectors().col(i)[j];
+    for (int i = 0; i < dim; i++) alpha[i + num_locked] = block_arrow_eig.eigenvalue(i);
 
+    std::vector<Complex> last_row(dim);
+    block_arrow_eig.lastRow(last_row.data());
     for (int i = 0; i < blocks; i++) {
       for (int b = 0; b < block_size; b++) {
         idx = b * (block_size + 1);
-        residua[i * block_size + b + num_locked] = fabs(block_beta[n_kr * block_size - block_data_length + idx]
-                                                        * block_ritz_mat[dim * (i * block_size + b + 1) - 1]);
+        residua[i * block_size + b + num_locked]
+          = abs(block_beta[n_kr * block_size - block_data_length + idx] * last_row[i * block_size + b]);
       }
     }
 
@@ -472,6 +459,12 @@ namespace quda
     int offset = n_kr + block_size;
     int dim = n_kr - num_locked;
 
+    // Form the Ritz vectors we keep
+    profile.TPSTART(QUDA_PROFILE_EIGEN);
+    block_ritz_mat.resize(dim * iter_keep);
+    block_arrow_eig.vectors(iter_keep, block_ritz_mat.data());
+    profile.TPSTOP(QUDA_PROFILE_EIGEN);
+
     // Multi-BLAS friendly array to store part of Ritz matrix we want
     Complex *ritz_mat_keep = (Complex *)safe_malloc((dim * iter_keep) * sizeof(Complex));
     for (int j = 0; j < dim; j++) {
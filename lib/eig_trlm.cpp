@@ -11,7 +11,6 @@
 #include <color_spinor_field.h>
 #include <blas_quda.h>
 #include <util_quda.h>
-#include <eigen_helper.h>
 
 namespace quda
 {
@@ -280,11 +279,6 @@ namespace quda
     // int arrow_pos = std::max(num_keep - num_locked + 1, 2);
     int arrow_pos = num_keep - num_locked;
 
-    // Eigen objects
-    MatrixXd A = MatrixXd::Zero(dim, dim);
-    ritz_mat.resize(dim * dim);
-    for (int i = 0; i < dim * dim; i++) ritz_mat[i] = 0.0;
-
     // Invert the spectrum due to chebyshev
     if (reverse) {
       for (int i = num_locked; i < n_kr - 1; i++) {
@@ -294,39 +288,27 @@ namespace quda
       alpha[n_kr - 1] *= -1.0;
     }
 
-    // Construct arrow mat A_{dim,dim}
-    for (int i = 0; i < dim; i++) {
-
-      // alpha populates the diagonal
-      A(i, i) = alpha[i + num_locked];
-    }
-
+    // Construct arrow mat A_{dim,dim}: alpha populates the diagonal,
+    // beta populates the arrow and the sub-diagonal
+    arrow_eig.resize(dim, 1, arrow_pos);
     for (int i = 0; i < arrow_pos; i++) {
-
-      // beta populates the arrow
-      A(i, arrow_pos) = beta[i + num_locked];
-      A(arrow_pos, i) = beta[i + num_locked];
+      arrow_eig.diagonal(i) = alpha[i + num_locked];
+      arrow_eig.arrow(0, i) = beta[i + num_locked];
     }
+    for (int i = arrow_pos; i < dim; i++) arrow_eig.block(i - arrow_pos, 0, 0) = alpha[i + num_locked];
+    for (int i = arrow_pos; i < dim - 1; i++) arrow_eig.subBlock(i - arrow_pos, 0, 0) = beta[i + num_locked];
 
-    for (int i = arrow_pos; i < dim - 1; i++) {
-
-      // beta populates the sub-diagonal
-      A(i, i + 1) = beta[i + num_locked];
-      A(i + 1, i) = beta[i + num_locked];
-    }
-
-    // Eigensolve the arrow matrix
-    SelfAdjointEigenSolver<MatrixXd> eigensolver;
-    eigensolver.compute(A);
-
-    // repopulate ritz matrix
-    for (int i = 0; i < dim; i++)
-      for (int j = 0; j < dim; j++) ritz_mat[dim * i + j] = eigensolver.eigenvectors().col(i)[j];
+    // Eigensolve the arrow matrix.  Only the last row of the
+    // eigenvectors is needed for the residua; the kept Ritz vectors are
+    // formed in computeKeptRitz
+    arrow_eig.compute();
 
+    std::vector<double> last_row(dim);
+    arrow_eig.lastRow(last_row.data());
     for (int i = 0; i < dim; i++) {
-      residua[i + num_locked] = fabs(beta[n_kr - 1] * eigensolver.eigenvectors().col(i)[dim - 1]);
+      residua[i + num_locked] = fabs(beta[n_kr - 1] * last_row[i]);
       // Update the alpha array
-      alpha[i + num_locked] = eigensolver.eigenvalues()[i];
+      alpha[i + num_locked] = arrow_eig.eigenvalue(i);
     }
 
     // Put spectrum back in order
@@ -342,6 +324,12 @@ namespace quda
     int offset = n_kr + 1;
     int dim = n_kr - num_locked;
 
+    // Form the Ritz vectors we keep
+    profile.TPSTART(QUDA_PROFILE_EIGEN);
+    ritz_mat.resize(dim * iter_keep);
+    arrow_eig.vectors(iter_keep, ritz_mat.data());
+    profile.TPSTOP(QUDA_PROFILE_EIGEN);
+
     // Multi-BLAS friendly array to store part of Ritz matrix we want
     double *ritz_mat_keep = (double *)safe_malloc((dim * iter_keep) * sizeof(double));
     for (int j = 0; j < dim; j++) {
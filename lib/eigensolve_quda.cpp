@@ -4,6 +4,8 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <complex>
+#include <type_traits>
 
 #include <quda_internal.h>
 #include <eigensolve_quda.h>
@@ -517,6 +519,78 @@ namespace quda
     }
   }
 
+  /**
+     @brief Compute y = x * a (+ y if accumulate) on host vectors,
+     where a is a row-major x.size() x y.size() matrix.  Each thread
+     gathers a tile of the same elements from every vector of x, does
+     a GEMM with a, and writes the tile back to y.  A tile is read
+     completely before it is written, so y may alias the leading
+     vectors of x.
+  */
+  template <typename Float, typename Scalar>
+  static void rotateHostTiles(const std::vector<ColorSpinorField *> &x, const std::vector<ColorSpinorField *> &y,
+                              const Scalar *a, bool accumulate)
+  {
+    using element_t = typename std::conditional<std::is_same<Scalar, double>::value, Float, std::complex<Float>>::type;
+    using Tile = Matrix<Scalar, Dynamic, Dynamic>;
+    const int nx = x.size();
+    const int ny = y.size();
+    const size_t length = x[0]->Length() / (sizeof(element_t) / sizeof(Float));
+
+    Map<const Matrix<Scalar, Dynamic, Dynamic, RowMajor>> A(a, nx, ny);
+
+    // size the tiles so that a thread's input tile is about 2 MiB
+    const size_t tile = std::max<size_t>(16, std::min<size_t>(1024, (size_t(1) << 21) / (nx * sizeof(Scalar))));
+    const long n_tiles = (length + tile - 1) / tile;
+
+#pragma omp parallel
+    {
+      Tile in(tile, nx);
+      Tile out(tile, ny);
+#pragma omp for schedule(static)
+      for (long t = 0; t < n_tiles; t++) {
+        const size_t begin = t * tile;
+        const size_t n = std::min(tile, length - begin);
+        for (int i = 0; i < nx; i++) {
+          auto v = static_cast<const element_t *>(x[i]->V()) + begin;
+          for (size_t e = 0; e < n; e++) in(e, i) = v[e];
+        }
+        if (accumulate) {
+          for (int j = 0; j < ny; j++) {
+            auto v = static_cast<const element_t *>(y[j]->V()) + begin;
+            for (size_t e = 0; e < n; e++) out(e, j) = v[e];
+          }
+          out.topRows(n).noalias() += in.topRows(n) * A;
+        } else {
+          out.topRows(n).noalias() = in.topRows(n) * A;
+        }
+        for (int j = 0; j < ny; j++) {
+          auto v = static_cast<element_t *>(y[j]->V()) + begin;
+          for (size_t e = 0; e < n; e++) v[e] = element_t(out(e, j));
+        }
+      }
+    }
+  }
+
+  template <typename Scalar>
+  static void rotateHost(const std::vector<ColorSpinorField *> &x, const std::vector<ColorSpinorField *> &y,
+                         const Scalar *a, bool accumulate)
+  {
+    for (auto v : {x, y}) {
+      for (auto f : v) {
+        if (f->Location() != QUDA_CPU_FIELD_LOCATION || f->Precision() != x[0]->Precision()
+            || f->Length() != x[0]->Length())
+          errorQuda("Host rotation requires host fields of equal precision and length");
+      }
+    }
+
+    switch (x[0]->Precision()) {
+    case QUDA_DOUBLE_PRECISION: rotateHostTiles<double>(x, y, a, accumulate); break;
+    case QUDA_SINGLE_PRECISION: rotateHostTiles<float>(x, y, a, accumulate); break;
+    default: errorQuda("Host rotation not supported for precision %d", x[0]->Precision());
+    }
+  }
+
   void EigenSolver::blockRotate(std::vector<ColorSpinorField *> &kSpace, double *array, int rank, const range &i_range,
                                 const range &j_range, blockType b_type)
   {
@@ -549,11 +623,16 @@ namespace quda
         batch_array[i_arr * block_j_rank + j_arr] = array[j * rank + i];
       }
     }
-    switch (b_type) {
-    case PENCIL: blas::axpy(batch_array, vecs_ptr, kSpace_ptr); break;
-    case LOWER_TRI: blas::axpy_L(batch_array, vecs_ptr, kSpace_ptr); break;
-    case UPPER_TRI: blas::axpy_U(batch_array, vecs_ptr, kSpace_ptr); break;
-    default: errorQuda("Undefined MultiBLAS type in blockRotate");
+    if (kSpace[0]->Location() == QUDA_CPU_FIELD_LOCATION) {
+      // the triangular arrays are stored with their zeros, so a full GEMM suffices
+      rotateHost(vecs_ptr, kSpace_ptr, batch_array, true);
+    } else {
+      switch (b_type) {
+      case PENCIL: blas::axpy(batch_array, vecs_ptr, kSpace_ptr); break;
+      case LOWER_TRI: blas::axpy_L(batch_array, vecs_ptr, kSpace_ptr); break;
+      case UPPER_TRI: blas::axpy_U(batch_array, vecs_ptr, kSpace_ptr); break;
+      default: errorQuda("Undefined MultiBLAS type in blockRotate");
+      }
     }
     host_free(batch_array);
 
@@ -603,11 +682,16 @@ namespace quda
         batch_array[i_arr * block_j_rank + j_arr] = array[j * rank + i];
       }
     }
-    switch (b_type) {
-    case PENCIL: blas::caxpy(batch_array, vecs_ptr, kSpace_ptr); break;
-    case LOWER_TRI: blas::caxpy_L(batch_array, vecs_ptr, kSpace_ptr); break;
-    case UPPER_TRI: blas::caxpy_U(batch_array, vecs_ptr, kSpace_ptr); break;
-    default: errorQuda("Undefined MultiBLAS type in blockRotate");
+    if (kSpace[0]->Location() == QUDA_CPU_FIELD_LOCATION) {
+      // the triangular arrays are stored with their zeros, so a full GEMM suffices
+      rotateHost(vecs_ptr, kSpace_ptr, batch_array, true);
+    } else {
+      switch (b_type) {
+      case PENCIL: blas::caxpy(batch_array, vecs_ptr, kSpace_ptr); break;
+      case LOWER_TRI: blas::caxpy_L(batch_array, vecs_ptr, kSpace_ptr); break;
+      case UPPER_TRI: blas::caxpy_U(batch_array, vecs_ptr, kSpace_ptr); break;
+      default: errorQuda("Undefined MultiBLAS type in blockRotate");
+      }
     }
     host_free(batch_array);
 
@@ -908,6 +992,16 @@ namespace quda
   void EigenSolver::rotateVecsComplex(std::vector<ColorSpinorField *> &kSpace, const Complex *rot_array, const int offset,
                                       const int dim, const int keep, const int locked, TimeProfile &profile)
   {
+    // Host vectors are rotated in place, without workspace
+    if (kSpace[0]->Location() == QUDA_CPU_FIELD_LOCATION) {
+      std::vector<ColorSpinorField *> vecs_ptr(kSpace.begin() + locked, kSpace.begin() + locked + dim);
+      std::vector<ColorSpinorField *> kSpace_ptr(kSpace.begin() + locked, kSpace.begin() + locked + keep);
+      profile.TPSTART(QUDA_PROFILE_HOST_COMPUTE);
+      rotateHost(vecs_ptr, kSpace_ptr, rot_array, false);
+      profile.TPSTOP(QUDA_PROFILE_HOST_COMPUTE);
+      return;
+    }
+
     // If we have memory availible, do the entire rotation
     if (batched_rotate <= 0 || batched_rotate >= keep) {
       if ((int)kSpace.size() < offset + keep) {
@@ -1052,6 +1146,16 @@ namespace quda
   void EigenSolver::rotateVecs(std::vector<ColorSpinorField *> &kSpace, const double *rot_array, const int offset,
                                const int dim, const int keep, const int locked, TimeProfile &profile)
   {
+    // Host vectors are rotated in place, without workspace
+    if (kSpace[0]->Location() == QUDA_CPU_FIELD_LOCATION) {
+      std::vector<ColorSpinorField *> vecs_ptr(kSpace.begin() + locked, kSpace.begin() + locked + dim);
+      std::vector<ColorSpinorField *> kSpace_ptr(kSpace.begin() + locked, kSpace.begin() + locked + keep);
+      profile.TPSTART(QUDA_PROFILE_HOST_COMPUTE);
+      rotateHost(vecs_ptr, kSpace_ptr, rot_array, false);
+      profile.TPSTOP(QUDA_PROFILE_HOST_COMPUTE);
+      return;
+    }
+
     // If we have memory availible, do the entire rotation
     if (batched_rotate <= 0 || batched_rotate >= keep) {
       if ((int)kSpace.size() < offset + keep) {
@@ -9,12 +9,17 @@
 #include <reduce_helper.h>
 #include <index_helper.cuh>
 
+#include <instantiate.h>
+
+#ifdef GPU_GAUGE_ALG
 #include <cufft.h>
 #include <CUFFT_Plans.h>
-#include <instantiate.h>
+#endif
 
 namespace quda {
 
+#ifdef GPU_GAUGE_ALG
+
 //UNCOMMENT THIS IF YOU WAN'T TO USE LESS MEMORY
 #define GAUGEFIXING_DONT_USE_GX
 //Without using the precalculation of g(x),
@@ -369,7 +374,7 @@ namespace quda {
     int parity = threadIdx.y + blockIdx.y * blockDim.y;
     if (id >= arg.threads/2) return;
 
-    using complex = complex<Float>;
+    using complex = quda::complex<Float>;
     using matrix = Matrix<complex, 3>;
 
     int x[4];
@@ -469,7 +474,7 @@ namespace quda {
     int id = blockIdx.x * blockDim.x + threadIdx.x;
     if (id >= arg.threads) return;
 
-    using complex = complex<Float>;
+    using complex = quda::complex<Float>;
 
     Matrix<complex,3> de;
     //Read Delta
@@ -841,6 +846,8 @@ namespace quda {
     }
   };
 
+#endif // GPU_GAUGE_ALG
+
   /**
    * @brief Gauge fixing with Steepest descent method with FFTs with support for single GPU only.
    * @param[in,out] data, quda gauge field
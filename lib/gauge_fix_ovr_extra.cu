@@ -1,8 +1,11 @@
 #include <comm_quda.h>
 #include <gauge_fix_ovr_extra.h>
-#include <thrust_helper.cuh>
 #include <tune_quda.h>
 
+#if defined(GPU_GAUGE_ALG) && defined(MULTI_GPU)
+#include <thrust_helper.cuh>
+#endif
+
 namespace quda {
 
 #if defined(GPU_GAUGE_ALG) && defined(MULTI_GPU)
@@ -114,7 +114,7 @@ namespace quda {
 
     template <typename real, int nColor, QudaReconstructType reconstruct=QUDA_RECONSTRUCT_NO>
     struct FatLinkArg : public BaseForceArg<real, nColor, reconstruct> {
-      using BaseForceArg = BaseForceArg<real, nColor, reconstruct>;
+      using BaseForceArg = fermion_force::BaseForceArg<real, nColor, reconstruct>;
       typedef typename gauge_mapper<real,QUDA_RECONSTRUCT_NO>::type F;
       F outA;
       F outB;
@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <sys/time.h>
 #include <complex.h>
 
@@ -135,6 +136,90 @@ std::vector<cudaColorSpinorField*> solutionResident;
 // each entry is one p
 std::vector< std::vector<ColorSpinorField*> > chronoResident(QUDA_MAX_CHRONO);
 
+// generation counters of the resident gauge and clover fields: every
+// path that creates, modifies or frees a resident field increments the
+// matching counter, and a cached chrono A p is only reused if it was
+// computed against the current generation of both
+static uint64_t gauge_generation = 0;
+static uint64_t clover_generation = 0;
+
+// the resident gauge field changed, so every A p computed against it is stale
+static void gaugeFieldChanged() { gauge_generation++; }
+
+// the resident clover field changed, so every A p computed against it is stale
+static void cloverFieldChanged() { clover_generation++; }
+
+// the operator parameters and fields that the chrono A p products depend on
+struct ChronoOperator {
+  bool normal = false; // M^dagger M or M
+  QudaPrecision precision = QUDA_INVALID_PRECISION;
+  QudaDslashType dslash_type = QUDA_INVALID_DSLASH;
+  QudaMatPCType matpc_type = QUDA_MATPC_INVALID;
+  QudaDagType dagger = QUDA_DAG_INVALID;
+  QudaMassNormalization mass_normalization = QUDA_INVALID_NORMALIZATION;
+  QudaTwistFlavorType twist_flavor = QUDA_TWIST_INVALID;
+  double kappa = 0.0, mass = 0.0, mu = 0.0, epsilon = 0.0, m5 = 0.0;
+  double clover_coeff = 0.0, clover_rho = 0.0;
+  double eofa_shift = 0.0, mq1 = 0.0, mq2 = 0.0, mq3 = 0.0;
+  int eofa_pm = 0, laplace3D = 0, Ls = 0;
+  std::vector<Complex> b_5, c_5; // Möbius coefficients of the Ls slices
+  uint64_t gauge_generation = 0, clover_generation = 0;
+
+  ChronoOperator() = default;
+  ChronoOperator(const QudaInvertParam &param, bool normal) :
+    normal(normal),
+    precision(param.chrono_precision),
+    dslash_type(param.dslash_type),
+    matpc_type(param.matpc_type),
+    dagger(param.dagger),
+    mass_normalization(param.mass_normalization),
+    twist_flavor(param.twist_flavor),
+    kappa(param.kappa),
+    mass(param.mass),
+    mu(param.mu),
+    epsilon(param.epsilon),
+    m5(param.m5),
+    clover_coeff(param.clover_coeff),
+    clover_rho(param.clover_rho),
+    eofa_shift(param.eofa_shift),
+    mq1(param.mq1),
+    mq2(param.mq2),
+    mq3(param.mq3),
+    eofa_pm(param.eofa_pm),
+    laplace3D(param.laplace3D),
+    Ls(param.Ls),
+    gauge_generation(::gauge_generation),
+    clover_generation(::clover_generation)
+  {
+    // only the coefficients of the slices in use are set
+    const int n = std::min(std::max(Ls, 0), QUDA_MAX_DWF_LS);
+    b_5.resize(n);
+    c_5.resize(n);
+    memcpy(b_5.data(), param.b_5, sizeof(Complex) * n);
+    memcpy(c_5.data(), param.c_5, sizeof(Complex) * n);
+  }
+
+  bool operator==(const ChronoOperator &o) const
+  {
+    return normal == o.normal && precision == o.precision && dslash_type == o.dslash_type && matpc_type == o.matpc_type
+      && dagger == o.dagger && mass_normalization == o.mass_normalization && twist_flavor == o.twist_flavor
+      && kappa == o.kappa && mass == o.mass && mu == o.mu && epsilon == o.epsilon && m5 == o.m5
+      && clover_coeff == o.clover_coeff && clover_rho == o.clover_rho
+      && eofa_shift == o.eofa_shift && mq1 == o.mq1 && mq2 == o.mq2 && mq3 == o.mq3
+      && eofa_pm == o.eofa_pm && laplace3D == o.laplace3D && Ls == o.Ls && b_5 == o.b_5 && c_5 == o.c_5
+      && gauge_generation == o.gauge_generation && clover_generation == o.clover_generation;
+  }
+};
+
+// each entry is the operator applied to the matching p, kept in step
+// with chronoResident so that only stale products are recomputed
+struct ChronoAp {
+  std::vector<ColorSpinorField *> Ap;
+  std::vector<bool> valid;
+  ChronoOperator op;
+};
+std::vector<ChronoAp> chronoResidentAp(QUDA_MAX_CHRONO);
+
 // Mapped memory buffer used to hold unitarization failures
 static int *num_failures_h = nullptr;
 static int *num_failures_d = nullptr;
@@ -379,7 +464,7 @@ static void initMPIComms(void)
 }
 #endif
 
-static bool comms_initialized = false;
+static QUDA_RANK_LOCAL bool comms_initialized = false;
 
 void initCommsGridQuda(int nDim, const int *dims, QudaCommsMap func, void *fdata)
 {
@@ -445,6 +530,8 @@ static void init_default_comms()
   }
 #elif defined(MPI_COMMS)
   errorQuda("When using MPI for communications, initCommsGridQuda() must be called before initQuda()");
+#elif defined(THREAD_COMMS)
+  errorQuda("When using threaded communications, initCommsGridQuda() must be called before initQuda()");
 #else // single-GPU
   const int dims[4] = {1, 1, 1, 1};
   initCommsGridQuda(4, dims, nullptr, nullptr);
@@ -495,9 +582,14 @@ void initQudaDevice(int dev)
   device::init(dev);
 
   { // determine if we will do CPU or GPU data reordering (default is GPU)
+#ifdef TARGET_CPU
+    bool reorder_cpu = true; // the reorder kernels cannot be launched on the host-only target
+#else
     char *reorder_str = getenv("QUDA_REORDER_LOCATION");
+    bool reorder_cpu = reorder_str && (!strcmp(reorder_str, "CPU") || !strcmp(reorder_str, "cpu"));
+#endif
 
-    if (!reorder_str || (strcmp(reorder_str,"CPU") && strcmp(reorder_str,"cpu")) ) {
+    if (!reorder_cpu) {
       warningQuda("Data reordering done on GPU (set with QUDA_REORDER_LOCATION=GPU/CPU)");
       reorder_location_set(QUDA_CUDA_FIELD_LOCATION);
     } else {
@@ -580,19 +672,24 @@ void loadGaugeQuda(void *h_gauge, QudaGaugeParam *param)
     static_cast<GaugeField*>(new cudaGaugeField(gauge_param));
 
   if (in->Order() == QUDA_BQCD_GAUGE_ORDER) {
-    static size_t checksum = SIZE_MAX;
-    size_t in_checksum = in->checksum(true);
+    static GaugeChecksum checksum;
+    GaugeChecksum in_checksum = BlockChecksum(*in);
     if (in_checksum == checksum) {
-      if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Gauge field unchanged - using cached gauge field %lu\n", checksum);
+      if (getVerbosity() >= QUDA_VERBOSE)
+        printfQuda("Gauge field unchanged - using cached gauge field %lu\n", checksum.root);
       profileGauge.TPSTOP(QUDA_PROFILE_INIT);
       profileGauge.TPSTOP(QUDA_PROFILE_TOTAL);
       delete in;
       invalidate_clover = false;
       return;
     }
+    if (getVerbosity() >= QUDA_VERBOSE)
+      printfQuda("Gauge field changed in %lu of %lu local blocks\n", in_checksum.dirty(checksum).size(),
+                 in_checksum.block.size());
     checksum = in_checksum;
     invalidate_clover = true;
   }
+  gaugeFieldChanged();
 
   // free any current gauge field before new allocations to reduce memory overhead
   switch (param->type) {
@@ -942,6 +1039,7 @@ void loadCloverQuda(void *h_clover, void *h_clovinv, QudaInvertParam *inv_param)
   // compute or download clover field only if gauge field has been updated or clover field doesn't exist
   if (clover_update) {
     if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Creating new clover field\n");
+    cloverFieldChanged();
     freeSloppyCloverQuda();
     if (cloverPrecise) delete cloverPrecise;
 
@@ -1060,6 +1158,7 @@ void freeSloppyCloverQuda();
 
 void loadSloppyCloverQuda(const QudaPrecision *prec)
 {
+  cloverFieldChanged();
   freeSloppyCloverQuda();
 
   if (cloverPrecise) {
@@ -1200,6 +1299,7 @@ void freeGaugeQuda(void)
 {
   if (!initialized) errorQuda("QUDA not initialized");
 
+  gaugeFieldChanged();
   freeSloppyGaugeQuda();
 
   if (gaugePrecise) delete gaugePrecise;
@@ -1231,6 +1331,8 @@ void freeGaugeQuda(void)
 
 void loadSloppyGaugeQuda(const QudaPrecision *prec, const QudaReconstructType *recon)
 {
+  gaugeFieldChanged();
+
   // first do SU3 links (if they exist)
   if (gaugePrecise) {
     GaugeFieldParam gauge_param(*gaugePrecise);
@@ -1450,6 +1552,7 @@ void freeSloppyCloverQuda()
 void freeCloverQuda(void)
 {
   if (!initialized) errorQuda("QUDA not initialized");
+  cloverFieldChanged();
   freeSloppyCloverQuda();
   if (cloverPrecise) delete cloverPrecise;
   cloverPrecise = nullptr;
@@ -1466,6 +1569,106 @@ void flushChronoQuda(int i)
     if (v)  delete v;
   }
   basis.clear();
+
+  auto &cache = chronoResidentAp[i];
+  for (auto ap : cache.Ap) {
+    if (ap) delete ap;
+  }
+  cache.Ap.clear();
+  cache.valid.clear();
+}
+
+/**
+   @brief Return the operator applied to each vector of a
+   chronological basis, recomputing only the products that are stale
+   because the basis vector was replaced or the operator changed.
+   @param[in] param The invert parameters (chrono_index, chrono_precision and operator)
+   @param[in] m The full-precision operator
+   @param[in] mSloppy The sloppy operator
+   @param[in] normal Whether m is the normal operator
+   @param[in] tmp Temporary for applying the operator
+   @param[in] tmp2 Temporary for applying the operator
+   @return The A p vectors
+ */
+static std::vector<ColorSpinorField *> &chronoAp(const QudaInvertParam &param, const DiracMatrix &m,
+                                                 const DiracMatrix &mSloppy, bool normal, ColorSpinorField &tmp,
+                                                 ColorSpinorField &tmp2)
+{
+  auto &basis = chronoResident[param.chrono_index];
+  auto &cache = chronoResidentAp[param.chrono_index];
+
+  const DiracMatrix *mat = nullptr;
+  if (param.chrono_precision == param.cuda_prec) {
+    mat = &m;
+  } else if (param.chrono_precision == param.cuda_prec_sloppy) {
+    mat = &mSloppy;
+  } else {
+    errorQuda("Unexpected precision %d for chrono vectors (doesn't match outer %d or sloppy precision %d)",
+              param.chrono_precision, param.cuda_prec, param.cuda_prec_sloppy);
+  }
+
+  ChronoOperator op(param, normal);
+  if (!(op == cache.op)) {
+    std::fill(cache.valid.begin(), cache.valid.end(), false);
+    cache.op = op;
+  }
+
+  int n_apply = 0;
+  for (unsigned int j = 0; j < basis.size(); j++) {
+    if (cache.valid[j]) continue;
+    (*mat)(*cache.Ap[j], *basis[j], tmp, tmp2);
+    cache.valid[j] = true;
+    n_apply++;
+  }
+  if (getVerbosity() >= QUDA_DEBUG_VERBOSE)
+    printfQuda("Chrono basis %d: recomputed %d of %lu A p vectors\n", param.chrono_index, n_apply, basis.size());
+
+  return cache.Ap;
+}
+
+/**
+   @brief Forecast the solution from a chronological basis by minimum
+   residual extrapolation.  MinResExt orthonormalizes the vectors it
+   is given in place, so it is given copies: the resident basis and
+   A p products are left untouched, and each resident A p remains
+   the operator applied to its basis vector.
+   @param[in] param The invert parameters (chrono_index, chrono_precision and operator)
+   @param[in] m The full-precision operator
+   @param[in] mSloppy The sloppy operator
+   @param[in] normal Whether m is the normal operator, which is Hermitian
+   @param[out] out The forecast solution
+   @param[in] in The source
+ */
+static void chronoForecast(const QudaInvertParam &param, const DiracMatrix &m, const DiracMatrix &mSloppy, bool normal,
+                           ColorSpinorField &out, const ColorSpinorField &in)
+{
+  auto &basis = chronoResident[param.chrono_index];
+
+  ColorSpinorParam cs_param(*basis[0]);
+  ColorSpinorField *tmp = ColorSpinorField::Create(cs_param);
+  ColorSpinorField *tmp2 = (param.chrono_precision == out.Precision()) ? &out : ColorSpinorField::Create(cs_param);
+  auto &Ap = chronoAp(param, m, mSloppy, normal, *tmp, *tmp2);
+
+  std::vector<ColorSpinorField *> p(basis.size()), q(basis.size());
+  for (unsigned int j = 0; j < basis.size(); j++) {
+    p[j] = ColorSpinorField::Create(cs_param);
+    q[j] = ColorSpinorField::Create(cs_param);
+    blas::copy(*p[j], *basis[j]);
+    blas::copy(*q[j], *Ap[j]);
+  }
+
+  bool orthogonal = true;
+  bool apply_mat = false;
+  bool hermitian = normal;
+  MinResExt mre(m, orthogonal, apply_mat, hermitian, profileInvert);
+
+  blas::copy(*tmp, in);
+  mre(out, *tmp, p, q);
+
+  for (auto v : p) delete v;
+  for (auto v : q) delete v;
+  delete tmp;
+  if (tmp2 != &out) delete tmp2;
 }
 
 void endQuda(void)
@@ -1506,6 +1709,9 @@ void endQuda(void)
   // flush any outstanding force monitoring (if enabled)
   flushForceMonitor();
 
+  // merge and write out the timeline (if enabled)
+  timeline::finalize();
+
   initialized = false;
 
   comm_finalize();
@@ -1552,6 +1758,8 @@ void endQuda(void)
     printfQuda("\n");
     printPeakMemUsage();
     printfQuda("\n");
+    pool::print_statistics();
+    printfQuda("\n");
   }
 
   assertAllMemFree();
@@ -1838,6 +2046,52 @@ namespace quda {
     dEig = Dirac::create(diracEigParam);
   }
 
+  /**
+     @brief Return the largest deviation of the resident A p products
+     of a chronological basis from the operator applied to the basis
+     vectors, relative to the norm of the product.  Used by the tests
+     to check that forecasting leaves the resident products exact.
+     @param[in] param The invert parameters of the solves that built the basis
+     @return The largest relative deviation over the valid products
+  */
+  double chronoApDeviation(QudaInvertParam &param)
+  {
+    auto &basis = chronoResident[param.chrono_index];
+    auto &cache = chronoResidentAp[param.chrono_index];
+    if (basis.empty()) return 0.0;
+
+    const bool pc_solve = param.solve_type == QUDA_DIRECT_PC_SOLVE || param.solve_type == QUDA_NORMOP_PC_SOLVE;
+    const bool normal = param.solve_type == QUDA_NORMOP_SOLVE || param.solve_type == QUDA_NORMOP_PC_SOLVE;
+
+    Dirac *d = nullptr;
+    Dirac *dSloppy = nullptr;
+    Dirac *dPre = nullptr;
+    createDirac(d, dSloppy, dPre, param, pc_solve);
+    const Dirac &dirac = param.chrono_precision == param.cuda_prec ? *d : *dSloppy;
+    std::unique_ptr<DiracMatrix> m;
+    if (normal) m = std::make_unique<DiracMdagM>(dirac);
+    else m = std::make_unique<DiracM>(dirac);
+
+    ColorSpinorParam cs_param(*basis[0]);
+    std::unique_ptr<ColorSpinorField> Ap(ColorSpinorField::Create(cs_param));
+    std::unique_ptr<ColorSpinorField> tmp(ColorSpinorField::Create(cs_param));
+    std::unique_ptr<ColorSpinorField> tmp2(ColorSpinorField::Create(cs_param));
+
+    double deviation = 0.0;
+    for (unsigned int j = 0; j < basis.size(); j++) {
+      if (!cache.valid[j]) continue;
+      (*m)(*Ap, *basis[j], *tmp, *tmp2);
+      double Ap2 = blas::norm2(*cache.Ap[j]);
+      double dev2 = blas::xmyNorm(*cache.Ap[j], *Ap);
+      deviation = std::max(deviation, sqrt(dev2 / Ap2));
+    }
+
+    delete d;
+    delete dSloppy;
+    delete dPre;
+    return deviation;
+  }
+
   static double unscaled_shifts[QUDA_MAX_MULTI_SHIFT];
 
   void massRescale(cudaColorSpinorField &b, QudaInvertParam &param) {
@@ -3029,40 +3283,7 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
     // chronological forecasting
     if (param->chrono_use_resident && chronoResident[param->chrono_index].size() > 0) {
       profileInvert.TPSTART(QUDA_PROFILE_CHRONO);
-
-      auto &basis = chronoResident[param->chrono_index];
-
-      ColorSpinorParam cs_param(*basis[0]);
-      ColorSpinorField *tmp = ColorSpinorField::Create(cs_param);
-      ColorSpinorField *tmp2 = (param->chrono_precision == out->Precision()) ? out : ColorSpinorField::Create(cs_param);
-      std::vector<ColorSpinorField*> Ap;
-      for (unsigned int k=0; k < basis.size(); k++) {
-        Ap.emplace_back((ColorSpinorField::Create(cs_param)));
-      }
-
-      if (param->chrono_precision == param->cuda_prec) {
-        for (unsigned int j=0; j<basis.size(); j++) m(*Ap[j], *basis[j], *tmp, *tmp2);
-      } else if (param->chrono_precision == param->cuda_prec_sloppy) {
-        for (unsigned int j=0; j<basis.size(); j++) mSloppy(*Ap[j], *basis[j], *tmp, *tmp2);
-      } else {
-        errorQuda("Unexpected precision %d for chrono vectors (doesn't match outer %d or sloppy precision %d)",
-                  param->chrono_precision, param->cuda_prec, param->cuda_prec_sloppy);
-      }
-
-      bool orthogonal = true;
-      bool apply_mat = false;
-      bool hermitian = false;
-      MinResExt mre(m, orthogonal, apply_mat, hermitian, profileInvert);
-
-      blas::copy(*tmp, *in);
-      mre(*out, *tmp, basis, Ap);
-
-      for (auto ap: Ap) {
-        if (ap) delete (ap);
-      }
-      delete tmp;
-      if (tmp2 != out) delete tmp2;
-
+      chronoForecast(*param, m, mSloppy, false, *out, *in);
       profileInvert.TPSTOP(QUDA_PROFILE_CHRONO);
     }
 
@@ -3077,40 +3298,7 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
     // chronological forecasting
     if (param->chrono_use_resident && chronoResident[param->chrono_index].size() > 0) {
       profileInvert.TPSTART(QUDA_PROFILE_CHRONO);
-
-      auto &basis = chronoResident[param->chrono_index];
-
-      ColorSpinorParam cs_param(*basis[0]);
-      std::vector<ColorSpinorField*> Ap;
-      ColorSpinorField *tmp = ColorSpinorField::Create(cs_param);
-      ColorSpinorField *tmp2 = (param->chrono_precision == out->Precision()) ? out : ColorSpinorField::Create(cs_param);
-      for (unsigned int k=0; k < basis.size(); k++) {
-        Ap.emplace_back((ColorSpinorField::Create(cs_param)));
-      }
-
-      if (param->chrono_precision == param->cuda_prec) {
-        for (unsigned int j=0; j<basis.size(); j++) m(*Ap[j], *basis[j], *tmp, *tmp2);
-      } else if (param->chrono_precision == param->cuda_prec_sloppy) {
-        for (unsigned int j=0; j<basis.size(); j++) mSloppy(*Ap[j], *basis[j], *tmp, *tmp2);
-      } else {
-        errorQuda("Unexpected precision %d for chrono vectors (doesn't match outer %d or sloppy precision %d)",
-                  param->chrono_precision, param->cuda_prec, param->cuda_prec_sloppy);
-      }
-
-      bool orthogonal = true;
-      bool apply_mat = false;
-      bool hermitian = true;
-      MinResExt mre(m, orthogonal, apply_mat, hermitian, profileInvert);
-
-      blas::copy(*tmp, *in);
-      mre(*out, *tmp, basis, Ap);
-
-      for (auto ap: Ap) {
-        if (ap) delete(ap);
-      }
-      delete tmp;
-      if (tmp2 != out) delete tmp2;
-
+      chronoForecast(*param, m, mSloppy, true, *out, *in);
       profileInvert.TPSTOP(QUDA_PROFILE_CHRONO);
     }
 
@@ -3154,6 +3342,7 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
       errorQuda("Requested chrono index %d is outside of max %d\n", i, QUDA_MAX_CHRONO);
 
     auto &basis = chronoResident[i];
+    auto &cache = chronoResidentAp[i];
 
     if(param->chrono_max_dim < (int)basis.size()){
       errorQuda("Requested chrono_max_dim %i is smaller than already existing chroology %i",param->chrono_max_dim,(int)basis.size());
@@ -3165,14 +3354,21 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
         ColorSpinorParam cs_param(*out);
         cs_param.setPrecision(param->chrono_precision);
         basis.emplace_back(ColorSpinorField::Create(cs_param));
+        cache.Ap.emplace_back(ColorSpinorField::Create(cs_param));
+        cache.valid.push_back(false);
       }
 
       // shuffle every entry down one and bring the last to the front
       ColorSpinorField *tmp = basis[basis.size()-1];
       for (unsigned int j=basis.size()-1; j>0; j--) basis[j] = basis[j-1];
         basis[0] = tmp;
+
+      // the A p products follow their vectors
+      std::rotate(cache.Ap.rbegin(), cache.Ap.rbegin() + 1, cache.Ap.rend());
+      std::rotate(cache.valid.rbegin(), cache.valid.rbegin() + 1, cache.valid.rend());
     }
     *(basis[0]) = *out; // set first entry to new solution
+    cache.valid[0] = false; // and compute its A p when it is next used
   }
   dirac.reconstruct(*x, *b, param->solution_type);
 
@@ -4053,6 +4249,10 @@ void computeKSLinkQuda(void* fatlink, void* longlink, void* ulink, void* inlink,
     profileFatLink.TPSTOP(QUDA_PROFILE_COMPUTE);
   }
 
+  // new fat and long links supersede those the resident staggered
+  // operator was built from, even before they are loaded
+  gaugeFieldChanged();
+
   profileFatLink.TPSTART(QUDA_PROFILE_D2H);
   if (ulink) cudaUnitarizedLink->saveCPUField(cpuUnitarizedLink);
   if (fatlink) cudaFatLink->saveCPUField(cpuFatLink);
@@ -4285,6 +4485,7 @@ void createCloverQuda(QudaInvertParam* invertParam)
   profileClover.TPSTART(QUDA_PROFILE_COMPUTE);
   computeFmunu(Fmunu, *gauge);
   computeClover(*cloverPrecise, Fmunu, invertParam->clover_coeff);
+  cloverFieldChanged();
   profileClover.TPSTOP(QUDA_PROFILE_COMPUTE);
   profileClover.TPSTOP(QUDA_PROFILE_TOTAL);
 
@@ -5007,6 +5208,8 @@ void updateGaugeFieldQuda(void* gauge,
   }
 
   profileGaugeUpdate.TPSTART(QUDA_PROFILE_FREE);
+  // the resident gauge field is either replaced or, if it was the input, consumed
+  if (param->make_resident_gauge || param->use_resident_gauge) gaugeFieldChanged();
   if (param->make_resident_gauge) {
     if (gaugePrecise != nullptr) delete gaugePrecise;
     gaugePrecise = cudaOutGauge;
@@ -5076,6 +5279,8 @@ void updateGaugeFieldQuda(void* gauge,
    if (param->return_result_gauge) cudaGauge->saveCPUField(*cpuGauge);
    profileProject.TPSTOP(QUDA_PROFILE_D2H);
 
+   // the resident gauge field is either replaced or, if it was the input, consumed
+   if (param->make_resident_gauge || param->use_resident_gauge) gaugeFieldChanged();
    if (param->make_resident_gauge) {
      if (gaugePrecise != nullptr && cudaGauge != gaugePrecise) delete gaugePrecise;
      gaugePrecise = cudaGauge;
@@ -5462,6 +5667,7 @@ void gaussGaugeQuda(unsigned long long seed, double sigma)
 
   profileGauss.TPSTART(QUDA_PROFILE_COMPUTE);
   quda::gaugeGauss(*data, seed, sigma);
+  gaugeFieldChanged();
   profileGauss.TPSTOP(QUDA_PROFILE_COMPUTE);
 
   if (extendedGaugeResident) {
@@ -5808,6 +6014,7 @@ int computeGaugeFixingOVRQuda(void *gauge, const unsigned int gauge_dir, const u
   GaugeFixOVRQuda.TPSTOP(QUDA_PROFILE_TOTAL);
 
   if (param->make_resident_gauge) {
+    gaugeFieldChanged();
     if (gaugePrecise != nullptr) delete gaugePrecise;
     gaugePrecise = cudaInGauge;
   } else {
@@ -5873,6 +6080,7 @@ int computeGaugeFixingFFTQuda(void* gauge, const unsigned int gauge_dir,  const
   GaugeFixFFTQuda.TPSTOP(QUDA_PROFILE_TOTAL);
 
   if (param->make_resident_gauge) {
+    gaugeFieldChanged();
     if (gaugePrecise != nullptr) delete gaugePrecise;
     gaugePrecise = cudaInGauge;
   } else {
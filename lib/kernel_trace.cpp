@@ -0,0 +1,441 @@
+#include <kernel_trace.h>
+#include <comm_quda.h>
+#include <malloc_quda.h>
+#include <util_quda.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace quda
+{
+
+  namespace kernel_trace
+  {
+
+    static_assert(sizeof(FileHeader) % alignof(Record) == 0, "FileHeader breaks record alignment");
+    static_assert(sizeof(Record) % alignof(ChunkHeader) == 0, "Record breaks chunk alignment");
+
+    /**
+       The ids of the keys of a trace, with the definitions of the keys
+       not yet written to the file
+     */
+    class KeyTable
+    {
+      std::unordered_map<uint64_t, std::vector<uint32_t>> ids; // key hash -> ids
+      std::vector<TuneKey> keys;
+
+    public:
+      std::vector<char> pending; // definitions not yet written
+      uint32_t n_pending = 0;
+
+      uint32_t id(const TuneKey &key)
+      {
+        auto &bucket = ids[key.hash];
+        for (auto i : bucket)
+          if (keys[i] == key) return i;
+
+        const uint32_t i = keys.size();
+        keys.push_back(key);
+        bucket.push_back(i);
+
+        KeyDefinition def = {i, static_cast<uint32_t>(strlen(key.volume)), static_cast<uint32_t>(strlen(key.name)),
+                             static_cast<uint32_t>(strlen(key.aux))};
+        const char *d = reinterpret_cast<const char *>(&def);
+        pending.insert(pending.end(), d, d + sizeof(def));
+        pending.insert(pending.end(), key.volume, key.volume + def.volume_length);
+        pending.insert(pending.end(), key.name, key.name + def.name_length);
+        pending.insert(pending.end(), key.aux, key.aux + def.aux_length);
+        n_pending++;
+        return i;
+      }
+    };
+
+    /**
+       @brief Initialize the header of a trace file
+     */
+    static FileHeader makeHeader(int rank, int64_t created, const std::string &version, const std::string &gitversion,
+                                 const std::string &hash)
+    {
+      FileHeader header = {};
+      memcpy(header.magic, binary_magic, sizeof(binary_magic));
+      header.format_version = binary_format_version;
+      header.endian = binary_endian_check;
+      header.rank = rank;
+      header.created = created;
+      strncpy(header.version, version.c_str(), sizeof(header.version) - 1);
+      strncpy(header.gitversion, gitversion.c_str(), sizeof(header.gitversion) - 1);
+      strncpy(header.hash, hash.c_str(), sizeof(header.hash) - 1);
+      return header;
+    }
+
+    /**
+       The trace state.  record() appends to the ring buffer and to the
+       pending key definitions; the flusher thread moves both to the
+       file.  Key definitions are always written before the records
+       that were appended after them, so every record in the file
+       follows the definition of its key.
+     */
+    class Trace
+    {
+      std::mutex mutex;
+      std::condition_variable drain;   // signals the flusher
+      std::condition_variable space;   // signals producers waiting for space in the ring
+      std::condition_variable flushed; // signals flush() that a requested flush is complete
+
+      std::vector<Record> ring;
+      uint64_t head = 0; // number of records appended
+      uint64_t tail = 0; // number of records taken by the flusher
+      uint64_t dropped = 0;
+
+      KeyTable keys;
+
+      FILE *file = nullptr;
+      std::string file_path;
+      std::thread flusher;
+      bool stop = false;
+      uint64_t flush_requested = 0;
+      uint64_t flush_completed = 0;
+
+      void write(const ChunkHeader &chunk, const void *data, size_t bytes)
+      {
+        if (fwrite(&chunk, sizeof(chunk), 1, file) != 1 || (bytes && fwrite(data, bytes, 1, file) != 1))
+          errorQuda("Failed to write trace file %s", file_path.c_str());
+      }
+
+      void run()
+      {
+        std::vector<char> keys_out;
+        std::vector<Record> records_out;
+        records_out.reserve(ring.size());
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+          drain.wait_for(lock, std::chrono::seconds(1), [&] {
+            return stop || head - tail >= ring.size() / 2 || flush_requested > flush_completed;
+          });
+
+          const uint64_t request = flush_requested;
+          const uint32_t n_keys = keys.n_pending;
+          keys_out.swap(keys.pending);
+          keys.pending.clear();
+          keys.n_pending = 0;
+          records_out.clear();
+          for (; tail < head; tail++) records_out.push_back(ring[tail % ring.size()]);
+          const bool done = stop;
+          space.notify_all();
+          lock.unlock();
+
+          if (n_keys) write({CHUNK_KEYS, n_keys}, keys_out.data(), keys_out.size());
+          if (records_out.size())
+            write({CHUNK_RECORDS, static_cast<uint32_t>(records_out.size())}, records_out.data(),
+                  records_out.size() * sizeof(Record));
+          fflush(file);
+
+          lock.lock();
+          flush_completed = request;
+          flushed.notify_all();
+          if (done) break;
+        }
+      }
+
+    public:
+      Trace()
+      {
+        char *buffer_env = getenv("QUDA_TRACE_BUFFER");
+        size_t capacity = buffer_env ? strtoul(buffer_env, nullptr, 10) : 65536;
+        if (capacity < 2) errorQuda("Invalid QUDA_TRACE_BUFFER=%s", buffer_env);
+        ring.resize(capacity);
+      }
+
+      ~Trace()
+      {
+        if (!file) return;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          stop = true;
+        }
+        drain.notify_one();
+        flusher.join();
+        fclose(file);
+      }
+
+      void open(const std::string &path, const std::string &version, const std::string &gitversion,
+                const std::string &hash, int rank)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (file) return;
+
+        file = fopen(path.c_str(), "wb");
+        if (!file) {
+          warningQuda("Unable to open trace file %s; the trace will not be saved", path.c_str());
+          return;
+        }
+        file_path = path;
+
+        FileHeader header = makeHeader(rank, time(nullptr), version, gitversion, hash);
+        if (fwrite(&header, sizeof(header), 1, file) != 1) errorQuda("Failed to write trace file %s", path.c_str());
+
+        flusher = std::thread(&Trace::run, this);
+      }
+
+      void record(const TuneKey &key, float time)
+      {
+        Record record = {0, time, device_allocated_peak(), pinned_allocated_peak(), mapped_allocated_peak(),
+                         host_allocated_peak()};
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (head - tail == ring.size()) {
+          if (!file) { // nothing will drain the ring until the file is opened
+            dropped++;
+            return;
+          }
+          drain.notify_one();
+          space.wait(lock, [&] { return head - tail < ring.size(); });
+        }
+        record.key = keys.id(key);
+        ring[head++ % ring.size()] = record;
+        if (head - tail == ring.size() / 2) drain.notify_one();
+      }
+
+      void flush()
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        // report drops even when no file was ever opened, since then
+        // every entry past the ring capacity was lost
+        if (dropped) {
+          warningQuda("%lu trace entries recorded while no trace file was open were dropped", dropped);
+          dropped = 0;
+        }
+        if (!file) return;
+        const uint64_t request = ++flush_requested;
+        drain.notify_one();
+        flushed.wait(lock, [&] { return flush_completed >= request; });
+      }
+
+      std::string path()
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        return file_path;
+      }
+
+      size_t size()
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        return head;
+      }
+    };
+
+    static Trace &trace()
+    {
+      static Trace trace;
+      return trace;
+    }
+
+    void open(const std::string &path, const std::string &version, const std::string &gitversion,
+              const std::string &hash)
+    {
+      trace().open(path, version, gitversion, hash, comm_rank());
+    }
+
+    void record(const TuneKey &key, float time) { trace().record(key, time); }
+
+    void flush() { trace().flush(); }
+
+    std::string path() { return trace().path(); }
+
+    size_t size() { return trace().size(); }
+
+    bool Reader::open(const std::string &path)
+    {
+      in.open(path.c_str(), std::ios::binary);
+      if (!in) return false;
+      if (!in.read(reinterpret_cast<char *>(&header_), sizeof(header_))) return false;
+      return memcmp(header_.magic, binary_magic, sizeof(binary_magic)) == 0
+        && header_.format_version == binary_format_version && header_.endian == binary_endian_check;
+    }
+
+    bool Reader::readChunk()
+    {
+      ChunkHeader chunk;
+      if (!in.read(reinterpret_cast<char *>(&chunk), sizeof(chunk))) return false;
+
+      if (chunk.type == CHUNK_KEYS) {
+        for (uint32_t i = 0; i < chunk.count; i++) {
+          KeyDefinition def;
+          if (!in.read(reinterpret_cast<char *>(&def), sizeof(def))) return false;
+          if (def.volume_length >= TuneKey::volume_n || def.name_length >= TuneKey::name_n
+              || def.aux_length >= TuneKey::aux_n)
+            return false;
+          TuneKey key("", "", "");
+          if (!in.read(key.volume, def.volume_length) || !in.read(key.name, def.name_length)
+              || !in.read(key.aux, def.aux_length))
+            return false;
+          key.volume[def.volume_length] = '\0';
+          key.name[def.name_length] = '\0';
+          key.aux[def.aux_length] = '\0';
+          key.updateHash();
+          if (def.id >= keys.size()) keys.resize(def.id + 1);
+          keys[def.id] = key;
+        }
+      } else if (chunk.type == CHUNK_RECORDS) {
+        records.resize(chunk.count);
+        next_record = 0;
+        if (!in.read(reinterpret_cast<char *>(records.data()), chunk.count * sizeof(Record))) return false;
+        for (auto &r : records)
+          if (r.key >= keys.size()) return false;
+      } else {
+        return false;
+      }
+      return true;
+    }
+
+    bool Reader::next(Record &record)
+    {
+      while (next_record == records.size()) {
+        records.clear();
+        next_record = 0;
+        if (!readChunk()) {
+          records.clear(); // a truncated chunk is discarded
+          return false;
+        }
+      }
+      record = records[next_record++];
+      return true;
+    }
+
+    void writeTextHeader(std::ostream &out, const FileHeader &header)
+    {
+      time_t created = header.created;
+      out << "trace"
+          << "\t" << header.version << "\t" << header.gitversion << "\t" << header.hash << "\t# Last updated "
+          << ctime(&created) << std::endl;
+
+      out << std::setw(12) << "time\t" << std::setw(12) << "device-mem\t" << std::setw(12) << "pinned-mem\t";
+      out << std::setw(12) << "mapped-mem\t" << std::setw(12) << "host-mem\t";
+      out << std::setw(16) << "volume"
+          << "\tname\taux" << std::endl;
+    }
+
+    void writeText(std::ostream &out, const TuneKey &key, const Record &record)
+    {
+      // special case kernel members of a policy
+      char tmp[TuneKey::aux_n] = {};
+      strncpy(tmp, key.aux, TuneKey::aux_n);
+      bool is_policy_kernel = strcmp(tmp, "policy_kernel") == 0 ? true : false;
+
+      out << std::setw(12) << record.time << "\t";
+      out << std::setw(12) << record.device_bytes << "\t";
+      out << std::setw(12) << record.pinned_bytes << "\t";
+      out << std::setw(12) << record.mapped_bytes << "\t";
+      out << std::setw(12) << record.host_bytes << "\t";
+      out << std::setw(16) << key.volume << "\t";
+      if (is_policy_kernel) out << "\t";
+      out << key.name << "\t";
+      if (!is_policy_kernel) out << "\t";
+      out << key.aux << std::endl;
+    }
+
+    bool binaryToText(const std::string &in, const std::string &out)
+    {
+      Reader reader;
+      if (!reader.open(in)) return false;
+
+      std::ofstream text(out.c_str());
+      if (!text) return false;
+      writeTextHeader(text, reader.header());
+
+      Record record;
+      while (reader.next(record)) writeText(text, reader.key(record), record);
+      return text.good();
+    }
+
+    /**
+       @brief Split a line of the text format at its tabs
+     */
+    static std::vector<std::string> splitTabs(const std::string &line)
+    {
+      std::vector<std::string> fields;
+      std::istringstream ls(line);
+      std::string field;
+      while (std::getline(ls, field, '\t')) fields.push_back(field);
+      if (!line.empty() && line.back() == '\t') fields.push_back("");
+      return fields;
+    }
+
+    bool textToBinary(const std::string &in, const std::string &out)
+    {
+      std::ifstream text(in.c_str());
+      if (!text) return false;
+
+      // the version line: trace, the version strings, and the creation time
+      const std::string updated = "# Last updated ";
+      std::string line;
+      if (!std::getline(text, line)) return false;
+      auto fields = splitTabs(line);
+      if (fields.size() != 5 || fields[0] != "trace" || fields[4].compare(0, updated.size(), updated) != 0) return false;
+      struct tm created = {};
+      if (!strptime(fields[4].c_str() + updated.size(), "%a %b %d %H:%M:%S %Y", &created)) return false;
+      created.tm_isdst = -1;
+      // the rank is not part of the text format
+      FileHeader header = makeHeader(0, mktime(&created), fields[1], fields[2], fields[3]);
+
+      // skip the blank line that ends the creation time and the column headings
+      do {
+        if (!std::getline(text, line)) return false;
+      } while (line.empty());
+
+      KeyTable keys;
+      std::vector<Record> records;
+      while (std::getline(text, line)) {
+        if (line.empty()) continue;
+        fields = splitTabs(line);
+        if (fields.size() != 9) return false;
+
+        // the name of a policy kernel is in the column after its own
+        const bool is_policy_kernel = fields[6].empty();
+        const std::string &name = is_policy_kernel ? fields[7] : fields[6];
+        const std::string volume = fields[5].substr(std::min(fields[5].find_first_not_of(' '), fields[5].size()));
+        if (volume.size() >= TuneKey::volume_n || name.size() >= TuneKey::name_n || fields[8].size() >= TuneKey::aux_n)
+          return false;
+
+        Record record;
+        record.key = keys.id(TuneKey(volume.c_str(), name.c_str(), fields[8].c_str()));
+        record.time = strtof(fields[0].c_str(), nullptr);
+        record.device_bytes = strtoll(fields[1].c_str(), nullptr, 10);
+        record.pinned_bytes = strtoll(fields[2].c_str(), nullptr, 10);
+        record.mapped_bytes = strtoll(fields[3].c_str(), nullptr, 10);
+        record.host_bytes = strtoll(fields[4].c_str(), nullptr, 10);
+        records.push_back(record);
+      }
+
+      FILE *file = fopen(out.c_str(), "wb");
+      if (!file) return false;
+      bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+      if (keys.n_pending) {
+        ChunkHeader chunk = {CHUNK_KEYS, keys.n_pending};
+        written = written && fwrite(&chunk, sizeof(chunk), 1, file) == 1
+          && fwrite(keys.pending.data(), keys.pending.size(), 1, file) == 1;
+      }
+      // the records in chunks of the default ring buffer capacity
+      constexpr size_t chunk_records = 65536;
+      for (size_t first = 0; first < records.size(); first += chunk_records) {
+        ChunkHeader chunk = {CHUNK_RECORDS, static_cast<uint32_t>(std::min(chunk_records, records.size() - first))};
+        written = written && fwrite(&chunk, sizeof(chunk), 1, file) == 1
+          && fwrite(&records[first], sizeof(Record), chunk.count, file) == chunk.count;
+      }
+      return fclose(file) == 0 && written;
+    }
+
+  } // namespace kernel_trace
+
+} // namespace quda
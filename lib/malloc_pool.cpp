@@ -0,0 +1,82 @@
+#include <cstring>
+#include <quda_internal.h>
+#include <malloc_pool.h>
+
+namespace quda
+{
+
+  namespace pool
+  {
+
+    static void pinned_allocator_free(const char *func, const char *file, int line, void *ptr)
+    {
+      quda::host_free_(func, file, line, ptr);
+    }
+
+    static Pool pinned("Pinned", quda::pinned_malloc_, pinned_allocator_free);
+    static Pool device("Device", quda::device_malloc_, quda::device_free_);
+
+    static bool pool_init = false;
+
+    void init()
+    {
+      if (!pool_init) {
+        // device memory pool
+        char *enable_device_pool = getenv("QUDA_ENABLE_DEVICE_MEMORY_POOL");
+        if (!enable_device_pool || strcmp(enable_device_pool, "0") != 0) {
+          warningQuda("Using device memory pool allocator");
+          device.enabled = true;
+        } else {
+          warningQuda("Not using device memory pool allocator");
+          device.enabled = false;
+        }
+
+        // pinned memory pool
+        char *enable_pinned_pool = getenv("QUDA_ENABLE_PINNED_MEMORY_POOL");
+        if (!enable_pinned_pool || strcmp(enable_pinned_pool, "0") != 0) {
+          warningQuda("Using pinned memory pool allocator");
+          pinned.enabled = true;
+        } else {
+          warningQuda("Not using pinned memory pool allocator");
+          pinned.enabled = false;
+        }
+
+        // headroom above the high-water mark before cached allocations are trimmed
+        char *slack_env = getenv("QUDA_MEMORY_POOL_SLACK");
+        if (slack_env) {
+          int slack = atoi(slack_env);
+          if (slack < 0) errorQuda("Invalid QUDA_MEMORY_POOL_SLACK=%s", slack_env);
+          pinned.set_slack(slack / 100.0);
+          device.set_slack(slack / 100.0);
+        }
+        pool_init = true;
+      }
+    }
+
+    void *pinned_malloc_(const char *func, const char *file, int line, size_t nbytes)
+    {
+      return pinned.malloc(func, file, line, nbytes);
+    }
+
+    void pinned_free_(const char *func, const char *file, int line, void *ptr) { pinned.free(func, file, line, ptr); }
+
+    void *device_malloc_(const char *func, const char *file, int line, size_t nbytes)
+    {
+      return device.malloc(func, file, line, nbytes);
+    }
+
+    void device_free_(const char *func, const char *file, int line, void *ptr) { device.free(func, file, line, ptr); }
+
+    void flush_pinned() { pinned.flush(); }
+
+    void flush_device() { device.flush(); }
+
+    void print_statistics()
+    {
+      pinned.print_statistics();
+      device.print_statistics();
+    }
+
+  } // namespace pool
+
+} // namespace quda
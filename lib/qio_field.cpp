@@ -60,6 +60,25 @@ template <typename oFloat, typename iFloat, int len> void vget(char *s1, size_t
   }
 }
 
+// the fields [first, first + n) of a record, which are read into field[0, n)
+struct FieldWindow {
+  void **field;
+  int first;
+  int n;
+};
+
+template <typename oFloat, typename iFloat, int len> void vput_window(char *s1, size_t index, int count, void *s2)
+{
+  FieldWindow *window = (FieldWindow *)s2;
+  iFloat *src = (iFloat *)s1 + window->first * len;
+
+  // as vput, skipping the fields outside the window
+  for (int i = 0; i < window->n; i++) {
+    oFloat *dest = (oFloat *)window->field[i] + len * index;
+    for (int j = 0; j < len; j++) dest[j] = src[i * len + j];
+  }
+}
+
 QIO_Reader *open_test_input(const char *filename, int volfmt, int serpar)
 {
   QIO_Iflag iflag;
@@ -124,7 +143,7 @@ QIO_Writer *open_test_output(const char *filename, int volfmt, int serpar, int i
 
 template <int len>
 int read_field(QIO_Reader *infile, int count, void *field_in[], QudaPrecision cpu_prec, QudaSiteSubset subset,
-               QudaParity parity, int nSpin, int nColor)
+               QudaParity parity, int nSpin, int nColor, int first = 0, int n = -1)
 {
   // Get the QIO record and string
   char dummy[100] = "";
@@ -170,22 +189,30 @@ int read_field(QIO_Reader *infile, int count, void *field_in[], QudaPrecision cp
   // Get total size. Could probably check the filesize better, but tbd.
   size_t rec_size = file_prec * count * len;
 
+  // Read only a window of the fields?
+  if (n < 0) n = count;
+  if (first < 0 || first + n > count) errorQuda("Invalid window [%d, %d) of %d fields", first, first + n, count);
+  FieldWindow window = {field_in, first, n};
+  const bool whole = first == 0 && n == count;
+  void *arg = whole ? (void *)field_in : (void *)&window;
+
   /* Read the field record and convert to cpu precision*/
   if (cpu_prec == QUDA_DOUBLE_PRECISION) {
     if (file_prec == QUDA_DOUBLE_PRECISION) {
-      status = QIO_read(infile, rec_info, xml_record_in, vput<double, double, len>, rec_size, QUDA_DOUBLE_PRECISION,
-                        field_in);
+      status = QIO_read(infile, rec_info, xml_record_in,
+                        whole ? vput<double, double, len> : vput_window<double, double, len>, rec_size,
+                        QUDA_DOUBLE_PRECISION, arg);
     } else {
-      status
-        = QIO_read(infile, rec_info, xml_record_in, vput<double, float, len>, rec_size, QUDA_SINGLE_PRECISION, field_in);
+      status = QIO_read(infile, rec_info, xml_record_in, whole ? vput<double, float, len> : vput_window<double, float, len>,
+                        rec_size, QUDA_SINGLE_PRECISION, arg);
     }
   } else {
     if (file_prec == QUDA_DOUBLE_PRECISION) {
-      status
-        = QIO_read(infile, rec_info, xml_record_in, vput<float, double, len>, rec_size, QUDA_DOUBLE_PRECISION, field_in);
+      status = QIO_read(infile, rec_info, xml_record_in, whole ? vput<float, double, len> : vput_window<float, double, len>,
+                        rec_size, QUDA_DOUBLE_PRECISION, arg);
     } else {
-      status
-        = QIO_read(infile, rec_info, xml_record_in, vput<float, float, len>, rec_size, QUDA_SINGLE_PRECISION, field_in);
+      status = QIO_read(infile, rec_info, xml_record_in, whole ? vput<float, float, len> : vput_window<float, float, len>,
+                        rec_size, QUDA_SINGLE_PRECISION, arg);
     }
   }
 
@@ -254,16 +281,22 @@ void read_gauge_field(const char *filename, void *gauge[], QudaPrecision precisi
 // count is the number of vectors
 // Ninternal is the size of the "inner struct" (24 for Wilson spinor)
 int read_field(QIO_Reader *infile, int Ninternal, int count, void *field_in[], QudaPrecision cpu_prec,
-               QudaSiteSubset subset, QudaParity parity, int nSpin, int nColor)
+               QudaSiteSubset subset, QudaParity parity, int nSpin, int nColor, int first = 0, int n = -1)
 {
   int status = 0;
   switch (Ninternal) {
-  case 6: status = read_field<6>(infile, count, field_in, cpu_prec, subset, parity, nSpin, nColor); break;
-  case 24: status = read_field<24>(infile, count, field_in, cpu_prec, subset, parity, nSpin, nColor); break;
-  case 96: status = read_field<96>(infile, count, field_in, cpu_prec, subset, parity, nSpin, nColor); break;
-  case 128: status = read_field<128>(infile, count, field_in, cpu_prec, subset, parity, nSpin, nColor); break;
-  case 256: status = read_field<256>(infile, count, field_in, cpu_prec, subset, parity, nSpin, nColor); break;
-  case 384: status = read_field<384>(infile, count, field_in, cpu_prec, subset, parity, nSpin, nColor); break;
+  case 6: status = read_field<6>(infile, count, field_in, cpu_prec, subset, parity, nSpin, nColor, first, n); break;
+  case 24: status = read_field<24>(infile, count, field_in, cpu_prec, subset, parity, nSpin, nColor, first, n); break;
+  case 96: status = read_field<96>(infile, count, field_in, cpu_prec, subset, parity, nSpin, nColor, first, n); break;
+  case 128:
+    status = read_field<128>(infile, count, field_in, cpu_prec, subset, parity, nSpin, nColor, first, n);
+    break;
+  case 256:
+    status = read_field<256>(infile, count, field_in, cpu_prec, subset, parity, nSpin, nColor, first, n);
+    break;
+  case 384:
+    status = read_field<384>(infile, count, field_in, cpu_prec, subset, parity, nSpin, nColor, first, n);
+    break;
   default:
     errorQuda("Undefined %d", Ninternal);
   }
@@ -481,3 +514,95 @@ void write_spinor_field(const char *filename, void *V[], QudaPrecision precision
   QIO_close_write(outfile);
   printfQuda("%s: Closed file for writing\n",__func__);
 }
+
+struct QioSpinorInput {
+  QIO_Reader *reader;
+};
+
+struct QioSpinorOutput {
+  QIO_Writer *writer;
+};
+
+QioSpinorInput *open_spinor_input(const char *filename, const int *X, QudaSiteSubset subset)
+{
+  quda_this_node = QMP_get_node_number();
+
+  set_layout(X, subset);
+
+  QIO_Reader *reader = open_test_input(filename, QIO_UNKNOWN, QIO_PARALLEL);
+  if (reader == NULL) { errorQuda("Open file failed\n"); }
+
+  return new QioSpinorInput {reader};
+}
+
+int next_spinor_record_count(QioSpinorInput *infile, QudaPrecision *precision)
+{
+  // the record info is cached by QIO, so read_field will see this same record
+  char dummy[100] = "";
+  QIO_RecordInfo *rec_info = QIO_create_record_info(0, NULL, NULL, 0, dummy, dummy, 0, 0, 0, 0);
+  QIO_String *xml_record_in = QIO_string_create();
+
+  int status = QIO_read_record_info(infile->reader, rec_info, xml_record_in);
+  int count = status == QIO_SUCCESS ? QIO_get_datacount(rec_info) : 0;
+  if (status != QIO_SUCCESS && status != QIO_EOF) errorQuda("QIO_read_record_info failed %d\n", status);
+  if (precision && count > 0)
+    *precision = *QIO_get_precision(rec_info) == 'F' ? QUDA_SINGLE_PRECISION : QUDA_DOUBLE_PRECISION;
+
+  QIO_string_destroy(xml_record_in);
+  QIO_destroy_record_info(rec_info);
+  return count;
+}
+
+void read_spinor_record(QioSpinorInput *infile, void *V[], QudaPrecision precision, QudaSiteSubset subset,
+                        QudaParity parity, int nColor, int nSpin, int Nvec, int first, int n)
+{
+  if (n < 0) n = Nvec;
+  printfQuda("%s: reading vector fields [%d, %d) of %d\n", __func__, first, first + n, Nvec);
+  int status
+    = read_field(infile->reader, 2 * nSpin * nColor, Nvec, V, precision, subset, parity, nSpin, nColor, first, n);
+  if (status) { errorQuda("read_spinor_record failed %d\n", status); }
+}
+
+void skip_spinor_record(QioSpinorInput *infile)
+{
+  int status = QIO_next_record(infile->reader);
+  if (status != QIO_SUCCESS) { errorQuda("QIO_next_record failed %d\n", status); }
+}
+
+void close_spinor_input(QioSpinorInput *infile)
+{
+  QIO_close_read(infile->reader);
+  delete infile;
+  printfQuda("%s: Closed file for reading\n", __func__);
+}
+
+QioSpinorOutput *open_spinor_output(const char *filename, const int *X, QudaSiteSubset subset)
+{
+  quda_this_node = QMP_get_node_number();
+
+  set_layout(X, subset);
+
+  QIO_Writer *writer = open_test_output(filename, QIO_SINGLEFILE, QIO_PARALLEL, QIO_ILDGNO);
+  if (writer == NULL) { errorQuda("Open file failed\n"); }
+
+  return new QioSpinorOutput {writer};
+}
+
+void write_spinor_record(QioSpinorOutput *outfile, void *V[], QudaPrecision precision, QudaSiteSubset subset,
+                         QudaParity parity, int nColor, int nSpin, int Nvec)
+{
+  char type[128];
+  sprintf(type, "QUDA_%sNs%dNc%d_ColorSpinorField", (precision == QUDA_DOUBLE_PRECISION) ? "D" : "F", nSpin, nColor);
+
+  printfQuda("%s: writing %d vector fields\n", __func__, Nvec);
+  int status
+    = write_field(outfile->writer, 2 * nSpin * nColor, Nvec, V, precision, precision, subset, parity, nSpin, nColor, type);
+  if (status) { errorQuda("write_spinor_record failed %d\n", status); }
+}
+
+void close_spinor_output(QioSpinorOutput *outfile)
+{
+  QIO_close_write(outfile->writer);
+  delete outfile;
+  printfQuda("%s: Closed file for writing\n", __func__);
+}
@@ -78,11 +78,15 @@ namespace quda
 
       if (!reduce_count) {
         reduce_count = static_cast<count_t *>(device_malloc(max_n_reduce() * sizeof(decltype(*reduce_count))));
+#ifdef TARGET_CPU
+        init_count<count_t>(reduce_count); // device memory is host memory
+#else
         TuneParam tp;
         tp.grid = dim3(1, 1, 1);
         tp.block = dim3(1, 1, 1);
 
         qudaLaunchKernel(init_count<count_t>, tp, 0, reduce_count);
+#endif
       }
 
       cudaEventCreateWithFlags(&reduceEnd, cudaEventDisableTiming);
@@ -57,7 +57,7 @@ namespace quda {
 
   template<typename real, typename Arg> __global__ void interiorOprodKernel(Arg arg)
   {
-    using complex = complex<real>;
+    using complex = quda::complex<real>;
     using matrix = Matrix<complex, Arg::nColor>;
     using vector = ColorSpinor<real, Arg::nColor, 1>;
 
@@ -102,7 +102,7 @@ namespace quda {
 
   template<int dim, typename real, typename Arg> __global__ void exteriorOprodKernel(Arg arg)
   {
-    using complex = complex<real>;
+    using complex = quda::complex<real>;
     using matrix = Matrix<complex, Arg::nColor>;
     using vector = ColorSpinor<real, Arg::nColor, 1>;
 
@@ -0,0 +1,29 @@
+#include <blas_lapack.h>
+
+namespace quda
+{
+
+  namespace blas_lapack
+  {
+
+    /**
+       On the CPU target there is no vendor library distinct from the
+       host one, so the native interface forwards to the generic
+       (Eigen) implementation.
+     */
+    namespace native
+    {
+
+      void init() { generic::init(); }
+
+      void destroy() { generic::destroy(); }
+
+      long long BatchInvertMatrix(void *Ainv, void *A, const int n, const uint64_t batch, QudaPrecision prec,
+                                  QudaFieldLocation location)
+      {
+        return generic::BatchInvertMatrix(Ainv, A, n, batch, prec, location);
+      }
+
+    } // namespace native
+  }   // namespace blas_lapack
+} // namespace quda
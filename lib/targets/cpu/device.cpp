@@ -0,0 +1,111 @@
+#include <cuda_runtime.h>
+#include <cuda_profiler_api.h>
+#include <unistd.h> // for gethostname()
+#include <util_quda.h>
+#include <quda_internal.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+cudaDeviceProp deviceProp;
+qudaStream_t *streams;
+
+/**
+   The host presents itself as a single device whose
+   "multiprocessors" are the OpenMP threads, so that heuristics that
+   scale with the device size (e.g., grid sizes in Tunable) remain
+   sensible.  The architecture version is reported as 0.0, which
+   disables all architecture-specific code paths.  Every device
+   ordinal refers to the host, so that several ranks per node work.
+ */
+cudaError_t cudaGetDeviceProperties(cudaDeviceProp *prop, int)
+{
+  *prop = {};
+  char host[128] = {};
+  gethostname(host, sizeof(host) - 1);
+  snprintf(prop->name, sizeof(prop->name), "CPU (%s)", host);
+  prop->major = 0;
+  prop->minor = 0;
+#ifdef _OPENMP
+  prop->multiProcessorCount = omp_get_max_threads();
+#else
+  prop->multiProcessorCount = 1;
+#endif
+  prop->maxThreadsPerBlock = 1024;
+  prop->maxThreadsPerMultiProcessor = 2048;
+  prop->maxThreadsDim[0] = 1024;
+  prop->maxThreadsDim[1] = 1024;
+  prop->maxThreadsDim[2] = 64;
+  prop->maxGridSize[0] = 0x7fffffff;
+  prop->maxGridSize[1] = 65535;
+  prop->maxGridSize[2] = 65535;
+  prop->sharedMemPerBlock = quda_cpu_shared_bytes;
+  prop->warpSize = 1;
+  return cudaSuccess;
+}
+
+cudaError_t cudaDeviceGetAttribute(int *value, cudaDeviceAttr attr, int)
+{
+  switch (attr) {
+  case cudaDevAttrMaxSharedMemoryPerBlockOptin: *value = quda_cpu_shared_bytes; break;
+  case cudaDevAttrMaxBlocksPerMultiprocessor: *value = 1; break;
+  default: return cudaErrorInvalidValue;
+  }
+  return cudaSuccess;
+}
+
+namespace quda
+{
+
+  namespace device
+  {
+
+    static bool initialized = false;
+
+    void init(int dev)
+    {
+      if (initialized) return;
+      initialized = true;
+      printfQuda("*** CPU BACKEND ***\n");
+
+      cudaGetDeviceProperties(&deviceProp, dev);
+      if (getVerbosity() >= QUDA_SUMMARIZE) {
+        printfQuda("Using device %d: %s with %d OpenMP threads\n", dev, deviceProp.name,
+                   deviceProp.multiProcessorCount);
+      }
+    }
+
+    void create_context()
+    {
+      streams = new qudaStream_t[Nstream];
+      for (int i = 0; i < Nstream; i++) cudaStreamCreate(&streams[i]);
+    }
+
+    void destroy()
+    {
+      if (streams) {
+        for (int i = 0; i < Nstream; i++) cudaStreamDestroy(streams[i]);
+        delete[] streams;
+        streams = nullptr;
+      }
+    }
+
+    size_t max_dynamic_shared_memory()
+    {
+      static int max_shared_bytes = 0;
+      if (!max_shared_bytes) cudaDeviceGetAttribute(&max_shared_bytes, cudaDevAttrMaxSharedMemoryPerBlockOptin, 0);
+      return max_shared_bytes;
+    }
+
+    namespace profile
+    {
+
+      void start() { cudaProfilerStart(); }
+
+      void stop() { cudaProfilerStop(); }
+
+    } // namespace profile
+
+  } // namespace device
+} // namespace quda
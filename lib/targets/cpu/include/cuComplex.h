@@ -0,0 +1,18 @@
+#pragma once
+
+/**
+   @file cuComplex.h (CPU target)
+
+   The complex types of the CUDA runtime, which share the layout of
+   the vector types.
+ */
+
+#include <cuda_runtime.h>
+
+typedef float2 cuFloatComplex;
+typedef double2 cuDoubleComplex;
+typedef cuFloatComplex cuComplex;
+
+inline cuFloatComplex make_cuFloatComplex(float x, float y) { return make_float2(x, y); }
+inline cuDoubleComplex make_cuDoubleComplex(double x, double y) { return make_double2(x, y); }
+inline cuComplex make_cuComplex(float x, float y) { return make_float2(x, y); }
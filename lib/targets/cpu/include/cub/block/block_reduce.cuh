@@ -0,0 +1,45 @@
+#pragma once
+
+/**
+   @file block_reduce.cuh (CPU target)
+
+   Host implementation of the cub::BlockReduce interface that QUDA
+   uses.  A thread block on this target is a single thread, so the
+   block reduction of a value is the value itself.
+ */
+
+namespace cub
+{
+
+  enum BlockReduceAlgorithm { BLOCK_REDUCE_RAKING_COMMUTATIVE_ONLY, BLOCK_REDUCE_RAKING, BLOCK_REDUCE_WARP_REDUCTIONS };
+
+  struct Sum {
+    template <typename T> T operator()(const T &a, const T &b) const { return a + b; }
+  };
+
+  struct Max {
+    template <typename T> T operator()(const T &a, const T &b) const { return a < b ? b : a; }
+  };
+
+  struct Min {
+    template <typename T> T operator()(const T &a, const T &b) const { return b < a ? b : a; }
+  };
+
+  template <typename T, int block_dim_x, BlockReduceAlgorithm algorithm = BLOCK_REDUCE_WARP_REDUCTIONS,
+            int block_dim_y = 1, int block_dim_z = 1, int ptx_arch = 0>
+  class BlockReduce
+  {
+  public:
+    struct TempStorage {
+    };
+
+    BlockReduce() = default;
+    BlockReduce(TempStorage &) { }
+
+    T Sum(T input) { return input; }
+    T Sum(T input, int) { return input; }
+    template <typename Reducer> T Reduce(T input, Reducer) { return input; }
+    template <typename Reducer> T Reduce(T input, Reducer, int) { return input; }
+  };
+
+} // namespace cub
@@ -0,0 +1,111 @@
+#pragma once
+
+/**
+   @file cuda.h (CPU target)
+
+   Host implementation of the subset of the CUDA driver API that QUDA
+   uses.  On the CPU target all "device" memory is ordinary host
+   memory, so pointer queries always report host memory and the
+   memory operations reduce to their libc equivalents.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+
+/**
+   The version of the CUDA API that this header emulates.  Code that
+   is conditional on a minimum API version (and not on a GPU
+   architecture, which is zero for this target) takes the newer path.
+ */
+#define CUDA_VERSION 11000
+
+typedef enum cudaError_enum {
+  CUDA_SUCCESS = 0,
+  CUDA_ERROR_INVALID_VALUE = 1,
+  CUDA_ERROR_OUT_OF_MEMORY = 2,
+  CUDA_ERROR_NOT_READY = 600,
+  CUDA_ERROR_NOT_SUPPORTED = 801,
+} CUresult;
+
+typedef unsigned long long CUdeviceptr;
+
+struct CUstream_st {
+};
+typedef CUstream_st *CUstream;
+
+struct CUevent_st {
+  std::chrono::steady_clock::time_point time;
+};
+typedef CUevent_st *CUevent;
+
+typedef enum CUmemorytype_enum {
+  CU_MEMORYTYPE_HOST = 1,
+  CU_MEMORYTYPE_DEVICE = 2,
+  CU_MEMORYTYPE_ARRAY = 3,
+  CU_MEMORYTYPE_UNIFIED = 4
+} CUmemorytype;
+
+typedef enum CUpointer_attribute_enum { CU_POINTER_ATTRIBUTE_MEMORY_TYPE = 2 } CUpointer_attribute;
+
+typedef struct CUDA_MEMCPY2D_st {
+  size_t srcXInBytes;
+  size_t srcY;
+  CUmemorytype srcMemoryType;
+  const void *srcHost;
+  CUdeviceptr srcDevice;
+  size_t srcPitch;
+  size_t dstXInBytes;
+  size_t dstY;
+  CUmemorytype dstMemoryType;
+  void *dstHost;
+  CUdeviceptr dstDevice;
+  size_t dstPitch;
+  size_t WidthInBytes;
+  size_t Height;
+} CUDA_MEMCPY2D;
+
+inline CUresult cuGetErrorName(CUresult error, const char **str)
+{
+  switch (error) {
+  case CUDA_SUCCESS: *str = "CUDA_SUCCESS"; break;
+  case CUDA_ERROR_INVALID_VALUE: *str = "CUDA_ERROR_INVALID_VALUE"; break;
+  case CUDA_ERROR_OUT_OF_MEMORY: *str = "CUDA_ERROR_OUT_OF_MEMORY"; break;
+  case CUDA_ERROR_NOT_READY: *str = "CUDA_ERROR_NOT_READY"; break;
+  case CUDA_ERROR_NOT_SUPPORTED: *str = "CUDA_ERROR_NOT_SUPPORTED"; break;
+  default: *str = "CUDA_ERROR_UNKNOWN"; return CUDA_ERROR_INVALID_VALUE;
+  }
+  return CUDA_SUCCESS;
+}
+
+inline CUresult cuGetErrorString(CUresult error, const char **str) { return cuGetErrorName(error, str); }
+
+inline CUresult cuPointerGetAttributes(unsigned int n, CUpointer_attribute *attr, void **data, CUdeviceptr)
+{
+  for (unsigned int i = 0; i < n; i++) {
+    if (attr[i] != CU_POINTER_ATTRIBUTE_MEMORY_TYPE) return CUDA_ERROR_INVALID_VALUE;
+    *static_cast<CUmemorytype *>(data[i]) = CU_MEMORYTYPE_HOST;
+  }
+  return CUDA_SUCCESS;
+}
+
+inline CUresult cuMemcpy(CUdeviceptr dst, CUdeviceptr src, size_t count)
+{
+  memcpy(reinterpret_cast<void *>(dst), reinterpret_cast<const void *>(src), count);
+  return CUDA_SUCCESS;
+}
+
+inline CUresult cuMemcpy2D(const CUDA_MEMCPY2D *p)
+{
+  const char *src = p->srcMemoryType == CU_MEMORYTYPE_HOST ? static_cast<const char *>(p->srcHost) :
+                                                             reinterpret_cast<const char *>(p->srcDevice);
+  char *dst = p->dstMemoryType == CU_MEMORYTYPE_HOST ? static_cast<char *>(p->dstHost) :
+                                                       reinterpret_cast<char *>(p->dstDevice);
+  src += p->srcY * p->srcPitch + p->srcXInBytes;
+  dst += p->dstY * p->dstPitch + p->dstXInBytes;
+  for (size_t i = 0; i < p->Height; i++) memcpy(dst + i * p->dstPitch, src + i * p->srcPitch, p->WidthInBytes);
+  return CUDA_SUCCESS;
+}
+
+inline CUresult cuCtxSynchronize() { return CUDA_SUCCESS; }
@@ -0,0 +1,11 @@
+#pragma once
+
+/**
+   @file cuda_profiler_api.h (CPU target)
+   @brief Profiler control is a no-op on the host
+ */
+
+#include <cuda_runtime.h>
+
+inline cudaError_t cudaProfilerStart() { return cudaSuccess; }
+inline cudaError_t cudaProfilerStop() { return cudaSuccess; }
@@ -0,0 +1,524 @@
+#pragma once
+
+/**
+   @file cuda_runtime.h (CPU target)
+
+   Host implementation of the subset of the CUDA runtime API, the
+   built-in vector types and the function-space qualifiers that QUDA
+   uses, so that the library can be built with a host C++ compiler
+   only (QUDA_TARGET_TYPE=CPU).  Device memory is host memory, streams
+   and events are host objects, and every operation completes before
+   it returns.
+
+   Device kernels still compile, but cannot be launched:
+   qudaLaunchKernel reports an error on this target.  The code that
+   runs is the QUDA_CPU_FIELD_LOCATION path of each algorithm.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <cuda.h>
+
+// function-space and variable-space qualifiers
+#define __host__
+#define __device__
+#define __global__
+// A thread block runs on a single host thread, so shared memory is
+// thread-local storage.  The dynamic shared memory that kernels
+// declare extern __shared__ is defined in quda_api.cpp, with the size
+// that is reported as sharedMemPerBlock.
+#define __shared__ thread_local
+static constexpr size_t quda_cpu_shared_bytes = 48 * 1024;
+// Without relocatable device code every translation unit has its own
+// copy of a __constant__ variable defined in a header.  On the host
+// these are inline variables instead, so that the definitions are
+// merged rather than duplicated at link time; GCC and Clang accept
+// inline variables before C++17 as an extension.
+#define __constant__ inline
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+#define __managed__
+#define __forceinline__ inline __attribute__((always_inline))
+#define __launch_bounds__(...)
+
+#ifndef __inline__
+#define __inline__ inline
+#endif
+
+#define CUDART_VERSION CUDA_VERSION
+
+// built-in vector types, with the alignment of their CUDA counterparts
+#define QUDA_CPU_VECTOR_TYPE(T, name, align)                                                                           \
+  struct alignas(align) name##1 {                                                                                      \
+    T x;                                                                                                               \
+  };                                                                                                                   \
+  struct alignas(2 * align) name##2 {                                                                                  \
+    T x, y;                                                                                                            \
+  };                                                                                                                   \
+  struct alignas(align) name##3 {                                                                                      \
+    T x, y, z;                                                                                                         \
+  };                                                                                                                   \
+  struct alignas(4 * align) name##4 {                                                                                  \
+    T x, y, z, w;                                                                                                      \
+  };                                                                                                                   \
+  inline name##1 make_##name##1(T x) { return {x}; }                                                                   \
+  inline name##2 make_##name##2(T x, T y) { return {x, y}; }                                                           \
+  inline name##3 make_##name##3(T x, T y, T z) { return {x, y, z}; }                                                   \
+  inline name##4 make_##name##4(T x, T y, T z, T w) { return {x, y, z, w}; }
+
+QUDA_CPU_VECTOR_TYPE(signed char, char, 1)
+QUDA_CPU_VECTOR_TYPE(unsigned char, uchar, 1)
+QUDA_CPU_VECTOR_TYPE(short, short, 2)
+QUDA_CPU_VECTOR_TYPE(unsigned short, ushort, 2)
+QUDA_CPU_VECTOR_TYPE(int, int, 4)
+QUDA_CPU_VECTOR_TYPE(unsigned int, uint, 4)
+QUDA_CPU_VECTOR_TYPE(long, long, 8)
+QUDA_CPU_VECTOR_TYPE(unsigned long, ulong, 8)
+QUDA_CPU_VECTOR_TYPE(long long, longlong, 8)
+QUDA_CPU_VECTOR_TYPE(unsigned long long, ulonglong, 8)
+QUDA_CPU_VECTOR_TYPE(float, float, 4)
+QUDA_CPU_VECTOR_TYPE(double, double, 8)
+
+#undef QUDA_CPU_VECTOR_TYPE
+
+struct dim3 {
+  unsigned int x, y, z;
+  constexpr dim3(unsigned int x = 1, unsigned int y = 1, unsigned int z = 1) : x(x), y(y), z(z) {}
+};
+
+// Kernels are compiled but never launched on this target; these
+// exist only so that kernel bodies are well formed.  As with nvcc, the
+// built-in variables are only visible in the .cu sources, which the
+// build marks with QUDA_CPU_CU_SOURCE, so host sources may use the names.
+#ifdef QUDA_CPU_CU_SOURCE
+static constexpr dim3 threadIdx(0, 0, 0);
+static constexpr dim3 blockIdx(0, 0, 0);
+static constexpr dim3 blockDim(1, 1, 1);
+static constexpr dim3 gridDim(1, 1, 1);
+#endif
+static constexpr int warpSize = 1;
+inline void __syncthreads() {}
+inline void __syncwarp(unsigned int = 0xffffffff) {}
+inline void __threadfence() {}
+
+// math intrinsics
+inline float rsqrtf(float x) { return 1.0f / std::sqrt(x); }
+inline double rsqrt(double x) { return 1.0 / std::sqrt(x); }
+inline float __fdividef(float x, float y) { return x / y; }
+inline float __expf(float x) { return std::exp(x); }
+inline float __logf(float x) { return std::log(x); }
+inline float __sinf(float x) { return std::sin(x); }
+inline float __cosf(float x) { return std::cos(x); }
+inline void sincosf(float x, float *s, float *c)
+{
+  *s = std::sin(x);
+  *c = std::cos(x);
+}
+inline void sincos(double x, double *s, double *c)
+{
+  *s = std::sin(x);
+  *c = std::cos(x);
+}
+inline void sincos(float x, float *s, float *c) { sincosf(x, s, c); }
+inline void sincospif(float x, float *s, float *c) { sincosf(static_cast<float>(M_PI) * x, s, c); }
+inline void sincospi(float x, float *s, float *c) { sincospif(x, s, c); }
+inline void sincospi(double x, double *s, double *c) { sincos(M_PI * x, s, c); }
+inline float __saturatef(float x) { return x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x); }
+inline float __powf(float x, float y) { return std::pow(x, y); }
+inline void __sincosf(float x, float *s, float *c) { sincosf(x, s, c); }
+inline float __fadd_rn(float x, float y) { return x + y; }
+inline float __fmul_rn(float x, float y) { return x * y; }
+inline float __fmaf_rn(float x, float y, float z) { return std::fma(x, y, z); }
+inline double __dadd_rn(double x, double y) { return x + y; }
+inline double __dmul_rn(double x, double y) { return x * y; }
+inline double __fma_rn(double x, double y, double z) { return std::fma(x, y, z); }
+inline float __int2float_rn(int x) { return static_cast<float>(x); }
+inline int __float2int_rn(float x) { return static_cast<int>(std::nearbyint(x)); }
+
+// the CUDA math library declares the classification functions globally
+using std::isfinite;
+using std::isinf;
+using std::isnan;
+
+// reinterpretation of the bits of a value
+template <typename To, typename From> inline To quda_cpu_bit_cast(From x)
+{
+  static_assert(sizeof(To) == sizeof(From), "bit cast between types of different size");
+  To y;
+  memcpy(&y, &x, sizeof(To));
+  return y;
+}
+inline unsigned int __float_as_uint(float x) { return quda_cpu_bit_cast<unsigned int>(x); }
+inline float __uint_as_float(unsigned int x) { return quda_cpu_bit_cast<float>(x); }
+inline int __float_as_int(float x) { return quda_cpu_bit_cast<int>(x); }
+inline float __int_as_float(int x) { return quda_cpu_bit_cast<float>(x); }
+inline long long __double_as_longlong(double x) { return quda_cpu_bit_cast<long long>(x); }
+inline double __longlong_as_double(long long x) { return quda_cpu_bit_cast<double>(x); }
+
+// a warp is a single thread, so warp-level operations are the identity
+inline unsigned int __activemask() { return 1u; }
+template <typename T> inline T __shfl_sync(unsigned int, T var, int, int = warpSize) { return var; }
+template <typename T> inline T __shfl_up_sync(unsigned int, T var, unsigned int, int = warpSize) { return var; }
+template <typename T> inline T __shfl_down_sync(unsigned int, T var, unsigned int, int = warpSize) { return var; }
+template <typename T> inline T __shfl_xor_sync(unsigned int, T var, int, int = warpSize) { return var; }
+inline void __threadfence_block() {}
+inline void __threadfence_system() {}
+
+/**
+   Atomics, which kernels on this target still need when host threads
+   update shared results.  Floating-point updates use a
+   compare-and-swap loop on the bit pattern.
+ */
+template <typename T> inline T quda_cpu_atomic_cas(T *address, T compare, T val)
+{
+  __atomic_compare_exchange_n(address, &compare, val, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  return compare;
+}
+inline int atomicCAS(int *address, int compare, int val) { return quda_cpu_atomic_cas(address, compare, val); }
+inline unsigned int atomicCAS(unsigned int *address, unsigned int compare, unsigned int val)
+{
+  return quda_cpu_atomic_cas(address, compare, val);
+}
+inline unsigned long long atomicCAS(unsigned long long *address, unsigned long long compare, unsigned long long val)
+{
+  return quda_cpu_atomic_cas(address, compare, val);
+}
+
+template <typename T> inline T atomicExch(T *address, T val) { return __atomic_exchange_n(address, val, __ATOMIC_SEQ_CST); }
+
+inline int atomicAdd(int *address, int val) { return __atomic_fetch_add(address, val, __ATOMIC_SEQ_CST); }
+inline unsigned int atomicAdd(unsigned int *address, unsigned int val)
+{
+  return __atomic_fetch_add(address, val, __ATOMIC_SEQ_CST);
+}
+inline unsigned long long atomicAdd(unsigned long long *address, unsigned long long val)
+{
+  return __atomic_fetch_add(address, val, __ATOMIC_SEQ_CST);
+}
+
+template <typename Float, typename Bits> inline Float quda_cpu_atomic_add(Float *address, Float val)
+{
+  Bits *bits = reinterpret_cast<Bits *>(address);
+  Bits old = __atomic_load_n(bits, __ATOMIC_RELAXED);
+  Bits updated;
+  do {
+    updated = quda_cpu_bit_cast<Bits>(quda_cpu_bit_cast<Float>(old) + val);
+  } while (!__atomic_compare_exchange_n(bits, &old, updated, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+  return quda_cpu_bit_cast<Float>(old);
+}
+inline float atomicAdd(float *address, float val) { return quda_cpu_atomic_add<float, unsigned int>(address, val); }
+inline double atomicAdd(double *address, double val)
+{
+  return quda_cpu_atomic_add<double, unsigned long long>(address, val);
+}
+
+template <typename T> inline T atomicMax(T *address, T val)
+{
+  T old = __atomic_load_n(address, __ATOMIC_RELAXED);
+  while (old < val && !__atomic_compare_exchange_n(address, &old, val, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) { }
+  return old;
+}
+
+template <typename T> inline T atomicMin(T *address, T val)
+{
+  T old = __atomic_load_n(address, __ATOMIC_RELAXED);
+  while (val < old && !__atomic_compare_exchange_n(address, &old, val, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) { }
+  return old;
+}
+
+/**
+   @brief As on the device: returns the old value and stores
+   (old >= val) ? 0 : old + 1
+ */
+inline unsigned int atomicInc(unsigned int *address, unsigned int val)
+{
+  unsigned int old = __atomic_load_n(address, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(address, &old, old >= val ? 0u : old + 1, true, __ATOMIC_SEQ_CST,
+                                      __ATOMIC_RELAXED)) { }
+  return old;
+}
+
+typedef enum cudaError {
+  cudaSuccess = 0,
+  cudaErrorInvalidValue = 1,
+  cudaErrorMemoryAllocation = 2,
+  cudaErrorNotReady = 600,
+  cudaErrorNotSupported = 801,
+} cudaError_t;
+
+inline const char *cudaGetErrorString(cudaError_t error)
+{
+  switch (error) {
+  case cudaSuccess: return "no error";
+  case cudaErrorInvalidValue: return "invalid argument";
+  case cudaErrorMemoryAllocation: return "out of memory";
+  case cudaErrorNotReady: return "device not ready";
+  case cudaErrorNotSupported: return "operation not supported on the CPU target";
+  default: return "unknown error";
+  }
+}
+
+inline cudaError_t cudaGetLastError() { return cudaSuccess; }
+inline cudaError_t cudaPeekAtLastError() { return cudaSuccess; }
+
+typedef CUstream cudaStream_t;
+typedef CUevent cudaEvent_t;
+
+enum cudaMemcpyKind {
+  cudaMemcpyHostToHost = 0,
+  cudaMemcpyHostToDevice = 1,
+  cudaMemcpyDeviceToHost = 2,
+  cudaMemcpyDeviceToDevice = 3,
+  cudaMemcpyDefault = 4
+};
+
+static constexpr int cudaCpuDeviceId = -1;
+static constexpr unsigned int cudaStreamDefault = 0x0;
+static constexpr unsigned int cudaEventDefault = 0x0;
+static constexpr unsigned int cudaEventDisableTiming = 0x2;
+static constexpr unsigned int cudaEventInterprocess = 0x4;
+static constexpr unsigned int cudaHostRegisterDefault = 0x0;
+static constexpr unsigned int cudaHostRegisterPortable = 0x1;
+static constexpr unsigned int cudaHostRegisterMapped = 0x2;
+static constexpr unsigned int cudaHostAllocPortable = 0x1;
+static constexpr unsigned int cudaHostAllocMapped = 0x2;
+static constexpr unsigned int cudaIpcMemLazyEnablePeerAccess = 0x1;
+
+/**
+   Only the fields QUDA reads are provided; they are filled in by
+   quda::device::init() from the host properties.
+ */
+struct cudaDeviceProp {
+  char name[256];
+  int major;
+  int minor;
+  int multiProcessorCount;
+  int maxThreadsPerBlock;
+  int maxThreadsPerMultiProcessor;
+  int maxThreadsDim[3];
+  int maxGridSize[3];
+  size_t sharedMemPerBlock;
+  int warpSize;
+  int unifiedAddressing; // zero: no peer-to-peer between host ranks
+};
+
+enum cudaDeviceAttr {
+  cudaDevAttrMaxSharedMemoryPerBlockOptin = 97,
+  cudaDevAttrMaxBlocksPerMultiprocessor = 106
+};
+
+enum cudaDeviceP2PAttr { cudaDevP2PAttrPerformanceRank = 1 };
+
+enum cudaFuncCache { cudaFuncCachePreferNone = 0, cudaFuncCachePreferShared = 1, cudaFuncCachePreferL1 = 2 };
+
+enum cudaFuncAttribute {
+  cudaFuncAttributeMaxDynamicSharedMemorySize = 8,
+  cudaFuncAttributePreferredSharedMemoryCarveout = 9
+};
+
+enum cudaSharedCarveout { cudaSharedmemCarveoutMaxShared = 100 };
+
+struct cudaFuncAttributes {
+  size_t sharedSizeBytes;
+  int maxThreadsPerBlock;
+  int numRegs;
+};
+
+struct cudaIpcMemHandle_t {
+  char reserved[64];
+};
+
+struct cudaIpcEventHandle_t {
+  char reserved[64];
+};
+
+// device management: every device ordinal refers to the host
+inline cudaError_t cudaGetDeviceCount(int *count)
+{
+  *count = 1;
+  return cudaSuccess;
+}
+inline cudaError_t cudaSetDevice(int) { return cudaSuccess; }
+inline cudaError_t cudaGetDevice(int *dev)
+{
+  *dev = 0;
+  return cudaSuccess;
+}
+inline cudaError_t cudaDeviceSynchronize() { return cudaSuccess; }
+inline cudaError_t cudaDeviceReset() { return cudaSuccess; }
+inline cudaError_t cudaDeviceSetCacheConfig(cudaFuncCache) { return cudaSuccess; }
+inline cudaError_t cudaDriverGetVersion(int *version)
+{
+  *version = CUDA_VERSION;
+  return cudaSuccess;
+}
+inline cudaError_t cudaRuntimeGetVersion(int *version)
+{
+  *version = CUDA_VERSION;
+  return cudaSuccess;
+}
+cudaError_t cudaGetDeviceProperties(cudaDeviceProp *prop, int dev);
+cudaError_t cudaDeviceGetAttribute(int *value, cudaDeviceAttr attr, int dev);
+inline cudaError_t cudaDeviceCanAccessPeer(int *can_access, int, int)
+{
+  *can_access = 0;
+  return cudaSuccess;
+}
+inline cudaError_t cudaDeviceGetP2PAttribute(int *value, cudaDeviceP2PAttr, int, int)
+{
+  *value = 0;
+  return cudaSuccess;
+}
+inline cudaError_t cudaFuncSetAttribute(const void *, cudaFuncAttribute, int) { return cudaSuccess; }
+inline cudaError_t cudaFuncGetAttributes(cudaFuncAttributes *attr, const void *)
+{
+  *attr = {};
+  return cudaSuccess;
+}
+
+// memory management
+inline cudaError_t cudaMalloc(void **ptr, size_t size)
+{
+  return posix_memalign(ptr, 128, size ? size : 1) == 0 ? cudaSuccess : cudaErrorMemoryAllocation;
+}
+inline cudaError_t cudaMallocManaged(void **ptr, size_t size) { return cudaMalloc(ptr, size); }
+inline cudaError_t cudaHostAlloc(void **ptr, size_t size, unsigned int) { return cudaMalloc(ptr, size); }
+inline cudaError_t cudaFree(void *ptr)
+{
+  free(ptr);
+  return cudaSuccess;
+}
+inline cudaError_t cudaFreeHost(void *ptr) { return cudaFree(ptr); }
+inline cudaError_t cudaHostRegister(void *, size_t, unsigned int) { return cudaSuccess; }
+inline cudaError_t cudaHostUnregister(void *) { return cudaSuccess; }
+inline cudaError_t cudaHostGetDevicePointer(void **device, void *host, unsigned int)
+{
+  *device = host;
+  return cudaSuccess;
+}
+
+inline cudaError_t cudaMemcpy(void *dst, const void *src, size_t count, cudaMemcpyKind)
+{
+  memcpy(dst, src, count);
+  return cudaSuccess;
+}
+inline cudaError_t cudaMemcpyAsync(void *dst, const void *src, size_t count, cudaMemcpyKind kind, cudaStream_t = 0)
+{
+  return cudaMemcpy(dst, src, count, kind);
+}
+inline cudaError_t cudaMemcpy2D(void *dst, size_t dpitch, const void *src, size_t spitch, size_t width, size_t height,
+                                cudaMemcpyKind)
+{
+  for (size_t i = 0; i < height; i++)
+    memcpy(static_cast<char *>(dst) + i * dpitch, static_cast<const char *>(src) + i * spitch, width);
+  return cudaSuccess;
+}
+inline cudaError_t cudaMemcpy2DAsync(void *dst, size_t dpitch, const void *src, size_t spitch, size_t width,
+                                     size_t height, cudaMemcpyKind kind, cudaStream_t = 0)
+{
+  return cudaMemcpy2D(dst, dpitch, src, spitch, width, height, kind);
+}
+inline cudaError_t cudaMemset(void *ptr, int value, size_t count)
+{
+  memset(ptr, value, count);
+  return cudaSuccess;
+}
+inline cudaError_t cudaMemsetAsync(void *ptr, int value, size_t count, cudaStream_t = 0)
+{
+  return cudaMemset(ptr, value, count);
+}
+inline cudaError_t cudaMemset2D(void *ptr, size_t pitch, int value, size_t width, size_t height)
+{
+  for (size_t i = 0; i < height; i++) memset(static_cast<char *>(ptr) + i * pitch, value, width);
+  return cudaSuccess;
+}
+inline cudaError_t cudaMemset2DAsync(void *ptr, size_t pitch, int value, size_t width, size_t height, cudaStream_t = 0)
+{
+  return cudaMemset2D(ptr, pitch, value, width, height);
+}
+// __constant__ symbols are ordinary host objects
+template <typename T>
+inline cudaError_t cudaMemcpyToSymbol(T &symbol, const void *src, size_t count, size_t offset = 0,
+                                      cudaMemcpyKind = cudaMemcpyHostToDevice)
+{
+  memcpy(reinterpret_cast<char *>(&symbol) + offset, src, count);
+  return cudaSuccess;
+}
+template <typename T>
+inline cudaError_t cudaMemcpyToSymbolAsync(T &symbol, const void *src, size_t count, size_t offset = 0,
+                                           cudaMemcpyKind kind = cudaMemcpyHostToDevice, cudaStream_t = 0)
+{
+  return cudaMemcpyToSymbol(symbol, src, count, offset, kind);
+}
+template <typename T>
+inline cudaError_t cudaMemcpyFromSymbol(void *dst, const T &symbol, size_t count, size_t offset = 0,
+                                        cudaMemcpyKind = cudaMemcpyDeviceToHost)
+{
+  memcpy(dst, reinterpret_cast<const char *>(&symbol) + offset, count);
+  return cudaSuccess;
+}
+template <typename T> inline cudaError_t cudaGetSymbolAddress(void **ptr, T &symbol)
+{
+  *ptr = &symbol;
+  return cudaSuccess;
+}
+inline cudaError_t cudaMemPrefetchAsync(const void *, size_t, int, cudaStream_t = 0) { return cudaSuccess; }
+
+// streams: all work is complete on return, so streams carry no state
+inline cudaError_t cudaStreamCreate(cudaStream_t *stream)
+{
+  *stream = new CUstream_st;
+  return cudaSuccess;
+}
+inline cudaError_t cudaStreamCreateWithPriority(cudaStream_t *stream, unsigned int, int)
+{
+  return cudaStreamCreate(stream);
+}
+inline cudaError_t cudaStreamDestroy(cudaStream_t stream)
+{
+  delete stream;
+  return cudaSuccess;
+}
+inline cudaError_t cudaStreamSynchronize(cudaStream_t) { return cudaSuccess; }
+inline cudaError_t cudaStreamWaitEvent(cudaStream_t, cudaEvent_t, unsigned int) { return cudaSuccess; }
+inline cudaError_t cudaDeviceGetStreamPriorityRange(int *least, int *greatest)
+{
+  *least = 0;
+  *greatest = 0;
+  return cudaSuccess;
+}
+
+// events record the host time at which they are recorded
+inline cudaError_t cudaEventCreate(cudaEvent_t *event)
+{
+  *event = new CUevent_st;
+  (*event)->time = std::chrono::steady_clock::now();
+  return cudaSuccess;
+}
+inline cudaError_t cudaEventCreateWithFlags(cudaEvent_t *event, unsigned int) { return cudaEventCreate(event); }
+inline cudaError_t cudaEventCreate(cudaEvent_t *event, unsigned int) { return cudaEventCreate(event); }
+inline cudaError_t cudaEventDestroy(cudaEvent_t event)
+{
+  delete event;
+  return cudaSuccess;
+}
+inline cudaError_t cudaEventRecord(cudaEvent_t event, cudaStream_t = 0)
+{
+  event->time = std::chrono::steady_clock::now();
+  return cudaSuccess;
+}
+inline cudaError_t cudaEventSynchronize(cudaEvent_t) { return cudaSuccess; }
+inline cudaError_t cudaEventQuery(cudaEvent_t) { return cudaSuccess; }
+inline cudaError_t cudaEventElapsedTime(float *ms, cudaEvent_t start, cudaEvent_t end)
+{
+  *ms = std::chrono::duration<float, std::milli>(end->time - start->time).count();
+  return cudaSuccess;
+}
+
+// inter-process communication is not available between host processes
+inline cudaError_t cudaIpcGetMemHandle(cudaIpcMemHandle_t *, void *) { return cudaErrorNotSupported; }
+inline cudaError_t cudaIpcOpenMemHandle(void **, cudaIpcMemHandle_t, unsigned int) { return cudaErrorNotSupported; }
+inline cudaError_t cudaIpcCloseMemHandle(void *) { return cudaErrorNotSupported; }
+inline cudaError_t cudaIpcGetEventHandle(cudaIpcEventHandle_t *, cudaEvent_t) { return cudaErrorNotSupported; }
+inline cudaError_t cudaIpcOpenEventHandle(cudaEvent_t *, cudaIpcEventHandle_t) { return cudaErrorNotSupported; }
@@ -0,0 +1,8 @@
+#pragma once
+
+/**
+   @file cuda_runtime_api.h (CPU target)
+   @brief See cuda_runtime.h
+ */
+
+#include <cuda_runtime.h>
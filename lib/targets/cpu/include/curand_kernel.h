@@ -0,0 +1,271 @@
+#pragma once
+
+/**
+   @file curand_kernel.h (CPU target)
+
+   Host implementation of the device API of cuRAND that QUDA uses: the
+   MRG32k3a and XORWOW generator states, curand_init and the uniform
+   and normal distributions.  MRG32k3a follows L'Ecuyer's recurrence,
+   and subsequences are separated by 2^76 steps as on the device, so
+   states initialized with different subsequences are independent.
+   The seeding is not bitwise compatible with cuRAND, so a given seed
+   produces a different, equally valid, sequence on this target.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cuda_runtime.h>
+
+struct curandStateMRG32k3a {
+  unsigned int s1[3], s2[3];
+  int boxmuller_flag;
+  int boxmuller_flag_double;
+  float boxmuller_extra;
+  double boxmuller_extra_double;
+};
+
+struct curandStateXORWOW {
+  unsigned int d, v[5];
+  int boxmuller_flag;
+  int boxmuller_flag_double;
+  float boxmuller_extra;
+  double boxmuller_extra_double;
+};
+
+typedef struct curandStateMRG32k3a curandStateMRG32k3a_t;
+typedef struct curandStateXORWOW curandStateXORWOW_t;
+typedef struct curandStateXORWOW curandState_t;
+typedef struct curandStateXORWOW curandState;
+
+namespace quda
+{
+  namespace cpu_curand
+  {
+
+    constexpr uint64_t mrg_m1 = 4294967087ull;
+    constexpr uint64_t mrg_m2 = 4294944443ull;
+    constexpr double mrg_norm = 2.328306549295728e-10;
+
+    // (x_{n-3}, x_{n-2}, x_{n-1}) -> (x_{n-2}, x_{n-1}, x_n) for each component
+    constexpr uint64_t mrg_a1[3][3] = {{0, 1, 0}, {0, 0, 1}, {mrg_m1 - 810728, 1403580, 0}};
+    constexpr uint64_t mrg_a2[3][3] = {{0, 1, 0}, {0, 0, 1}, {mrg_m2 - 1370589, 0, 527612}};
+
+    struct Matrix {
+      uint64_t a[3][3];
+    };
+
+    inline Matrix multiply(const Matrix &x, const Matrix &y, uint64_t m)
+    {
+      Matrix z;
+      for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++) {
+          uint64_t sum = 0;
+          for (int k = 0; k < 3; k++) sum = (sum + x.a[i][k] * y.a[k][j] % m) % m;
+          z.a[i][j] = sum;
+        }
+      return z;
+    }
+
+    inline void apply(const Matrix &x, unsigned int s[3], uint64_t m)
+    {
+      uint64_t r[3];
+      for (int i = 0; i < 3; i++) {
+        uint64_t sum = 0;
+        for (int k = 0; k < 3; k++) sum = (sum + x.a[i][k] * s[k] % m) % m;
+        r[i] = sum;
+      }
+      for (int i = 0; i < 3; i++) s[i] = static_cast<unsigned int>(r[i]);
+    }
+
+    /**
+       @brief The transition matrices A^(2^k) of both components, for
+       k < 128, computed once by repeated squaring
+     */
+    struct SkipTable {
+      Matrix a1[128], a2[128];
+      SkipTable()
+      {
+        for (int i = 0; i < 3; i++)
+          for (int j = 0; j < 3; j++) {
+            a1[0].a[i][j] = mrg_a1[i][j];
+            a2[0].a[i][j] = mrg_a2[i][j];
+          }
+        for (int k = 1; k < 128; k++) {
+          a1[k] = multiply(a1[k - 1], a1[k - 1], mrg_m1);
+          a2[k] = multiply(a2[k - 1], a2[k - 1], mrg_m2);
+        }
+      }
+    };
+
+    inline const SkipTable &skipTable()
+    {
+      static const SkipTable table;
+      return table;
+    }
+
+    /**
+       @brief Advance the state by n * 2^shift steps
+     */
+    inline void skip(curandStateMRG32k3a *state, unsigned long long n, int shift)
+    {
+      const SkipTable &table = skipTable();
+      for (int k = 0; n && k + shift < 128; k++, n >>= 1) {
+        if (n & 1) {
+          apply(table.a1[k + shift], state->s1, mrg_m1);
+          apply(table.a2[k + shift], state->s2, mrg_m2);
+        }
+      }
+    }
+
+    /**
+       @brief Step the generator, returning an integer in [1, m1]
+     */
+    inline uint64_t next(curandStateMRG32k3a *state)
+    {
+      uint64_t p1 = (1403580ull * state->s1[1] + (mrg_m1 - 810728ull) * state->s1[0] % mrg_m1) % mrg_m1;
+      state->s1[0] = state->s1[1];
+      state->s1[1] = state->s1[2];
+      state->s1[2] = static_cast<unsigned int>(p1);
+
+      uint64_t p2 = (527612ull * state->s2[2] + (mrg_m2 - 1370589ull) * state->s2[0] % mrg_m2) % mrg_m2;
+      state->s2[0] = state->s2[1];
+      state->s2[1] = state->s2[2];
+      state->s2[2] = static_cast<unsigned int>(p2);
+
+      return p1 > p2 ? p1 - p2 : p1 + mrg_m1 - p2;
+    }
+
+    inline unsigned int next(curandStateXORWOW *state)
+    {
+      unsigned int t = state->v[0] ^ (state->v[0] >> 2);
+      state->v[0] = state->v[1];
+      state->v[1] = state->v[2];
+      state->v[2] = state->v[3];
+      state->v[3] = state->v[4];
+      state->v[4] = (state->v[4] ^ (state->v[4] << 4)) ^ (t ^ (t << 1));
+      state->d += 362437;
+      return state->v[4] + state->d;
+    }
+
+    inline uint64_t splitmix64(uint64_t &x)
+    {
+      uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+      return z ^ (z >> 31);
+    }
+
+  } // namespace cpu_curand
+} // namespace quda
+
+/**
+   @brief Initialize a MRG32k3a state.  Each subsequence starts 2^76
+   steps after the previous one, and offset skips within it.
+ */
+inline void curand_init(unsigned long long seed, unsigned long long subsequence, unsigned long long offset,
+                        curandStateMRG32k3a *state)
+{
+  using namespace quda::cpu_curand;
+  uint64_t x = seed;
+  for (int i = 0; i < 3; i++) {
+    // each component must be nonzero and below its modulus
+    state->s1[i] = static_cast<unsigned int>(splitmix64(x) % (mrg_m1 - 1) + 1);
+    state->s2[i] = static_cast<unsigned int>(splitmix64(x) % (mrg_m2 - 1) + 1);
+  }
+  skip(state, subsequence, 76);
+  skip(state, offset, 0);
+  state->boxmuller_flag = 0;
+  state->boxmuller_flag_double = 0;
+  state->boxmuller_extra = 0.0f;
+  state->boxmuller_extra_double = 0.0;
+}
+
+/**
+   @brief Initialize a XORWOW state.  Subsequences are decorrelated by
+   hashing them into the seed rather than by skipping ahead.
+ */
+inline void curand_init(unsigned long long seed, unsigned long long subsequence, unsigned long long offset,
+                        curandStateXORWOW *state)
+{
+  using namespace quda::cpu_curand;
+  uint64_t y = subsequence;
+  uint64_t x = seed ^ (splitmix64(y) << 1);
+  for (int i = 0; i < 5; i++) {
+    state->v[i] = static_cast<unsigned int>(splitmix64(x));
+    if (state->v[i] == 0) state->v[i] = 0x2545f491u;
+  }
+  state->d = 6615241u;
+  for (unsigned long long i = 0; i < offset; i++) next(state);
+  state->boxmuller_flag = 0;
+  state->boxmuller_flag_double = 0;
+  state->boxmuller_extra = 0.0f;
+  state->boxmuller_extra_double = 0.0;
+}
+
+inline unsigned int curand(curandStateMRG32k3a *state)
+{
+  return static_cast<unsigned int>(quda::cpu_curand::next(state) * quda::cpu_curand::mrg_norm * 4294967296.0);
+}
+
+inline unsigned int curand(curandStateXORWOW *state) { return quda::cpu_curand::next(state); }
+
+/**
+   @brief Uniform in (0, 1]
+ */
+inline float curand_uniform(curandStateMRG32k3a *state)
+{
+  return static_cast<float>(quda::cpu_curand::next(state) * quda::cpu_curand::mrg_norm);
+}
+
+inline double curand_uniform_double(curandStateMRG32k3a *state)
+{
+  return quda::cpu_curand::next(state) * quda::cpu_curand::mrg_norm;
+}
+
+inline float curand_uniform(curandStateXORWOW *state)
+{
+  return (quda::cpu_curand::next(state) + 1.0f) * 2.3283064e-10f;
+}
+
+inline double curand_uniform_double(curandStateXORWOW *state)
+{
+  uint64_t hi = quda::cpu_curand::next(state);
+  uint64_t lo = quda::cpu_curand::next(state);
+  return (((hi << 32 | lo) >> 11) + 1.0) * 1.1102230246251565e-16;
+}
+
+/**
+   @brief Normal deviates by the Box-Muller transform, which produces
+   them in pairs; the second of each pair is kept in the state
+ */
+template <typename State> inline float curand_normal(State *state)
+{
+  if (state->boxmuller_flag) {
+    state->boxmuller_flag = 0;
+    return state->boxmuller_extra;
+  }
+  float u = curand_uniform(state);
+  float v = curand_uniform(state);
+  float r = std::sqrt(-2.0f * std::log(u));
+  float s, c;
+  sincospif(2.0f * v, &s, &c);
+  state->boxmuller_extra = r * s;
+  state->boxmuller_flag = 1;
+  return r * c;
+}
+
+template <typename State> inline double curand_normal_double(State *state)
+{
+  if (state->boxmuller_flag_double) {
+    state->boxmuller_flag_double = 0;
+    return state->boxmuller_extra_double;
+  }
+  double u = curand_uniform_double(state);
+  double v = curand_uniform_double(state);
+  double r = std::sqrt(-2.0 * std::log(u));
+  double s, c;
+  sincospi(2.0 * v, &s, &c);
+  state->boxmuller_extra_double = r * s;
+  state->boxmuller_flag_double = 1;
+  return r * c;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+/**
+   @file shfl.h (CPU target)
+
+   The generic shuffles of arbitrary types.  A warp on this target is
+   a single thread, so the shuffles of cuda_runtime.h, which return
+   their argument for any type, already cover them.
+ */
+
+#include <cuda_runtime.h>
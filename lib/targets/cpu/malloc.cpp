@@ -0,0 +1,479 @@
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <map>
+#include <mutex>
+#include <unistd.h>   // for getpagesize()
+#include <execinfo.h> // for backtrace
+#include <quda_internal.h>
+
+#ifdef USE_QDPJIT
+#include "qdp_quda.h"
+#include "qdp_config.h"
+#endif
+
+#ifdef QUDA_BACKWARDSCPP
+#include "backward.hpp"
+#endif
+namespace quda
+{
+
+  enum AllocType { DEVICE, DEVICE_PINNED, HOST, PINNED, MAPPED, MANAGED, N_ALLOC_TYPE };
+
+  class MemAlloc
+  {
+
+  public:
+    std::string func;
+    std::string file;
+    int line;
+    size_t size;
+    size_t base_size;
+#ifdef QUDA_BACKWARDSCPP
+    backward::StackTrace st;
+#endif
+
+    MemAlloc() : line(-1), size(0), base_size(0) {}
+
+    MemAlloc(std::string func, std::string file, int line) : func(func), file(file), line(line), size(0), base_size(0)
+    {
+#ifdef QUDA_BACKWARDSCPP
+      st.load_here(32);
+      st.skip_n_firsts(1);
+#endif
+    }
+
+    MemAlloc &operator=(const MemAlloc &a)
+    {
+      if (&a != this) {
+        func = a.func;
+        file = a.file;
+        line = a.line;
+        size = a.size;
+        base_size = a.base_size;
+#ifdef QUDA_BACKWARDSCPP
+        st = a.st;
+#endif
+      }
+      return *this;
+    }
+  };
+
+  static std::map<void *, MemAlloc> alloc[N_ALLOC_TYPE];
+  static std::mutex alloc_mutex; // ranks of the threaded comms backend allocate concurrently
+  static long total_bytes[N_ALLOC_TYPE] = {0};
+  static long max_total_bytes[N_ALLOC_TYPE] = {0};
+  static long total_host_bytes, max_total_host_bytes;
+  static long total_pinned_bytes, max_total_pinned_bytes;
+
+  long device_allocated_peak() { return max_total_bytes[DEVICE]; }
+
+  long pinned_allocated_peak() { return max_total_bytes[PINNED]; }
+
+  long mapped_allocated_peak() { return max_total_bytes[MAPPED]; }
+
+  long managed_allocated_peak() { return max_total_bytes[MANAGED]; }
+
+  long host_allocated_peak() { return max_total_bytes[HOST]; }
+
+  static void print_trace(void)
+  {
+    void *array[10];
+    size_t size;
+    char **strings;
+    size = backtrace(array, 10);
+    strings = backtrace_symbols(array, size);
+    printfQuda("Obtained %zd stack frames.\n", size);
+    for (size_t i = 0; i < size; i++) printfQuda("%s\n", strings[i]);
+    free(strings);
+  }
+
+  static void print_alloc_header()
+  {
+    printfQuda("Type    Pointer          Size             Location\n");
+    printfQuda("----------------------------------------------------------\n");
+  }
+
+  static void print_alloc(AllocType type)
+  {
+    const char *type_str[] = {"Device", "Device Pinned", "Host  ", "Pinned", "Mapped", "Managed"};
+    std::map<void *, MemAlloc>::iterator entry;
+
+    for (entry = alloc[type].begin(); entry != alloc[type].end(); entry++) {
+      void *ptr = entry->first;
+      MemAlloc a = entry->second;
+      printfQuda("%s  %15p  %15lu  %s(), %s:%d\n", type_str[type], ptr, (unsigned long)a.base_size, a.func.c_str(),
+                 a.file.c_str(), a.line);
+#ifdef QUDA_BACKWARDSCPP
+      if (getRankVerbosity()) {
+        backward::Printer p;
+        p.print(a.st);
+      }
+#endif
+    }
+  }
+
+  static void track_malloc(const AllocType &type, const MemAlloc &a, void *ptr)
+  {
+    std::lock_guard<std::mutex> lock(alloc_mutex);
+    total_bytes[type] += a.base_size;
+    if (total_bytes[type] > max_total_bytes[type]) { max_total_bytes[type] = total_bytes[type]; }
+    if (type != DEVICE && type != DEVICE_PINNED) {
+      total_host_bytes += a.base_size;
+      if (total_host_bytes > max_total_host_bytes) { max_total_host_bytes = total_host_bytes; }
+    }
+    if (type == PINNED || type == MAPPED) {
+      total_pinned_bytes += a.base_size;
+      if (total_pinned_bytes > max_total_pinned_bytes) { max_total_pinned_bytes = total_pinned_bytes; }
+    }
+    alloc[type][ptr] = a;
+  }
+
+  static void track_free(const AllocType &type, void *ptr)
+  {
+    std::lock_guard<std::mutex> lock(alloc_mutex);
+    size_t size = alloc[type][ptr].base_size;
+    total_bytes[type] -= size;
+    if (type != DEVICE && type != DEVICE_PINNED) { total_host_bytes -= size; }
+    if (type == PINNED || type == MAPPED) { total_pinned_bytes -= size; }
+    alloc[type].erase(ptr);
+  }
+
+  static bool tracked(const AllocType &type, void *ptr)
+  {
+    std::lock_guard<std::mutex> lock(alloc_mutex);
+    return alloc[type].count(ptr);
+  }
+
+
+  /**
+   * Page-aligned host allocation, used for the pinned and mapped
+   * allocations so that their alignment matches the GPU targets.
+   */
+  static void *aligned_malloc(MemAlloc &a, size_t size)
+  {
+    void *ptr = nullptr;
+
+    a.size = size;
+
+    static int page_size = 2 * getpagesize();
+    a.base_size = ((size + page_size - 1) / page_size) * page_size; // round up to the nearest multiple of page_size
+    int align = posix_memalign(&ptr, page_size, a.base_size);
+    if (!ptr || align != 0) {
+      errorQuda("Failed to allocate aligned host memory of size %zu (%s:%d in %s())\n", size, a.file.c_str(), a.line,
+                a.func.c_str());
+    }
+    return ptr;
+  }
+
+  bool use_managed_memory()
+  {
+    static bool managed = false;
+    static bool init = false;
+
+    if (!init) {
+      char *enable_managed_memory = getenv("QUDA_ENABLE_MANAGED_MEMORY");
+      if (enable_managed_memory && strcmp(enable_managed_memory, "1") == 0) {
+        warningQuda("Using managed memory for CPU allocations");
+        managed = true;
+      }
+
+      init = true;
+    }
+
+    return managed;
+  }
+
+  bool is_prefetch_enabled()
+  {
+    static bool prefetch = false;
+    static bool init = false;
+
+    if (!init) {
+      if (use_managed_memory()) {
+        char *enable_managed_prefetch = getenv("QUDA_ENABLE_MANAGED_PREFETCH");
+        if (enable_managed_prefetch && strcmp(enable_managed_prefetch, "1") == 0) {
+          warningQuda("Enabling prefetch support for managed memory");
+          prefetch = true;
+        }
+      }
+
+      init = true;
+    }
+
+    return prefetch;
+  }
+
+  /**
+   * Allocate "device" memory, which on the CPU target is aligned host
+   * memory that is tracked separately from host allocations so that
+   * get_pointer_location() can tell them apart.  This function should
+   * only be called via the device_malloc() macro, defined in
+   * malloc_quda.h
+   */
+  void *device_malloc_(const char *func, const char *file, int line, size_t size)
+  {
+    if (use_managed_memory()) return managed_malloc_(func, file, line, size);
+
+#ifndef QDP_USE_CUDA_MANAGED_MEMORY
+    MemAlloc a(func, file, line);
+    void *ptr;
+
+    a.size = a.base_size = size;
+
+    cudaError_t err = cudaMalloc(&ptr, size);
+    if (err != cudaSuccess) {
+      errorQuda("Failed to allocate device memory of size %zu (%s:%d in %s())\n", size, file, line, func);
+    }
+    track_malloc(DEVICE, a, ptr);
+#ifdef HOST_DEBUG
+    qudaMemset(ptr, 0xff, size);
+#endif
+    return ptr;
+#else
+    // when QDO uses managed memory we can bypass the QDP memory manager
+    return device_pinned_malloc_(func, file, line, size);
+#endif
+  }
+
+  /**
+   * Allocate device memory that is not redirected by a memory
+   * manager.  There is no peer-to-peer access between host processes,
+   * so this is normally forwarded to device_malloc_().  This should
+   * only be called via the device_pinned_malloc() macro, defined in
+   * malloc_quda.h.
+   */
+  void *device_pinned_malloc_(const char *func, const char *file, int line, size_t size)
+  {
+    if (!comm_peer2peer_present()) return device_malloc_(func, file, line, size);
+
+    MemAlloc a(func, file, line);
+    void *ptr;
+
+    a.size = a.base_size = size;
+
+    cudaError_t err = cudaMalloc(&ptr, size);
+    if (err != cudaSuccess) {
+      errorQuda("Failed to allocate device memory of size %zu (%s:%d in %s())\n", size, file, line, func);
+    }
+    track_malloc(DEVICE_PINNED, a, ptr);
+#ifdef HOST_DEBUG
+    qudaMemset(ptr, 0xff, size);
+#endif
+    return ptr;
+  }
+
+  /**
+   * Perform a standard malloc() with error-checking.  This function
+   * should only be called via the safe_malloc() macro, defined in
+   * malloc_quda.h
+   */
+  void *safe_malloc_(const char *func, const char *file, int line, size_t size)
+  {
+    MemAlloc a(func, file, line);
+    a.size = a.base_size = size;
+
+    void *ptr = malloc(size);
+    if (!ptr) { errorQuda("Failed to allocate host memory of size %zu (%s:%d in %s())\n", size, file, line, func); }
+    track_malloc(HOST, a, ptr);
+#ifdef HOST_DEBUG
+    memset(ptr, 0xff, size);
+#endif
+    return ptr;
+  }
+
+  /**
+   * Allocate page-locked ("pinned") host memory.  This function
+   * should only be called via the pinned_malloc() macro, defined in
+   * malloc_quda.h
+   *
+   * On the CPU target there is nothing to register, so this is a
+   * page-aligned host allocation.
+   */
+  void *pinned_malloc_(const char *func, const char *file, int line, size_t size)
+  {
+    MemAlloc a(func, file, line);
+    void *ptr = aligned_malloc(a, size);
+    track_malloc(PINNED, a, ptr);
+#ifdef HOST_DEBUG
+    memset(ptr, 0xff, a.base_size);
+#endif
+    return ptr;
+  }
+
+  /**
+   * Allocate host memory that is visible to the "device".  On the CPU
+   * target the device view is the host pointer itself.  This function
+   * should only be called via the mapped_malloc() macro, defined in
+   * malloc_quda.h
+   */
+  void *mapped_malloc_(const char *func, const char *file, int line, size_t size)
+  {
+    MemAlloc a(func, file, line);
+    void *ptr = aligned_malloc(a, size);
+    track_malloc(MAPPED, a, ptr);
+#ifdef HOST_DEBUG
+    memset(ptr, 0xff, a.base_size);
+#endif
+    return ptr;
+  }
+
+  /**
+   * Allocate managed memory, which on the CPU target is the same as
+   * device memory.  This function should only be called via the
+   * managed_malloc() macro, defined in malloc_quda.h
+   */
+  void *managed_malloc_(const char *func, const char *file, int line, size_t size)
+  {
+    MemAlloc a(func, file, line);
+    void *ptr;
+
+    a.size = a.base_size = size;
+
+    cudaError_t err = cudaMallocManaged(&ptr, size);
+    if (err != cudaSuccess) {
+      errorQuda("Failed to allocate managed memory of size %zu (%s:%d in %s())\n", size, file, line, func);
+    }
+    track_malloc(MANAGED, a, ptr);
+#ifdef HOST_DEBUG
+    qudaMemset(ptr, 0xff, size);
+#endif
+    return ptr;
+  }
+
+  /**
+   * Free device memory allocated with device_malloc().  This function
+   * should only be called via the device_free() macro, defined in
+   * malloc_quda.h
+   */
+  void device_free_(const char *func, const char *file, int line, void *ptr)
+  {
+    if (use_managed_memory()) {
+      managed_free_(func, file, line, ptr);
+      return;
+    }
+
+#ifndef QDP_USE_CUDA_MANAGED_MEMORY
+    if (!ptr) { errorQuda("Attempt to free NULL device pointer (%s:%d in %s())\n", file, line, func); }
+    if (!tracked(DEVICE, ptr)) {
+      errorQuda("Attempt to free invalid device pointer (%s:%d in %s())\n", file, line, func);
+    }
+    cudaError_t err = cudaFree(ptr);
+    if (err != cudaSuccess) { errorQuda("Failed to free device memory (%s:%d in %s())\n", file, line, func); }
+    track_free(DEVICE, ptr);
+#else
+    device_pinned_free_(func, file, line, ptr);
+#endif
+  }
+
+  /**
+   * Free device memory allocated with device_pinned malloc().  This
+   * function should only be called via the device_pinned_free()
+   * macro, defined in malloc_quda.h
+   */
+  void device_pinned_free_(const char *func, const char *file, int line, void *ptr)
+  {
+    if (!comm_peer2peer_present()) {
+      device_free_(func, file, line, ptr);
+      return;
+    }
+
+    if (!ptr) { errorQuda("Attempt to free NULL device pointer (%s:%d in %s())\n", file, line, func); }
+    if (!tracked(DEVICE_PINNED, ptr)) {
+      errorQuda("Attempt to free invalid device pointer (%s:%d in %s())\n", file, line, func);
+    }
+    cudaError_t err = cudaFree(ptr);
+    if (err != cudaSuccess) { printfQuda("Failed to free device memory (%s:%d in %s())\n", file, line, func); }
+    track_free(DEVICE_PINNED, ptr);
+  }
+
+  /**
+   * Free device memory allocated with device_malloc().  This function
+   * should only be called via the device_free() macro, defined in
+   * malloc_quda.h
+   */
+  void managed_free_(const char *func, const char *file, int line, void *ptr)
+  {
+    if (!ptr) { errorQuda("Attempt to free NULL managed pointer (%s:%d in %s())\n", file, line, func); }
+    if (!tracked(MANAGED, ptr)) {
+      errorQuda("Attempt to free invalid managed pointer (%s:%d in %s())\n", file, line, func);
+    }
+    cudaError_t err = cudaFree(ptr);
+    if (err != cudaSuccess) { errorQuda("Failed to free device memory (%s:%d in %s())\n", file, line, func); }
+    track_free(MANAGED, ptr);
+  }
+
+  /**
+   * Free host memory allocated with safe_malloc(), pinned_malloc(),
+   * or mapped_malloc().  This function should only be called via the
+   * host_free() macro, defined in malloc_quda.h
+   */
+  void host_free_(const char *func, const char *file, int line, void *ptr)
+  {
+    if (!ptr) { errorQuda("Attempt to free NULL host pointer (%s:%d in %s())\n", file, line, func); }
+    if (tracked(HOST, ptr)) {
+      track_free(HOST, ptr);
+      free(ptr);
+    } else if (tracked(PINNED, ptr)) {
+      track_free(PINNED, ptr);
+      free(ptr);
+    } else if (tracked(MAPPED, ptr)) {
+      track_free(MAPPED, ptr);
+      free(ptr);
+    } else {
+      printfQuda("ERROR: Attempt to free invalid host pointer (%s:%d in %s())\n", file, line, func);
+      print_trace();
+      errorQuda("Aborting");
+    }
+  }
+
+  void printPeakMemUsage()
+  {
+    printfQuda("Device memory used = %.1f MB\n", max_total_bytes[DEVICE] / (double)(1 << 20));
+    printfQuda("Pinned device memory used = %.1f MB\n", max_total_bytes[DEVICE_PINNED] / (double)(1 << 20));
+    printfQuda("Managed memory used = %.1f MB\n", max_total_bytes[MANAGED] / (double)(1 << 20));
+    printfQuda("Page-locked host memory used = %.1f MB\n", max_total_pinned_bytes / (double)(1 << 20));
+    printfQuda("Total host memory used >= %.1f MB\n", max_total_host_bytes / (double)(1 << 20));
+  }
+
+  void assertAllMemFree()
+  {
+    if (!alloc[DEVICE].empty() || !alloc[DEVICE_PINNED].empty() || !alloc[HOST].empty() || !alloc[PINNED].empty()
+        || !alloc[MAPPED].empty()) {
+      warningQuda("The following internal memory allocations were not freed.");
+      printfQuda("\n");
+      print_alloc_header();
+      print_alloc(DEVICE);
+      print_alloc(DEVICE_PINNED);
+      print_alloc(HOST);
+      print_alloc(PINNED);
+      print_alloc(MAPPED);
+      printfQuda("\n");
+    }
+  }
+
+  /**
+     Host and device memory share an address space on the CPU target,
+     so the location of a pointer is that of the tracked allocation
+     containing it.  Pointers that were not allocated by QUDA are
+     host pointers.
+   */
+  static bool contains(const std::map<void *, MemAlloc> &allocs, const void *ptr)
+  {
+    auto it = allocs.upper_bound(const_cast<void *>(ptr));
+    if (it == allocs.begin()) return false;
+    --it;
+    return static_cast<const char *>(ptr) < static_cast<const char *>(it->first) + it->second.base_size;
+  }
+
+  QudaFieldLocation get_pointer_location(const void *ptr)
+  {
+    std::lock_guard<std::mutex> lock(alloc_mutex);
+    if (contains(alloc[DEVICE], ptr) || contains(alloc[DEVICE_PINNED], ptr) || contains(alloc[MANAGED], ptr))
+      return QUDA_CUDA_FIELD_LOCATION;
+    return QUDA_CPU_FIELD_LOCATION;
+  }
+
+  void *get_mapped_device_pointer_(const char *, const char *, int, const void *host) { return const_cast<void *>(host); }
+
+} // namespace quda
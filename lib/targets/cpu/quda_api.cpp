@@ -0,0 +1,188 @@
+#include <cstring>
+#include <algorithm>
+#include <tune_quda.h>
+#include <quda_internal.h>
+#include <device.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// if this macro is defined then we profile the API calls
+//#define API_PROFILE
+
+#ifdef API_PROFILE
+#define PROFILE(f, idx)                                 \
+  apiTimer.TPSTART(idx);				\
+  f;                                                    \
+  apiTimer.TPSTOP(idx);
+#else
+#define PROFILE(f, idx) f;
+#endif
+
+namespace quda {
+
+  /*
+    On the CPU target, host and device share an address space and every
+    operation completes before it returns, so the copy and set
+    operations are libc calls and the synchronization operations are
+    no-ops.  Large copies and sets are split across the OpenMP threads
+    so that field reorders are not limited to a single core's
+    bandwidth.
+  */
+
+  static TimeProfile apiTimer("CPU API calls");
+
+  // below this size a copy is not worth distributing across threads
+  static constexpr size_t parallel_bytes = 1 << 20;
+
+  static void copy(void *dst, const void *src, size_t count)
+  {
+#ifdef _OPENMP
+    if (count >= parallel_bytes && !omp_in_parallel()) {
+#pragma omp parallel
+      {
+        const size_t n = omp_get_num_threads();
+        const size_t i = omp_get_thread_num();
+        const size_t chunk = ((count + n - 1) / n + 63) / 64 * 64;
+        const size_t begin = std::min(count, i * chunk);
+        const size_t end = std::min(count, begin + chunk);
+        if (end > begin) memcpy(static_cast<char *>(dst) + begin, static_cast<const char *>(src) + begin, end - begin);
+      }
+      return;
+    }
+#endif
+    memcpy(dst, src, count);
+  }
+
+  static void set(void *ptr, int value, size_t count)
+  {
+#ifdef _OPENMP
+    if (count >= parallel_bytes && !omp_in_parallel()) {
+#pragma omp parallel
+      {
+        const size_t n = omp_get_num_threads();
+        const size_t i = omp_get_thread_num();
+        const size_t chunk = ((count + n - 1) / n + 63) / 64 * 64;
+        const size_t begin = std::min(count, i * chunk);
+        const size_t end = std::min(count, begin + chunk);
+        if (end > begin) memset(static_cast<char *>(ptr) + begin, value, end - begin);
+      }
+      return;
+    }
+#endif
+    memset(ptr, value, count);
+  }
+
+  static QudaProfileType copy_profile(cudaMemcpyKind kind)
+  {
+    switch (kind) {
+    case cudaMemcpyDeviceToHost: return QUDA_PROFILE_MEMCPY_D2H_ASYNC;
+    case cudaMemcpyHostToDevice: return QUDA_PROFILE_MEMCPY_H2D_ASYNC;
+    case cudaMemcpyDeviceToDevice: return QUDA_PROFILE_MEMCPY_D2D_ASYNC;
+    default: return QUDA_PROFILE_MEMCPY_DEFAULT_ASYNC;
+    }
+  }
+
+  qudaError_t qudaLaunchKernel(const void *, const TuneParam &, void **, qudaStream_t)
+  {
+    // kernels written for the GPU targets cannot be executed here
+    if (!activeTuning())
+      errorQuda("Device kernels cannot be launched on the CPU target; use a QUDA_CPU_FIELD_LOCATION code path");
+    return QUDA_ERROR;
+  }
+
+  // the dynamic shared memory that kernels declare extern __shared__
+  // (dslash_coarse.cuh, clover_deriv.cuh and shared_memory_cache_helper.cuh):
+  // one block's worth for each host thread
+  alignas(16) thread_local float s[quda_cpu_shared_bytes / sizeof(float)];
+  alignas(16) thread_local int cache_[quda_cpu_shared_bytes / sizeof(int)];
+
+  void qudaMemcpy_(void *dst, const void *src, size_t count, cudaMemcpyKind kind, const char *func, const char *file,
+                   const char *line)
+  {
+    if (count == 0) return;
+    PROFILE(copy(dst, src, count), copy_profile(kind));
+  }
+
+  void qudaMemcpyAsync_(void *dst, const void *src, size_t count, cudaMemcpyKind kind, const qudaStream_t &stream,
+                        const char *func, const char *file, const char *line)
+  {
+    if (count == 0) return;
+    PROFILE(copy(dst, src, count), copy_profile(kind));
+  }
+
+  void qudaMemcpy2D_(void *dst, size_t dpitch, const void *src, size_t spitch, size_t width, size_t height,
+                     cudaMemcpyKind kind, const char *func, const char *file, const char *line)
+  {
+    PROFILE(cudaMemcpy2D(dst, dpitch, src, spitch, width, height, kind), QUDA_PROFILE_MEMCPY2D_D2H_ASYNC);
+  }
+
+  void qudaMemcpy2DAsync_(void *dst, size_t dpitch, const void *src, size_t spitch, size_t width, size_t height,
+                          cudaMemcpyKind kind, const qudaStream_t &stream, const char *func, const char *file,
+                          const char *line)
+  {
+    PROFILE(cudaMemcpy2D(dst, dpitch, src, spitch, width, height, kind), QUDA_PROFILE_MEMCPY2D_D2H_ASYNC);
+  }
+
+  void qudaMemset_(void *ptr, int value, size_t count, const char *func, const char *file, const char *line)
+  {
+    if (count == 0) return;
+    set(ptr, value, count);
+  }
+
+  void qudaMemsetAsync_(void *ptr, int value, size_t count, const qudaStream_t &stream, const char *func,
+                        const char *file, const char *line)
+  {
+    if (count == 0) return;
+    set(ptr, value, count);
+  }
+
+  void qudaMemset2D_(void *ptr, size_t pitch, int value, size_t width, size_t height, const char *func,
+                     const char *file, const char *line)
+  {
+    cudaMemset2D(ptr, pitch, value, width, height);
+  }
+
+  void qudaMemset2DAsync_(void *ptr, size_t pitch, int value, size_t width, size_t height, const qudaStream_t &stream,
+                          const char *func, const char *file, const char *line)
+  {
+    cudaMemset2D(ptr, pitch, value, width, height);
+  }
+
+  void qudaMemPrefetchAsync_(void *ptr, size_t count, QudaFieldLocation mem_space, const qudaStream_t &stream,
+                             const char *func, const char *file, const char *line)
+  {
+    if (mem_space != QUDA_CUDA_FIELD_LOCATION && mem_space != QUDA_CPU_FIELD_LOCATION)
+      errorQuda("Invalid QudaFieldLocation.");
+  }
+
+  bool qudaEventQuery_(cudaEvent_t &event, const char *func, const char *file, const char *line)
+  {
+    PROFILE(cudaError_t error = cudaEventQuery(event), QUDA_PROFILE_EVENT_QUERY);
+    return error == cudaSuccess;
+  }
+
+  void qudaEventRecord_(cudaEvent_t &event, qudaStream_t stream, const char *func, const char *file, const char *line)
+  {
+    PROFILE(cudaEventRecord(event, stream), QUDA_PROFILE_EVENT_RECORD);
+  }
+
+  void qudaStreamWaitEvent_(qudaStream_t stream, cudaEvent_t event, unsigned int flags, const char *func,
+                            const char *file, const char *line)
+  {
+  }
+
+  void qudaEventSynchronize_(cudaEvent_t &event, const char *func, const char *file, const char *line) { }
+
+  void qudaStreamSynchronize_(qudaStream_t &stream, const char *func, const char *file, const char *line) { }
+
+  void qudaDeviceSynchronize_(const char *func, const char *file, const char *line) { }
+
+  void printAPIProfile() {
+#ifdef API_PROFILE
+    apiTimer.Print();
+#endif
+  }
+
+} // namespace quda
@@ -20,20 +20,22 @@ namespace quda
 
       void destroy() {}
 
-      template <typename EigenMatrix, typename Float>
-      void invertEigen(std::complex<Float> *A_eig, std::complex<Float> *Ainv_eig, int n, uint64_t batch)
+      /**
+         @brief Invert matrix number batch of a set of column-major
+         n x n matrices, mapping both the input and output directly
+         with no intermediate copies.  When N is
+         not Eigen::Dynamic the matrix size is fixed at compile time,
+         which lets Eigen fully unroll and vectorize the LU
+         factorization.
+      */
+      template <typename Float, int N>
+      void invertEigen(const std::complex<Float> *A_eig, std::complex<Float> *Ainv_eig, int n, uint64_t batch)
       {
-        EigenMatrix res = EigenMatrix::Zero(n, n);
-        EigenMatrix inv = EigenMatrix::Zero(n, n);
-        for (int j = 0; j < n; j++) {
-          for (int k = 0; k < n; k++) { res(k, j) = A_eig[batch * n * n + j * n + k]; }
-        }
-
-        inv = res.inverse();
+        using EigenMatrix = Matrix<std::complex<Float>, N, N>;
+        Map<const EigenMatrix> res(A_eig + batch * n * n, n, n);
+        Map<EigenMatrix> inv(Ainv_eig + batch * n * n, n, n);
 
-        for (int j = 0; j < n; j++) {
-          for (int k = 0; k < n; k++) { Ainv_eig[batch * n * n + j * n + k] = inv(k, j); }
-        }
+        inv = res.partialPivLu().inverse();
 
         // Check result:
 #ifdef _DEBUG
@@ -44,6 +46,33 @@ namespace quda
 #endif
       }
 
+      template <typename Float, int N>
+      void invertBatch(const std::complex<Float> *A_eig, std::complex<Float> *Ainv_eig, int n, uint64_t batch)
+      {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (uint64_t i = 0; i < batch; i++) { invertEigen<Float, N>(A_eig, Ainv_eig, n, i); }
+      }
+
+      /**
+         @brief Dispatch the batched inversion to a fixed-size kernel
+         for the matrix sizes that appear in multigrid (2 x coarse
+         colors), falling back to the dynamically sized kernel
+      */
+      template <typename Float>
+      void invertBatch(const std::complex<Float> *A_eig, std::complex<Float> *Ainv_eig, int n, uint64_t batch)
+      {
+        switch (n) {
+        case 12: invertBatch<Float, 12>(A_eig, Ainv_eig, n, batch); break;
+        case 24: invertBatch<Float, 24>(A_eig, Ainv_eig, n, batch); break;
+        case 32: invertBatch<Float, 32>(A_eig, Ainv_eig, n, batch); break;
+        case 48: invertBatch<Float, 48>(A_eig, Ainv_eig, n, batch); break;
+        case 64: invertBatch<Float, 64>(A_eig, Ainv_eig, n, batch); break;
+        default: invertBatch<Float, Dynamic>(A_eig, Ainv_eig, n, batch); break;
+        }
+      }
+
       long long BatchInvertMatrix(void *Ainv, void *A, const int n, const uint64_t batch, QudaPrecision prec,
                                   QudaFieldLocation location)
       {
@@ -62,20 +91,12 @@ namespace quda
         if (prec == QUDA_SINGLE_PRECISION) {
           std::complex<float> *A_eig = (std::complex<float> *)A_h;
           std::complex<float> *Ainv_eig = (std::complex<float> *)Ainv_h;
-
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-          for (uint64_t i = 0; i < batch; i++) { invertEigen<MatrixXcf, float>(A_eig, Ainv_eig, n, i); }
+          invertBatch(A_eig, Ainv_eig, n, batch);
           flops += batch * FLOPS_CGETRF(n, n);
         } else if (prec == QUDA_DOUBLE_PRECISION) {
           std::complex<double> *A_eig = (std::complex<double> *)A_h;
           std::complex<double> *Ainv_eig = (std::complex<double> *)Ainv_h;
-
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-          for (uint64_t i = 0; i < batch; i++) { invertEigen<MatrixXcd, double>(A_eig, Ainv_eig, n, i); }
+          invertBatch(A_eig, Ainv_eig, n, batch);
           flops += batch * FLOPS_ZGETRF(n, n);
         } else {
           errorQuda("%s not implemented for precision = %d", __func__, prec);
@@ -89,16 +110,16 @@ namespace quda
         if (getVerbosity() >= QUDA_VERBOSE) {
           int threads = 1;
 #ifdef _OPENMP
-          threads = omp_get_num_threads();
+          threads = omp_get_max_threads();
 #endif
           printfQuda("CPU: Batched matrix inversion completed in %f seconds using %d threads with GFLOPS = %f\n", timeh,
                      threads, 1e-9 * flops / timeh);
         }
 
         if (location == QUDA_CUDA_FIELD_LOCATION) {
+          qudaMemcpy((void *)Ainv, Ainv_h, size, cudaMemcpyHostToDevice);
           pool_pinned_free(Ainv_h);
           pool_pinned_free(A_h);
-          qudaMemcpy((void *)Ainv, Ainv_h, size, cudaMemcpyHostToDevice);
         }
 
         return flops;
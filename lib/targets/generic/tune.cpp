@@ -1,4 +1,6 @@
 #include <tune_quda.h>
+#include <tune_cache.h>
+#include <kernel_trace.h>
 #include <comm_quda.h>
 #include <quda.h>     // for QUDA_VERSION_STRING
 #include <sys/stat.h> // for stat()
@@ -15,13 +17,14 @@
 #include <deque>
 #include <queue>
 #include <functional>
+#include <mutex>
 
 //#define LAUNCH_TIMER
 extern char *gitversion;
 
 namespace quda
 {
-  static TuneKey last_key;
+  static thread_local TuneKey last_key; // of the calling thread
 }
 
 // intentionally leave this outside of the namespace for now
@@ -31,54 +34,6 @@ namespace quda
 {
   typedef std::map<TuneKey, TuneParam> map;
 
-  struct TraceKey {
-
-    TuneKey key;
-    float time;
-
-    long device_bytes;
-    long pinned_bytes;
-    long mapped_bytes;
-    long host_bytes;
-
-    TraceKey() {}
-
-    TraceKey(const TuneKey &key, float time) :
-      key(key),
-      time(time),
-      device_bytes(device_allocated_peak()),
-      pinned_bytes(pinned_allocated_peak()),
-      mapped_bytes(mapped_allocated_peak()),
-      host_bytes(host_allocated_peak())
-    {
-    }
-
-    TraceKey(const TraceKey &trace) :
-      key(trace.key),
-      time(trace.time),
-      device_bytes(trace.device_bytes),
-      pinned_bytes(trace.pinned_bytes),
-      mapped_bytes(trace.mapped_bytes),
-      host_bytes(trace.host_bytes)
-    {
-    }
-
-    TraceKey &operator=(const TraceKey &trace)
-    {
-      if (&trace != this) {
-        key = trace.key;
-        time = trace.time;
-        device_bytes = trace.device_bytes;
-        pinned_bytes = trace.pinned_bytes;
-        mapped_bytes = trace.mapped_bytes;
-        host_bytes = trace.host_bytes;
-      }
-      return *this;
-    }
-  };
-
-  // linked list that is augmented each time we call a kernel
-  static std::list<TraceKey> trace_list;
   static int enable_trace = 0;
 
   int traceEnabled()
@@ -111,16 +66,18 @@ namespace quda
       i32toa(tmp, line);
       strcat(aux, tmp);
       TuneKey key("", func, aux);
-      TraceKey trace_entry(key, 0.0);
-      trace_list.push_back(trace_entry);
+      kernel_trace::record(key, 0.0);
     }
   }
 
   static const std::string quda_hash = QUDA_HASH; // defined in lib/Makefile
   static std::string resource_path;
-  static map tunecache;
-  static map::iterator it;
+  static map tunecache;                     // ordered store, used for saving, profiling and broadcast
+  static tune_cache::Index tunecache_index; // lock-free lookup of the published entries
+  static std::mutex tunecache_mutex;        // serializes updates of tunecache and tunecache_index
+  static tune_cache::MappedCache mapped_cache; // read-only view of tunecache.bin, entries are promoted on first use
   static size_t initial_cache_size = 0;
+  static bool stale_binary = false; // tunecache.bin was rejected, so rewrite it on the next save
 
 #define STR_(x) #x
 #define STR(x) STR_(x)
@@ -129,8 +86,16 @@ namespace quda
 #undef STR
 #undef STR_
 
-  /** tuning in progress? */
-  static bool tuning = false;
+  /** tuning in progress on this thread? */
+  static thread_local bool tuning = false;
+
+  /**
+     Threads that tune on their own take turns, so that their timings
+     do not overlap.  The lock is never held across a comm collective:
+     with threaded ranks, a rank waiting for the lock would never join
+     the collective that the rank holding it is waiting in.
+  */
+  static std::recursive_mutex tuning_mutex;
 
   bool activeTuning() { return tuning; }
 
@@ -141,66 +106,84 @@ namespace quda
 
   const map &getTuneCache() { return tunecache; }
 
+  static bool sameTuneParam(const TuneParam &a, const TuneParam &b)
+  {
+    return a.block.x == b.block.x && a.block.y == b.block.y && a.block.z == b.block.z && a.grid.x == b.grid.x
+      && a.grid.y == b.grid.y && a.grid.z == b.grid.z && a.shared_bytes == b.shared_bytes && a.aux.x == b.aux.x
+      && a.aux.y == b.aux.y && a.aux.z == b.aux.z && a.aux.w == b.aux.w && a.time == b.time && a.comment == b.comment;
+  }
+
   /**
-   * Deserialize tunecache from an istream, useful for reading a file or receiving from other nodes.
+   * Publish any entries of the tunecache that are not yet in the
+   * index, or that differ from their published copy.  Needed after
+   * bulk insertion, e.g., loading or receiving the cache.
    */
-  static void deserializeTuneCache(std::istream &in)
+  static void indexTuneCache()
   {
-    std::string line;
-    std::stringstream ls;
-
-    TuneKey key;
-    TuneParam param;
-
-    std::string v;
-    std::string n;
-    std::string a;
-
-    int check;
-
-    while (in.good()) {
-      getline(in, line);
-      if (!line.length()) continue; // skip blank lines (e.g., at end of file)
-      ls.clear();
-      ls.str(line);
-      ls >> v >> n >> a >> param.block.x >> param.block.y >> param.block.z;
-      check = snprintf(key.volume, key.volume_n, "%s", v.c_str());
-      if (check < 0 || check >= key.volume_n) errorQuda("Error writing volume string (check = %d)", check);
-      check = snprintf(key.name, key.name_n, "%s", n.c_str());
-      if (check < 0 || check >= key.name_n) errorQuda("Error writing name string (check=%d)", check);
-      check = snprintf(key.aux, key.aux_n, "%s", a.c_str());
-      if (check < 0 || check >= key.aux_n) errorQuda("Error writing aux string (check=%d)", check);
-      ls >> param.grid.x >> param.grid.y >> param.grid.z >> param.shared_bytes >> param.aux.x >> param.aux.y
-        >> param.aux.z >> param.aux.w >> param.time;
-      ls.ignore(1);               // throw away tab before comment
-      getline(ls, param.comment); // assume anything remaining on the line is a comment
-      param.comment += "\n";      // our convention is to include the newline, since ctime() likes to do this
-      tunecache[key] = param;
+    std::lock_guard<std::mutex> lock(tunecache_mutex);
+    for (auto &entry : tunecache) {
+      map::value_type *published = tunecache_index.find(entry.first);
+      if (!published || !sameTuneParam(published->second, entry.second))
+        tunecache_index.publish(entry.first, entry.second);
     }
   }
 
   /**
-   * Serialize tunecache to an ostream, useful for writing to a file or sending to other nodes.
+   * Insert or update an entry in the tunecache.  An update publishes a
+   * new entry rather than assigning to the published one, which
+   * launches on other threads may be reading.
    */
-  static void serializeTuneCache(std::ostream &out)
+  static map::value_type *insertTuneCache(const TuneKey &key, const TuneParam &param)
   {
-    map::iterator entry;
+    std::lock_guard<std::mutex> lock(tunecache_mutex);
+    tunecache[key] = param;
+    return tunecache_index.publish(key, param);
+  }
 
-    for (entry = tunecache.begin(); entry != tunecache.end(); entry++) {
-      TuneKey key = entry->first;
-      TuneParam param = entry->second;
+  /**
+   * Copy of the tunecache with the call counts of the published
+   * entries, which launches update, so that it can be saved or
+   * profiled while other threads launch and tune.
+   */
+  static map snapshotTuneCache()
+  {
+    std::lock_guard<std::mutex> lock(tunecache_mutex);
+    map snapshot(tunecache);
+    for (auto &entry : snapshot) {
+      map::value_type *published = tunecache_index.find(entry.first);
+      if (published) entry.second.n_calls = __atomic_load_n(&published->second.n_calls, __ATOMIC_RELAXED);
+    }
+    return snapshot;
+  }
 
-      out << std::setw(16) << key.volume << "\t" << key.name << "\t" << key.aux << "\t";
-      out << param.block.x << "\t" << param.block.y << "\t" << param.block.z << "\t";
-      out << param.grid.x << "\t" << param.grid.y << "\t" << param.grid.z << "\t";
-      out << param.shared_bytes << "\t" << param.aux.x << "\t" << param.aux.y << "\t" << param.aux.z << "\t"
-          << param.aux.w << "\t";
-      out << param.time << "\t" << param.comment; // param.comment ends with a newline
+  /**
+   * Find key in the tunecache, falling back to the memory-mapped
+   * binary tunecache.  Entries found in the latter are inserted into
+   * the map, so that subsequent lookups and profiling see them.  The
+   * common case of a hit in the index takes no lock.
+   */
+  static map::value_type *findTuneCache(const TuneKey &key)
+  {
+    map::value_type *entry = tunecache_index.find(key);
+    if (!entry && mapped_cache.isOpen()) {
+      TuneParam param;
+      if (mapped_cache.find(key, param)) {
+        std::lock_guard<std::mutex> lock(tunecache_mutex);
+        entry = tunecache_index.find(key); // another thread may have promoted it meanwhile
+        if (!entry) {
+          auto result = tunecache.insert(std::make_pair(key, param));
+          if (result.second) initial_cache_size++; // not a new tuning, so shouldn't trigger a save
+          entry = tunecache_index.publish(key, result.first->second);
+        }
+      }
     }
+    return entry;
   }
 
-  template <class T> struct less_significant : std::binary_function<T, T, bool> {
-    inline bool operator()(const T &lhs, const T &rhs)
+  bool tuneCacheContains(const TuneKey &key) { return findTuneCache(key) != nullptr; }
+
+  template <class T> struct less_significant {
+    inline bool operator()(const T &lhs, const T &rhs) const
     {
       return lhs.second.time * lhs.second.n_calls < rhs.second.time * rhs.second.n_calls;
     }
@@ -209,9 +192,9 @@ namespace quda
   /**
    * Serialize tunecache to an ostream, useful for writing to a file or sending to other nodes.
    */
-  static void serializeProfile(std::ostream &out, std::ostream &async_out)
+  static void serializeProfile(std::ostream &out, std::ostream &async_out, const map &tunecache)
   {
-    map::iterator entry;
+    map::const_iterator entry;
     double total_time = 0.0;
     double async_total_time = 0.0;
 
@@ -272,63 +255,91 @@ namespace quda
               << "# Total time spent in asynchronous execution = " << async_total_time << " seconds" << std::endl;
   }
 
-  /**
-   * Serialize trace to an ostream, useful for writing to a file or sending to other nodes.
-   */
-  static void serializeTrace(std::ostream &out)
-  {
-    for (auto it = trace_list.begin(); it != trace_list.end(); it++) {
-
-      TuneKey &key = it->key;
-
-      // special case kernel members of a policy
-      char tmp[TuneKey::aux_n] = {};
-      strncpy(tmp, key.aux, TuneKey::aux_n);
-      bool is_policy_kernel = strcmp(tmp, "policy_kernel") == 0 ? true : false;
-
-      out << std::setw(12) << it->time << "\t";
-      out << std::setw(12) << it->device_bytes << "\t";
-      out << std::setw(12) << it->pinned_bytes << "\t";
-      out << std::setw(12) << it->mapped_bytes << "\t";
-      out << std::setw(12) << it->host_bytes << "\t";
-      out << std::setw(16) << key.volume << "\t";
-      if (is_policy_kernel) out << "\t";
-      out << key.name << "\t";
-      if (!is_policy_kernel) out << "\t";
-      out << key.aux << std::endl;
-    }
-  }
-
   /**
    * Distribute the tunecache from node 0 to all other nodes.
    */
   static void broadcastTuneCache()
   {
 #ifdef MULTI_GPU
-    std::stringstream serialized;
+    // the binary image is sent since it is much cheaper to (de)serialize than the text format
+    std::vector<char> serialized;
     size_t size;
 
     if (comm_rank() == 0) {
-      serializeTuneCache(serialized);
-      size = serialized.str().length();
+      std::lock_guard<std::mutex> lock(tunecache_mutex);
+      serialized = tune_cache::serializeBinary(tunecache, "", "", "", false);
+      size = serialized.size();
     }
     comm_broadcast(&size, sizeof(size_t));
 
     if (size > 0) {
-      if (comm_rank() == 0) {
-        comm_broadcast(const_cast<char *>(serialized.str().c_str()), size);
-      } else {
-        char *serstr = new char[size + 1];
-        comm_broadcast(serstr, size);
-        serstr[size] = '\0'; // null-terminate
-        serialized.str(serstr);
-        deserializeTuneCache(serialized);
-        delete[] serstr;
+      if (comm_rank() != 0) serialized.resize(size);
+      comm_broadcast(serialized.data(), size);
+      if (comm_rank() != 0) {
+        {
+          std::lock_guard<std::mutex> lock(tunecache_mutex);
+          if (!tune_cache::deserializeBinary(serialized.data(), size, tunecache))
+            errorQuda("Received malformed tunecache");
+        }
+        indexTuneCache();
       }
     }
 #endif
   }
 
+  /**
+   * Map the binary tunecache on all ranks.  Lookups then happen
+   * lazily against the mapping, so there is no need to parse or
+   * broadcast the cache.  Returns false if any rank failed to map
+   * the file, or if the file was written by a different QUDA version
+   * or build or from a text tunecache that has since changed, in
+   * which case the text tunecache should be used.
+   */
+  static bool loadBinaryTuneCache(bool version_check)
+  {
+    char *binary_env = getenv("QUDA_TUNECACHE_BINARY");
+    if (binary_env && strcmp(binary_env, "0") == 0) return false;
+
+#ifdef GITVERSION
+    const std::string git = gitversion;
+#else
+    const std::string git = quda_version;
+#endif
+    std::string cache_path = resource_path + "/tunecache.bin";
+    std::string text_path = resource_path + "/tunecache.tsv";
+    const char *reason = nullptr;
+    if (!mapped_cache.open(cache_path)) {
+      reason = "is missing or malformed";
+    } else if (version_check
+               && (mapped_cache.version().compare(quda_version) || mapped_cache.gitversion().compare(git)
+                   || mapped_cache.hash().compare(quda_hash))) {
+      reason = "does not match the current QUDA version and build";
+    } else {
+      // an edited or replaced text tunecache takes precedence
+      tune_cache::TextStamp text = tune_cache::textStamp(text_path);
+      if (text.bytes > 0 && text != mapped_cache.text()) reason = "is older than or differs from tunecache.tsv";
+    }
+
+    int fail = reason ? 1 : 0;
+    comm_allreduce_int(&fail);
+    if (fail) {
+      // regenerate the binary tunecache if one exists but was rejected,
+      // including one written in an older format
+      bool exists = access(cache_path.c_str(), F_OK) == 0;
+      stale_binary = stale_binary || exists;
+      if (exists && reason && getVerbosity() >= QUDA_SUMMARIZE)
+        printfQuda("Ignoring %s since it %s\n", cache_path.c_str(), reason);
+      mapped_cache.close();
+      return false;
+    }
+
+    if (getVerbosity() >= QUDA_SUMMARIZE) {
+      printfQuda("Mapped %d sets of cached parameters from %s\n", static_cast<int>(mapped_cache.size()),
+                 cache_path.c_str());
+    }
+    return true;
+  }
+
   /*
    * Read tunecache from disk.
    */
@@ -359,6 +370,17 @@ namespace quda
       resource_path = path;
     }
 
+    if (traceEnabled()) {
+      char *profile_fname = getenv("QUDA_PROFILE_OUTPUT_BASE");
+      std::string trace_path = resource_path + "/" + (profile_fname ? std::string(profile_fname) + "_trace" : "trace")
+        + "_rank" + std::to_string(comm_rank()) + ".bin";
+#ifdef GITVERSION
+      kernel_trace::open(trace_path, quda_version, gitversion, quda_hash);
+#else
+      kernel_trace::open(trace_path, quda_version, quda_version, quda_hash);
+#endif
+    }
+
     bool version_check = true;
     char *override_version_env = getenv("QUDA_TUNE_VERSION_CHECK");
     if (override_version_env && strcmp(override_version_env, "0") == 0) {
@@ -366,6 +388,8 @@ namespace quda
       warningQuda("Disabling QUDA tunecache version check");
     }
 
+    if (loadBinaryTuneCache(version_check)) return;
+
 #ifdef MULTI_GPU
     if (comm_rank() == 0) {
 #endif
@@ -410,7 +434,7 @@ namespace quda
         if (!cache_file.good()) errorQuda("Bad format in %s", cache_path.c_str());
         getline(cache_file, line); // eat the description line
 
-        deserializeTuneCache(cache_file);
+        tune_cache::readText(cache_file, tunecache);
 
         cache_file.close();
         initial_cache_size = tunecache.size();
@@ -429,6 +453,7 @@ namespace quda
 #endif
 
     broadcastTuneCache();
+    indexTuneCache();
   }
 
   /**
@@ -436,7 +461,6 @@ namespace quda
    */
   void saveTuneCache(bool error)
   {
-    time_t now;
     int lock_handle;
     std::string lock_path, cache_path;
     std::ofstream cache_file;
@@ -451,7 +475,15 @@ namespace quda
     if (comm_rank() == 0) {
 #endif
 
-      if (tunecache.size() == initial_cache_size && !error) return;
+      {
+        std::lock_guard<std::mutex> lock(tunecache_mutex);
+        if (tunecache.size() == initial_cache_size && !error && !stale_binary) return;
+
+        // entries that were never looked up are still only in the mapped tunecache
+        mapped_cache.materialize(tunecache);
+      }
+      indexTuneCache();
+      const map cache = snapshotTuneCache();
 
       // Acquire lock.  Note that this is only robust if the filesystem supports flock() semantics, which is true for
       // NFS on recent versions of linux but not Lustre by default (unless the filesystem was mounted with "-o flock").
@@ -473,29 +505,35 @@ namespace quda
       cache_file.open(cache_path.c_str());
 
       if (getVerbosity() >= QUDA_SUMMARIZE) {
-        printfQuda("Saving %d sets of cached parameters to %s\n", static_cast<int>(tunecache.size()), cache_path.c_str());
+        printfQuda("Saving %d sets of cached parameters to %s\n", static_cast<int>(cache.size()), cache_path.c_str());
       }
 
-      time(&now);
-      cache_file << "tunecache\t" << quda_version;
 #ifdef GITVERSION
-      cache_file << "\t" << gitversion;
+      const std::string git = gitversion;
 #else
-    cache_file << "\t" << quda_version;
+    const std::string git = quda_version;
 #endif
-      cache_file << "\t" << quda_hash << "\t# Last updated " << ctime(&now) << std::endl;
-      cache_file << std::setw(16) << "volume"
-                 << "\tname\taux\tblock.x\tblock.y\tblock.z\tgrid.x\tgrid.y\tgrid.z\tshared_bytes\taux.x\taux.y\taux."
-                    "z\taux.w\ttime\tcomment"
-                 << std::endl;
-      serializeTuneCache(cache_file);
+      tune_cache::writeTextHeader(cache_file, quda_version, git, quda_hash);
+      tune_cache::writeText(cache_file, cache);
       cache_file.close();
 
+      // the binary tunecache is only written from a clean exit, and
+      // records the stamp of the text file just written
+      if (!error) {
+        std::string binary_path = resource_path + "/tunecache.bin";
+        auto image = tune_cache::serializeBinary(cache, quda_version, git, quda_hash, true,
+                                                 tune_cache::textStamp(cache_path));
+        if (tune_cache::writeBinaryFile(binary_path, image))
+          stale_binary = false;
+        else
+          warningQuda("Unable to write binary tunecache %s", binary_path.c_str());
+      }
+
       // Release lock.
       close(lock_handle);
       remove(lock_path.c_str());
 
-      initial_cache_size = tunecache.size();
+      initial_cache_size = cache.size();
 
 #ifdef MULTI_GPU
     } else {
@@ -514,10 +552,13 @@ namespace quda
   // flush profile, setting counts to zero
   void flushProfile()
   {
+    std::lock_guard<std::mutex> lock(tunecache_mutex);
     for (map::iterator entry = tunecache.begin(); entry != tunecache.end(); entry++) {
       // set all n_calls = 0
       TuneParam &param = entry->second;
       param.n_calls = 0;
+      map::value_type *published = tunecache_index.find(entry->first);
+      if (published) __atomic_store_n(&published->second.n_calls, 0, __ATOMIC_RELAXED);
     }
   }
 
@@ -526,8 +567,17 @@ namespace quda
   {
     time_t now;
     int lock_handle;
-    std::string lock_path, profile_path, async_profile_path, trace_path;
-    std::ofstream profile_file, async_profile_file, trace_file;
+    std::string lock_path, profile_path, async_profile_path;
+    std::ofstream profile_file, async_profile_file;
+
+    // every rank streams its own trace; flush before checking the
+    // resource path so that entries dropped without a trace file are
+    // still reported
+    if (traceEnabled()) {
+      kernel_trace::flush();
+      if (getVerbosity() >= QUDA_SUMMARIZE && !kernel_trace::path().empty())
+        printfQuda("Flushed trace with %lu entries to %s\n", kernel_trace::size(), kernel_trace::path().c_str());
+    }
 
     if (resource_path.empty()) return;
 
@@ -561,25 +611,23 @@ namespace quda
           "Environment variable QUDA_PROFILE_OUTPUT_BASE not set; writing to profile.tsv and profile_async.tsv");
         profile_path = resource_path + "/profile_" + std::to_string(count) + ".tsv";
         async_profile_path = resource_path + "/profile_async_" + std::to_string(count) + ".tsv";
-        if (traceEnabled()) trace_path = resource_path + "/trace_" + std::to_string(count) + ".tsv";
       } else {
         profile_path = resource_path + "/" + profile_fname + "_" + std::to_string(count) + ".tsv";
         async_profile_path = resource_path + "/" + profile_fname + "_" + std::to_string(count) + "_async.tsv";
-        if (traceEnabled())
-          trace_path = resource_path + "/" + profile_fname + "_trace_" + std::to_string(count) + ".tsv";
       }
 
       count++;
 
+      const map cache = snapshotTuneCache();
+
       profile_file.open(profile_path.c_str());
       async_profile_file.open(async_profile_path.c_str());
-      if (traceEnabled()) trace_file.open(trace_path.c_str());
 
       if (getVerbosity() >= QUDA_SUMMARIZE) {
         // compute number of non-zero entries that will be output in the profile
         int n_entry = 0;
         int n_policy = 0;
-        for (map::iterator entry = tunecache.begin(); entry != tunecache.end(); entry++) {
+        for (map::const_iterator entry = cache.begin(); entry != cache.end(); entry++) {
           // if a policy entry, then we can ignore
           char tmp[TuneKey::aux_n] = {};
           strncpy(tmp, entry->first.aux, TuneKey::aux_n);
@@ -591,8 +639,6 @@ namespace quda
 
         printfQuda("Saving %d sets of cached parameters to %s\n", n_entry, profile_path.c_str());
         printfQuda("Saving %d sets of cached profiles to %s\n", n_policy, async_profile_path.c_str());
-        if (traceEnabled())
-          printfQuda("Saving trace list with %lu entries to %s\n", trace_list.size(), trace_path.c_str());
       }
 
       time(&now);
@@ -627,31 +673,11 @@ namespace quda
                          << "\t" << std::setw(16) << "volume"
                          << "\tname\taux\tcomment" << std::endl;
 
-      serializeProfile(profile_file, async_profile_file);
+      serializeProfile(profile_file, async_profile_file, cache);
 
       profile_file.close();
       async_profile_file.close();
 
-      if (traceEnabled()) {
-        trace_file << "trace"
-                   << "\t" << quda_version;
-#ifdef GITVERSION
-        trace_file << "\t" << gitversion;
-#else
-      trace_file << "\t" << quda_version;
-#endif
-        trace_file << "\t" << quda_hash << "\t# Last updated " << ctime(&now) << std::endl;
-
-        trace_file << std::setw(12) << "time\t" << std::setw(12) << "device-mem\t" << std::setw(12) << "pinned-mem\t";
-        trace_file << std::setw(12) << "mapped-mem\t" << std::setw(12) << "host-mem\t";
-        trace_file << std::setw(16) << "volume"
-                   << "\tname\taux" << std::endl;
-
-        serializeTrace(trace_file);
-
-        trace_file.close();
-      }
-
       // Release lock.
       close(lock_handle);
       remove(lock_path.c_str());
@@ -676,27 +702,30 @@ namespace quda
 #endif
 
     TuneKey key = tunable.tuneKey();
-    if (use_managed_memory()) strcat(key.aux, ",managed");
+    if (use_managed_memory()) {
+      strcat(key.aux, ",managed");
+      key.updateHash();
+    }
     last_key = key;
-    static TuneParam param;
+    static thread_local TuneParam param;
 
 #ifdef LAUNCH_TIMER
     launchTimer.TPSTOP(QUDA_PROFILE_INIT);
     launchTimer.TPSTART(QUDA_PROFILE_PREAMBLE);
 #endif
 
-    static const Tunable *active_tunable; // for error checking
-    it = tunecache.find(key);
+    static thread_local const Tunable *active_tunable; // for error checking
+    map::value_type *entry = findTuneCache(key);
 
     // first check if we have the tuned value and return if we have it
-    if (enabled == QUDA_TUNE_YES && it != tunecache.end()) {
+    if (enabled == QUDA_TUNE_YES && entry) {
 
 #ifdef LAUNCH_TIMER
       launchTimer.TPSTOP(QUDA_PROFILE_PREAMBLE);
       launchTimer.TPSTART(QUDA_PROFILE_COMPUTE);
 #endif
 
-      TuneParam &param = it->second;
+      TuneParam &param = entry->second;
 
       if (verbosity >= QUDA_DEBUG_VERBOSE) {
         printfQuda("Launching %s with %s at vol=%s with %s\n", key.name, key.aux, key.volume,
@@ -710,8 +739,8 @@ namespace quda
 
       tunable.checkLaunchParam(param);
 
-      // we could be tuning outside of the current scope
-      if (!tuning && profile_count) param.n_calls++;
+      // we could be tuning outside of the current scope; other threads may be counting the same entry
+      if (!tuning && profile_count) __atomic_fetch_add(&param.n_calls, 1, __ATOMIC_RELAXED);
 
 #ifdef LAUNCH_TIMER
       launchTimer.TPSTOP(QUDA_PROFILE_EPILOGUE);
@@ -719,8 +748,7 @@ namespace quda
 #endif
 
       if (traceEnabled() >= 2) {
-        TraceKey trace_entry(key, param.time);
-        trace_list.push_back(trace_entry);
+        kernel_trace::record(key, param.time);
       }
 
       return param;
@@ -732,18 +760,24 @@ namespace quda
 #endif
 
     if (enabled == QUDA_TUNE_NO) {
-      tunable.defaultTuneParam(param);
+      if (tunable.tuneHost())
+        tunable.defaultHostTuneParam(param);
+      else
+        tunable.defaultTuneParam(param);
       tunable.checkLaunchParam(param);
       if (verbosity >= QUDA_DEBUG_VERBOSE) {
         printfQuda("Launching %s with %s at vol=%s with %s (untuned)\n", key.name, key.aux, key.volume,
                    tunable.paramString(param).c_str());
       }
     } else if (!tuning) {
-
       /* As long as global reductions are not disabled, only do the
          tuning on node 0, else do the tuning on all nodes since we
          can't guarantee that all nodes are partaking */
       if (comm_rank() == 0 || !commGlobalReduction() || policyTuning()) {
+        // policy tuning exchanges halos between the ranks, so the ranks must tune it together
+        std::unique_lock<std::recursive_mutex> tuning_lock(tuning_mutex, std::defer_lock);
+        if (!policyTuning()) tuning_lock.lock();
+
         TuneParam best_param;
         cudaError_t error = cudaSuccess;
         cudaEvent_t start, end;
@@ -767,7 +801,10 @@ namespace quda
         Timer tune_timer;
         tune_timer.Start(__func__, __FILE__, __LINE__);
 
-        tunable.initTuneParam(param);
+        if (tunable.tuneHost())
+          tunable.initHostTuneParam(param);
+        else
+          tunable.initTuneParam(param);
         while (tuning) {
           cudaDeviceSynchronize();
           cudaGetLastError(); // clear error counter
@@ -779,13 +816,22 @@ namespace quda
           }
           tunable.apply(0); // do initial call in case we need to jit compile for these parameters or if policy tuning
 
-          cudaEventRecord(start, 0);
-          for (int i = 0; i < tunable.tuningIter(); i++) {
-            tunable.apply(0); // calls tuneLaunch() again, which simply returns the currently active param
+          if (tunable.tuneHost()) {
+            // host launches complete before returning, so events would not capture them
+            Timer host_timer;
+            host_timer.Start(__func__, __FILE__, __LINE__);
+            for (int i = 0; i < tunable.tuningIter(); i++) { tunable.apply(0); }
+            host_timer.Stop(__func__, __FILE__, __LINE__);
+            elapsed_time = 1e3 * host_timer.Last();
+          } else {
+            cudaEventRecord(start, 0);
+            for (int i = 0; i < tunable.tuningIter(); i++) {
+              tunable.apply(0); // calls tuneLaunch() again, which simply returns the currently active param
+            }
+            cudaEventRecord(end, 0);
+            cudaEventSynchronize(end);
+            cudaEventElapsedTime(&elapsed_time, start, end);
           }
-          cudaEventRecord(end, 0);
-          cudaEventSynchronize(end);
-          cudaEventElapsedTime(&elapsed_time, start, end);
           cudaDeviceSynchronize();
           error = cudaGetLastError();
 
@@ -816,7 +862,7 @@ namespace quda
               }
             }
           }
-          tuning = tunable.advanceTuneParam(param);
+          tuning = tunable.tuneHost() ? tunable.advanceHostTuneParam(param) : tunable.advanceTuneParam(param);
           tunable.jitifyError() = CUDA_SUCCESS;
         }
 
@@ -843,19 +889,17 @@ namespace quda
         tunable.postTune();
         tuning = false;
         param = best_param;
-        tunecache[key] = best_param;
-      }
+        insertTuneCache(key, best_param);
+      } // the tuning lock is released before the broadcast, which is a collective
       if (commGlobalReduction() || policyTuning()) broadcastTuneCache();
 
       // check this process is getting the key that is expected
-      if (tunecache.find(key) == tunecache.end()) {
-        errorQuda("Failed to find key entry (%s:%s:%s)", key.name, key.volume, key.aux);
-      }
-      param = tunecache[key]; // read this now for all processes
+      entry = findTuneCache(key);
+      if (!entry) errorQuda("Failed to find key entry (%s:%s:%s)", key.name, key.volume, key.aux);
+      param = entry->second; // read this now for all processes
 
       if (traceEnabled() >= 2) {
-        TraceKey trace_entry(key, param.time);
-        trace_list.push_back(trace_entry);
+        kernel_trace::record(key, param.time);
       }
 
     } else if (&tunable != active_tunable) {
@@ -2,6 +2,7 @@
 #include <cstdio>
 #include <string>
 #include <map>
+#include <mutex>
 #include <unistd.h>   // for getpagesize()
 #include <execinfo.h> // for backtrace
 #include <quda_internal.h>
@@ -59,6 +60,7 @@ namespace quda
   };
 
   static std::map<void *, MemAlloc> alloc[N_ALLOC_TYPE];
+  static std::mutex alloc_mutex; // ranks of the threaded comms backend allocate concurrently
   static long total_bytes[N_ALLOC_TYPE] = {0};
   static long max_total_bytes[N_ALLOC_TYPE] = {0};
   static long total_host_bytes, max_total_host_bytes;
@@ -113,6 +115,7 @@ namespace quda
 
   static void track_malloc(const AllocType &type, const MemAlloc &a, void *ptr)
   {
+    std::lock_guard<std::mutex> lock(alloc_mutex);
     total_bytes[type] += a.base_size;
     if (total_bytes[type] > max_total_bytes[type]) { max_total_bytes[type] = total_bytes[type]; }
     if (type != DEVICE && type != DEVICE_PINNED) {
@@ -128,6 +131,7 @@ namespace quda
 
   static void track_free(const AllocType &type, void *ptr)
   {
+    std::lock_guard<std::mutex> lock(alloc_mutex);
     size_t size = alloc[type][ptr].base_size;
     total_bytes[type] -= size;
     if (type != DEVICE && type != DEVICE_PINNED) { total_host_bytes -= size; }
@@ -135,6 +139,13 @@ namespace quda
     alloc[type].erase(ptr);
   }
 
+  static bool tracked(const AllocType &type, void *ptr)
+  {
+    std::lock_guard<std::mutex> lock(alloc_mutex);
+    return alloc[type].count(ptr);
+  }
+
+
   /**
    * Under CUDA 4.0, cudaHostRegister seems to require that both the
    * beginning and end of the buffer be aligned on page boundaries.
@@ -357,7 +368,7 @@ namespace quda
 
 #ifndef QDP_USE_CUDA_MANAGED_MEMORY
     if (!ptr) { errorQuda("Attempt to free NULL device pointer (%s:%d in %s())\n", file, line, func); }
-    if (!alloc[DEVICE].count(ptr)) {
+    if (!tracked(DEVICE, ptr)) {
       errorQuda("Attempt to free invalid device pointer (%s:%d in %s())\n", file, line, func);
     }
     hipError_t err = hipFree(ptr);
@@ -381,7 +392,7 @@ namespace quda
     }
 
     if (!ptr) { errorQuda("Attempt to free NULL device pointer (%s:%d in %s())\n", file, line, func); }
-    if (!alloc[DEVICE_PINNED].count(ptr)) {
+    if (!tracked(DEVICE_PINNED, ptr)) {
       errorQuda("Attempt to free invalid device pointer (%s:%d in %s())\n", file, line, func);
     }
     hipError_t err = hipMemFree((hipDeviceptr_t)ptr);
@@ -397,7 +408,7 @@ namespace quda
   void managed_free_(const char *func, const char *file, int line, void *ptr)
   {
     if (!ptr) { errorQuda("Attempt to free NULL managed pointer (%s:%d in %s())\n", file, line, func); }
-    if (!alloc[MANAGED].count(ptr)) {
+    if (!tracked(MANAGED, ptr)) {
       errorQuda("Attempt to free invalid managed pointer (%s:%d in %s())\n", file, line, func);
     }
     hipError_t err = hipFree(ptr);
@@ -413,15 +424,15 @@ namespace quda
   void host_free_(const char *func, const char *file, int line, void *ptr)
   {
     if (!ptr) { errorQuda("Attempt to free NULL host pointer (%s:%d in %s())\n", file, line, func); }
-    if (alloc[HOST].count(ptr)) {
+    if (tracked(HOST, ptr)) {
       track_free(HOST, ptr);
       free(ptr);
-    } else if (alloc[PINNED].count(ptr)) {
+    } else if (tracked(PINNED, ptr)) {
       hipError_t err = hipHostUnregister(ptr);
       if (err != hipSuccess) { errorQuda("Failed to unregister pinned memory (%s:%d in %s())\n", file, line, func); }
       track_free(PINNED, ptr);
       free(ptr);
-    } else if (alloc[MAPPED].count(ptr)) {
+    } else if (tracked(MAPPED, ptr)) {
 #ifdef HOST_ALLOC
       hipError_t err = hipFreeHost(ptr);
       if (err != hipSuccess) { errorQuda("Failed to free host memory (%s:%d in %s())\n", file, line, func); }
@@ -503,168 +514,4 @@ namespace quda
     return device;
   }
 
-
-  namespace pool
-  {
-
-    /** Cache of inactive pinned-memory allocations.  We cache pinned
-        memory allocations so that fields can reuse these with minimal
-        overhead.*/
-    static std::multimap<size_t, void *> pinnedCache;
-
-    /** Sizes of active pinned-memory allocations.  For convenience,
-        we keep track of the sizes of active allocations (i.e., those not
-        in the cache). */
-    static std::map<void *, size_t> pinnedSize;
-
-    /** Cache of inactive device-memory allocations.  We cache pinned
-        memory allocations so that fields can reuse these with minimal
-        overhead.*/
-    static std::multimap<size_t, void *> deviceCache;
-
-    /** Sizes of active device-memory allocations.  For convenience,
-        we keep track of the sizes of active allocations (i.e., those not
-        in the cache). */
-    static std::map<void *, size_t> deviceSize;
-
-    static bool pool_init = false;
-
-    /** whether to use a memory pool allocator for device memory */
-    static bool device_memory_pool = true;
-
-    /** whether to use a memory pool allocator for pinned memory */
-    static bool pinned_memory_pool = true;
-
-    void init()
-    {
-      if (!pool_init) {
-        // device memory pool
-        char *enable_device_pool = getenv("QUDA_ENABLE_DEVICE_MEMORY_POOL");
-        if (!enable_device_pool || strcmp(enable_device_pool, "0") != 0) {
-          warningQuda("Using device memory pool allocator");
-          device_memory_pool = true;
-        } else {
-          warningQuda("Not using device memory pool allocator");
-          device_memory_pool = false;
-        }
-
-        // pinned memory pool
-        char *enable_pinned_pool = getenv("QUDA_ENABLE_PINNED_MEMORY_POOL");
-        if (!enable_pinned_pool || strcmp(enable_pinned_pool, "0") != 0) {
-          warningQuda("Using pinned memory pool allocator");
-          pinned_memory_pool = true;
-        } else {
-          warningQuda("Not using pinned memory pool allocator");
-          pinned_memory_pool = false;
-        }
-        pool_init = true;
-      }
-    }
-
-    void *pinned_malloc_(const char *func, const char *file, int line, size_t nbytes)
-    {
-      void *ptr = nullptr;
-      if (pinned_memory_pool) {
-        std::multimap<size_t, void *>::iterator it;
-
-        if (pinnedCache.empty()) {
-          ptr = quda::pinned_malloc_(func, file, line, nbytes);
-        } else {
-          it = pinnedCache.lower_bound(nbytes);
-          if (it != pinnedCache.end()) { // sufficiently large allocation found
-            nbytes = it->first;
-            ptr = it->second;
-            pinnedCache.erase(it);
-          } else { // sacrifice the smallest cached allocation
-            it = pinnedCache.begin();
-            ptr = it->second;
-            pinnedCache.erase(it);
-            host_free(ptr);
-            ptr = quda::pinned_malloc_(func, file, line, nbytes);
-          }
-        }
-        pinnedSize[ptr] = nbytes;
-      } else {
-        ptr = quda::pinned_malloc_(func, file, line, nbytes);
-      }
-      return ptr;
-    }
-
-    void pinned_free_(const char *func, const char *file, int line, void *ptr)
-    {
-      if (pinned_memory_pool) {
-        if (!pinnedSize.count(ptr)) { errorQuda("Attempt to free invalid pointer"); }
-        pinnedCache.insert(std::make_pair(pinnedSize[ptr], ptr));
-        pinnedSize.erase(ptr);
-      } else {
-        quda::host_free_(func, file, line, ptr);
-      }
-    }
-
-    void *device_malloc_(const char *func, const char *file, int line, size_t nbytes)
-    {
-      void *ptr = nullptr;
-      if (device_memory_pool) {
-        std::multimap<size_t, void *>::iterator it;
-
-        if (deviceCache.empty()) {
-          ptr = quda::device_malloc_(func, file, line, nbytes);
-        } else {
-          it = deviceCache.lower_bound(nbytes);
-          if (it != deviceCache.end()) { // sufficiently large allocation found
-            nbytes = it->first;
-            ptr = it->second;
-            deviceCache.erase(it);
-          } else { // sacrifice the smallest cached allocation
-            it = deviceCache.begin();
-            ptr = it->second;
-            deviceCache.erase(it);
-            quda::device_free_(func, file, line, ptr);
-            ptr = quda::device_malloc_(func, file, line, nbytes);
-          }
-        }
-        deviceSize[ptr] = nbytes;
-      } else {
-        ptr = quda::device_malloc_(func, file, line, nbytes);
-      }
-      return ptr;
-    }
-
-    void device_free_(const char *func, const char *file, int line, void *ptr)
-    {
-      if (device_memory_pool) {
-        if (!deviceSize.count(ptr)) { errorQuda("Attempt to free invalid pointer"); }
-        deviceCache.insert(std::make_pair(deviceSize[ptr], ptr));
-        deviceSize.erase(ptr);
-      } else {
-        quda::device_free_(func, file, line, ptr);
-      }
-    }
-
-    void flush_pinned()
-    {
-      if (pinned_memory_pool) {
-        std::multimap<size_t, void *>::iterator it;
-        for (it = pinnedCache.begin(); it != pinnedCache.end(); it++) {
-          void *ptr = it->second;
-          host_free(ptr);
-        }
-        pinnedCache.clear();
-      }
-    }
-
-    void flush_device()
-    {
-      if (device_memory_pool) {
-        std::multimap<size_t, void *>::iterator it;
-        for (it = deviceCache.begin(); it != deviceCache.end(); it++) {
-          void *ptr = it->second;
-          device_free(ptr);
-        }
-        deviceCache.clear();
-      }
-    }
-
-  } // namespace pool
-
 } // namespace quda
@@ -1,5 +1,16 @@
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
 #include <quda_internal.h>
 #include <timer.h>
+#include <comm_quda.h>
 
 namespace quda {
 
@@ -115,4 +126,381 @@ namespace quda {
 
   }
 
+  namespace timeline
+  {
+
+    /**
+       A node of the call tree of a thread: a region name and phase
+       under a given parent region, with the time spent in it
+    */
+    struct Node {
+      int parent;
+      int name;
+      QudaProfileType idx;
+      std::vector<int> children;
+      long count = 0;
+      int64_t time = 0; // inclusive time in nanoseconds
+
+      Node(int parent, int name, QudaProfileType idx) : parent(parent), name(name), idx(idx) { }
+    };
+
+    struct Event {
+      int64_t begin;
+      int64_t end;
+      int node;
+    };
+
+    struct Frame {
+      int node;
+      int64_t begin;
+    };
+
+    /**
+       The timeline of a thread.  Only the owning thread writes to it,
+       and it is read by finalize once the thread is quiescent.
+    */
+    struct ThreadTimeline {
+      int rank = 0;
+      int tid = 0;
+      std::vector<Node> nodes = {Node(-1, -1, QUDA_PROFILE_COUNT)}; // node 0 is the root
+      std::vector<Frame> stack;                                      // regions that are open
+      std::vector<Event> events;
+      size_t dropped = 0;
+    };
+
+    struct Registry {
+      std::mutex mutex;
+      std::vector<std::string> names;
+      std::unordered_map<std::string, int> ids;
+      std::vector<std::unique_ptr<ThreadTimeline>> threads;
+    };
+
+    static Registry &registry()
+    {
+      static Registry registry;
+      return registry;
+    }
+
+    static int64_t now()
+    {
+      static const auto epoch = std::chrono::steady_clock::now();
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    bool enabled()
+    {
+      static const bool enable = [] {
+        char *enable_timeline = getenv("QUDA_ENABLE_TIMELINE");
+        return enable_timeline && strcmp(enable_timeline, "1") == 0;
+      }();
+      return enable;
+    }
+
+    /**
+       Events recorded per thread (QUDA_TIMELINE_EVENTS, default 2^20).
+       Once a buffer is full, further events are dropped, but are still
+       accounted for in the call-path summary.
+    */
+    static size_t max_events()
+    {
+      static const size_t max = [] {
+        char *max_env = getenv("QUDA_TIMELINE_EVENTS");
+        return max_env ? strtoul(max_env, nullptr, 10) : 1ul << 20;
+      }();
+      return max;
+    }
+
+    static ThreadTimeline &local()
+    {
+      static thread_local ThreadTimeline *timeline = nullptr;
+      if (!timeline) {
+        auto &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.threads.emplace_back(new ThreadTimeline);
+        timeline = r.threads.back().get();
+        timeline->tid = r.threads.size() - 1;
+#ifdef THREAD_COMMS
+        timeline->rank = comm_rank();
+#endif
+      }
+      return *timeline;
+    }
+
+    int name_id(const std::string &name)
+    {
+      auto &r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      auto it = r.ids.find(name);
+      if (it != r.ids.end()) return it->second;
+      r.names.push_back(name);
+      return r.ids[name] = r.names.size() - 1;
+    }
+
+    void begin(int name, QudaProfileType idx)
+    {
+      auto &t = local();
+      const int parent = t.stack.empty() ? 0 : t.stack.back().node;
+
+      int node = -1;
+      for (auto c : t.nodes[parent].children) {
+        if (t.nodes[c].name == name && t.nodes[c].idx == idx) {
+          node = c;
+          break;
+        }
+      }
+      if (node < 0) {
+        node = t.nodes.size();
+        t.nodes.emplace_back(parent, name, idx);
+        t.nodes[parent].children.push_back(node);
+      }
+
+      t.stack.push_back({node, now()});
+    }
+
+    void end(int name, QudaProfileType idx)
+    {
+      const int64_t stop = now();
+      auto &t = local();
+
+      // regions usually close in reverse order, but the phases of a profile may overlap
+      for (auto frame = t.stack.rbegin(); frame != t.stack.rend(); frame++) {
+        auto &node = t.nodes[frame->node];
+        if (node.name != name || node.idx != idx) continue;
+
+        node.count++;
+        node.time += stop - frame->begin;
+        if (t.events.size() < max_events())
+          t.events.push_back({frame->begin, stop, frame->node});
+        else
+          t.dropped++;
+
+        t.stack.erase(std::next(frame).base());
+        return;
+      }
+    }
+
+    static std::string label(const std::vector<std::string> &names, const Node &node)
+    {
+      if (node.idx == QUDA_PROFILE_TOTAL || node.idx == QUDA_PROFILE_COUNT) return names[node.name];
+      return TimeProfile::Name(node.idx);
+    }
+
+    static std::string escape(const std::string &s)
+    {
+      std::string escaped;
+      for (auto c : s) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+      }
+      return escaped;
+    }
+
+    /**
+       Gather a string from every rank to rank 0.  Only used for the
+       call-path summaries, which are small next to the event traces.
+    */
+    static std::vector<std::string> gather(const std::string &s)
+    {
+      double max_size = s.size();
+      comm_allreduce_max(&max_size);
+      const size_t nbytes = sizeof(uint64_t) + static_cast<size_t>(max_size);
+
+      std::vector<char> send(nbytes);
+      const uint64_t size = s.size();
+      memcpy(send.data(), &size, sizeof(uint64_t));
+      memcpy(send.data() + sizeof(uint64_t), s.data(), s.size());
+
+      std::vector<char> recv(comm_rank() == 0 ? nbytes * comm_size() : 0);
+      comm_gather(send.data(), recv.data(), nbytes);
+
+      std::vector<std::string> strings(recv.size() ? comm_size() : 0);
+      for (auto r = 0u; r < strings.size(); r++) {
+        uint64_t size_r;
+        memcpy(&size_r, recv.data() + r * nbytes, sizeof(uint64_t));
+        strings[r].assign(recv.data() + r * nbytes + sizeof(uint64_t), size_r);
+      }
+      return strings;
+    }
+
+    struct PathSummary {
+      int ranks = 0;
+      long count = 0;
+      double time = 0.0;
+      double min = 0.0;
+      double max = 0.0;
+      double self = 0.0;
+    };
+
+    /**
+       Orders call paths depth first, so that each path is followed by
+       the paths below it
+    */
+    struct PathOrder {
+      bool operator()(const std::string &a, const std::string &b) const
+      {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+          return (x == ';' ? '\0' : x) < (y == ';' ? '\0' : y);
+        });
+      }
+    };
+
+    void finalize()
+    {
+      if (!enabled()) return;
+      auto &r = registry();
+
+      // the lock is not held across the collectives below, since with
+      // threaded comms the other ranks share the registry
+      std::vector<ThreadTimeline *> threads;
+      std::vector<std::string> names;
+      {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (auto &t : r.threads) {
+#ifdef THREAD_COMMS
+          if (t->rank != comm_rank()) continue; // threads of the other ranks in this process
+#endif
+          threads.push_back(t.get());
+        }
+        names = r.names;
+      }
+
+      // the rank timelines are aligned at this barrier, and shifted so
+      // that the earliest event on any rank is at zero
+      comm_barrier();
+      const int64_t sync = now();
+      double first = 0.0;
+      for (auto t : threads)
+        for (auto &e : t->events) first = std::min(first, static_cast<double>(e.begin - sync));
+      comm_allreduce_min(&first);
+      const int64_t origin = sync + static_cast<int64_t>(first);
+
+      std::stringstream events, paths;
+      events.precision(3);
+      events << std::fixed;
+      paths.precision(17);
+      std::map<std::string, PathSummary> rank_paths;
+      double n_events = 0;
+      double dropped = 0;
+
+      events << ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << comm_rank()
+             << ",\"args\":{\"name\":\"rank " << comm_rank() << "\"}}";
+
+      for (auto t : threads) {
+        events << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << comm_rank() << ",\"tid\":" << t->tid
+               << ",\"args\":{\"name\":\"host thread " << t->tid << "\"}}";
+
+        for (auto &e : t->events) {
+          const auto &node = t->nodes[e.node];
+          events << ",\n{\"name\":\"" << escape(label(names, node)) << "\",\"cat\":\"" << escape(names[node.name])
+                 << "\",\"ph\":\"X\",\"pid\":" << comm_rank() << ",\"tid\":" << t->tid
+                 << ",\"ts\":" << (e.begin - origin) * 1e-3 << ",\"dur\":" << (e.end - e.begin) * 1e-3 << "}";
+        }
+        n_events += t->events.size();
+        dropped += t->dropped;
+
+        // accumulate the call tree of this thread into per-path totals
+        std::vector<std::string> path(t->nodes.size());
+        for (auto n = 1u; n < t->nodes.size(); n++) {
+          const auto &node = t->nodes[n];
+          path[n] = (node.parent ? path[node.parent] + ";" : "") + label(names, node);
+          if (node.count == 0) continue;
+          int64_t children = 0;
+          for (auto c : node.children) children += t->nodes[c].time;
+          auto &p = rank_paths[path[n]];
+          p.count += node.count;
+          p.time += node.time * 1e-9;
+          p.self += (node.time - children) * 1e-9;
+        }
+
+        // reset the recorded events, keeping the tree for any region that is still open
+        t->events.clear();
+        t->dropped = 0;
+        for (auto &node : t->nodes) {
+          node.count = 0;
+          node.time = 0;
+        }
+      }
+
+      for (auto &p : rank_paths)
+        paths << p.first << "\t" << p.second.count << "\t" << p.second.time << "\t" << p.second.self << "\n";
+
+      comm_allreduce(&n_events);
+      comm_allreduce(&dropped);
+      if (dropped > 0)
+        warningQuda("Timeline buffers overflowed: %.0f events were dropped (increase QUDA_TIMELINE_EVENTS)", dropped);
+
+      const char *path_env = getenv("QUDA_RESOURCE_PATH");
+      const char *base_env = getenv("QUDA_PROFILE_OUTPUT_BASE");
+      const std::string base = std::string(path_env ? path_env : ".") + "/" + (base_env ? base_env : "profile");
+
+      // each rank writes its own trace, so no rank has to hold the
+      // events of all the others; the ranks are distinguished by pid,
+      // and share the time origin, so the files can be merged offline
+      const std::string trace_path = base + "_timeline_rank" + std::to_string(comm_rank()) + ".json";
+      std::ofstream trace_file(trace_path.c_str());
+      int trace_fail = trace_file ? 0 : 1;
+      if (trace_file)
+        trace_file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << events.str().substr(1) << "\n]}\n";
+      trace_file.close();
+      comm_allreduce_int(&trace_fail);
+      if (trace_fail)
+        warningQuda("Unable to save the timeline of %d ranks to %s_timeline_rank*.json", trace_fail, base.c_str());
+      else if (getVerbosity() >= QUDA_SUMMARIZE)
+        printfQuda("Saving timeline with %.0f events to %s_timeline_rank*.json\n", n_events, base.c_str());
+
+      auto rank_summaries = gather(paths.str());
+      if (comm_rank() != 0) return;
+
+      std::map<std::string, PathSummary, PathOrder> summary;
+      for (auto &s : rank_summaries) {
+        std::stringstream lines(s);
+        std::string path;
+        while (std::getline(lines, path, '\t')) {
+          long count;
+          double time, self;
+          lines >> count >> time >> self;
+          lines.ignore(1);
+          auto &p = summary[path];
+          p.min = p.ranks ? std::min(p.min, time) : time;
+          p.max = p.ranks ? std::max(p.max, time) : time;
+          p.ranks++;
+          p.count += count;
+          p.time += time;
+          p.self += self;
+        }
+      }
+
+      const std::string summary_path = base + "_callpath.tsv"; // paths are ';' separated, as in folded stacks
+
+      std::ofstream summary_file(summary_path.c_str());
+      if (!summary_file) {
+        warningQuda("Unable to open %s; call-path summary will not be saved", summary_path.c_str());
+      } else {
+        summary_file << "ranks\tcalls\tmean time\tmin time\tmax time\tmean self time\tpath\n";
+        for (auto &p : summary)
+          summary_file << p.second.ranks << "\t" << p.second.count << "\t" << p.second.time / p.second.ranks << "\t"
+                       << p.second.min << "\t" << p.second.max << "\t" << p.second.self / p.second.ranks << "\t"
+                       << p.first << "\n";
+      }
+
+      if (getVerbosity() >= QUDA_SUMMARIZE && summary.size()) {
+        // only paths that take at least 1% of the longest one are printed
+        double longest = 0.0;
+        for (auto &p : summary) longest = std::max(longest, p.second.max);
+
+        printfQuda("\n   %-60s %10s %12s %12s %12s\n", "Call path (mean over ranks)", "calls", "time (s)", "max (s)",
+                   "self (s)");
+        for (auto &p : summary) {
+          if (p.second.max < 0.01 * longest) continue;
+          const int depth = std::count(p.first.begin(), p.first.end(), ';');
+          const std::string leaf = p.first.substr(p.first.rfind(';') + 1);
+          const std::string indented = std::string(2 * depth, ' ') + leaf;
+          printfQuda("   %-60s %10ld %12.6f %12.6f %12.6f\n", indented.c_str(), p.second.count,
+                     p.second.time / p.second.ranks, p.second.max, p.second.self / p.second.ranks);
+        }
+      }
+    }
+
+  } // namespace timeline
+
 }
@@ -0,0 +1,463 @@
+#include <tune_cache.h>
+#include <util_quda.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace quda
+{
+
+  namespace tune_cache
+  {
+
+    static_assert(sizeof(BinaryHeader) % alignof(BinaryRecord) == 0, "BinaryHeader breaks record alignment");
+    static_assert(sizeof(BinaryRecord) % sizeof(uint32_t) == 0, "BinaryRecord breaks bucket alignment");
+
+    TextStamp textStamp(const std::string &path)
+    {
+      TextStamp stamp;
+      struct stat st;
+      if (stat(path.c_str(), &st) == 0) {
+        stamp.bytes = st.st_size;
+#ifdef __APPLE__
+        stamp.mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+        stamp.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+      }
+      return stamp;
+    }
+
+    void readText(std::istream &in, tune_map &cache)
+    {
+      std::string line;
+      std::stringstream ls;
+
+      TuneKey key;
+      TuneParam param;
+
+      std::string v;
+      std::string n;
+      std::string a;
+
+      int check;
+
+      while (in.good()) {
+        getline(in, line);
+        if (!line.length()) continue; // skip blank lines (e.g., at end of file)
+        ls.clear();
+        ls.str(line);
+        ls >> v >> n >> a >> param.block.x >> param.block.y >> param.block.z;
+        check = snprintf(key.volume, key.volume_n, "%s", v.c_str());
+        if (check < 0 || check >= key.volume_n) errorQuda("Error writing volume string (check = %d)", check);
+        check = snprintf(key.name, key.name_n, "%s", n.c_str());
+        if (check < 0 || check >= key.name_n) errorQuda("Error writing name string (check=%d)", check);
+        check = snprintf(key.aux, key.aux_n, "%s", a.c_str());
+        if (check < 0 || check >= key.aux_n) errorQuda("Error writing aux string (check=%d)", check);
+        key.updateHash();
+        ls >> param.grid.x >> param.grid.y >> param.grid.z >> param.shared_bytes >> param.aux.x >> param.aux.y
+          >> param.aux.z >> param.aux.w >> param.time;
+        ls.ignore(1);               // throw away tab before comment
+        getline(ls, param.comment); // assume anything remaining on the line is a comment
+        param.comment += "\n";      // our convention is to include the newline, since ctime() likes to do this
+        cache[key] = param;
+      }
+    }
+
+    void writeText(std::ostream &out, const tune_map &cache)
+    {
+      for (auto entry = cache.begin(); entry != cache.end(); entry++) {
+        const TuneKey &key = entry->first;
+        const TuneParam &param = entry->second;
+
+        out << std::setw(16) << key.volume << "\t" << key.name << "\t" << key.aux << "\t";
+        out << param.block.x << "\t" << param.block.y << "\t" << param.block.z << "\t";
+        out << param.grid.x << "\t" << param.grid.y << "\t" << param.grid.z << "\t";
+        out << param.shared_bytes << "\t" << param.aux.x << "\t" << param.aux.y << "\t" << param.aux.z << "\t"
+            << param.aux.w << "\t";
+        out << param.time << "\t" << param.comment; // param.comment ends with a newline
+      }
+    }
+
+    void writeTextHeader(std::ostream &out, const std::string &version, const std::string &gitversion,
+                         const std::string &hash)
+    {
+      time_t now;
+      time(&now);
+      out << "tunecache\t" << version << "\t" << gitversion;
+      out << "\t" << hash << "\t# Last updated " << ctime(&now) << std::endl;
+      out << std::setw(16) << "volume"
+          << "\tname\taux\tblock.x\tblock.y\tblock.z\tgrid.x\tgrid.y\tgrid.z\tshared_bytes\taux.x\taux.y\taux."
+             "z\taux.w\ttime\tcomment"
+          << std::endl;
+    }
+
+    static void copyString(char *dst, size_t n, const std::string &src)
+    {
+      strncpy(dst, src.c_str(), n - 1);
+      dst[n - 1] = '\0';
+    }
+
+    std::vector<char> serializeBinary(const tune_map &cache, const std::string &version,
+                                      const std::string &gitversion, const std::string &hash, bool index,
+                                      const TextStamp &text)
+    {
+      const size_t n_entry = cache.size();
+      size_t n_bucket = 0;
+      if (index) {
+        n_bucket = 1;
+        while (n_bucket < 2 * n_entry) n_bucket <<= 1;
+      }
+
+      // build the string pool and records first since the pool size is not known up front
+      std::vector<BinaryRecord> records(n_entry);
+      std::string pool;
+      auto add_string = [&pool](const char *s) {
+        uint32_t offset = pool.size();
+        pool.append(s);
+        pool.push_back('\0');
+        return offset;
+      };
+
+      size_t i = 0;
+      for (auto entry = cache.begin(); entry != cache.end(); entry++, i++) {
+        const TuneKey &key = entry->first;
+        const TuneParam &param = entry->second;
+        BinaryRecord &r = records[i];
+        memset(&r, 0, sizeof(r));
+        r.hash = key.hash;
+        r.volume = add_string(key.volume);
+        r.name = add_string(key.name);
+        r.aux = add_string(key.aux);
+        // strip the trailing newline that we keep by convention
+        std::string comment = param.comment;
+        if (!comment.empty() && comment.back() == '\n') comment.pop_back();
+        r.comment = add_string(comment.c_str());
+        r.block[0] = param.block.x;
+        r.block[1] = param.block.y;
+        r.block[2] = param.block.z;
+        r.grid[0] = param.grid.x;
+        r.grid[1] = param.grid.y;
+        r.grid[2] = param.grid.z;
+        r.shared_bytes = param.shared_bytes;
+        r.aux_param[0] = param.aux.x;
+        r.aux_param[1] = param.aux.y;
+        r.aux_param[2] = param.aux.z;
+        r.aux_param[3] = param.aux.w;
+        r.time = param.time;
+      }
+
+      std::vector<uint32_t> buckets(n_bucket, 0); // record index + 1, zero marks an empty bucket
+      for (size_t j = 0; j < n_entry && n_bucket; j++) {
+        size_t b = records[j].hash & (n_bucket - 1);
+        while (buckets[b]) b = (b + 1) & (n_bucket - 1);
+        buckets[b] = j + 1;
+      }
+
+      BinaryHeader header;
+      memset(&header, 0, sizeof(header));
+      memcpy(header.magic, binary_magic, sizeof(header.magic));
+      header.format_version = binary_format_version;
+      header.endian = binary_endian_check;
+      copyString(header.version, sizeof(header.version), version);
+      copyString(header.gitversion, sizeof(header.gitversion), gitversion);
+      copyString(header.hash, sizeof(header.hash), hash);
+      header.text_bytes = text.bytes;
+      header.text_mtime = text.mtime;
+      header.n_entry = n_entry;
+      header.n_bucket = n_bucket;
+      header.record_offset = sizeof(BinaryHeader);
+      header.bucket_offset = header.record_offset + n_entry * sizeof(BinaryRecord);
+      header.string_offset = header.bucket_offset + n_bucket * sizeof(uint32_t);
+      header.total_bytes = header.string_offset + pool.size();
+
+      std::vector<char> image(header.total_bytes);
+      memcpy(image.data(), &header, sizeof(header));
+      if (n_entry) memcpy(image.data() + header.record_offset, records.data(), n_entry * sizeof(BinaryRecord));
+      if (n_bucket) memcpy(image.data() + header.bucket_offset, buckets.data(), n_bucket * sizeof(uint32_t));
+      if (pool.size()) memcpy(image.data() + header.string_offset, pool.data(), pool.size());
+
+      return image;
+    }
+
+    bool validBinary(const char *image, size_t bytes)
+    {
+      if (!image || bytes < sizeof(BinaryHeader)) return false;
+      const BinaryHeader &h = *reinterpret_cast<const BinaryHeader *>(image);
+      if (memcmp(h.magic, binary_magic, sizeof(h.magic))) return false;
+      if (h.endian != binary_endian_check) return false;
+      if (h.format_version != binary_format_version) return false;
+      // the version strings are read as C strings, so must be terminated within their fields
+      if (!memchr(h.version, '\0', sizeof(h.version)) || !memchr(h.gitversion, '\0', sizeof(h.gitversion))
+          || !memchr(h.hash, '\0', sizeof(h.hash)))
+        return false;
+      if (h.total_bytes != bytes) return false;
+      if (h.n_bucket & (h.n_bucket - 1)) return false;
+      if (h.n_bucket && h.n_bucket <= h.n_entry) return false; // need an empty bucket to terminate probing
+      if (h.record_offset != sizeof(BinaryHeader)) return false;
+      if (h.bucket_offset != h.record_offset + h.n_entry * sizeof(BinaryRecord)) return false;
+      if (h.string_offset != h.bucket_offset + h.n_bucket * sizeof(uint32_t)) return false;
+      if (h.string_offset > bytes) return false;
+      if (h.string_offset < bytes && image[bytes - 1] != '\0') return false; // pool must be null terminated
+
+      const size_t pool_bytes = bytes - h.string_offset;
+      const BinaryRecord *r = reinterpret_cast<const BinaryRecord *>(image + h.record_offset);
+      for (size_t i = 0; i < h.n_entry; i++) {
+        if (r[i].volume >= pool_bytes || r[i].name >= pool_bytes || r[i].aux >= pool_bytes
+            || r[i].comment >= pool_bytes)
+          return false;
+        const char *pool = image + h.string_offset;
+        if (strlen(pool + r[i].volume) >= TuneKey::volume_n || strlen(pool + r[i].name) >= TuneKey::name_n
+            || strlen(pool + r[i].aux) >= TuneKey::aux_n)
+          return false;
+      }
+
+      const uint32_t *b = reinterpret_cast<const uint32_t *>(image + h.bucket_offset);
+      for (size_t i = 0; i < h.n_bucket; i++)
+        if (b[i] > h.n_entry) return false;
+
+      return true;
+    }
+
+    static void copyRecord(const char *pool, const BinaryRecord &r, TuneKey &key, TuneParam &param)
+    {
+      strcpy(key.volume, pool + r.volume);
+      strcpy(key.name, pool + r.name);
+      strcpy(key.aux, pool + r.aux);
+      key.updateHash();
+      param.block = dim3(r.block[0], r.block[1], r.block[2]);
+      param.grid = dim3(r.grid[0], r.grid[1], r.grid[2]);
+      param.shared_bytes = r.shared_bytes;
+      param.aux = make_int4(r.aux_param[0], r.aux_param[1], r.aux_param[2], r.aux_param[3]);
+      param.time = r.time;
+      param.comment = pool + r.comment;
+      param.comment += "\n";
+    }
+
+    bool deserializeBinary(const char *image, size_t bytes, tune_map &cache)
+    {
+      if (!validBinary(image, bytes)) return false;
+      const BinaryHeader &h = *reinterpret_cast<const BinaryHeader *>(image);
+      const BinaryRecord *r = reinterpret_cast<const BinaryRecord *>(image + h.record_offset);
+      TuneKey key;
+      TuneParam param;
+      for (size_t i = 0; i < h.n_entry; i++) {
+        copyRecord(image + h.string_offset, r[i], key, param);
+        cache[key] = param;
+      }
+      return true;
+    }
+
+    bool writeBinaryFile(const std::string &path, const std::vector<char> &image)
+    {
+      std::string tmp_path = path + ".tmp";
+      std::ofstream file(tmp_path.c_str(), std::ios::binary | std::ios::trunc);
+      if (!file) return false;
+      file.write(image.data(), image.size());
+      file.close();
+      if (!file) {
+        remove(tmp_path.c_str());
+        return false;
+      }
+      // atomically replace, so existing mappings of the old file remain valid
+      if (rename(tmp_path.c_str(), path.c_str())) {
+        remove(tmp_path.c_str());
+        return false;
+      }
+      return true;
+    }
+
+    bool MappedCache::open(const std::string &path)
+    {
+      close();
+
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd == -1) return false;
+
+      struct stat st;
+      if (fstat(fd, &st) || st.st_size < static_cast<off_t>(sizeof(BinaryHeader))) {
+        ::close(fd);
+        return false;
+      }
+
+      void *ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      ::close(fd); // the mapping keeps the file alive
+      if (ptr == MAP_FAILED) return false;
+
+      const char *mapped = static_cast<const char *>(ptr);
+      if (!validBinary(mapped, st.st_size) || reinterpret_cast<const BinaryHeader *>(mapped)->n_bucket == 0) {
+        munmap(ptr, st.st_size);
+        return false;
+      }
+
+      image = mapped;
+      bytes = st.st_size;
+      return true;
+    }
+
+    void MappedCache::close()
+    {
+      if (image) munmap(const_cast<char *>(image), bytes);
+      image = nullptr;
+      bytes = 0;
+    }
+
+    void MappedCache::copy(const BinaryRecord &record, TuneKey &key, TuneParam &param) const
+    {
+      copyRecord(image + header().string_offset, record, key, param);
+    }
+
+    bool MappedCache::find(const TuneKey &key, TuneParam &param) const
+    {
+      if (!isOpen() || header().n_entry == 0) return false;
+
+      const uint64_t h = key.hash;
+      const uint64_t mask = header().n_bucket - 1;
+      const BinaryRecord *r = records();
+      const uint32_t *b = buckets();
+
+      for (uint64_t i = h & mask;; i = (i + 1) & mask) {
+        if (b[i] == 0) return false;
+        const BinaryRecord &record = r[b[i] - 1];
+        if (record.hash == h && !strcmp(string(record.volume), key.volume) && !strcmp(string(record.name), key.name)
+            && !strcmp(string(record.aux), key.aux)) {
+          TuneKey tmp;
+          copy(record, tmp, param);
+          return true;
+        }
+      }
+    }
+
+    void MappedCache::materialize(tune_map &cache) const
+    {
+      if (!isOpen()) return;
+      TuneKey key;
+      TuneParam param;
+      for (size_t i = 0; i < header().n_entry; i++) {
+        copy(records()[i], key, param);
+        cache.insert(std::make_pair(key, param)); // does not overwrite existing entries
+      }
+    }
+
+    Index::Table::Table(size_t size) : mask(size - 1), slot(new std::atomic<value_type *>[size])
+    {
+      for (size_t i = 0; i < size; i++) slot[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    Index::Index(size_t size)
+    {
+      size_t n = 1;
+      while (n < size) n <<= 1;
+      tables.emplace_back(new Table(n));
+      table.store(tables.back().get(), std::memory_order_release);
+    }
+
+    void Index::place(Table &table, value_type *entry)
+    {
+      size_t i = entry->first.hash & table.mask;
+      while (table.slot[i].load(std::memory_order_relaxed)) i = (i + 1) & table.mask;
+      table.slot[i].store(entry, std::memory_order_release);
+    }
+
+    Index::value_type *Index::find(const TuneKey &key) const
+    {
+      const Table &t = *table.load(std::memory_order_acquire);
+      for (size_t i = key.hash & t.mask;; i = (i + 1) & t.mask) {
+        value_type *entry = t.slot[i].load(std::memory_order_acquire);
+        if (!entry) return nullptr;
+        if (entry->first == key) return entry;
+      }
+    }
+
+    Index::value_type *Index::publish(const TuneKey &key, const TuneParam &param)
+    {
+      entries.emplace_back(new value_type(key, param));
+      value_type *entry = entries.back().get();
+
+      // a replacement swaps the new entry into the slot of the old one
+      Table *t = table.load(std::memory_order_relaxed);
+      for (size_t i = key.hash & t->mask;; i = (i + 1) & t->mask) {
+        value_type *e = t->slot[i].load(std::memory_order_relaxed);
+        if (!e) break;
+        if (e->first == key) {
+          t->slot[i].store(entry, std::memory_order_release);
+          return entry;
+        }
+      }
+
+      if (2 * (n_entry + 1) > t->mask + 1) {
+        // keep the load factor below one half: rehash into a private
+        // table, then publish it, retiring the old one
+        Table *grown = new Table(2 * (t->mask + 1));
+        for (size_t i = 0; i <= t->mask; i++) {
+          value_type *e = t->slot[i].load(std::memory_order_relaxed);
+          if (e) place(*grown, e);
+        }
+        tables.emplace_back(grown);
+        table.store(grown, std::memory_order_release);
+        t = grown;
+      }
+
+      place(*t, entry);
+      n_entry++;
+      return entry;
+    }
+
+    static bool readTextFile(const std::string &path, tune_map &cache, std::string token[3])
+    {
+      std::ifstream file(path.c_str());
+      if (!file) return false;
+
+      std::string line, magic;
+      getline(file, line);
+      std::stringstream ls(line);
+      ls >> magic >> token[0] >> token[1] >> token[2];
+      if (magic.compare("tunecache")) return false;
+
+      if (!file.good()) return false;
+      getline(file, line); // eat the blank line
+      if (!file.good()) return false;
+      getline(file, line); // eat the description line
+
+      readText(file, cache);
+      return true;
+    }
+
+    bool textToBinary(const std::string &text_path, const std::string &binary_path)
+    {
+      tune_map cache;
+      std::string token[3];
+      if (!readTextFile(text_path, cache, token)) return false;
+      return writeBinaryFile(binary_path,
+                             serializeBinary(cache, token[0], token[1], token[2], true, textStamp(text_path)));
+    }
+
+    bool binaryToText(const std::string &binary_path, const std::string &text_path)
+    {
+      std::ifstream file(binary_path.c_str(), std::ios::binary);
+      if (!file) return false;
+      std::vector<char> image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+      tune_map cache;
+      if (!deserializeBinary(image.data(), image.size(), cache)) return false;
+      const BinaryHeader &h = *reinterpret_cast<const BinaryHeader *>(image.data());
+
+      std::ofstream out(text_path.c_str());
+      if (!out) return false;
+      writeTextHeader(out, h.version, h.gitversion, h.hash);
+      writeText(out, cache);
+      return out.good();
+    }
+
+  } // namespace tune_cache
+
+} // namespace quda
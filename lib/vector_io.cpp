@@ -1,7 +1,13 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
 #include <color_spinor_field.h>
 #include <qio_field.h>
 #include <vector_io.h>
-#include <blas_quda.h>
 
 namespace quda
 {
@@ -17,98 +23,305 @@ namespace quda
     if (strcmp(filename.c_str(), "") == 0) { errorQuda("No eigenspace input file defined."); }
   }
 
-  void VectorIO::load(std::vector<ColorSpinorField *> &vecs)
-  {
 #ifdef HAVE_QIO
-    const int Nvec = vecs.size();
-    auto spinor_parity = vecs[0]->SuggestedParity();
-    if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Start loading %04d vectors from %s\n", Nvec, filename.c_str());
+  namespace
+  {
+
+    /**
+       A chunk of vectors in flight between file I/O and conversion:
+       vectors [first, first + n) of the set, held in the file layout
+       when they are staged, and in host fields in the order of the
+       vectors when these are on the device or in another order
+    */
+    struct Chunk {
+      int first = 0;
+      int n = 0;
+      QudaPrecision file_prec = QUDA_INVALID_PRECISION;
+      std::vector<std::vector<char>> file;
+      std::vector<ColorSpinorField *> transfer;
 
-    std::vector<ColorSpinorField *> tmp;
-    tmp.reserve(Nvec);
-    if (vecs[0]->Location() == QUDA_CUDA_FIELD_LOCATION) {
-      ColorSpinorParam csParam(*vecs[0]);
-      csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
-      csParam.setPrecision(vecs[0]->Precision() < QUDA_SINGLE_PRECISION ? QUDA_SINGLE_PRECISION : vecs[0]->Precision());
-      csParam.location = QUDA_CPU_FIELD_LOCATION;
-      csParam.create = QUDA_NULL_FIELD_CREATE;
-      if (csParam.siteSubset == QUDA_PARITY_SITE_SUBSET && parity_inflate) {
-        csParam.x[0] *= 2;
-        csParam.siteSubset = QUDA_FULL_SITE_SUBSET;
+      ~Chunk()
+      {
+        for (auto f : transfer) delete f;
       }
-      for (int i = 0; i < Nvec; i++) { tmp.push_back(ColorSpinorField::Create(csParam)); }
-    } else {
-      ColorSpinorParam csParam(*vecs[0]);
-      if (csParam.siteSubset == QUDA_PARITY_SITE_SUBSET && parity_inflate) {
-        csParam.x[0] *= 2;
-        csParam.siteSubset = QUDA_FULL_SITE_SUBSET;
-        for (int i = 0; i < Nvec; i++) { tmp.push_back(ColorSpinorField::Create(csParam)); }
-      } else {
-        for (int i = 0; i < Nvec; i++) { tmp.push_back(vecs[i]); }
+    };
+
+    /**
+       @brief Pass a sequence of chunks through three stages, double
+       buffered so that chunk k passes through the host stage while
+       the calling thread moves chunk k - 1 out and chunk k + 1 in.
+       Only the host stage runs on a worker thread: it touches nothing
+       but host memory (precision conversion and parity inflation),
+       while the entry and exit stages, which perform the file I/O
+       (QIO communicates) and every device transfer, device kernel and
+       autotuned launch, run on the calling thread.
+       @param[in,out] chunk The two chunk buffers, chunk k uses chunk[k % 2]
+       @param[in] enter Entry stage, called as enter(k, chunk) on the
+       calling thread, returns whether further chunks follow chunk k
+       @param[in] host Host stage, called as host(k, chunk) on the worker
+       @param[in] leave Exit stage, called as leave(k, chunk) on the
+       calling thread
+    */
+    template <typename Enter, typename Host, typename Leave>
+    void pipeline(Chunk (&chunk)[2], Enter &&enter, Host &&host, Leave &&leave)
+    {
+      std::mutex mutex;
+      std::condition_variable cv;
+      int n_entered = 0; // chunks through the entry stage
+      int n_host = 0;    // chunks through the host stage
+      bool last = false; // whether the entry stage is done
+
+      std::thread worker([&]() {
+        for (int k = 0;; k++) {
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return n_entered > k; });
+          }
+          host(k, chunk[k % 2]);
+          bool done;
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            n_host++;
+            done = last && n_host == n_entered;
+          }
+          cv.notify_all();
+          if (done) break;
+        }
+      });
+
+      auto wait_host = [&](int k) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return n_host > k; });
+      };
+
+      // chunk k - 2 left its buffer in the previous iteration
+      for (int k = 0;; k++) {
+        bool more = enter(k, chunk[k % 2]);
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          n_entered++;
+          last = !more;
+        }
+        cv.notify_all();
+
+        if (k > 0) {
+          wait_host(k - 1);
+          leave(k - 1, chunk[(k - 1) % 2]);
+        }
+        if (!more) {
+          wait_host(k);
+          leave(k, chunk[k % 2]);
+          break;
+        }
       }
+      worker.join();
     }
 
-    if (vecs[0]->Ndim() == 4 || vecs[0]->Ndim() == 5) {
-      // since QIO routines presently assume we have 4-d fields, we need to convert to array of 4-d fields
-      auto Ls = vecs[0]->Ndim() == 5 ? tmp[0]->X(4) : 1;
-      auto V4 = tmp[0]->Volume() / Ls;
-      auto stride = V4 * tmp[0]->Ncolor() * tmp[0]->Nspin() * 2 * tmp[0]->Precision();
-      void **V = static_cast<void **>(safe_malloc(Nvec * Ls * sizeof(void *)));
-      for (int i = 0; i < Nvec; i++) {
-        for (int j = 0; j < Ls; j++) { V[i * Ls + j] = static_cast<char *>(tmp[i]->V()) + j * stride; }
-      }
+    // host memory a chunk of vectors stages when loading, unless QUDA_VECTOR_IO_CHUNK is set
+    constexpr size_t default_chunk_bytes = 1ul << 30;
 
-      read_spinor_field(filename.c_str(), &V[0], tmp[0]->Precision(), tmp[0]->X(), tmp[0]->SiteSubset(), spinor_parity,
-                        tmp[0]->Ncolor(), tmp[0]->Nspin(), Nvec * Ls, 0, (char **)0);
+    /**
+       @return The number of vectors per chunk set with
+       QUDA_VECTOR_IO_CHUNK, or zero when this is unset.  Saving writes
+       each chunk as its own record, so setting it opts in to files of
+       several records; loading stages at most a chunk at a time.
+    */
+    int chunkEnv()
+    {
+      char *chunk_env = getenv("QUDA_VECTOR_IO_CHUNK");
+      int chunk_size = chunk_env ? atoi(chunk_env) : 0;
+      if (chunk_size < 0) errorQuda("Invalid QUDA_VECTOR_IO_CHUNK=%s", chunk_env);
+      return chunk_size;
+    }
 
-      host_free(V);
-    } else {
-      errorQuda("Unexpected field dimension %d", vecs[0]->Ndim());
+    /**
+       @brief Copy n reals, converting between double and single precision
+    */
+    void convertReals(void *dst, QudaPrecision dst_prec, const void *src, QudaPrecision src_prec, size_t n)
+    {
+      if (dst_prec == src_prec) {
+        memcpy(dst, src, n * dst_prec);
+      } else if (dst_prec == QUDA_DOUBLE_PRECISION) {
+        for (size_t i = 0; i < n; i++) static_cast<double *>(dst)[i] = static_cast<const float *>(src)[i];
+      } else {
+        for (size_t i = 0; i < n; i++) static_cast<float *>(dst)[i] = static_cast<const double *>(src)[i];
+      }
     }
 
-    if (vecs[0]->Location() == QUDA_CUDA_FIELD_LOCATION) {
+    /**
+       How vectors map to the file: QIO moves host fields in
+       space-spin-color order, holding both parities when single-parity
+       vectors are inflated
+    */
+    struct Staging {
+      ColorSpinorParam param;          // the fields in the file layout
+      ColorSpinorParam transfer_param; // host fields the vectors are copied through
+      QudaParity parity;
+      bool inflate;
+      bool transfer;      // whether the vectors are copied through host fields
+      bool direct;        // whether QIO reads and writes the vectors themselves
+      QudaPrecision prec; // precision of the vectors, or of their host fields
+      int Ls;
+      size_t reals;  // reals per vector in the file layout
+      size_t stride; // reals per 4-d field
 
-      ColorSpinorParam csParam(*vecs[0]);
-      if (csParam.siteSubset == QUDA_FULL_SITE_SUBSET || !parity_inflate) {
-        for (int i = 0; i < Nvec; i++) {
-          *vecs[i] = *tmp[i];
-          delete tmp[i];
+      /**
+         @param[in] v A vector of the set
+         @param[in] parity_inflate Whether to inflate single-parity vectors
+      */
+      Staging(const ColorSpinorField &v, bool parity_inflate) :
+        transfer_param(v),
+        parity(v.SuggestedParity()),
+        inflate(v.SiteSubset() == QUDA_PARITY_SITE_SUBSET && parity_inflate),
+        transfer(v.Location() == QUDA_CUDA_FIELD_LOCATION || v.FieldOrder() != QUDA_SPACE_SPIN_COLOR_FIELD_ORDER),
+        direct(!transfer && !inflate)
+      {
+        // since QIO routines presently assume we have 4-d fields, we need to convert to array of 4-d fields
+        if (v.Ndim() != 4 && v.Ndim() != 5) errorQuda("Unexpected field dimension %d", v.Ndim());
+        if (inflate && parity != QUDA_EVEN_PARITY && parity != QUDA_ODD_PARITY)
+          errorQuda("When loading or saving single parity vectors, the suggested parity must be set.");
+
+        transfer_param.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
+        transfer_param.location = QUDA_CPU_FIELD_LOCATION;
+        transfer_param.setPrecision(v.Precision() < QUDA_SINGLE_PRECISION ? QUDA_SINGLE_PRECISION : v.Precision());
+        transfer_param.create = QUDA_NULL_FIELD_CREATE;
+        prec = transfer_param.Precision();
+
+        param = transfer_param;
+        if (inflate) {
+          param.x[0] *= 2;                          // corrects for the factor of two in the X direction
+          param.siteSubset = QUDA_FULL_SITE_SUBSET; // create a full-parity field.
         }
+
+        Ls = v.Ndim() == 5 ? param.x[4] : 1;
+        stride = static_cast<size_t>(param.x[0]) * param.x[1] * param.x[2] * param.x[3] * 2 * param.nSpin * param.nColor;
+        reals = stride * Ls;
+      }
+
+      /**
+         @return Reals of a vector, which an inflated vector holds from
+         offset() on, with zeros in the other parity
+      */
+      size_t vectorReals() const { return inflate ? reals / 2 : reals; }
+      size_t offset() const { return inflate && parity == QUDA_ODD_PARITY ? reals / 2 : 0; }
+
+      /**
+         @return Host bytes a chunk stages per vector
+      */
+      size_t chunkBytes(QudaPrecision file_prec) const
+      {
+        return (direct ? 0 : reals * file_prec) + (transfer ? vectorReals() * prec : 0);
+      }
+
+      // the host memory the host stage converts a vector to or from
+      void *host(const std::vector<ColorSpinorField *> &vecs, const Chunk &c, int i) const
+      {
+        return transfer ? c.transfer[i]->V() : vecs[c.first + i]->V();
+      }
+
+      // the 4-d fields of n vectors in the file layout
+      template <typename F> std::vector<void *> slices(int n, QudaPrecision file_prec, F &&vector) const
+      {
+        std::vector<void *> V(n * Ls);
+        for (int i = 0; i < n; i++)
+          for (int s = 0; s < Ls; s++) V[i * Ls + s] = static_cast<char *>(vector(i)) + s * stride * file_prec;
+        return V;
+      }
+    };
+
+  } // namespace
+#endif
+
+  void VectorIO::load(std::vector<ColorSpinorField *> &vecs)
+  {
+#ifdef HAVE_QIO
+    const int Nvec = vecs.size();
+    if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Start loading %04d vectors from %s\n", Nvec, filename.c_str());
+
+    Staging staging(*vecs[0], parity_inflate);
+    const int Ls = staging.Ls;
+
+    // Staged vectors are read a chunk at a time.  QIO reads a record
+    // whole, so a record of more vectors than a chunk, e.g., a file
+    // saved as a single record, is read in passes that each keep one
+    // chunk of its vectors.
+    const int chunk_env = chunkEnv();
+    const int chunk_size = staging.direct ?
+      Nvec :
+      (chunk_env > 0 ? chunk_env :
+                       static_cast<int>(std::max(default_chunk_bytes / staging.chunkBytes(QUDA_DOUBLE_PRECISION), size_t(1))));
+
+    QioSpinorInput *infile = open_spinor_input(filename.c_str(), staging.param.x, staging.param.siteSubset);
+    int record = 0;       // the record being read
+    int record_first = 0; // its first vector
+    int record_n = 0;     // its number of vectors
+    int pass_first = 0;   // its first vector not yet read
+    QudaPrecision file_prec = QUDA_INVALID_PRECISION;
+
+    auto enter = [&](int, Chunk &c) {
+      if (pass_first == 0) {
+        int count = next_spinor_record_count(infile, &file_prec);
+        if (count == 0) errorQuda("File %s holds %d vectors, expected %d", filename.c_str(), record_first, Nvec);
+        if (count % Ls != 0)
+          errorQuda("Record of %d fields is not a whole number of %d-d vectors", count, vecs[0]->Ndim());
+        if (record_first + count / Ls > Nvec)
+          errorQuda("File %s holds more than the %d vectors expected", filename.c_str(), Nvec);
+        record_n = count / Ls;
       } else {
-        // Create a temporary single-parity CPU field
-        csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
-        csParam.setPrecision(vecs[0]->Precision() < QUDA_SINGLE_PRECISION ? QUDA_SINGLE_PRECISION : vecs[0]->Precision());
-        csParam.location = QUDA_CPU_FIELD_LOCATION;
-        csParam.create = QUDA_NULL_FIELD_CREATE;
-
-        ColorSpinorField *tmp_intermediate = ColorSpinorField::Create(csParam);
-
-        for (int i = 0; i < Nvec; i++) {
-          if (spinor_parity == QUDA_EVEN_PARITY)
-            blas::copy(*tmp_intermediate, tmp[i]->Even());
-          else if (spinor_parity == QUDA_ODD_PARITY)
-            blas::copy(*tmp_intermediate, tmp[i]->Odd());
-          else
-            errorQuda("When loading single parity vectors, the suggested parity must be set.");
-
-          *vecs[i] = *tmp_intermediate;
-          delete tmp[i];
+        // the next pass over the record starts from the beginning of the file
+        close_spinor_input(infile);
+        infile = open_spinor_input(filename.c_str(), staging.param.x, staging.param.siteSubset);
+        for (int r = 0; r < record; r++) {
+          next_spinor_record_count(infile);
+          skip_spinor_record(infile);
         }
+        next_spinor_record_count(infile);
+      }
+
+      c.first = record_first + pass_first;
+      c.n = std::min(chunk_size, record_n - pass_first);
+      c.file_prec = file_prec;
 
-        delete tmp_intermediate;
+      std::vector<void *> V;
+      if (staging.direct) {
+        V = staging.slices(c.n, staging.prec, [&](int i) { return vecs[c.first + i]->V(); });
+      } else {
+        c.file.resize(c.n);
+        for (auto &f : c.file) f.resize(staging.reals * file_prec);
+        while (staging.transfer && static_cast<int>(c.transfer.size()) < c.n)
+          c.transfer.push_back(ColorSpinorField::Create(staging.transfer_param));
+        V = staging.slices(c.n, file_prec, [&](int i) { return c.file[i].data(); });
       }
-    } else if (vecs[0]->Location() == QUDA_CPU_FIELD_LOCATION && vecs[0]->SiteSubset() == QUDA_PARITY_SITE_SUBSET) {
-      for (int i = 0; i < Nvec; i++) {
-        if (spinor_parity == QUDA_EVEN_PARITY)
-          blas::copy(*vecs[i], tmp[i]->Even());
-        else if (spinor_parity == QUDA_ODD_PARITY)
-          blas::copy(*vecs[i], tmp[i]->Odd());
-        else
-          errorQuda("When loading single parity vectors, the suggested parity must be set.");
-
-        delete tmp[i];
+      read_spinor_record(infile, V.data(), staging.direct ? staging.prec : file_prec, staging.param.siteSubset,
+                         staging.parity, staging.param.nColor, staging.param.nSpin, record_n * Ls, pass_first * Ls,
+                         c.n * Ls);
+
+      pass_first += c.n;
+      if (pass_first == record_n) {
+        record++;
+        record_first += record_n;
+        pass_first = 0;
       }
-    }
+      return record_first + pass_first < Nvec;
+    };
+
+    // convert the precision of the staged vectors and extract their parity
+    auto host = [&](int, Chunk &c) {
+      if (staging.direct) return;
+      for (int i = 0; i < c.n; i++)
+        convertReals(staging.host(vecs, c, i), staging.prec, c.file[i].data() + staging.offset() * c.file_prec,
+                     c.file_prec, staging.vectorReals());
+    };
+
+    auto leave = [&](int, Chunk &c) {
+      if (staging.transfer)
+        for (int i = 0; i < c.n; i++) *vecs[c.first + i] = *c.transfer[i];
+    };
+
+    Chunk chunk[2];
+    pipeline(chunk, enter, host, leave);
+
+    close_spinor_input(infile);
 
     if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Done loading vectors\n");
 #else
@@ -120,93 +333,58 @@ namespace quda
   {
 #ifdef HAVE_QIO
     const int Nvec = vecs.size();
-    std::vector<ColorSpinorField *> tmp;
-    tmp.reserve(Nvec);
-    auto spinor_parity = vecs[0]->SuggestedParity();
-    if (vecs[0]->Location() == QUDA_CUDA_FIELD_LOCATION) {
-      ColorSpinorParam csParam(*vecs[0]);
-      csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
-      csParam.setPrecision(vecs[0]->Precision() < QUDA_SINGLE_PRECISION ? QUDA_SINGLE_PRECISION : vecs[0]->Precision());
-      csParam.location = QUDA_CPU_FIELD_LOCATION;
-
-      if (csParam.siteSubset == QUDA_FULL_SITE_SUBSET || !parity_inflate) {
-        // We're good, copy as is.
-        csParam.create = QUDA_NULL_FIELD_CREATE;
-        for (int i = 0; i < Nvec; i++) {
-          tmp.push_back(ColorSpinorField::Create(csParam));
-          *tmp[i] = *vecs[i];
-        }
-      } else { // QUDA_PARITY_SITE_SUBSET
-        csParam.create = QUDA_NULL_FIELD_CREATE;
-
-        // intermediate host single-parity field
-        ColorSpinorField *tmp_intermediate = ColorSpinorField::Create(csParam);
-
-        csParam.x[0] *= 2;                          // corrects for the factor of two in the X direction
-        csParam.siteSubset = QUDA_FULL_SITE_SUBSET; // create a full-parity field.
-        csParam.create = QUDA_ZERO_FIELD_CREATE;    // to explicitly zero the odd sites.
-        for (int i = 0; i < Nvec; i++) {
-          tmp.push_back(ColorSpinorField::Create(csParam));
-
-          // copy the single parity eigen/singular vector into an
-          // intermediate device-side vector
-          *tmp_intermediate = *vecs[i];
-
-          // copy the single parity only eigen/singular vector into the even components of the full parity vector
-          if (spinor_parity == QUDA_EVEN_PARITY)
-            blas::copy(tmp[i]->Even(), *tmp_intermediate);
-          else if (spinor_parity == QUDA_ODD_PARITY)
-            blas::copy(tmp[i]->Odd(), *tmp_intermediate);
-          else
-            errorQuda("When saving single parity vectors, the suggested parity must be set.");
-        }
-        delete tmp_intermediate;
+
+    Staging staging(*vecs[0], parity_inflate);
+    const int Ls = staging.Ls;
+
+    // the set is written as a single record, the format of earlier
+    // versions, unless QUDA_VECTOR_IO_CHUNK asks for a record per chunk
+    const int chunk_env = chunkEnv();
+    const int chunk_size = chunk_env > 0 ? std::min(chunk_env, Nvec) : Nvec;
+    const int n_chunk = (Nvec + chunk_size - 1) / chunk_size;
+
+    if (getVerbosity() >= QUDA_SUMMARIZE)
+      printfQuda("Start saving %d vectors to %s in %d record(s)\n", Nvec, filename.c_str(), n_chunk);
+
+    QioSpinorOutput *outfile = open_spinor_output(filename.c_str(), staging.param.x, staging.param.siteSubset);
+
+    auto enter = [&](int k, Chunk &c) {
+      c.first = k * chunk_size;
+      c.n = std::min(chunk_size, Nvec - c.first);
+      if (staging.transfer) {
+        while (static_cast<int>(c.transfer.size()) < c.n)
+          c.transfer.push_back(ColorSpinorField::Create(staging.transfer_param));
+        for (int i = 0; i < c.n; i++) *c.transfer[i] = *vecs[c.first + i];
       }
-    } else {
-      ColorSpinorParam csParam(*vecs[0]);
-      if (csParam.siteSubset == QUDA_PARITY_SITE_SUBSET && parity_inflate) {
-        csParam.x[0] *= 2;
-        csParam.siteSubset = QUDA_FULL_SITE_SUBSET;
-        csParam.create = QUDA_ZERO_FIELD_CREATE;
-        for (int i = 0; i < Nvec; i++) {
-          tmp.push_back(ColorSpinorField::Create(csParam));
-          if (spinor_parity == QUDA_EVEN_PARITY)
-            blas::copy(tmp[i]->Even(), *vecs[i]);
-          else if (spinor_parity == QUDA_ODD_PARITY)
-            blas::copy(tmp[i]->Odd(), *vecs[i]);
-          else
-            errorQuda("When saving single parity vectors, the suggested parity must be set.");
-        }
-      } else {
-        for (int i = 0; i < Nvec; i++) { tmp.push_back(vecs[i]); }
+      if (staging.inflate) {
+        // the other parity is zero, and is never written
+        while (static_cast<int>(c.file.size()) < c.n) c.file.emplace_back(staging.reals * staging.prec, 0);
       }
-    }
+      return k + 1 < n_chunk;
+    };
 
-    if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Start saving %d vectors to %s\n", Nvec, filename.c_str());
+    // inflate the vectors to both parities
+    auto host = [&](int, Chunk &c) {
+      if (!staging.inflate) return;
+      for (int i = 0; i < c.n; i++)
+        convertReals(c.file[i].data() + staging.offset() * staging.prec, staging.prec, staging.host(vecs, c, i),
+                     staging.prec, staging.vectorReals());
+    };
 
-    if (vecs[0]->Ndim() == 4 || vecs[0]->Ndim() == 5) {
-      // since QIO routines presently assume we have 4-d fields, we need to convert to array of 4-d fields
-      auto Ls = vecs[0]->Ndim() == 5 ? tmp[0]->X(4) : 1;
-      auto V4 = tmp[0]->Volume() / Ls;
-      auto stride = V4 * tmp[0]->Ncolor() * tmp[0]->Nspin() * 2 * tmp[0]->Precision();
-      void **V = static_cast<void **>(safe_malloc(Nvec * Ls * sizeof(void *)));
-      for (int i = 0; i < Nvec; i++) {
-        for (int j = 0; j < Ls; j++) { V[i * Ls + j] = static_cast<char *>(tmp[i]->V()) + j * stride; }
-      }
+    auto leave = [&](int, Chunk &c) {
+      auto V = staging.slices(c.n, staging.prec, [&](int i) -> void * {
+        return staging.inflate ? c.file[i].data() : staging.host(vecs, c, i);
+      });
+      write_spinor_record(outfile, V.data(), staging.prec, staging.param.siteSubset, staging.parity,
+                          staging.param.nColor, staging.param.nSpin, c.n * Ls);
+    };
 
-      write_spinor_field(filename.c_str(), &V[0], tmp[0]->Precision(), tmp[0]->X(), tmp[0]->SiteSubset(), spinor_parity,
-                         tmp[0]->Ncolor(), tmp[0]->Nspin(), Nvec * Ls, 0, (char **)0);
+    Chunk chunk[2];
+    pipeline(chunk, enter, host, leave);
 
-      host_free(V);
-    } else {
-      errorQuda("Unexpected field dimension %d", vecs[0]->Ndim());
-    }
+    close_spinor_output(outfile);
 
     if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Done saving vectors\n");
-    if (vecs[0]->Location() == QUDA_CUDA_FIELD_LOCATION
-        || (vecs[0]->Location() == QUDA_CPU_FIELD_LOCATION && vecs[0]->SiteSubset() == QUDA_PARITY_SITE_SUBSET)) {
-      for (int i = 0; i < Nvec; i++) delete tmp[i];
-    }
 #else
     errorQuda("\nQIO library was not built.\n");
 #endif
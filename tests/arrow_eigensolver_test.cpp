@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+#include <arrow_eigensolver.h>
+#include <Eigen/Dense>
+#include <Eigen/Eigenvalues>
+
+// google test
+#include <gtest/gtest.h>
+
+using namespace quda;
+
+/**
+   Unit tests of ArrowEigensolver against Eigen's dense
+   SelfAdjointEigenSolver on random arrow matrices: a real diagonal,
+   an arrow of block size b and a block tridiagonal tail.  Besides
+   generic matrices, the cases exercise the deflation paths of the
+   arrowhead merges: zero arrow elements, repeated and nearly repeated
+   diagonal elements, and a zero subdiagonal block, which decouples the
+   tail.  Eigenvectors are only unique up to a rotation within a
+   degenerate eigenspace, so they are checked through their residuals
+   and orthonormality rather than element by element.
+*/
+
+template <typename T> using Mat = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+
+enum class Shape { Generic, ZeroArrow, RepeatedDiagonal, NearRepeatedDiagonal, SplitTail };
+
+struct ArrowCase {
+  int n;
+  int b;
+  int k;
+  Shape shape;
+};
+
+static double uniform(std::mt19937_64 &rng) { return std::uniform_real_distribution<double>(-1.0, 1.0)(rng); }
+
+static void random(double &x, std::mt19937_64 &rng) { x = uniform(rng); }
+static void random(std::complex<double> &x, std::mt19937_64 &rng)
+{
+  const double re = uniform(rng);
+  x = {re, uniform(rng)};
+}
+
+/**
+   @brief Fill the solver with a random matrix of the given shape and
+   return the same matrix in dense form
+ */
+template <typename T> Mat<T> fill(ArrowEigensolver<T> &solver, const ArrowCase &c, std::mt19937_64 &rng)
+{
+  const int n = c.n, b = c.b, k = c.k;
+  solver.resize(n, b, k);
+  Mat<T> A = Mat<T>::Zero(n, n);
+
+  for (int i = 0; i < k; i++) {
+    double d = uniform(rng);
+    // groups of three equal, or nearly equal, diagonal elements
+    const double d0 = Eigen::numext::real(A(i - i % 3, i - i % 3));
+    if (c.shape == Shape::RepeatedDiagonal && i % 3 != 0) d = d0;
+    if (c.shape == Shape::NearRepeatedDiagonal && i % 3 != 0) d = d0 + 1e-15 * (i % 3);
+    solver.diagonal(i) = d;
+    A(i, i) = d;
+  }
+
+  for (int r = 0; r < b; r++) {
+    for (int i = 0; i < k; i++) {
+      T z;
+      random(z, rng);
+      if (c.shape == Shape::ZeroArrow && (i + r) % 2 == 0) z = 0.0;
+      solver.arrow(r, i) = z;
+      A(k + r, i) = z;
+      A(i, k + r) = Eigen::numext::conj(z);
+    }
+  }
+
+  const int nb = (n - k) / b;
+  for (int i = 0; i < nb; i++) {
+    for (int r = 0; r < b; r++) {
+      for (int col = 0; col <= r; col++) {
+        T x;
+        random(x, rng);
+        if (r == col) x = Eigen::numext::real(x);
+        solver.block(i, r, col) = x;
+        A(k + i * b + r, k + i * b + col) = x;
+        A(k + i * b + col, k + i * b + r) = Eigen::numext::conj(x);
+      }
+    }
+    if (i == nb - 1) continue;
+    for (int r = 0; r < b; r++) {
+      for (int col = 0; col < b; col++) {
+        T x;
+        random(x, rng);
+        if (c.shape == Shape::SplitTail && i == nb / 2) x = 0.0;
+        solver.subBlock(i, r, col) = x;
+        A(k + (i + 1) * b + r, k + i * b + col) = x;
+        A(k + i * b + col, k + (i + 1) * b + r) = Eigen::numext::conj(x);
+      }
+    }
+  }
+  return A;
+}
+
+template <typename T> void check(const ArrowCase &c, unsigned seed)
+{
+  const int n = c.n;
+  std::mt19937_64 rng(seed);
+  ArrowEigensolver<T> solver;
+  Mat<T> A = fill(solver, c, rng);
+  solver.compute();
+
+  Eigen::SelfAdjointEigenSolver<Mat<T>> dense(A);
+  const double scale = A.norm();
+  const double tol = 1e-12 * scale * std::sqrt(static_cast<double>(n));
+
+  for (int i = 0; i < n; i++) EXPECT_NEAR(solver.eigenvalue(i), dense.eigenvalues()[i], tol) << "eigenvalue " << i;
+  for (int i = 1; i < n; i++) EXPECT_LE(solver.eigenvalue(i - 1), solver.eigenvalue(i)) << "eigenvalue " << i;
+
+  // every eigenvector, with the residual of each and orthonormality of the set
+  Mat<T> V(n, n);
+  solver.vectors(n, V.data());
+  Eigen::VectorXd lambda(n);
+  for (int i = 0; i < n; i++) lambda[i] = solver.eigenvalue(i);
+  const Mat<T> R = A * V - V * lambda.asDiagonal();
+  for (int i = 0; i < n; i++) EXPECT_LE(R.col(i).norm(), tol) << "eigenvector " << i;
+  EXPECT_LE((V.adjoint() * V - Mat<T>::Identity(n, n)).norm(), 1e-12 * n);
+
+  // a leading subset of the eigenvectors matches the full set
+  const int p = std::max(1, n / 4);
+  Mat<T> Vp(n, p);
+  solver.vectors(p, Vp.data());
+  EXPECT_LE((Vp - V.leftCols(p)).norm(), 1e-12 * p);
+
+  // the last row of the eigenvector matrix, from which TRLM computes the residua
+  std::vector<T> row(n);
+  solver.lastRow(row.data());
+  double row_err = 0.0;
+  for (int i = 0; i < n; i++) row_err = std::max(row_err, std::abs(row[i] - V(n - 1, i)));
+  EXPECT_LE(row_err, 1e-12 * std::sqrt(static_cast<double>(n)));
+}
+
+static std::string name(const ::testing::TestParamInfo<ArrowCase> &info)
+{
+  static const char *shapes[] = {"generic", "zero_arrow", "repeated_diagonal", "near_repeated_diagonal", "split_tail"};
+  const ArrowCase &c = info.param;
+  return std::string(shapes[static_cast<int>(c.shape)]) + "_n" + std::to_string(c.n) + "_b" + std::to_string(c.b)
+    + "_k" + std::to_string(c.k);
+}
+
+// tails longer than the dense leaf size (64) are solved by divide and conquer
+static const std::vector<ArrowCase> real_cases = {
+  {2, 1, 1, Shape::Generic},
+  {100, 1, 0, Shape::Generic},
+  {10, 1, 4, Shape::Generic},
+  {40, 1, 20, Shape::Generic},
+  {300, 1, 100, Shape::Generic},
+  {300, 1, 100, Shape::ZeroArrow},
+  {300, 1, 150, Shape::RepeatedDiagonal},
+  {300, 1, 150, Shape::NearRepeatedDiagonal},
+  {300, 1, 60, Shape::SplitTail},
+};
+
+static const std::vector<ArrowCase> complex_cases = {
+  {12, 1, 6, Shape::Generic},
+  {300, 1, 100, Shape::Generic},
+  {12, 2, 4, Shape::Generic},
+  {24, 4, 8, Shape::Generic},
+  {200, 4, 0, Shape::Generic},
+  {240, 2, 80, Shape::Generic},
+  {320, 4, 96, Shape::Generic},
+  {320, 4, 96, Shape::ZeroArrow},
+  {320, 4, 160, Shape::RepeatedDiagonal},
+  {320, 4, 160, Shape::NearRepeatedDiagonal},
+  {320, 4, 64, Shape::SplitTail},
+  {240, 8, 48, Shape::Generic},
+};
+
+class RealArrowTest : public ::testing::TestWithParam<ArrowCase>
+{
+};
+
+TEST_P(RealArrowTest, dense) { check<double>(GetParam(), 1234); }
+
+INSTANTIATE_TEST_SUITE_P(ArrowEigensolver, RealArrowTest, ::testing::ValuesIn(real_cases), name);
+
+class ComplexArrowTest : public ::testing::TestWithParam<ArrowCase>
+{
+};
+
+TEST_P(ComplexArrowTest, dense) { check<std::complex<double>>(GetParam(), 5678); }
+
+INSTANTIATE_TEST_SUITE_P(ArrowEigensolver, ComplexArrowTest, ::testing::ValuesIn(complex_cases), name);
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,98 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+// QUDA headers
+#include <quda.h>
+#include <color_spinor_field.h>
+
+// External headers
+#include <misc.h>
+#include <host_utils.h>
+#include <command_line_params.h>
+
+namespace quda
+{
+  extern double chronoApDeviation(QudaInvertParam &param);
+}
+
+/**
+   Check the chronological forecast: a series of solves builds up a
+   resident basis, and from the third solve on the forecast
+   extrapolates from two or more basis vectors.  After every solve,
+   each resident A p product must still equal the operator applied to
+   its basis vector, which the products are computed with, exactly.
+*/
+
+int main(int argc, char **argv)
+{
+  auto app = make_app();
+  try {
+    app->parse(argc, argv);
+  } catch (const CLI::ParseError &e) {
+    return app->exit(e);
+  }
+
+  // Set values for precisions via the command line.
+  setQudaPrecisions();
+
+  // initialize QMP/MPI, QUDA comms grid and RNG (host_utils.cpp)
+  initComms(argc, argv, gridsize_from_cmdline);
+
+  dslash_type = QUDA_WILSON_DSLASH;
+  QudaGaugeParam gauge_param = newQudaGaugeParam();
+  setWilsonGaugeParam(gauge_param);
+  QudaInvertParam inv_param = newQudaInvertParam();
+  setInvertParam(inv_param);
+
+  const int n_solve = 4;
+  inv_param.chrono_make_resident = 1;
+  inv_param.chrono_use_resident = 1;
+  inv_param.chrono_replace_last = 0;
+  inv_param.chrono_max_dim = n_solve;
+  inv_param.chrono_index = 0;
+  inv_param.chrono_precision = inv_param.cuda_prec;
+
+  initQuda(device_ordinal);
+
+  setDims(gauge_param.X);
+  setSpinorSiteSize(24);
+
+  void *gauge[4];
+  for (int dir = 0; dir < 4; dir++) gauge[dir] = malloc(V * gauge_site_size * host_gauge_data_type_size);
+  constructHostGaugeField(gauge, gauge_param, argc, argv);
+  loadGaugeQuda((void *)gauge, &gauge_param);
+
+  quda::ColorSpinorParam cs_param;
+  constructWilsonTestSpinorParam(&cs_param, &inv_param, &gauge_param);
+  quda::ColorSpinorField *in = quda::ColorSpinorField::Create(cs_param);
+  quda::ColorSpinorField *out = quda::ColorSpinorField::Create(cs_param);
+
+  auto *rng = new quda::RNG(quda::LatticeFieldParam(gauge_param), 1234);
+  rng->Init();
+
+  int failed = 0;
+  for (int i = 0; i < n_solve; i++) {
+    constructRandomSpinorSource(in->V(), 4, 3, inv_param.cpu_prec, gauge_param.X, *rng);
+    invertQuda(out->V(), in->V(), &inv_param);
+
+    double deviation = quda::chronoApDeviation(inv_param);
+    printfQuda("Solve %d: %d iter, resident A p deviation from A applied to the basis = %e\n", i, inv_param.iter,
+               deviation);
+    if (deviation > 0.0) failed++;
+  }
+  if (failed > 0) printfQuda("The resident A p products drifted after %d of %d solves\n", failed, n_solve);
+
+  rng->Release();
+  delete rng;
+
+  delete in;
+  delete out;
+
+  freeGaugeQuda();
+  for (int dir = 0; dir < 4; dir++) free(gauge[dir]);
+
+  endQuda();
+  finalizeComms();
+
+  return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <comm_quda.h>
+
+// google test
+#include <gtest/gtest.h>
+
+/**
+   Unit tests of the integer representation of the reproducible sums
+   (comm_reproducible_encode/decode).  A reduction over ranks adds the
+   digits of the contributions in an order and grouping that depend on
+   the number of ranks and on the backend; these tests add the digits
+   of a fixed set of terms with many groupings and orders, and require
+   the decoded sums to be bitwise identical and accurate.
+*/
+
+using digits_t = std::vector<int64_t>;
+
+static bool bitwiseEqual(double a, double b) { return memcmp(&a, &b, sizeof(double)) == 0; }
+
+/**
+   @brief The max-reduced exponent of a set of terms
+ */
+static int maxExponent(const std::vector<double> &terms)
+{
+  int exponent = std::numeric_limits<int>::min();
+  for (auto t : terms) {
+    int e;
+    comm_reproducible_exponent(&e, &t, 1);
+    exponent = std::max(exponent, e);
+  }
+  return exponent;
+}
+
+static digits_t encode(double x, int exponent)
+{
+  digits_t d(comm_reproducible_words);
+  comm_reproducible_encode(d.data(), &x, &exponent, 1);
+  return d;
+}
+
+static void add(digits_t &a, const digits_t &b)
+{
+  for (int k = 0; k < comm_reproducible_words; k++) a[k] += b[k];
+}
+
+static double decode(digits_t d, int exponent)
+{
+  double x;
+  comm_reproducible_decode(&x, d.data(), &exponent, 1);
+  return x;
+}
+
+/**
+   @brief Sum the terms as a reduction over ranks would: the terms
+   are split into nranks contiguous groups in the given order, each
+   group is summed, and the group sums are combined by a binary tree
+ */
+static double treeSum(const std::vector<double> &terms, const std::vector<int> &order, int nranks)
+{
+  const int exponent = maxExponent(terms);
+  std::vector<digits_t> rank(nranks, digits_t(comm_reproducible_words, 0));
+  for (size_t i = 0; i < order.size(); i++) add(rank[i * nranks / order.size()], encode(terms[order[i]], exponent));
+
+  for (int stride = 1; stride < nranks; stride *= 2)
+    for (int r = 0; r + stride < nranks; r += 2 * stride) add(rank[r], rank[r + stride]);
+  return decode(rank[0], exponent);
+}
+
+TEST(Reproducible, roundTrip)
+{
+  // a single term is exactly representable on its own grid
+  std::mt19937_64 rng(1234);
+  std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+  std::uniform_int_distribution<int> exponent(-1000, 1000);
+  for (int i = 0; i < 10000; i++) {
+    const double x = std::ldexp(mantissa(rng), exponent(rng));
+    EXPECT_TRUE(bitwiseEqual(decode(encode(x, maxExponent({x})), maxExponent({x})), x)) << x;
+  }
+  for (double x : {0.0, std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::min(),
+                   std::numeric_limits<double>::max(), -std::numeric_limits<double>::max()})
+    EXPECT_TRUE(bitwiseEqual(decode(encode(x, maxExponent({x})), maxExponent({x})), x)) << x;
+}
+
+TEST(Reproducible, nonFinite)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  auto sum = [](const std::vector<double> &terms) {
+    std::vector<int> order(terms.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    return treeSum(terms, order, terms.size());
+  };
+
+  EXPECT_EQ(sum({1.0, inf, -2.0}), inf);
+  EXPECT_EQ(sum({1.0, -inf, 3.0}), -inf);
+  EXPECT_TRUE(std::isnan(sum({inf, -inf})));
+  EXPECT_TRUE(std::isnan(sum({1.0, nan, inf})));
+}
+
+TEST(Reproducible, groupings)
+{
+  // terms spanning many orders of magnitude of both signs, on a grid
+  // fine enough that they sum exactly in 128-bit integer arithmetic
+  const int n = 5040;
+  const int scale = 60;
+  std::mt19937_64 rng(5678);
+  std::uniform_int_distribution<int64_t> mantissa(-(int64_t(1) << 53) + 1, (int64_t(1) << 53) - 1);
+  std::uniform_int_distribution<int> shift(0, scale);
+  std::vector<double> terms(n);
+  __int128 exact = 0;
+  for (auto &t : terms) {
+    const int64_t m = mantissa(rng);
+    const int s = shift(rng);
+    t = std::ldexp(static_cast<double>(m), s - scale);
+    exact += static_cast<__int128>(m) * (static_cast<__int128>(1) << s);
+  }
+  // leave a large cancellation, so that the order of a floating-point sum would matter
+  const double total = static_cast<double>(exact);
+  terms.push_back(-std::ldexp(total, -scale));
+  exact -= static_cast<__int128>(total);
+  const double expected = std::ldexp(static_cast<double>(exact), -scale);
+
+  std::vector<int> order(terms.size());
+  for (size_t i = 0; i < order.size(); i++) order[i] = i;
+  const double reference = treeSum(terms, order, 1);
+  EXPECT_LE(std::fabs(reference - expected), 2.0 * std::fabs(expected) * std::numeric_limits<double>::epsilon());
+  EXPECT_NE(expected, 0.0);
+
+  for (int nranks : {2, 3, 7, 8, 60, 1000, static_cast<int>(terms.size())}) {
+    for (int shuffle = 0; shuffle < 4; shuffle++) {
+      std::shuffle(order.begin(), order.end(), rng);
+      EXPECT_TRUE(bitwiseEqual(treeSum(terms, order, nranks), reference)) << nranks << " ranks, shuffle " << shuffle;
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,175 @@
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <quda.h>
+#include <comm_quda.h>
+#include <color_spinor_field.h>
+
+#include <host_utils.h>
+#include <wilson_dslash_reference.h>
+
+// Test of the host Wilson dslash on a decomposed lattice: runs a
+// partitioned process grid as threads of this process, applies the
+// reference dslash on every rank, whose neighbors across the rank
+// boundaries arrive through the halo exchange of the threaded
+// backend, and compares the result with the dslash of a single rank
+// holding the whole lattice.  Both apply the same operations in the
+// same order to the same values at every site, so the results must
+// agree exactly.
+//
+// usage: comm_threads_dslash_test [gridx gridy gridz gridt]
+
+static int grid[4] = {2, 1, 1, 2};
+static const int X[4] = {4, 4, 4, 6}; // local lattice of every rank
+static int G[4];                      // global lattice
+static std::atomic<int> failures(0);
+
+// dslash of the whole lattice, indexed as the fields of a single rank
+static std::vector<double> reference[2][2]; // [parity][dagger]
+
+/**
+   @brief A pseudo-random value in [-1, 1) for component k of site
+   index of a field, the same on every rank
+*/
+static double globalValue(int index, int k, int field)
+{
+  uint64_t h = (static_cast<uint64_t>(index) << 20) ^ (static_cast<uint64_t>(k) << 8) ^ field;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return std::ldexp(static_cast<double>(h >> 11), -52) - 1.0;
+}
+
+struct Lattice {
+  const int *L;   // local lattice
+  int offset[4];  // global coordinates of the local origin
+
+  int volume() const { return L[0] * L[1] * L[2] * L[3]; }
+
+  void coords(int *x, int full) const
+  {
+    x[0] = full % L[0];
+    x[1] = (full / L[0]) % L[1];
+    x[2] = (full / (L[0] * L[1])) % L[2];
+    x[3] = full / (L[0] * L[1] * L[2]);
+  }
+
+  // the global lexicographic index of a local site
+  int global(const int *x) const
+  {
+    int index = 0;
+    for (int d = 3; d >= 0; d--) index = index * G[d] + offset[d] + x[d];
+    return index;
+  }
+};
+
+/**
+   @brief Apply the reference dslash to both parities and both dagger
+   settings of fields that hold the global fields restricted to this
+   rank
+*/
+static void applyDslash(const Lattice &lat, std::vector<double> out[2][2])
+{
+  const int volume = lat.volume();
+  std::vector<double> gauge[4], in[2];
+  for (int mu = 0; mu < 4; mu++) gauge[mu].resize(volume * gauge_site_size);
+  for (int parity = 0; parity < 2; parity++) in[parity].resize(volume / 2 * spinor_site_size);
+
+  // QDP order: the even sites precede the odd ones
+  for (int full = 0; full < volume; full++) {
+    int x[4];
+    lat.coords(x, full);
+    const int parity = (x[0] + x[1] + x[2] + x[3]) % 2;
+    const int global = lat.global(x);
+    for (int mu = 0; mu < 4; mu++)
+      for (int k = 0; k < gauge_site_size; k++)
+        gauge[mu][(parity * volume / 2 + full / 2) * gauge_site_size + k] = globalValue(global, k, mu);
+    for (int k = 0; k < spinor_site_size; k++)
+      in[parity][(full / 2) * spinor_site_size + k] = globalValue(global, k, 4);
+  }
+
+  QudaGaugeParam gauge_param = newQudaGaugeParam();
+  for (int d = 0; d < 4; d++) gauge_param.X[d] = lat.L[d];
+  gauge_param.cpu_prec = QUDA_DOUBLE_PRECISION;
+  gauge_param.cuda_prec = QUDA_DOUBLE_PRECISION;
+  gauge_param.reconstruct = QUDA_RECONSTRUCT_NO;
+  gauge_param.gauge_order = QUDA_QDP_GAUGE_ORDER;
+  gauge_param.type = QUDA_WILSON_LINKS;
+  gauge_param.t_boundary = QUDA_PERIODIC_T;
+  gauge_param.anisotropy = 1.0;
+
+  void *gauge_p[4] = {gauge[0].data(), gauge[1].data(), gauge[2].data(), gauge[3].data()};
+  for (int parity = 0; parity < 2; parity++) {
+    for (int dagger = 0; dagger < 2; dagger++) {
+      out[parity][dagger].resize(volume / 2 * spinor_site_size);
+      wil_dslash(out[parity][dagger].data(), gauge_p, in[1 - parity].data(), parity, dagger, QUDA_DOUBLE_PRECISION,
+                 gauge_param);
+    }
+  }
+}
+
+static void unpartitioned(int, void *)
+{
+  const int single[4] = {1, 1, 1, 1};
+  initCommsGridQuda(4, single, nullptr, nullptr);
+  applyDslash({G, {0, 0, 0, 0}}, reference);
+  comm_barrier();
+}
+
+static void partitioned(int rank, void *)
+{
+  initCommsGridQuda(4, grid, nullptr, nullptr);
+  Lattice lat {X, {}};
+  for (int d = 0; d < 4; d++) lat.offset[d] = comm_coord(d) * X[d];
+
+  std::vector<double> out[2][2];
+  applyDslash(lat, out);
+
+  int mismatches = 0;
+  const int volume = lat.volume();
+  for (int full = 0; full < volume; full++) {
+    int x[4];
+    lat.coords(x, full);
+    const int parity = (x[0] + x[1] + x[2] + x[3]) % 2;
+    const int global = lat.global(x);
+    for (int dagger = 0; dagger < 2; dagger++) {
+      const double *v = &out[parity][dagger][(full / 2) * spinor_site_size];
+      const double *r = &reference[parity][dagger][(global / 2) * spinor_site_size];
+      if (memcmp(v, r, spinor_site_size * sizeof(double)) != 0) mismatches++;
+    }
+  }
+  if (mismatches > 0) {
+    printf("Rank %d: %d of %d sites differ from the unpartitioned dslash\n", rank, mismatches, 2 * volume);
+    failures++;
+  }
+
+  quda::cpuColorSpinorField::freeGhostBuffer();
+  comm_barrier();
+}
+
+int main(int argc, char **argv)
+{
+  if (argc == 5)
+    for (int d = 0; d < 4; d++) grid[d] = atoi(argv[d + 1]);
+  for (int d = 0; d < 4; d++) G[d] = grid[d] * X[d];
+  setSpinorSiteSize(spinor_site_size);
+
+  // the harness geometry is shared by the threaded ranks, which all have the same local lattice
+  setDims(G);
+  comm_threads_launch(1, unpartitioned, nullptr);
+
+  const int nranks = grid[0] * grid[1] * grid[2] * grid[3];
+  printf("Running %d threaded ranks on a %dx%dx%dx%d grid of a %dx%dx%dx%d lattice\n", nranks, grid[0], grid[1],
+         grid[2], grid[3], G[0], G[1], G[2], G[3]);
+  setDims(const_cast<int *>(X));
+  comm_threads_launch(nranks, partitioned, nullptr);
+
+  printf("%s: %d failures\n", failures ? "FAILED" : "PASSED", failures.load());
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
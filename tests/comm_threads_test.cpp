@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <quda.h>
+#include <comm_quda.h>
+#include <color_spinor_field.h>
+#include <gauge_field.h>
+#include <stencil_map.h>
+
+// Test of the threaded communication backend: runs a decomposed
+// process grid as threads of this process and checks the halo
+// exchange (contiguous and strided), the reductions and the
+// broadcast on every rank, that the reproducible sum does not depend
+// on the order of the ranks, and the ghost exchange of host spinor and
+// gauge fields.  The fields hold a function of the global site, so
+// after the exchange every ghost must hold what a single rank
+// holding the whole lattice sees at that site; running on a 1x1x1x1
+// grid checks the same against the periodic wrap of that rank.
+//
+// usage: comm_threads_test [gridx gridy gridz gridt]
+
+static int grid[4] = {2, 2, 1, 2};
+static const int X[4] = {4, 4, 4, 6}; // local lattice of every rank
+static std::atomic<int> failures(0);
+
+static void check(bool pass, const char *what, int rank)
+{
+  if (!pass) {
+    printf("Rank %d: %s failed\n", rank, what);
+    failures++;
+  }
+}
+
+/**
+   @brief The value of component k of a field with n components per
+   site at global coordinates x, which are taken modulo the global
+   lattice
+*/
+static double globalValue(const int *x, int k, int n)
+{
+  int index = 0;
+  for (int d = 3; d >= 0; d--) {
+    const int L = grid[d] * X[d];
+    index = index * L + (x[d] % L + L) % L;
+  }
+  return static_cast<double>(index) * n + k;
+}
+
+/**
+   @brief Global coordinates of the site with local coordinates x,
+   which may lie beyond the local lattice
+*/
+static void globalCoords(int *g, const int *x)
+{
+  for (int d = 0; d < 4; d++) g[d] = comm_coord(d) * X[d] + x[d];
+}
+
+/**
+   @brief Exchange the ghosts of the parity fields of a spinor and
+   check the neighbors of every site at the given hop distance, as
+   the host reference operators gather them, against the global field
+*/
+static void testSpinorGhost(int rank, int nSpin, int nFace, int hop)
+{
+  const int site_size = 2 * nSpin * 3;
+  int partitioned[4];
+  for (int d = 0; d < 4; d++) partitioned[d] = comm_dim_partitioned(d);
+  StencilMap map(X, 1, QUDA_4D_PC, hop, partitioned);
+
+  quda::ColorSpinorParam param;
+  param.nColor = 3;
+  param.nSpin = nSpin;
+  param.nDim = 4;
+  for (int d = 0; d < 4; d++) param.x[d] = X[d];
+  param.x[0] /= 2;
+  param.setPrecision(QUDA_DOUBLE_PRECISION);
+  param.pad = 0;
+  param.siteSubset = QUDA_PARITY_SITE_SUBSET;
+  param.siteOrder = QUDA_EVEN_ODD_SITE_ORDER;
+  param.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
+  param.gammaBasis = QUDA_DEGRAND_ROSSI_GAMMA_BASIS;
+  param.create = QUDA_ZERO_FIELD_CREATE;
+  param.location = QUDA_CPU_FIELD_LOCATION;
+  quda::cpuColorSpinorField even(param), odd(param);
+
+  const int volume = X[0] * X[1] * X[2] * X[3];
+  for (int full = 0; full < volume; full++) {
+    int x[4] = {full % X[0], (full / X[0]) % X[1], (full / (X[0] * X[1])) % X[2], full / (X[0] * X[1] * X[2])};
+    int g[4];
+    globalCoords(g, x);
+    auto &field = (x[0] + x[1] + x[2] + x[3]) % 2 ? odd : even;
+    double *v = static_cast<double *>(field.V()) + (full / 2) * site_size;
+    for (int k = 0; k < site_size; k++) v[k] = globalValue(g, k, site_size);
+  }
+
+  bool pass = true;
+  for (int parity = 0; parity < 2; parity++) {
+    // the neighbors of the sites of one parity are in the field of the other
+    auto &field = parity ? even : odd;
+    field.exchangeGhost(parity ? QUDA_EVEN_PARITY : QUDA_ODD_PARITY, nFace, 0);
+    double **fwd = reinterpret_cast<double **>(quda::cpuColorSpinorField::fwdGhostFaceBuffer);
+    double **back = reinterpret_cast<double **>(quda::cpuColorSpinorField::backGhostFaceBuffer);
+
+    for (int full = 0; full < volume; full++) {
+      int x[4] = {full % X[0], (full / X[0]) % X[1], (full / (X[0] * X[1])) % X[2], full / (X[0] * X[1] * X[2])};
+      if ((x[0] + x[1] + x[2] + x[3]) % 2 != parity) continue;
+      for (int dir = 0; dir < 8; dir++) {
+        const double *nbr
+          = map.spinor(full / 2, dir, parity, static_cast<double *>(field.V()), fwd, back, nFace, site_size);
+        int y[4] = {x[0], x[1], x[2], x[3]};
+        y[dir / 2] += dir % 2 == 0 ? hop : -hop;
+        int g[4];
+        globalCoords(g, y);
+        for (int k = 0; k < site_size; k++) pass = pass && nbr[k] == globalValue(g, k, site_size);
+      }
+    }
+  }
+
+  char what[64];
+  snprintf(what, sizeof(what), "spinor ghost exchange (nSpin=%d, nFace=%d, hop=%d)", nSpin, nFace, hop);
+  check(pass, what, rank);
+}
+
+/**
+   @brief Fill the interior of an extended host gauge field, exchange
+   its borders and check every site of the extended lattice, borders
+   and corners included, against the global field
+*/
+static void testExtendedGaugeGhost(int rank, const int *R)
+{
+  constexpr int site_size = 18;
+  int E[4];
+  for (int d = 0; d < 4; d++) E[d] = X[d] + 2 * R[d];
+
+  quda::GaugeFieldParam param(E, QUDA_DOUBLE_PRECISION, QUDA_RECONSTRUCT_NO, 0, QUDA_VECTOR_GEOMETRY,
+                              QUDA_GHOST_EXCHANGE_EXTENDED);
+  param.nFace = 1;
+  for (int d = 0; d < 4; d++) param.r[d] = R[d];
+  param.order = QUDA_QDP_GAUGE_ORDER;
+  param.link_type = QUDA_GENERAL_LINKS;
+  param.t_boundary = QUDA_PERIODIC_T;
+  param.create = QUDA_ZERO_FIELD_CREATE;
+  quda::cpuGaugeField u(param);
+
+  const int volume = E[0] * E[1] * E[2] * E[3];
+  // the links of a site of the extended lattice, even sites first
+  auto link = [&](int mu, const int *y) {
+    const int full = ((y[3] * E[2] + y[2]) * E[1] + y[1]) * E[0] + y[0];
+    const int parity = (y[0] + y[1] + y[2] + y[3]) % 2;
+    return static_cast<double **>(u.Gauge_p())[mu] + (parity * volume / 2 + full / 2) * site_size;
+  };
+
+  for (int full = 0; full < volume; full++) {
+    int y[4] = {full % E[0], (full / E[0]) % E[1], (full / (E[0] * E[1])) % E[2], full / (E[0] * E[1] * E[2])};
+    bool interior = true;
+    for (int d = 0; d < 4; d++) interior = interior && y[d] >= R[d] && y[d] < X[d] + R[d];
+    if (!interior) continue;
+    int x[4] = {y[0] - R[0], y[1] - R[1], y[2] - R[2], y[3] - R[3]}, g[4];
+    globalCoords(g, x);
+    for (int mu = 0; mu < 4; mu++)
+      for (int k = 0; k < site_size; k++) link(mu, y)[k] = globalValue(g, mu * site_size + k, 4 * site_size);
+  }
+
+  u.exchangeExtendedGhost(R, true);
+
+  bool pass = true;
+  for (int full = 0; full < volume; full++) {
+    int y[4] = {full % E[0], (full / E[0]) % E[1], (full / (E[0] * E[1])) % E[2], full / (E[0] * E[1] * E[2])};
+    int x[4] = {y[0] - R[0], y[1] - R[1], y[2] - R[2], y[3] - R[3]}, g[4];
+    globalCoords(g, x);
+    for (int mu = 0; mu < 4; mu++)
+      for (int k = 0; k < site_size; k++)
+        pass = pass && link(mu, y)[k] == globalValue(g, mu * site_size + k, 4 * site_size);
+  }
+
+  char what[64];
+  snprintf(what, sizeof(what), "extended gauge ghost exchange (R=%d,%d,%d,%d)", R[0], R[1], R[2], R[3]);
+  check(pass, what, rank);
+}
+
+/**
+   @brief The contribution of a rank to element i of the reproducible
+   sum: terms of both signs and very different magnitudes, whose
+   floating-point sum depends on the order of the ranks
+*/
+static double reproducibleTerm(int rank, int i)
+{
+  return std::ldexp(std::sin(1.0 + rank + 7.0 * i), (rank * 37 + i) % 90 - 45);
+}
+
+static void testReproducibleSum(int rank)
+{
+  // every rank must get the sum of the digits of all contributions,
+  // which is the same for any order, here the ranks in reverse
+  const int n = 16;
+  const int size = comm_size();
+  std::vector<double> sum(n);
+  for (int i = 0; i < n; i++) sum[i] = reproducibleTerm(rank, i);
+  comm_allreduce_reproducible(sum.data(), n);
+
+  bool pass = true;
+  for (int i = 0; i < n; i++) {
+    std::vector<double> terms(size);
+    for (int r = 0; r < size; r++) terms[r] = reproducibleTerm(size - 1 - r, i);
+
+    std::vector<int> exponent(size);
+    comm_reproducible_exponent(exponent.data(), terms.data(), size);
+    int max_exponent = *std::max_element(exponent.begin(), exponent.end());
+    for (auto &e : exponent) e = max_exponent;
+
+    std::vector<int64_t> digits(size * comm_reproducible_words), total(comm_reproducible_words, 0);
+    comm_reproducible_encode(digits.data(), terms.data(), exponent.data(), size);
+    for (int r = 0; r < size; r++)
+      for (int k = 0; k < comm_reproducible_words; k++) total[k] += digits[r * comm_reproducible_words + k];
+    double expected;
+    comm_reproducible_decode(&expected, total.data(), &max_exponent, 1);
+    pass = pass && memcmp(&expected, &sum[i], sizeof(double)) == 0;
+  }
+  check(pass, "comm_allreduce_reproducible", rank);
+}
+
+static void test(int rank, void *)
+{
+  initCommsGridQuda(4, grid, nullptr, nullptr);
+  const int size = comm_size();
+  check(comm_rank() == rank, "comm_rank", rank);
+
+  // exchange our rank with both neighbors in every partitioned dimension
+  for (int d = 0; d < 4; d++) {
+    if (!comm_dim_partitioned(d)) continue;
+    int send_fwd = rank, send_back = rank, recv_fwd = -1, recv_back = -1;
+    MsgHandle *mh_recv_back = comm_declare_receive_relative(&recv_back, d, -1, sizeof(int));
+    MsgHandle *mh_recv_fwd = comm_declare_receive_relative(&recv_fwd, d, +1, sizeof(int));
+    MsgHandle *mh_send_back = comm_declare_send_relative(&send_back, d, -1, sizeof(int));
+    MsgHandle *mh_send_fwd = comm_declare_send_relative(&send_fwd, d, +1, sizeof(int));
+    comm_start(mh_recv_back);
+    comm_start(mh_recv_fwd);
+    comm_start(mh_send_fwd);
+    comm_start(mh_send_back);
+    comm_wait(mh_send_fwd);
+    comm_wait(mh_send_back);
+    comm_wait(mh_recv_back);
+    comm_wait(mh_recv_fwd);
+    comm_free(mh_send_fwd);
+    comm_free(mh_send_back);
+    comm_free(mh_recv_back);
+    comm_free(mh_recv_fwd);
+    check(recv_back == comm_neighbor_rank(0, d), "halo exchange (backward)", rank);
+    check(recv_fwd == comm_neighbor_rank(1, d), "halo exchange (forward)", rank);
+  }
+
+  // strided exchange: every other int of the send buffer into every third int of the receive buffer
+  for (int d = 0; d < 4; d++) {
+    if (!comm_dim_partitioned(d)) continue;
+    const int nblocks = 8;
+    std::vector<int> send(2 * nblocks), recv(3 * nblocks, -1);
+    for (int i = 0; i < nblocks; i++) send[2 * i] = 100 * rank + i;
+    MsgHandle *mh_recv = comm_declare_strided_receive_relative(recv.data(), d, -1, sizeof(int), nblocks, 3 * sizeof(int));
+    MsgHandle *mh_send = comm_declare_strided_send_relative(send.data(), d, +1, sizeof(int), nblocks, 2 * sizeof(int));
+    comm_start(mh_recv);
+    comm_start(mh_send);
+    comm_wait(mh_send);
+    comm_wait(mh_recv);
+    comm_free(mh_send);
+    comm_free(mh_recv);
+    bool pass = true;
+    for (int i = 0; i < nblocks; i++) {
+      pass = pass && recv[3 * i] == 100 * comm_neighbor_rank(0, d) + i;
+      pass = pass && recv[3 * i + 1] == -1 && recv[3 * i + 2] == -1;
+    }
+    check(pass, "strided exchange", rank);
+  }
+
+  double sum = rank;
+  comm_allreduce(&sum);
+  check(sum == size * (size - 1) / 2.0, "comm_allreduce", rank);
+
+  double max = rank, min = rank;
+  comm_allreduce_max(&max);
+  comm_allreduce_min(&min);
+  check(max == size - 1 && min == 0, "comm_allreduce_max/min", rank);
+
+  int isum = 1;
+  comm_allreduce_int(&isum);
+  check(isum == size, "comm_allreduce_int", rank);
+
+  uint64_t x = uint64_t(1) << rank;
+  comm_allreduce_xor(&x);
+  check(x == (uint64_t(1) << size) - 1, "comm_allreduce_xor", rank);
+
+  double array[3] = {1.0, 0.5 * rank, -1.0 * rank};
+  comm_allreduce_array(array, 3);
+  check(array[0] == size && array[1] == 0.25 * size * (size - 1) && array[2] == -0.5 * size * (size - 1),
+        "comm_allreduce_array", rank);
+
+  testReproducibleSum(rank);
+
+  int value = rank == 0 ? 42 : 0;
+  comm_broadcast(&value, sizeof(int));
+  check(value == 42, "comm_broadcast", rank);
+
+#ifdef NSPIN4
+  testSpinorGhost(rank, 4, 1, 1);
+#endif
+#ifdef NSPIN1
+  testSpinorGhost(rank, 1, 3, 1);
+  testSpinorGhost(rank, 1, 3, 3);
+#endif
+  quda::cpuColorSpinorField::freeGhostBuffer();
+
+#ifdef BUILD_QDP_INTERFACE
+  const int R1[4] = {1, 1, 1, 1};
+  const int R2[4] = {2, 2, 0, 2};
+  testExtendedGaugeGhost(rank, R1);
+  testExtendedGaugeGhost(rank, R2);
+#endif
+
+  comm_barrier();
+}
+
+int main(int argc, char **argv)
+{
+  if (argc == 5)
+    for (int d = 0; d < 4; d++) grid[d] = atoi(argv[d + 1]);
+
+  const int nranks = grid[0] * grid[1] * grid[2] * grid[3];
+  printf("Running %d threaded ranks on a %dx%dx%dx%d grid\n", nranks, grid[0], grid[1], grid[2], grid[3]);
+  comm_threads_launch(nranks, test, nullptr);
+
+  printf("%s: %d failures\n", failures ? "FAILED" : "PASSED", failures.load());
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -19,6 +19,7 @@
 #include <domain_wall_dslash_reference.h>
 #include "misc.h"
 #include "dslash_test_helpers.h"
+#include <reference_cache.h>
 
 // google test frame work
 #include <gtest/gtest.h>
@@ -520,6 +521,24 @@ DslashTime dslashCUDA(int niter) {
 
 void dslashRef()
 {
+  // reuse the reference of an earlier run with the same fields and parameters
+  ReferenceCache cache("dslash_test");
+  for (int dir = 0; dir < 4; dir++) cache.input(hostGauge[dir], (size_t)V * gauge_site_size * gauge_param.cpu_prec);
+  if (dslash_type == QUDA_CLOVER_WILSON_DSLASH || dslash_type == QUDA_CLOVER_HASENBUSCH_TWIST_DSLASH
+      || dslash_type == QUDA_TWISTED_CLOVER_DSLASH) {
+    cache.input(hostClover, (size_t)V * clover_site_size * inv_param.clover_cpu_prec);
+    cache.input(hostCloverInv, (size_t)V * clover_site_size * inv_param.clover_cpu_prec);
+  }
+  cache.input(spinor->V(), spinor->Bytes())
+    .gaugeParam(gauge_param)
+    .invertParam(inv_param)
+    .param(dtest_type)
+    .param(parity)
+    .param(dagger)
+    .param(kappa5)
+    .output(spinorRef->V(), spinorRef->Bytes());
+  if (cache.load()) return;
+
   // compare to dslash reference implementation
   printfQuda("Calculating reference implementation...");
 
@@ -939,6 +958,7 @@ void dslashRef()
   }
 
   printfQuda("done.\n");
+  cache.save();
 }
 
 void display_test_info()
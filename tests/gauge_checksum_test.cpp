@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <host_utils.h>
+#include <command_line_params.h>
+#include <gauge_field.h>
+
+// google test
+#include <gtest/gtest.h>
+
+using namespace quda;
+
+/**
+   Unit tests of the hierarchical gauge-field checksum: an unchanged
+   field has an unchanged root, changing one link or permuting links
+   changes it, and dirty() reports exactly the blocks that changed.
+   The lattice has two blocks per parity.
+*/
+
+class GaugeChecksumTest : public ::testing::Test
+{
+protected:
+  static constexpr int link_size = 18; // reals per SU(3) link
+  std::unique_ptr<cpuGaugeField> u;
+
+  void SetUp() override
+  {
+    GaugeFieldParam param;
+    param.x[0] = 8;
+    param.x[1] = 8;
+    param.x[2] = 16;
+    param.x[3] = 16;
+    param.nColor = 3;
+    param.reconstruct = QUDA_RECONSTRUCT_NO;
+    param.order = QUDA_QDP_GAUGE_ORDER;
+    param.link_type = QUDA_WILSON_LINKS;
+    param.t_boundary = QUDA_PERIODIC_T;
+    param.create = QUDA_ZERO_FIELD_CREATE;
+    param.setPrecision(QUDA_DOUBLE_PRECISION);
+    param.nDim = 4;
+    param.siteSubset = QUDA_FULL_SITE_SUBSET;
+    param.ghostExchange = QUDA_GHOST_EXCHANGE_NO;
+    param.geometry = QUDA_VECTOR_GEOMETRY;
+    u = std::make_unique<cpuGaugeField>(param);
+
+    for (int d = 0; d < 4; d++)
+      for (int i = 0; i < u->Volume() * link_size; i++) link(d, 0, 0)[i] = 1.0 / (d + 1) + 1e-3 * i;
+  }
+
+  /**
+     @brief The link of a site in the QDP order, where the even
+     sites precede the odd ones
+   */
+  double *link(int d, int parity, int x_cb)
+  {
+    return static_cast<double *>(static_cast<void **>(u->Gauge_p())[d]) + (parity * u->VolumeCB() + x_cb) * link_size;
+  }
+
+  int blocksPerParity() const { return u->VolumeCB() / GaugeChecksum::block_sites; }
+};
+
+TEST_F(GaugeChecksumTest, unchanged)
+{
+  ASSERT_EQ(blocksPerParity(), 2);
+  GaugeChecksum a = BlockChecksum(*u);
+  GaugeChecksum b = BlockChecksum(*u);
+  EXPECT_EQ(a.block.size(), 4u);
+  EXPECT_TRUE(a == b);
+  EXPECT_EQ(a.block, b.block);
+  EXPECT_TRUE(a.dirty(b).empty());
+}
+
+TEST_F(GaugeChecksumTest, oneLink)
+{
+  GaugeChecksum before = BlockChecksum(*u);
+
+  // the last link of the second block of the odd parity, in the last dimension
+  const int x_cb = u->VolumeCB() - 1;
+  const double value = link(3, 1, x_cb)[17];
+  link(3, 1, x_cb)[17] += 1e-12;
+  GaugeChecksum after = BlockChecksum(*u);
+  EXPECT_TRUE(after != before);
+  EXPECT_EQ(after.dirty(before), std::vector<int> {1 * blocksPerParity() + 1});
+
+  // restoring the link restores the root
+  link(3, 1, x_cb)[17] = value;
+  EXPECT_TRUE(BlockChecksum(*u) == before);
+}
+
+TEST_F(GaugeChecksumTest, permutation)
+{
+  GaugeChecksum before = BlockChecksum(*u);
+  const uint64_t xor_before = Checksum(*u);
+
+  // swap two links of the first block of the even parity, which the
+  // XOR checksum cannot see
+  std::swap_ranges(link(0, 0, 0), link(0, 0, 0) + link_size, link(0, 0, 1));
+  EXPECT_EQ(Checksum(*u), xor_before);
+
+  GaugeChecksum after = BlockChecksum(*u);
+  EXPECT_TRUE(after != before);
+  EXPECT_EQ(after.dirty(before), std::vector<int> {0});
+
+  // links swapped between blocks dirty both
+  std::swap_ranges(link(0, 0, 0), link(0, 0, 0) + link_size, link(0, 0, 1));
+  std::swap_ranges(link(2, 0, 5), link(2, 0, 5) + link_size, link(2, 1, GaugeChecksum::block_sites + 5));
+  after = BlockChecksum(*u);
+  EXPECT_TRUE(after != before);
+  EXPECT_EQ(after.dirty(before), (std::vector<int> {0, 1 * blocksPerParity() + 1}));
+}
+
+TEST_F(GaugeChecksumTest, layout)
+{
+  // a checksum of a different block layout dirties every block
+  GaugeChecksum a = BlockChecksum(*u);
+  GaugeChecksum b;
+  EXPECT_EQ(a.dirty(b), (std::vector<int> {0, 1, 2, 3}));
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  initComms(argc, argv, gridsize_from_cmdline);
+  int result = RUN_ALL_TESTS();
+  finalizeComms();
+  return result;
+}
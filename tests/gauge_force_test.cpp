@@ -8,6 +8,7 @@
 #include <gauge_field.h>
 #include "misc.h"
 #include "gauge_force_reference.h"
+#include "reference_cache.h"
 #include "gauge_force_quda.h"
 #include <sys/time.h>
 #include <dslash_quda.h>
@@ -338,8 +339,23 @@ void gauge_force_test(void)
 
   void *refmom = Mom_ref_milc->Gauge_p();
   if (verify_results) {
-    gauge_force_reference(refmom, eb3, (void **)U_qdp->Gauge_p(), gauge_param.cpu_prec, input_path_buf, length,
-                          loop_coeff, num_paths);
+    // reuse the reference force of an earlier run with the same fields and paths
+    ReferenceCache cache("gauge_force_test");
+    for (int dir = 0; dir < 4; dir++) {
+      cache.input(((void **)U_qdp->Gauge_p())[dir], (size_t)V * gauge_site_size * gauge_param.cpu_prec);
+      for (int i = 0; i < num_paths; i++) cache.input(input_path_buf[dir][i], length[i] * sizeof(int));
+    }
+    cache.input(refmom, (size_t)4 * V * mom_site_size * gauge_param.cpu_prec)
+      .input(length, num_paths * sizeof(int))
+      .input(loop_coeff, num_paths * gauge_param.cpu_prec)
+      .param(gauge_param.cpu_prec)
+      .param(eb3)
+      .output(refmom, (size_t)4 * V * mom_site_size * gauge_param.cpu_prec);
+    if (!cache.load()) {
+      gauge_force_reference(refmom, eb3, (void **)U_qdp->Gauge_p(), gauge_param.cpu_prec, input_path_buf, length,
+                            loop_coeff, num_paths);
+      cache.save();
+    }
     force_check = compare_floats(Mom_milc->Gauge_p(), refmom, 4 * V * mom_site_size, getTolerance(cuda_prec), gauge_param.cpu_prec);
     strong_check_mom(Mom_milc->Gauge_p(), refmom, 4 * V, gauge_param.cpu_prec);
   }
@@ -0,0 +1,88 @@
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include <host_rng.h>
+
+// google test
+#include <gtest/gtest.h>
+
+/**
+   Unit tests of the counter-based generator of the host test fields:
+   Philox4x32-10 against the known-answer vectors of the Random123
+   distribution (kat_vectors), and the mapping of its output to the
+   unit interval.
+*/
+
+struct KAT {
+  uint32_t ctr[4];
+  uint32_t key[2];
+  uint32_t expected[4];
+};
+
+TEST(HostRNG, philox4x32KAT)
+{
+  const KAT kat[] = {
+    {{0x00000000, 0x00000000, 0x00000000, 0x00000000},
+     {0x00000000, 0x00000000},
+     {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+    {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+     {0xffffffff, 0xffffffff},
+     {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+    {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+     {0xa4093822, 0x299f31d0},
+     {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}},
+  };
+
+  for (auto &k : kat) {
+    uint32_t ctr[4] = {k.ctr[0], k.ctr[1], k.ctr[2], k.ctr[3]};
+    host_rng::philox4x32(ctr, k.key);
+    for (int i = 0; i < 4; i++) EXPECT_EQ(ctr[i], k.expected[i]) << std::hex << "ctr " << k.ctr[0] << " word " << i;
+  }
+}
+
+TEST(HostRNG, uniform)
+{
+  // the seed forms the key: the low word first
+  const host_rng::RNG rng(0);
+  double u[4];
+  rng.uniform(u, 4, 0, 0);
+  EXPECT_EQ(u[0], 0x6627e8d5 / 4294967296.0);
+  EXPECT_EQ(u[3], 0x9b00dbd8 / 4294967296.0);
+
+  // a number depends only on the site, stream and position drawn, not
+  // on how many are drawn
+  const host_rng::RNG seeded(0x123456789abcdefull);
+  std::vector<double> all(72);
+  seeded.uniform(all.data(), all.size(), 1234567, 5);
+  for (int n = 1; n < 72; n += 7) {
+    std::vector<double> some(n);
+    seeded.uniform(some.data(), n, 1234567, 5);
+    for (int i = 0; i < n; i++) EXPECT_EQ(some[i], all[i]);
+  }
+  EXPECT_EQ(seeded.uniform(1234567, 5), all[0]);
+
+  // sites, streams and seeds draw distinct numbers in [0, 1)
+  std::set<double> seen;
+  for (uint64_t site : {0ull, 1ull, 1ull << 32})
+    for (uint32_t stream : {0u, 1u})
+      for (uint64_t seed : {0ull, 1ull << 32}) {
+        double v[8];
+        host_rng::RNG(seed).uniform(v, 8, site, stream);
+        for (auto x : v) {
+          EXPECT_GE(x, 0.0);
+          EXPECT_LT(x, 1.0);
+          EXPECT_TRUE(seen.insert(x).second);
+        }
+      }
+
+  float f[8];
+  seeded.uniform(f, 8, 1234567, 5);
+  for (int i = 0; i < 8; i++) EXPECT_EQ(f[i], static_cast<float>(all[i]));
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,288 @@
+#include <cmath>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <host_utils.h>
+#include <command_line_params.h>
+#include <color_spinor_field.h>
+#include <eigensolve_quda.h>
+
+// google test
+#include <gtest/gtest.h>
+
+using namespace quda;
+
+/**
+   Rotations of host-resident Krylov spaces, which multiply tiles of
+   elements gathered from every vector by the rotation, against a
+   naive dense rotation of each element: the in-place rotations of
+   rotateVecs and rotateVecsComplex, and the accumulating block
+   rotations of blockRotate and blockRotateComplex, with pencil and
+   triangular blocks.  The fields are in double and single precision,
+   on lattices of fewer elements than a tile and of a number of
+   elements that is not a multiple of the tile.
+*/
+
+/**
+   An eigensolver that only exposes the rotations of the base class
+*/
+class RotationSolver : public EigenSolver
+{
+public:
+  RotationSolver(const DiracMatrix &mat, QudaEigParam *param, TimeProfile &profile) : EigenSolver(mat, param, profile)
+  {
+  }
+  bool hermitian() override { return true; }
+  void operator()(std::vector<ColorSpinorField *> &, std::vector<Complex> &) override { }
+  void lock(int n) { num_locked = n; }
+};
+
+using Values = std::vector<double>;
+
+class HostRotationTest : public ::testing::TestWithParam<std::tuple<QudaPrecision, int>>
+{
+protected:
+  static constexpr int n_kr = 10;
+  static constexpr int n_ev = 6;
+
+  QudaEigParam eig_param = newQudaEigParam();
+  TimeProfile profile {"HostRotationTest"};
+  DiracM mat {static_cast<const Dirac *>(nullptr)}; // the rotations never apply the operator
+  std::unique_ptr<RotationSolver> solver;
+  std::mt19937 rng {1234};
+
+  std::vector<std::unique_ptr<ColorSpinorField>> fields;
+  std::vector<ColorSpinorField *> kSpace;
+  std::vector<Values> before; // the values of every vector before the rotation
+
+  void SetUp() override
+  {
+    eig_param.n_ev = n_ev;
+    eig_param.n_kr = n_kr;
+    eig_param.n_conv = n_ev;
+    eig_param.spectrum = QUDA_SPECTRUM_SR_EIG;
+    solver.reset(new RotationSolver(mat, &eig_param, profile));
+  }
+
+  double random() { return std::uniform_real_distribution<double>(-1.0, 1.0)(rng); }
+
+  /**
+     @brief Create a Krylov space of n random vectors
+  */
+  void create(int n)
+  {
+    ColorSpinorParam param;
+    param.nColor = 3;
+    param.nSpin = 4;
+    param.nDim = 4;
+    for (int d = 0; d < 3; d++) param.x[d] = 4;
+    param.x[3] = std::get<1>(GetParam());
+    param.siteSubset = QUDA_FULL_SITE_SUBSET;
+    param.siteOrder = QUDA_EVEN_ODD_SITE_ORDER;
+    param.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
+    param.gammaBasis = QUDA_DEGRAND_ROSSI_GAMMA_BASIS;
+    param.setPrecision(std::get<0>(GetParam()));
+    param.pad = 0;
+    param.location = QUDA_CPU_FIELD_LOCATION;
+    param.create = QUDA_NULL_FIELD_CREATE;
+
+    for (int i = 0; i < n; i++) {
+      fields.emplace_back(ColorSpinorField::Create(param));
+      kSpace.push_back(fields.back().get());
+      for (size_t e = 0; e < length(); e++) set(*kSpace.back(), e, random());
+      before.push_back(values(*kSpace.back()));
+    }
+  }
+
+  size_t length() const { return fields[0]->Length(); }
+
+  static void set(ColorSpinorField &v, size_t e, double value)
+  {
+    if (v.Precision() == QUDA_DOUBLE_PRECISION)
+      static_cast<double *>(v.V())[e] = value;
+    else
+      static_cast<float *>(v.V())[e] = value;
+  }
+
+  Values values(const ColorSpinorField &v) const
+  {
+    Values x(length());
+    for (size_t e = 0; e < length(); e++)
+      x[e] = v.Precision() == QUDA_DOUBLE_PRECISION ? static_cast<const double *>(v.V())[e] :
+                                                      static_cast<const float *>(v.V())[e];
+    return x;
+  }
+
+  /**
+     @brief Accumulate y += sum_i x[i] a(i), a naive dense rotation of
+     the real or complex elements of the vectors
+  */
+  template <typename A> static void rotate(Values &y, const std::vector<const Values *> &x, A &&a, bool complex)
+  {
+    for (size_t e = 0; e < y.size(); e += complex ? 2 : 1) {
+      for (size_t i = 0; i < x.size(); i++) {
+        const Complex c = a(i);
+        if (complex) {
+          y[e + 0] += (*x[i])[e + 0] * c.real() - (*x[i])[e + 1] * c.imag();
+          y[e + 1] += (*x[i])[e + 0] * c.imag() + (*x[i])[e + 1] * c.real();
+        } else {
+          y[e] += (*x[i])[e] * c.real();
+        }
+      }
+    }
+  }
+
+  /**
+     @brief Expect a vector to hold the expected values, to the
+     rounding of a sum of n terms of the precision of the vectors
+  */
+  void expect(int k, const Values &expected, int n) const
+  {
+    const double eps = std::get<0>(GetParam()) == QUDA_DOUBLE_PRECISION ? 1e-15 : 1e-6;
+    const Values x = values(*kSpace[k]);
+    double deviation = 0.0;
+    for (size_t e = 0; e < length(); e++) deviation = std::max(deviation, std::abs(x[e] - expected[e]));
+    EXPECT_LE(deviation, 4 * n * eps) << "vector " << k;
+  }
+
+  /**
+     @brief Check the in-place rotation of the dim vectors after the
+     locked ones into their first keep, where the rotation is the
+     row-major dim x keep matrix a
+  */
+  template <typename Scalar> void checkRotateVecs(const std::vector<Scalar> &a, int locked, int dim, int keep)
+  {
+    const bool complex = std::is_same<Scalar, Complex>::value;
+    for (int k = 0; k < static_cast<int>(kSpace.size()); k++) {
+      if (k < locked || k >= locked + keep) {
+        expect(k, before[k], 0);
+        continue;
+      }
+      const int j = k - locked;
+      Values expected(length(), 0.0);
+      std::vector<const Values *> x;
+      for (int i = 0; i < dim; i++) x.push_back(&before[locked + i]);
+      rotate(expected, x, [&](int i) { return Complex(a[i * keep + j]); }, complex);
+      expect(k, expected, dim);
+    }
+  }
+
+  /**
+     @brief Check a block rotation, which accumulates the vectors i of
+     i_range after the locked ones into the vectors from offset on,
+     one for each j of j_range, with the coefficients array[j * rank +
+     i] of the column-major array
+  */
+  template <typename Scalar>
+  void checkBlockRotate(const std::vector<Scalar> &array, int rank, std::pair<int, int> i_range,
+                        std::pair<int, int> j_range, int locked, int offset)
+  {
+    const bool complex = std::is_same<Scalar, Complex>::value;
+    const int n_i = i_range.second - i_range.first;
+    for (int k = 0; k < static_cast<int>(kSpace.size()); k++) {
+      const int j = j_range.first + k - offset;
+      if (k < offset || j >= j_range.second) {
+        expect(k, before[k], 0);
+        continue;
+      }
+      Values expected = before[k];
+      std::vector<const Values *> x;
+      for (int i = i_range.first; i < i_range.second; i++) x.push_back(&before[locked + i]);
+      rotate(expected, x, [&](int i) { return Complex(array[j * rank + i_range.first + i]); }, complex);
+      expect(k, expected, n_i + 1);
+    }
+  }
+
+  template <typename Scalar> Scalar randomScalar();
+};
+
+template <> double HostRotationTest::randomScalar<double>() { return random(); }
+template <> Complex HostRotationTest::randomScalar<Complex>() { return {random(), random()}; }
+
+TEST_P(HostRotationTest, rotateVecs)
+{
+  const int locked = 2, dim = 7, keep = 4;
+  create(locked + dim + 1);
+  std::vector<double> a(dim * keep);
+  for (auto &c : a) c = randomScalar<double>();
+
+  solver->rotateVecs(kSpace, a.data(), n_kr + 1, dim, keep, locked, profile);
+  checkRotateVecs(a, locked, dim, keep);
+}
+
+TEST_P(HostRotationTest, rotateVecsComplex)
+{
+  const int locked = 1, dim = 8, keep = 5;
+  create(locked + dim);
+  std::vector<Complex> a(dim * keep);
+  for (auto &c : a) c = randomScalar<Complex>();
+
+  solver->rotateVecsComplex(kSpace, a.data(), n_kr + 1, dim, keep, locked, profile);
+  checkRotateVecs(a, locked, dim, keep);
+}
+
+TEST_P(HostRotationTest, blockRotate)
+{
+  // blockRotate accumulates into the vectors after the Krylov space
+  const int locked = 1, rank = 8, offset = n_kr + 1;
+  for (blockType type : {PENCIL, LOWER_TRI}) {
+    fields.clear();
+    kSpace.clear();
+    before.clear();
+    create(offset + 3);
+    solver->lock(locked);
+
+    // a lower triangular block is stored with its zeros above the diagonal
+    const std::pair<int, int> i_range = type == PENCIL ? std::make_pair(4, rank) : std::make_pair(2, 5);
+    const std::pair<int, int> j_range = {2, 5};
+    std::vector<double> array(rank * rank);
+    for (int j = 0; j < rank; j++)
+      for (int i = 0; i < rank; i++) array[j * rank + i] = type == PENCIL || i >= j ? randomScalar<double>() : 0.0;
+
+    solver->blockRotate(kSpace, array.data(), rank, i_range, j_range, type);
+    checkBlockRotate(array, rank, i_range, j_range, locked, offset);
+  }
+}
+
+TEST_P(HostRotationTest, blockRotateComplex)
+{
+  const int locked = 2, rank = 7, offset = 12;
+  for (blockType type : {PENCIL, UPPER_TRI}) {
+    fields.clear();
+    kSpace.clear();
+    before.clear();
+    create(offset + 4);
+    solver->lock(locked);
+
+    // an upper triangular block is stored with its zeros below the diagonal
+    const std::pair<int, int> i_range = type == PENCIL ? std::make_pair(0, 3) : std::make_pair(3, 7);
+    const std::pair<int, int> j_range = {3, 7};
+    std::vector<Complex> array(rank * rank);
+    for (int j = 0; j < rank; j++)
+      for (int i = 0; i < rank; i++) array[j * rank + i] = type == PENCIL || i <= j ? randomScalar<Complex>() : 0.0;
+
+    solver->blockRotateComplex(kSpace, array.data(), rank, i_range, j_range, type, offset);
+    checkBlockRotate(array, rank, i_range, j_range, locked, offset);
+  }
+}
+
+// a 4^3 x 1 lattice holds fewer complex elements than a tile, and
+// neither lattice a whole number of tiles of real or complex elements
+INSTANTIATE_TEST_SUITE_P(HostRotation, HostRotationTest,
+                         ::testing::Combine(::testing::Values(QUDA_DOUBLE_PRECISION, QUDA_SINGLE_PRECISION),
+                                            ::testing::Values(1, 5)),
+                         [](const ::testing::TestParamInfo<HostRotationTest::ParamType> &info) {
+                           return std::string(std::get<0>(info.param) == QUDA_DOUBLE_PRECISION ? "double" : "single")
+                             + "_t" + std::to_string(std::get<1>(info.param));
+                         });
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  initComms(argc, argv, gridsize_from_cmdline);
+  int result = RUN_ALL_TESTS();
+  finalizeComms();
+  return result;
+}
@@ -159,9 +159,7 @@ int main(int argc, char **argv)
 
   // Perform host side verification of inversion if requested
   if (verify_results) {
-    for (int i = 0; i < inv_param.num_src; i++) {
-      verifyInversion(outMulti[i], inMulti[i], check->V(), gauge_param, inv_param, gauge, clover, clover_inv);
-    }
+    verifyInversionMultiSrc(outMulti, inMulti, check->V(), gauge_param, inv_param, gauge, clover, clover_inv);
   }
   // QUDA invert test COMPLETE
   //----------------------------------------------------------------------------
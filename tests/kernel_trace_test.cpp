@@ -0,0 +1,137 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <host_utils.h>
+#include <command_line_params.h>
+#include <kernel_trace.h>
+
+// google test
+#include <gtest/gtest.h>
+
+using namespace quda;
+
+/**
+   Round trip of the kernel trace through the conversions of
+   trace_convert: a trace streamed to a binary file is converted to
+   text, converted back to binary and to text again.  Both texts must
+   be identical, and the second binary trace must hold the entries of
+   the first, with the times to the precision of the text.
+*/
+
+static std::string dir;
+static std::string binary_file;
+
+static const TuneKey keys[] = {
+  TuneKey("16x16x16x16", "N4quda4blas4axpyE", "vol=65536,stride=65536,precision=8"),
+  TuneKey("8x8x8x16", "N4quda6DslashIN4quda10WilsonArgEEE", "policy_kernel"),
+  TuneKey("8x8x8x16", "N4quda12DslashPolicyE", "type=default,pol=3"),
+  TuneKey("4x4x4x4", "N4quda9CopyGaugeE", "out_prec=4,in_prec=8,policy=float2"),
+};
+
+static std::vector<std::string> lines(const std::string &path)
+{
+  std::ifstream in(path.c_str());
+  std::vector<std::string> l;
+  for (std::string line; std::getline(in, line);) l.push_back(line);
+  return l;
+}
+
+static std::vector<std::pair<TuneKey, kernel_trace::Record>> entries(kernel_trace::Reader &reader)
+{
+  std::vector<std::pair<TuneKey, kernel_trace::Record>> e;
+  kernel_trace::Record record;
+  while (reader.next(record)) e.push_back({reader.key(record), record});
+  return e;
+}
+
+TEST(KernelTrace, roundTrip)
+{
+  const std::string text = dir + "/trace.tsv";
+  const std::string binary = dir + "/trace_back.bin";
+  const std::string text_back = dir + "/trace_back.tsv";
+
+  ASSERT_TRUE(kernel_trace::binaryToText(binary_file, text));
+  ASSERT_TRUE(kernel_trace::textToBinary(text, binary));
+  ASSERT_TRUE(kernel_trace::binaryToText(binary, text_back));
+  auto text_lines = lines(text);
+  auto text_back_lines = lines(text_back);
+  ASSERT_EQ(text_back_lines.size(), text_lines.size());
+  for (size_t i = 0; i < text_lines.size(); i++) {
+    if (text_back_lines[i] != text_lines[i]) {
+      ADD_FAILURE() << "line " << i << " of the text differs: " << text_back_lines[i] << " instead of " << text_lines[i];
+      break;
+    }
+  }
+
+  kernel_trace::Reader original, converted;
+  ASSERT_TRUE(original.open(binary_file));
+  ASSERT_TRUE(converted.open(binary));
+  EXPECT_STREQ(converted.header().version, original.header().version);
+  EXPECT_STREQ(converted.header().gitversion, original.header().gitversion);
+  EXPECT_STREQ(converted.header().hash, original.header().hash);
+  EXPECT_EQ(converted.header().created, original.header().created);
+
+  auto a = entries(original);
+  auto b = entries(converted);
+  ASSERT_EQ(a.size(), b.size());
+  ASSERT_EQ(a.size(), kernel_trace::size());
+  int differ = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    const auto &ka = a[i].first, &kb = b[i].first;
+    const auto &ra = a[i].second, &rb = b[i].second;
+    // the text holds six significant digits of the time
+    bool same = strcmp(kb.volume, ka.volume) == 0 && strcmp(kb.name, ka.name) == 0 && strcmp(kb.aux, ka.aux) == 0
+      && std::abs(rb.time - ra.time) <= 5e-6 * std::abs(ra.time) && rb.device_bytes == ra.device_bytes
+      && rb.pinned_bytes == ra.pinned_bytes && rb.mapped_bytes == ra.mapped_bytes && rb.host_bytes == ra.host_bytes;
+    if (!same && differ++ == 0)
+      ADD_FAILURE() << "entry " << i << " differs: " << kb.volume << " " << kb.name << " " << kb.aux << " " << rb.time
+                    << " instead of " << ka.volume << " " << ka.name << " " << ka.aux << " " << ra.time;
+  }
+  EXPECT_EQ(differ, 0);
+
+  for (auto f : {text, binary, text_back}) remove(f.c_str());
+}
+
+TEST(KernelTrace, notText)
+{
+  // a binary trace is not a text trace
+  const std::string binary = dir + "/not_text.bin";
+  EXPECT_FALSE(kernel_trace::textToBinary(binary_file, binary));
+  EXPECT_FALSE(kernel_trace::textToBinary(dir + "/missing.tsv", binary));
+  remove(binary.c_str());
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  initComms(argc, argv, gridsize_from_cmdline);
+
+  char dir_template[] = "/tmp/quda_kernel_trace_XXXXXX";
+  if (!mkdtemp(dir_template)) {
+    perror("mkdtemp");
+    return EXIT_FAILURE;
+  }
+  dir = dir_template;
+
+  // more entries than fit in a chunk of the converted trace, with
+  // times over many orders of magnitude
+  binary_file = dir + "/trace.bin";
+  kernel_trace::open(binary_file, "1.1.0", "v1.1.0-abcdef", "cpu_arch=x86_64");
+  const int n_entries = 70000;
+  for (int i = 0; i < n_entries; i++)
+    kernel_trace::record(keys[(i * 7) % 4], std::ldexp(1.0f + 0.001f * (i % 997), (i % 41) - 30));
+  kernel_trace::flush();
+
+  int result = RUN_ALL_TESTS();
+
+  remove(binary_file.c_str());
+  rmdir(dir.c_str());
+  finalizeComms();
+  return result;
+}
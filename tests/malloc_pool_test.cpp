@@ -0,0 +1,239 @@
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <malloc_pool.h>
+
+// google test
+#include <gtest/gtest.h>
+
+using namespace quda::pool;
+
+/**
+   Unit tests of the pool allocator: the size classes round trip and
+   bound the waste of each request, and the pool reuses, caches and
+   evicts allocations as its statistics report, evicting the least
+   recently released allocations first.  The pool wraps a host
+   allocator that records what is outstanding with the system and
+   fails a test that exceeds the capacity it is given.
+*/
+
+static std::map<void *, size_t> outstanding; // allocations held from the system, and their sizes
+static std::vector<void *> released;        // allocations returned to the system, in order
+static size_t outstanding_bytes = 0;
+static size_t capacity = SIZE_MAX; // bytes the system can allocate
+
+static void *test_malloc(const char *, const char *, int, size_t nbytes)
+{
+  if (outstanding_bytes + nbytes > capacity)
+    ADD_FAILURE() << "out of memory: " << nbytes << " bytes requested with " << outstanding_bytes << " outstanding";
+  void *ptr = std::malloc(nbytes);
+  outstanding[ptr] = nbytes;
+  outstanding_bytes += nbytes;
+  return ptr;
+}
+
+static void test_free(const char *, const char *, int, void *ptr)
+{
+  auto it = outstanding.find(ptr);
+  ASSERT_TRUE(it != outstanding.end());
+  outstanding_bytes -= it->second;
+  outstanding.erase(it);
+  released.push_back(ptr);
+  std::free(ptr);
+}
+
+constexpr size_t KiB = 1024;
+constexpr size_t MiB = 1024 * KiB;
+
+TEST(MallocPool, binRoundTrip)
+{
+  for (int b = 0; b < 600; b++) {
+    const size_t size = Pool::bin_size(b);
+    EXPECT_EQ(Pool::bin_index(size), b) << "bin " << b;
+    EXPECT_EQ(Pool::bin_index(size + 1), b + 1) << "bin " << b;
+    if (b > 0) { EXPECT_GT(size, Pool::bin_size(b - 1)) << "bin " << b; }
+  }
+}
+
+TEST(MallocPool, binWaste)
+{
+  std::mt19937_64 rng(1234);
+  std::vector<size_t> sizes = {0, 1, 255, 256, 257, 4095, 4096, 4097, 8191, 8192, 8193, MiB - 1, MiB, MiB + 1};
+  for (int i = 0; i < 100000; i++) sizes.push_back(rng() >> (16 + rng() % 48)); // up to 256 TiB
+
+  for (auto n : sizes) {
+    const int b = Pool::bin_index(n);
+    const size_t size = Pool::bin_size(b);
+    EXPECT_GE(size, n) << n << " bytes";
+    if (b > 0) { EXPECT_LT(Pool::bin_size(b - 1), n) << n << " bytes"; }
+    // at most 255 bytes below 4 KiB, and a sixteenth of the request
+    // above, except for empty requests, which take the smallest class
+    if (n > 0) { EXPECT_LE(size - n, std::max<size_t>(255, n / Pool::sub_classes)) << n << " bytes"; }
+  }
+}
+
+class MallocPoolTest : public ::testing::Test
+{
+protected:
+  Pool pool {"Test", test_malloc, test_free};
+
+  void *malloc(size_t nbytes) { return pool.malloc(__func__, __FILE__, __LINE__, nbytes); }
+  void free(void *ptr) { pool.free(__func__, __FILE__, __LINE__, ptr); }
+
+  void SetUp() override
+  {
+    outstanding.clear();
+    released.clear();
+    outstanding_bytes = 0;
+    capacity = SIZE_MAX;
+  }
+
+  void TearDown() override
+  {
+    pool.flush();
+    EXPECT_TRUE(outstanding.empty());
+  }
+};
+
+TEST_F(MallocPoolTest, reuse)
+{
+  void *a = malloc(MiB + 1);
+  free(a);
+  auto s = pool.statistics();
+  EXPECT_EQ(s.cached_bytes, Pool::bin_size(Pool::bin_index(MiB + 1)));
+  EXPECT_EQ(s.active_bytes, 0u);
+
+  // a request of the same class reuses the allocation, another class does not
+  EXPECT_EQ(malloc(MiB + 2), a);
+  void *b = malloc(2 * MiB);
+  EXPECT_NE(b, a);
+
+  s = pool.statistics();
+  EXPECT_EQ(s.hits, 1u);
+  EXPECT_EQ(s.misses, 2u);
+  EXPECT_EQ(s.requested_bytes, MiB + 2 + 2 * MiB);
+  EXPECT_EQ(s.active_bytes, Pool::bin_size(Pool::bin_index(MiB + 1)) + 2 * MiB);
+  EXPECT_EQ(s.cached_bytes, 0u);
+  EXPECT_EQ(outstanding.size(), 2u);
+
+  free(a);
+  free(b);
+}
+
+TEST_F(MallocPoolTest, trim)
+{
+  pool.set_slack(0.0);
+
+  // cache allocations of 1, 2, 3 and 4 MiB, released in that order
+  std::vector<void *> p;
+  for (size_t i = 1; i <= 4; i++) p.push_back(malloc(i * MiB));
+  for (auto ptr : p) free(ptr);
+  auto s = pool.statistics();
+  EXPECT_EQ(s.high_water, 10 * MiB);
+  EXPECT_EQ(s.cached_bytes, 10 * MiB);
+  EXPECT_EQ(s.evictions, 0u);
+
+  // reusing the 3 MiB allocation keeps it out of the eviction order
+  EXPECT_EQ(malloc(3 * MiB), p[2]);
+
+  // 2.5 MiB more in use leaves room for 4.5 MiB of cache within the
+  // high-water mark, so the 1 and 2 MiB allocations, released first,
+  // are evicted and the 4 MiB one, released last, is kept
+  void *q = malloc(5 * MiB / 2);
+  s = pool.statistics();
+  EXPECT_EQ(s.high_water, 10 * MiB);
+  EXPECT_EQ(s.active_bytes, 11 * MiB / 2);
+  EXPECT_EQ(s.cached_bytes, 4 * MiB);
+  EXPECT_EQ(s.evictions, 2u);
+  EXPECT_EQ(released, (std::vector<void *> {p[0], p[1]}));
+  EXPECT_EQ(outstanding.size(), 3u);
+
+  // the kept allocation is still reused
+  EXPECT_EQ(malloc(4 * MiB), p[3]);
+
+  free(p[2]);
+  free(p[3]);
+  free(q);
+}
+
+TEST_F(MallocPoolTest, slack)
+{
+  pool.set_slack(1.0);
+
+  // within the slack, allocations of other classes stay cached
+  void *a = malloc(4 * MiB);
+  free(a);
+  void *b = malloc(3 * MiB);
+  free(b);
+  auto s = pool.statistics();
+  EXPECT_EQ(s.evictions, 0u);
+  EXPECT_EQ(s.high_water, 4 * MiB);
+  EXPECT_EQ(s.cached_bytes, 7 * MiB);
+
+  // beyond it, the oldest is evicted, before the new allocation is
+  // made, until the reserved bytes are within twice the high-water mark
+  void *c = malloc(5 * MiB);
+  s = pool.statistics();
+  EXPECT_EQ(s.evictions, 1u);
+  EXPECT_EQ(released, std::vector<void *> {a});
+  EXPECT_EQ(s.cached_bytes, 3 * MiB);
+  EXPECT_EQ(s.peak_reserved, 8 * MiB);
+
+  free(c);
+  s = pool.statistics();
+  EXPECT_EQ(s.cached_bytes, 8 * MiB);
+  EXPECT_EQ(s.active_bytes, 0u);
+
+  pool.flush();
+  s = pool.statistics();
+  EXPECT_EQ(s.cached_bytes, 0u);
+  EXPECT_EQ(s.high_water, 0u);
+  EXPECT_TRUE(outstanding.empty());
+}
+
+TEST_F(MallocPoolTest, evictBeforeAllocate)
+{
+  pool.set_slack(0.0);
+
+  // fill the cache up to the capacity of the system
+  capacity = 8 * MiB;
+  std::vector<void *> p;
+  for (int i = 0; i < 4; i++) p.push_back(malloc(2 * MiB));
+  for (auto ptr : p) free(ptr);
+  EXPECT_EQ(outstanding_bytes, capacity);
+
+  // a request of another size class at the limit is served by
+  // evicting the oldest allocations first, within the capacity
+  void *a = malloc(6 * MiB);
+  auto s = pool.statistics();
+  EXPECT_EQ(released, (std::vector<void *> {p[0], p[1], p[2]}));
+  EXPECT_EQ(s.evictions, 3u);
+  EXPECT_EQ(s.active_bytes, 6 * MiB);
+  EXPECT_EQ(s.cached_bytes, 2 * MiB);
+  EXPECT_EQ(s.peak_reserved, capacity);
+
+  // the remaining allocation is still reused
+  EXPECT_EQ(malloc(2 * MiB), p[3]);
+
+  free(a);
+  free(p[3]);
+}
+
+TEST_F(MallocPoolTest, disabled)
+{
+  pool.enabled = false;
+  void *a = malloc(MiB);
+  EXPECT_EQ(outstanding.size(), 1u);
+  free(a);
+  EXPECT_TRUE(outstanding.empty());
+  EXPECT_EQ(pool.statistics().misses, 0u);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
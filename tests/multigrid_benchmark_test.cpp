@@ -1,5 +1,9 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 
 #include <quda_internal.h>
 #include <color_spinor_field.h>
@@ -62,7 +66,9 @@ void initFields(QudaPrecision prec)
 
   param.siteOrder = QUDA_EVEN_ODD_SITE_ORDER;
   param.gammaBasis = QUDA_DEGRAND_ROSSI_GAMMA_BASIS;
-  param.setPrecision(QUDA_DOUBLE_PRECISION);
+  // the host operator must run in a precision the coarse dslash is compiled for
+  const QudaPrecision host_prec = std::max(prec, QUDA_SINGLE_PRECISION);
+  param.setPrecision(host_prec);
   param.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
 
   param.create = QUDA_ZERO_FIELD_CREATE;
@@ -98,7 +104,7 @@ void initFields(QudaPrecision prec)
   gParam.link_type = QUDA_COARSE_LINKS;
   gParam.t_boundary = QUDA_PERIODIC_T;
   gParam.create = QUDA_ZERO_FIELD_CREATE;
-  gParam.setPrecision(param.Precision());
+  gParam.setPrecision(host_prec);
   gParam.nDim = 4;
   gParam.siteSubset = QUDA_FULL_SITE_SUBSET;
   gParam.ghostExchange = QUDA_GHOST_EXCHANGE_PAD;
@@ -164,6 +170,123 @@ void freeFields()
 
 DiracCoarse *dirac;
 
+// fill a host QDP-ordered coarse gauge field with random numbers
+template <typename Float> void randomGauge(cpuGaugeField &g)
+{
+  void **p = static_cast<void **>(g.Gauge_p());
+  const size_t n = g.Volume() * 2 * g.Ncolor() * g.Ncolor();
+  for (int d = 0; d < g.Geometry(); d++)
+    for (size_t i = 0; i < n; i++) static_cast<Float *>(p[d])[i] = 2.0 * drand48() - 1.0;
+}
+
+void randomGauge(cpuGaugeField &g)
+{
+  if (g.Precision() == QUDA_DOUBLE_PRECISION) randomGauge<double>(g);
+  else randomGauge<float>(g);
+}
+
+// copy source s of a five-dimensional host field to a four-dimensional one
+void extractSource(ColorSpinorField &f4, const ColorSpinorField &f5, int s)
+{
+  const size_t bytes = f4.Bytes() / 2; // one parity of one source
+  for (int parity = 0; parity < 2; parity++)
+    memcpy(static_cast<char *>(f4.V()) + parity * bytes,
+           static_cast<const char *>(f5.V()) + parity * (f5.Bytes() / 2) + s * bytes, bytes);
+}
+
+// accumulate the largest deviation of a from b, and the largest element of b
+template <typename Float>
+void maxDeviation(double &max_dev, double &max_ref, const ColorSpinorField &a, const ColorSpinorField &b)
+{
+  const Float *a_ = static_cast<const Float *>(a.V());
+  const Float *b_ = static_cast<const Float *>(b.V());
+  for (size_t i = 0; i < a.Bytes() / sizeof(Float); i++) {
+    max_dev = std::max(max_dev, std::fabs(static_cast<double>(a_[i]) - b_[i]));
+    max_ref = std::max(max_ref, std::fabs(static_cast<double>(b_[i])));
+  }
+}
+
+void apply(int test, ColorSpinorField &out, ColorSpinorField &in)
+{
+  switch (test) {
+  case 0: dirac->Dslash(out.Even(), in.Odd(), QUDA_EVEN_PARITY); break;
+  case 1: dirac->M(out, in); break;
+  case 2: dirac->Clover(out.Even(), in.Even(), QUDA_EVEN_PARITY); break;
+  default: errorQuda("Undefined test %d", test);
+  }
+}
+
+/**
+   Check the multi-RHS coarse operator, which applies the sources a
+   block at a time and packs their halos together, against applying
+   it to each source on its own, on the fields of the given location.
+   Returns the largest deviation relative to the largest element.
+*/
+double verifyMultiSrc(int test, QudaFieldLocation location)
+{
+  randomGauge(*Y_h);
+  randomGauge(*X_h);
+  if (location == QUDA_CUDA_FIELD_LOCATION) {
+    Y_d->copy(*Y_h);
+    Y_d->exchangeGhost(QUDA_LINK_BIDIRECTIONAL);
+    X_d->copy(*X_h);
+  } else {
+    Y_h->exchangeGhost(QUDA_LINK_BIDIRECTIONAL);
+  }
+  static_cast<cpuColorSpinorField *>(yH)->Source(QUDA_RANDOM_SOURCE);
+
+  // the outputs are zero on creation, so a parity the test does not write stays zero
+  ColorSpinorField &in = location == QUDA_CUDA_FIELD_LOCATION ? *yD : *yH;
+  ColorSpinorField &out = location == QUDA_CUDA_FIELD_LOCATION ? *xD : *xH;
+  if (&in != yH) in = *yH;
+  apply(test, out, in);
+  if (&out != xH) *xH = out;
+
+  ColorSpinorParam param(*xH);
+  param.nDim = 4;
+  param.x[4] = 1;
+  param.create = QUDA_ZERO_FIELD_CREATE;
+  cpuColorSpinorField x4(param), y4(param), ref(param);
+
+  ColorSpinorParam param4(in);
+  param4.nDim = 4;
+  param4.x[4] = 1;
+  param4.create = QUDA_ZERO_FIELD_CREATE;
+  std::unique_ptr<ColorSpinorField> in4(ColorSpinorField::Create(param4));
+  std::unique_ptr<ColorSpinorField> out4(ColorSpinorField::Create(param4));
+
+  double max_dev = 0.0, max_ref = 0.0;
+  for (int s = 0; s < Nsrc; s++) {
+    extractSource(y4, *yH, s);
+    *in4 = y4;
+    apply(test, *out4, *in4);
+    ref = *out4;
+    extractSource(x4, *xH, s);
+    if (x4.Precision() == QUDA_DOUBLE_PRECISION) maxDeviation<double>(max_dev, max_ref, x4, ref);
+    else maxDeviation<float>(max_dev, max_ref, x4, ref);
+  }
+  return max_ref > 0.0 ? max_dev / max_ref : max_dev;
+}
+
+/**
+   The deviation allowed between the multi-RHS and single-RHS
+   operators, which may sum in a different order: a few units in the
+   last place of the lowest precision involved
+*/
+double multiSrcTolerance(QudaFieldLocation location)
+{
+  QudaPrecision p = xH->Precision();
+  if (location == QUDA_CUDA_FIELD_LOCATION) {
+    p = std::min({p, xD->Precision(), Y_d->Precision()});
+    if (smoother_halo_prec != QUDA_INVALID_PRECISION) p = std::min(p, smoother_halo_prec);
+  }
+  switch (p) {
+  case QUDA_DOUBLE_PRECISION: return 1e-12;
+  case QUDA_SINGLE_PRECISION: return 1e-5;
+  default: return 1e-2;
+  }
+}
+
 double benchmark(int test, const int niter) {
 
   cudaEvent_t start, end;
@@ -197,6 +320,9 @@ double benchmark(int test, const int niter) {
 }
 
 
+// only verify the host operator, e.g., on a target without a device
+bool host_only = false;
+
 const char *names[] = {
   "Dslash",
   "Mat",
@@ -216,6 +342,8 @@ int main(int argc, char** argv)
   add_multigrid_option_group(app);
   CLI::TransformPairs<int> test_type_map {{"Dslash", 0}, {"Mat", 1}, {"Clover", 2}};
   app->add_option("--test", test_type, "Test method")->transform(CLI::CheckedTransformer(test_type_map));
+  app->add_option("--host-only", host_only,
+                  "Only verify the multi-RHS host operator, skipping the device and the benchmark (default false)");
 
   try {
     app->parse(argc, argv);
@@ -239,19 +367,33 @@ int main(int argc, char** argv)
     initFields(prec);
 
     DiracParam param;
+    param.kappa = 1.0; // the hopping term is scaled by kappa, which defaults to zero
     param.halo_precision = smoother_halo_prec;
     dirac = new DiracCoarse(param, Y_h, X_h, Xinv_h, Yhat_h, Y_d, X_d, Xinv_d, Yhat_d);
 
-    // do the initial tune
-    benchmark(test_type, 1);
-
-    // now rerun with more iterations to get accurate speed measurements
-    dirac->Flops(); // reset flops counter
-
-    double secs = benchmark(test_type, niter);
-    double gflops = (dirac->Flops()*1e-9)/(secs);
-
-    printfQuda("Ncolor = %2d, %-31s: Gflop/s = %6.1f\n", Ncolor, names[test_type], gflops);
+    if (verify_results && Nsrc > 1) {
+      for (auto location : {QUDA_CPU_FIELD_LOCATION, QUDA_CUDA_FIELD_LOCATION}) {
+        if (host_only && location == QUDA_CUDA_FIELD_LOCATION) continue;
+        double deviation = verifyMultiSrc(test_type, location);
+        printfQuda("Ncolor = %2d, %-31s: %s multi-RHS deviation from single-RHS = %e\n", Ncolor, names[test_type],
+                   location == QUDA_CPU_FIELD_LOCATION ? "host" : "device", deviation);
+        if (deviation > multiSrcTolerance(location))
+          errorQuda("Multi-RHS coarse operator differs from single-RHS by %e", deviation);
+      }
+    }
+
+    if (!host_only) {
+      // do the initial tune
+      benchmark(test_type, 1);
+
+      // now rerun with more iterations to get accurate speed measurements
+      dirac->Flops(); // reset flops counter
+
+      double secs = benchmark(test_type, niter);
+      double gflops = (dirac->Flops() * 1e-9) / (secs);
+
+      printfQuda("Ncolor = %2d, %-31s: Gflop/s = %6.1f\n", Ncolor, names[test_type], gflops);
+    }
 
     delete dirac;
     freeFields();
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <host_utils.h>
+#include <command_line_params.h>
+#include <reference_cache.h>
+
+// google test
+#include <gtest/gtest.h>
+
+/**
+   Unit tests of the on-disk cache of host reference results: a miss
+   followed by a save and a hit that restores the result, misses on
+   changed inputs, and the rejection of stored files that are
+   truncated, corrupted or hold a result of a different shape.
+*/
+
+static std::string cache_dir;
+
+/**
+   @brief The files in the cache directory
+ */
+static std::vector<std::string> cacheFiles()
+{
+  std::vector<std::string> files;
+  DIR *dir = opendir(cache_dir.c_str());
+  if (!dir) return files;
+  while (auto entry = readdir(dir))
+    if (entry->d_name[0] != '.') files.push_back(cache_dir + "/" + entry->d_name);
+  closedir(dir);
+  return files;
+}
+
+class ReferenceCacheTest : public ::testing::Test
+{
+protected:
+  std::vector<double> field = std::vector<double>(1000);
+  std::vector<double> result = std::vector<double>(777);
+  std::vector<int> extra = std::vector<int>(3);
+  double kappa = 0.12;
+
+  void SetUp() override
+  {
+    for (auto f : cacheFiles()) remove(f.c_str());
+    for (size_t i = 0; i < field.size(); i++) field[i] = 1.0 / (i + 1);
+  }
+
+  /**
+     @brief Look up the reference of the test fields, computing and
+     storing it on a miss
+     @return Whether the lookup hit
+   */
+  bool reference(const std::string &name = "test")
+  {
+    ReferenceCache cache(name);
+    cache.input(field.data(), field.size() * sizeof(double)).param(kappa);
+    cache.output(result.data(), result.size() * sizeof(double)).output(extra.data(), extra.size() * sizeof(int));
+    if (cache.load()) return true;
+    for (size_t i = 0; i < result.size(); i++) result[i] = kappa * field[i];
+    for (size_t i = 0; i < extra.size(); i++) extra[i] = i + 1;
+    cache.save();
+    return false;
+  }
+
+  void clearResult()
+  {
+    std::fill(result.begin(), result.end(), 0.0);
+    std::fill(extra.begin(), extra.end(), 0);
+  }
+
+  void expectResult()
+  {
+    for (size_t i = 0; i < result.size(); i++) EXPECT_EQ(result[i], kappa * field[i]) << "result " << i;
+    for (size_t i = 0; i < extra.size(); i++) EXPECT_EQ(extra[i], static_cast<int>(i + 1)) << "extra " << i;
+  }
+};
+
+TEST_F(ReferenceCacheTest, roundTrip)
+{
+  EXPECT_FALSE(reference());
+  ASSERT_EQ(cacheFiles().size(), 1u);
+
+  clearResult();
+  EXPECT_TRUE(reference());
+  expectResult();
+}
+
+TEST_F(ReferenceCacheTest, changedInputs)
+{
+  EXPECT_FALSE(reference());
+
+  field[500] += 1e-16;
+  EXPECT_FALSE(reference());
+  kappa = 0.13;
+  EXPECT_FALSE(reference());
+  EXPECT_FALSE(reference("other"));
+  EXPECT_EQ(cacheFiles().size(), 4u);
+
+  // every result is stored under its own key
+  clearResult();
+  EXPECT_TRUE(reference());
+  expectResult();
+}
+
+TEST_F(ReferenceCacheTest, truncated)
+{
+  EXPECT_FALSE(reference());
+  auto files = cacheFiles();
+  ASSERT_EQ(files.size(), 1u);
+  ASSERT_EQ(truncate(files[0].c_str(), 100), 0);
+
+  clearResult();
+  EXPECT_FALSE(reference());
+  expectResult();
+
+  // the miss stored the result again
+  EXPECT_TRUE(reference());
+}
+
+TEST_F(ReferenceCacheTest, corrupted)
+{
+  EXPECT_FALSE(reference());
+  auto files = cacheFiles();
+  ASSERT_EQ(files.size(), 1u);
+  FILE *fp = fopen(files[0].c_str(), "r+b");
+  ASSERT_NE(fp, nullptr);
+  fputc('X', fp); // the magic number
+  fclose(fp);
+
+  clearResult();
+  EXPECT_FALSE(reference());
+  expectResult();
+}
+
+TEST_F(ReferenceCacheTest, mismatchedOutputs)
+{
+  EXPECT_FALSE(reference());
+  auto files = cacheFiles();
+  ASSERT_EQ(files.size(), 1u);
+
+  // a result of the same inputs and name but another shape, which the
+  // stored file must not be loaded into
+  std::vector<double> other(result.size() + 1, -1.0);
+  ReferenceCache cache("test");
+  cache.input(field.data(), field.size() * sizeof(double)).param(kappa);
+  cache.output(other.data(), other.size() * sizeof(double)).output(extra.data(), extra.size() * sizeof(int));
+  EXPECT_FALSE(cache.load());
+  for (auto o : other) EXPECT_EQ(o, -1.0);
+
+  ReferenceCache fewer("test");
+  fewer.input(field.data(), field.size() * sizeof(double)).param(kappa);
+  fewer.output(result.data(), result.size() * sizeof(double));
+  clearResult();
+  EXPECT_FALSE(fewer.load());
+  for (auto r : result) EXPECT_EQ(r, 0.0);
+}
+
+TEST_F(ReferenceCacheTest, disabled)
+{
+  std::string path = getenv("QUDA_REFERENCE_CACHE_PATH");
+  unsetenv("QUDA_REFERENCE_CACHE_PATH");
+  EXPECT_FALSE(reference());
+  EXPECT_FALSE(reference());
+  setenv("QUDA_REFERENCE_CACHE_PATH", path.c_str(), 1);
+  EXPECT_TRUE(cacheFiles().empty());
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+
+  char dir[] = "/tmp/quda_reference_cache_XXXXXX";
+  if (!mkdtemp(dir)) {
+    perror("mkdtemp");
+    return EXIT_FAILURE;
+  }
+  cache_dir = dir;
+  setenv("QUDA_REFERENCE_CACHE_PATH", dir, 1);
+
+  initComms(argc, argv, gridsize_from_cmdline);
+  int X[4] = {4, 4, 4, 8};
+  setDims(X);
+
+  int result = RUN_ALL_TESTS();
+
+  finalizeComms();
+  for (auto f : cacheFiles()) remove(f.c_str());
+  rmdir(dir);
+  return result;
+}
@@ -22,6 +22,7 @@
 #include <unitarization_links.h>
 
 #include "dslash_test_helpers.h"
+#include <reference_cache.h>
 #include <assert.h>
 #include <gtest/gtest.h>
 
@@ -322,6 +323,23 @@ DslashTime dslashCUDA(int niter) {
 
 void staggeredDslashRef()
 {
+  // reuse the reference of an earlier run with the same fields and parameters
+  ReferenceCache cache("staggered_dslash_test");
+  for (int dir = 0; dir < 4; dir++) {
+    cache.input(qdp_fatlink_cpu[dir], V * gauge_site_size * host_gauge_data_type_size);
+    cache.input(qdp_longlink_cpu[dir], V * gauge_site_size * host_gauge_data_type_size);
+  }
+  cache.input(spinor->V(), spinor->Bytes())
+    .gaugeParam(gauge_param)
+    .param(dslash_type)
+    .param(dtest_type)
+    .param(parity)
+    .param(dagger)
+    .param(mass)
+    .param(kappa)
+    .param(inv_param.cpu_prec)
+    .output(spinorRef->V(), spinorRef->Bytes());
+  if (cache.load()) return;
 
   // compare to dslash reference implementation
   // printfQuda("Calculating reference implementation...");
@@ -351,6 +369,8 @@ void staggeredDslashRef()
     default:
       errorQuda("Test type not defined");
   }
+
+  cache.save();
 }
 
 TEST(dslash, verify) {
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <kernel_trace.h>
+
+// Convert a binary kernel trace (trace_rank<N>.bin, written with
+// QUDA_ENABLE_TRACE) to the text trace format, and print a summary of
+// the trace aggregated by kernel name, together with the high-water
+// marks of the memory allocations and the kernel at which each was
+// first reached.  With --binary, convert a text trace back to binary
+// instead.
+
+using namespace quda::kernel_trace;
+
+struct KernelSummary {
+  long calls = 0;
+  double time = 0.0;
+  int64_t device_bytes = 0;
+  int64_t host_bytes = 0;
+};
+
+struct HighWater {
+  int64_t bytes = 0;
+  std::string kernel;
+  long entry = -1;
+
+  void update(int64_t b, const std::string &name, long e)
+  {
+    if (b > bytes) {
+      bytes = b;
+      kernel = name;
+      entry = e;
+    }
+  }
+};
+
+int main(int argc, char **argv)
+{
+  if (argc == 4 && strcmp(argv[1], "--binary") == 0) {
+    if (!textToBinary(argv[2], argv[3])) {
+      printf("Failed to convert %s to %s\n", argv[2], argv[3]);
+      return 1;
+    }
+    printf("Converted %s to %s\n", argv[2], argv[3]);
+    return 0;
+  }
+
+  if (argc != 2 && argc != 3) {
+    printf("Usage: %s <trace.bin> [<trace.tsv>]\n", argv[0]);
+    printf("       %s --binary <trace.tsv> <trace.bin>\n", argv[0]);
+    printf("Summarizes a binary kernel trace, and converts it to text if an output file is given,\n");
+    printf("or converts a text trace back to binary\n");
+    return 1;
+  }
+
+  Reader reader;
+  if (!reader.open(argv[1])) {
+    printf("Failed to read trace %s\n", argv[1]);
+    return 1;
+  }
+
+  std::ofstream text;
+  if (argc == 3) {
+    text.open(argv[2]);
+    if (!text) {
+      printf("Failed to open %s\n", argv[2]);
+      return 1;
+    }
+    writeTextHeader(text, reader.header());
+  }
+
+  std::map<std::string, KernelSummary> kernels;
+  HighWater device, pinned, mapped, host;
+  long entries = 0;
+
+  Record record;
+  while (reader.next(record)) {
+    const auto &key = reader.key(record);
+    if (text.is_open()) writeText(text, key, record);
+
+    auto &k = kernels[key.name];
+    k.calls++;
+    k.time += record.time;
+    k.device_bytes = std::max(k.device_bytes, record.device_bytes);
+    k.host_bytes = std::max(k.host_bytes, record.host_bytes);
+
+    device.update(record.device_bytes, key.name, entries);
+    pinned.update(record.pinned_bytes, key.name, entries);
+    mapped.update(record.mapped_bytes, key.name, entries);
+    host.update(record.host_bytes, key.name, entries);
+    entries++;
+  }
+
+  printf("Trace of rank %d with %ld entries (QUDA %s, %s)\n", reader.header().rank, entries, reader.header().version,
+         reader.header().gitversion);
+
+  // kernels in decreasing order of total time
+  std::vector<std::pair<std::string, KernelSummary>> sorted(kernels.begin(), kernels.end());
+  std::sort(sorted.begin(), sorted.end(),
+            [](const std::pair<std::string, KernelSummary> &a, const std::pair<std::string, KernelSummary> &b) {
+              return a.second.time > b.second.time;
+            });
+
+  printf("\n%12s\t%12s\t%12s\t%14s\t%14s\tname\n", "calls", "total time", "time / call", "device-mem", "host-mem");
+  for (auto &k : sorted) {
+    printf("%12ld\t%12g\t%12g\t%14ld\t%14ld\t%s\n", k.second.calls, k.second.time, k.second.time / k.second.calls,
+           static_cast<long>(k.second.device_bytes), static_cast<long>(k.second.host_bytes), k.first.c_str());
+  }
+
+  printf("\nMemory high-water marks:\n");
+  auto print = [](const char *label, const HighWater &hw) {
+    if (hw.entry < 0)
+      printf("  %-8s %14d bytes\n", label, 0);
+    else
+      printf("  %-8s %14ld bytes, first reached at entry %ld (%s)\n", label, static_cast<long>(hw.bytes), hw.entry,
+             hw.kernel.c_str());
+  };
+  print("device", device);
+  print("pinned", pinned);
+  print("mapped", mapped);
+  print("host", host);
+
+  if (text.is_open()) {
+    if (!text.good()) {
+      printf("Failed to write %s\n", argv[2]);
+      return 1;
+    }
+    printf("\nConverted %s to %s\n", argv[1], argv[2]);
+  }
+
+  return 0;
+}
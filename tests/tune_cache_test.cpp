@@ -0,0 +1,265 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <tune_cache.h>
+
+// google test
+#include <gtest/gtest.h>
+
+using namespace quda;
+using namespace quda::tune_cache;
+
+/**
+   Unit tests of the tunecache formats: the text and binary formats
+   round trip every field of the entries, validBinary rejects images
+   that are truncated or whose header, records, index or strings are
+   inconsistent, and the tunecache_convert tool converts in both
+   directions.  The path of tunecache_convert is given as the first
+   argument; without it that test is skipped.
+*/
+
+static std::string convert_path;
+
+static tune_map sampleCache()
+{
+  tune_map cache;
+  const char *volumes[] = {"4x4x4x4", "24x24x24x48"};
+  for (int i = 0; i < 20; i++) {
+    std::string name = "N4quda4blas" + std::to_string(i) + "axpbyzNorm2IdEEvPT_S4_";
+    std::string aux = "vol=" + std::to_string(i) + ",precision=8,order=2,Ns=4,Nc=3";
+    TuneKey key(volumes[i % 2], name.c_str(), aux.c_str());
+    TuneParam param;
+    param.block = dim3(32 * (i + 1), i % 3 + 1, 1);
+    param.grid = dim3(i + 7, 2, i % 4 + 1);
+    param.shared_bytes = 128 * i;
+    param.aux = make_int4(i, -i, 2 * i, 1);
+    param.time = 0.125f * (i + 1); // exactly representable in the text format
+    param.comment = "# " + std::to_string(i) + " tuned\n";
+    cache[key] = param;
+  }
+  return cache;
+}
+
+static void expectEqual(const tune_map &a, const tune_map &b)
+{
+  ASSERT_EQ(a.size(), b.size());
+  for (auto ia = a.begin(), ib = b.begin(); ia != a.end(); ia++, ib++) {
+    EXPECT_TRUE(ia->first == ib->first) << ia->first.name;
+    const TuneParam &p = ia->second, &q = ib->second;
+    EXPECT_EQ(p.block.x, q.block.x);
+    EXPECT_EQ(p.block.y, q.block.y);
+    EXPECT_EQ(p.block.z, q.block.z);
+    EXPECT_EQ(p.grid.x, q.grid.x);
+    EXPECT_EQ(p.grid.y, q.grid.y);
+    EXPECT_EQ(p.grid.z, q.grid.z);
+    EXPECT_EQ(p.shared_bytes, q.shared_bytes);
+    EXPECT_EQ(p.aux.x, q.aux.x);
+    EXPECT_EQ(p.aux.y, q.aux.y);
+    EXPECT_EQ(p.aux.z, q.aux.z);
+    EXPECT_EQ(p.aux.w, q.aux.w);
+    EXPECT_EQ(p.time, q.time);
+    EXPECT_EQ(p.comment, q.comment);
+  }
+}
+
+static void writeTextFile(const std::string &path, const tune_map &cache)
+{
+  std::ofstream out(path.c_str());
+  writeTextHeader(out, "1.1.0", "v1.1.0-abcdef", "hash0123");
+  writeText(out, cache);
+}
+
+static tune_map readBinaryFile(const std::string &path)
+{
+  std::ifstream file(path.c_str(), std::ios::binary);
+  std::vector<char> image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  tune_map cache;
+  EXPECT_TRUE(deserializeBinary(image.data(), image.size(), cache)) << path;
+  return cache;
+}
+
+static tune_map readTextFile(const std::string &path)
+{
+  std::ifstream file(path.c_str());
+  std::string line;
+  for (int i = 0; i < 3; i++) getline(file, line); // the header lines and the blank line between them
+  tune_map cache;
+  readText(file, cache);
+  return cache;
+}
+
+TEST(TuneCache, textRoundTrip)
+{
+  tune_map cache = sampleCache();
+  std::stringstream text;
+  writeText(text, cache);
+  tune_map read;
+  readText(text, read);
+  expectEqual(cache, read);
+}
+
+TEST(TuneCache, binaryRoundTrip)
+{
+  tune_map cache = sampleCache();
+  for (bool index : {false, true}) {
+    auto image = serializeBinary(cache, "1.1.0", "v1.1.0-abcdef", "hash0123", index);
+    EXPECT_TRUE(validBinary(image.data(), image.size()));
+    tune_map read;
+    EXPECT_TRUE(deserializeBinary(image.data(), image.size(), read));
+    expectEqual(cache, read);
+  }
+
+  // an empty cache is a valid image
+  auto image = serializeBinary(tune_map());
+  EXPECT_TRUE(validBinary(image.data(), image.size()));
+}
+
+TEST(TuneCache, mapped)
+{
+  tune_map cache = sampleCache();
+  const std::string path = "tune_cache_test_mapped.bin";
+  ASSERT_TRUE(writeBinaryFile(path, serializeBinary(cache, "1.1.0", "v1.1.0-abcdef", "hash0123", true)));
+
+  MappedCache mapped;
+  ASSERT_TRUE(mapped.open(path));
+  EXPECT_EQ(mapped.size(), cache.size());
+  EXPECT_EQ(mapped.version(), "1.1.0");
+  EXPECT_EQ(mapped.gitversion(), "v1.1.0-abcdef");
+  EXPECT_EQ(mapped.hash(), "hash0123");
+
+  for (auto &entry : cache) {
+    TuneParam param;
+    EXPECT_TRUE(mapped.find(entry.first, param)) << entry.first.name;
+    EXPECT_EQ(param.block.x, entry.second.block.x);
+    EXPECT_EQ(param.comment, entry.second.comment);
+  }
+  TuneParam param;
+  EXPECT_FALSE(mapped.find(TuneKey("4x4x4x4", "missing"), param));
+
+  tune_map materialized;
+  mapped.materialize(materialized);
+  expectEqual(cache, materialized);
+
+  // an image without an index cannot be queried in place
+  mapped.close();
+  ASSERT_TRUE(writeBinaryFile(path, serializeBinary(cache, "", "", "", false)));
+  EXPECT_FALSE(mapped.open(path));
+  remove(path.c_str());
+}
+
+/**
+   @brief Apply a corruption to a valid image and check it is rejected
+ */
+static void expectInvalid(const std::string &what, const std::function<void(std::vector<char> &)> &corrupt)
+{
+  auto image = serializeBinary(sampleCache(), "1.1.0", "v1.1.0-abcdef", "hash0123", true);
+  corrupt(image);
+  EXPECT_FALSE(validBinary(image.data(), image.size())) << what;
+  tune_map cache;
+  EXPECT_FALSE(deserializeBinary(image.data(), image.size(), cache)) << what;
+}
+
+static BinaryHeader &header(std::vector<char> &image) { return *reinterpret_cast<BinaryHeader *>(image.data()); }
+
+static BinaryRecord &record(std::vector<char> &image, int i)
+{
+  return reinterpret_cast<BinaryRecord *>(image.data() + header(image).record_offset)[i];
+}
+
+TEST(TuneCache, validBinary)
+{
+  EXPECT_FALSE(validBinary(nullptr, 0));
+  expectInvalid("truncated header", [](std::vector<char> &v) { v.resize(sizeof(BinaryHeader) - 1); });
+  expectInvalid("truncated", [](std::vector<char> &v) { v.pop_back(); });
+  expectInvalid("extended", [](std::vector<char> &v) { v.push_back('\0'); });
+  expectInvalid("magic", [](std::vector<char> &v) { header(v).magic[0] = 'X'; });
+  expectInvalid("endian", [](std::vector<char> &v) { header(v).endian = 0x04030201; });
+  expectInvalid("format version", [](std::vector<char> &v) { header(v).format_version++; });
+
+  // version strings that run to the end of their fields
+  expectInvalid("version", [](std::vector<char> &v) {
+    memset(header(v).version, 'x', sizeof(header(v).version));
+  });
+  expectInvalid("gitversion", [](std::vector<char> &v) {
+    memset(header(v).gitversion, 'x', sizeof(header(v).gitversion));
+  });
+  expectInvalid("hash", [](std::vector<char> &v) { memset(header(v).hash, 'x', sizeof(header(v).hash)); });
+
+  expectInvalid("n_bucket", [](std::vector<char> &v) { header(v).n_bucket--; });
+  expectInvalid("full index", [](std::vector<char> &v) { header(v).n_bucket = 16; }); // 20 entries
+  expectInvalid("record offset", [](std::vector<char> &v) { header(v).record_offset += 8; });
+  expectInvalid("bucket offset", [](std::vector<char> &v) { header(v).bucket_offset += 4; });
+  expectInvalid("string offset", [](std::vector<char> &v) { header(v).string_offset += 4; });
+  expectInvalid("n_entry", [](std::vector<char> &v) { header(v).n_entry++; });
+  expectInvalid("pool termination", [](std::vector<char> &v) { v.back() = 'x'; });
+  expectInvalid("string offset in record", [](std::vector<char> &v) {
+    record(v, 3).name = v.size() - header(v).string_offset;
+  });
+  expectInvalid("bucket", [](std::vector<char> &v) {
+    reinterpret_cast<uint32_t *>(v.data() + header(v).bucket_offset)[0] = header(v).n_entry + 1;
+  });
+
+  // a volume string too long for TuneKey
+  expectInvalid("volume length", [](std::vector<char> &v) {
+    BinaryRecord &r = record(v, 0);
+    r.volume = r.name; // the name is longer than TuneKey::volume_n
+  });
+}
+
+TEST(TuneCache, convertFunctions)
+{
+  tune_map cache = sampleCache();
+  writeTextFile("tune_cache_test.tsv", cache);
+
+  ASSERT_TRUE(textToBinary("tune_cache_test.tsv", "tune_cache_test.bin"));
+  expectEqual(cache, readBinaryFile("tune_cache_test.bin"));
+
+  MappedCache mapped;
+  ASSERT_TRUE(mapped.open("tune_cache_test.bin"));
+  EXPECT_EQ(mapped.version(), "1.1.0");
+  EXPECT_TRUE(mapped.text() == textStamp("tune_cache_test.tsv"));
+  mapped.close();
+
+  ASSERT_TRUE(binaryToText("tune_cache_test.bin", "tune_cache_test_2.tsv"));
+  expectEqual(cache, readTextFile("tune_cache_test_2.tsv"));
+
+  EXPECT_FALSE(textToBinary("tune_cache_test_missing.tsv", "tune_cache_test_missing.bin"));
+  EXPECT_FALSE(binaryToText("tune_cache_test.tsv", "tune_cache_test_missing.tsv"));
+
+  for (auto f : {"tune_cache_test.tsv", "tune_cache_test.bin", "tune_cache_test_2.tsv"}) remove(f);
+}
+
+TEST(TuneCache, convertTool)
+{
+  if (convert_path.empty()) GTEST_SKIP();
+
+  tune_map cache = sampleCache();
+  writeTextFile("tune_cache_tool.tsv", cache);
+
+  auto run = [](const std::string &in, const std::string &out) {
+    return system((convert_path + " " + in + " " + out + " > /dev/null").c_str());
+  };
+  EXPECT_EQ(run("tune_cache_tool.tsv", "tune_cache_tool.bin"), 0);
+  expectEqual(cache, readBinaryFile("tune_cache_tool.bin"));
+  EXPECT_EQ(run("tune_cache_tool.bin", "tune_cache_tool_2.tsv"), 0);
+  expectEqual(cache, readTextFile("tune_cache_tool_2.tsv"));
+
+  // a text file read as binary fails
+  rename("tune_cache_tool_2.tsv", "tune_cache_tool_2.bin");
+  EXPECT_NE(run("tune_cache_tool_2.bin", "tune_cache_tool_3.tsv"), 0);
+
+  for (auto f : {"tune_cache_tool.tsv", "tune_cache_tool.bin", "tune_cache_tool_2.bin"}) remove(f);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  if (argc > 1) convert_path = argv[1];
+  return RUN_ALL_TESTS();
+}
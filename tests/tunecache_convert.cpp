@@ -0,0 +1,41 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <tune_cache.h>
+
+// Convert between the text (tunecache.tsv) and binary (tunecache.bin)
+// tunecache formats.  The direction is deduced from the file extension
+// of the input.
+
+static bool endsWith(const std::string &s, const std::string &suffix)
+{
+  return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc != 3) {
+    printf("Usage: %s <input> <output>\n", argv[0]);
+    printf("Converts tunecache.tsv to tunecache.bin or vice versa, depending on the input file extension\n");
+    return 1;
+  }
+
+  std::string in = argv[1];
+  std::string out = argv[2];
+
+  bool success;
+  if (endsWith(in, ".bin")) {
+    success = quda::tune_cache::binaryToText(in, out);
+  } else {
+    success = quda::tune_cache::textToBinary(in, out);
+  }
+
+  if (!success) {
+    printf("Failed to convert %s to %s\n", in.c_str(), out.c_str());
+    return 1;
+  }
+
+  printf("Converted %s to %s\n", in.c_str(), out.c_str());
+  return 0;
+}
@@ -0,0 +1,122 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <tune_cache.h>
+
+// Microbenchmark of the per-launch tunecache lookup overhead: the
+// std::map lookup that tuneLaunch used to do, against the hashed
+// tune_cache::Index lookup that it does now.  Keys are modeled on
+// those generated by typical blas, reduction and dslash kernels.
+// Finally, entries are replaced while other threads look them up, and
+// the run fails if a reader ever sees a partially updated entry.
+
+using namespace quda;
+
+static double now()
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char **argv)
+{
+  const int n_entry = argc > 1 ? atoi(argv[1]) : 10000;
+  const int n_lookup = argc > 2 ? atoi(argv[2]) : 10000000;
+
+  std::vector<TuneKey> keys;
+  keys.reserve(n_entry);
+  const char *volumes[] = {"4x4x4x4", "8x8x8x8", "16x16x16x16", "24x24x24x48", "2x2x2x2"};
+  for (int i = 0; i < n_entry; i++) {
+    std::string name = "N4quda4blas" + std::to_string(i % 97) + "axpbyzNorm2IdEEvPT_S4_";
+    std::string aux = "vol=" + std::to_string(i) + ",stride=" + std::to_string(i * 3) + ",precision=8,order=2,Ns=4,Nc=3";
+    keys.emplace_back(volumes[i % 5], name.c_str(), aux.c_str());
+  }
+
+  tune_map cache;
+  TuneParam initial;
+  initial.shared_bytes = initial.aux.x = 0;
+  for (auto &key : keys) cache[key] = initial;
+  tune_cache::Index index;
+  for (auto &entry : cache) index.publish(entry.first, entry.second);
+
+  // random access pattern, fixed so that both lookups see the same sequence
+  std::vector<int> order(n_lookup);
+  unsigned int seed = 1234;
+  for (auto &o : order) o = (seed = seed * 1103515245 + 12345) % n_entry;
+
+  long check = 0;
+
+  double t0 = now();
+  for (int i = 0; i < n_lookup; i++) check += cache.find(keys[order[i]])->second.shared_bytes;
+  double map_time = now() - t0;
+
+  t0 = now();
+  for (int i = 0; i < n_lookup; i++) check += index.find(keys[order[i]])->second.shared_bytes;
+  double index_time = now() - t0;
+
+  // the key is rebuilt on every launch, so also measure the cost of (re)hashing it
+  t0 = now();
+  for (int i = 0; i < n_lookup; i++) {
+    TuneKey key = keys[order[i]];
+    key.updateHash();
+    check += key.hash & 1;
+  }
+  double hash_time = now() - t0;
+
+  int n_thread = 1;
+  t0 = now();
+#pragma omp parallel reduction(+ : check)
+  {
+#ifdef _OPENMP
+#pragma omp single
+    n_thread = omp_get_num_threads();
+#endif
+#pragma omp for
+    for (int i = 0; i < n_lookup; i++) check += index.find(keys[order[i]])->second.shared_bytes;
+  }
+  double threaded_time = now() - t0;
+
+  // replace every entry while the other threads look them up: each
+  // entry a reader sees must be complete, with matching fields
+  long torn = 0;
+  t0 = now();
+#pragma omp parallel reduction(+ : torn)
+  {
+#ifdef _OPENMP
+    const int thread = omp_get_thread_num();
+    const int n = omp_get_num_threads();
+#else
+    const int thread = 0;
+    const int n = 1;
+#endif
+    if (thread == 0) {
+      for (int i = 0; i < n_entry; i++) {
+        TuneParam param;
+        param.shared_bytes = param.aux.x = i + 1;
+        index.publish(keys[i], param);
+      }
+    } else {
+      for (int i = thread; i < n_lookup; i += n - 1) {
+        const TuneParam &param = index.find(keys[order[i]])->second;
+        if (param.shared_bytes != param.aux.x) torn++;
+      }
+    }
+  }
+  double replace_time = now() - t0;
+
+  printf("%d entries, %d lookups (check = %ld)\n", n_entry, n_lookup, check);
+  printf("std::map lookup                = %8.2f ns\n", 1e9 * map_time / n_lookup);
+  printf("index lookup                   = %8.2f ns\n", 1e9 * index_time / n_lookup);
+  printf("key copy and hash              = %8.2f ns\n", 1e9 * hash_time / n_lookup);
+  printf("index lookup (%3d threads)     = %8.2f ns per lookup, aggregate\n", n_thread, 1e9 * threaded_time / n_lookup);
+  printf("replace during lookup          = %8.2f ns per replacement, %ld torn entries\n",
+         1e9 * replace_time / n_entry, torn);
+
+  return torn == 0 ? 0 : 1;
+}
@@ -0,0 +1,257 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <host_utils.h>
+#include <command_line_params.h>
+#include <color_spinor_field.h>
+#include <qio_field.h>
+#include <vector_io.h>
+
+// google test
+#include <gtest/gtest.h>
+
+using namespace quda;
+
+/**
+   Round trips of host vectors through VectorIO: a set saved as a
+   single record (the default) or as a record per chunk, loaded whole
+   or in chunks, where a record larger than a chunk is read in passes,
+   with and without parity inflation, and into vectors of another
+   precision or field order, which are staged through host fields in
+   the file layout.  Vectors are compared exactly with what was saved.
+*/
+
+class VectorIOTest : public ::testing::Test
+{
+protected:
+  static constexpr int n_vec = 5;
+  std::string file;
+  std::vector<std::unique_ptr<ColorSpinorField>> saved;
+
+  void SetUp() override
+  {
+    file = std::string("vector_io_test_") + ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".lime";
+    unsetenv("QUDA_VECTOR_IO_CHUNK");
+  }
+
+  void TearDown() override
+  {
+    unsetenv("QUDA_VECTOR_IO_CHUNK");
+    std::remove(file.c_str());
+  }
+
+  static ColorSpinorParam param(QudaSiteSubset subset, QudaPrecision prec,
+                                QudaFieldOrder order = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER)
+  {
+    ColorSpinorParam param;
+    param.nColor = 3;
+    param.nSpin = 4;
+    param.nDim = 4;
+    for (int d = 0; d < 4; d++) param.x[d] = 4;
+    if (subset == QUDA_PARITY_SITE_SUBSET) param.x[0] /= 2;
+    param.siteSubset = subset;
+    param.siteOrder = QUDA_EVEN_ODD_SITE_ORDER;
+    param.fieldOrder = order;
+    param.gammaBasis = QUDA_DEGRAND_ROSSI_GAMMA_BASIS;
+    param.setPrecision(prec);
+    param.pad = 0;
+    param.location = QUDA_CPU_FIELD_LOCATION;
+    param.create = QUDA_ZERO_FIELD_CREATE;
+    return param;
+  }
+
+  static std::vector<ColorSpinorField *> pointers(const std::vector<std::unique_ptr<ColorSpinorField>> &vecs)
+  {
+    std::vector<ColorSpinorField *> p;
+    for (auto &v : vecs) p.push_back(v.get());
+    return p;
+  }
+
+  static std::vector<std::unique_ptr<ColorSpinorField>>
+  create(QudaSiteSubset subset, QudaPrecision prec, QudaFieldOrder order = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER)
+  {
+    std::vector<std::unique_ptr<ColorSpinorField>> vecs;
+    ColorSpinorParam p = param(subset, prec, order);
+    for (int i = 0; i < n_vec; i++) {
+      vecs.emplace_back(ColorSpinorField::Create(p));
+      vecs.back()->setSuggestedParity(QUDA_ODD_PARITY);
+    }
+    return vecs;
+  }
+
+  static size_t reals(const ColorSpinorField &v) { return v.Volume() * 2 * v.Nspin() * v.Ncolor(); }
+
+  /**
+     @brief Save a set of vectors with values that are exact in
+     single precision, from vectors of the given field order
+  */
+  void save(QudaSiteSubset subset, QudaPrecision prec, bool parity_inflate = false,
+            QudaFieldOrder order = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER)
+  {
+    saved = create(subset, prec);
+    for (int i = 0; i < n_vec; i++) {
+      for (size_t j = 0; j < reals(*saved[i]); j++) {
+        double value = std::ldexp(std::round(std::ldexp(std::sin(1.0 + i + 0.01 * j), 20)), -20);
+        if (prec == QUDA_DOUBLE_PRECISION)
+          static_cast<double *>(saved[i]->V())[j] = value;
+        else
+          static_cast<float *>(saved[i]->V())[j] = value;
+      }
+    }
+
+    if (order == QUDA_SPACE_SPIN_COLOR_FIELD_ORDER) {
+      VectorIO(file, parity_inflate).save(pointers(saved));
+    } else {
+      auto reordered = create(subset, prec, order);
+      for (int i = 0; i < n_vec; i++) *reordered[i] = *saved[i];
+      VectorIO(file, parity_inflate).save(pointers(reordered));
+    }
+  }
+
+  /**
+     @brief Load the saved vectors into vectors of the given precision
+     and field order and count the values that differ
+  */
+  int load(QudaPrecision prec, bool parity_inflate = false, QudaFieldOrder order = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER)
+  {
+    auto loaded = create(saved[0]->SiteSubset(), prec);
+    if (order == QUDA_SPACE_SPIN_COLOR_FIELD_ORDER) {
+      auto p = pointers(loaded);
+      VectorIO(file, parity_inflate).load(p);
+    } else {
+      auto reordered = create(saved[0]->SiteSubset(), prec, order);
+      auto p = pointers(reordered);
+      VectorIO(file, parity_inflate).load(p);
+      for (int i = 0; i < n_vec; i++) *loaded[i] = *reordered[i];
+    }
+
+    int differ = 0;
+    for (int i = 0; i < n_vec; i++) {
+      for (size_t j = 0; j < reals(*saved[i]); j++) {
+        auto value = [j](const ColorSpinorField &v) {
+          return v.Precision() == QUDA_DOUBLE_PRECISION ? static_cast<const double *>(v.V())[j] :
+                                                          static_cast<const float *>(v.V())[j];
+        };
+        if (value(*loaded[i]) != value(*saved[i])) differ++;
+      }
+    }
+    return differ;
+  }
+
+  /**
+     @brief Load the file of inflated vectors into full vectors and
+     count the values that differ from the saved vectors in their
+     parity, and from zero in the other
+  */
+  int inflated()
+  {
+    auto full = create(QUDA_FULL_SITE_SUBSET, saved[0]->Precision());
+    auto p = pointers(full);
+    VectorIO(file).load(p);
+
+    int differ = 0;
+    const size_t half = reals(*saved[0]);
+    for (int i = 0; i < n_vec; i++) {
+      for (size_t j = 0; j < 2 * half; j++) {
+        auto value = [](const ColorSpinorField &v, size_t j) {
+          return v.Precision() == QUDA_DOUBLE_PRECISION ? static_cast<const double *>(v.V())[j] :
+                                                          static_cast<const float *>(v.V())[j];
+        };
+        // the odd sites follow the even ones
+        double expected = j < half ? 0.0 : value(*saved[i], j - half);
+        if (value(*full[i], j) != expected) differ++;
+      }
+    }
+    return differ;
+  }
+
+  /**
+     @return The number of vectors of each record of the file
+  */
+  std::vector<int> records(QudaSiteSubset subset)
+  {
+    ColorSpinorParam p = param(subset, QUDA_DOUBLE_PRECISION);
+    std::vector<int> counts;
+    QioSpinorInput *infile = open_spinor_input(file.c_str(), p.x, subset);
+    for (int count; (count = next_spinor_record_count(infile)) > 0;) {
+      counts.push_back(count);
+      skip_spinor_record(infile);
+    }
+    close_spinor_input(infile);
+    return counts;
+  }
+};
+
+TEST_F(VectorIOTest, singleRecord)
+{
+  save(QUDA_FULL_SITE_SUBSET, QUDA_DOUBLE_PRECISION);
+  EXPECT_EQ(records(QUDA_FULL_SITE_SUBSET), std::vector<int> {n_vec});
+  EXPECT_EQ(load(QUDA_DOUBLE_PRECISION), 0);
+}
+
+TEST_F(VectorIOTest, chunkedRecords)
+{
+  setenv("QUDA_VECTOR_IO_CHUNK", "2", 1);
+  save(QUDA_FULL_SITE_SUBSET, QUDA_DOUBLE_PRECISION);
+  EXPECT_EQ(records(QUDA_FULL_SITE_SUBSET), (std::vector<int> {2, 2, 1}));
+  EXPECT_EQ(load(QUDA_DOUBLE_PRECISION), 0);
+
+  unsetenv("QUDA_VECTOR_IO_CHUNK");
+  EXPECT_EQ(load(QUDA_DOUBLE_PRECISION), 0);
+}
+
+TEST_F(VectorIOTest, recordInPasses)
+{
+  // a single record of five vectors, staged through chunks of two
+  save(QUDA_FULL_SITE_SUBSET, QUDA_SINGLE_PRECISION);
+  setenv("QUDA_VECTOR_IO_CHUNK", "2", 1);
+  EXPECT_EQ(load(QUDA_DOUBLE_PRECISION, false, QUDA_SPACE_COLOR_SPIN_FIELD_ORDER), 0);
+  EXPECT_EQ(load(QUDA_SINGLE_PRECISION, false, QUDA_SPACE_COLOR_SPIN_FIELD_ORDER), 0);
+}
+
+TEST_F(VectorIOTest, fieldOrder)
+{
+  save(QUDA_FULL_SITE_SUBSET, QUDA_DOUBLE_PRECISION, false, QUDA_SPACE_COLOR_SPIN_FIELD_ORDER);
+  EXPECT_EQ(records(QUDA_FULL_SITE_SUBSET), std::vector<int> {n_vec});
+  EXPECT_EQ(load(QUDA_DOUBLE_PRECISION), 0);
+
+  setenv("QUDA_VECTOR_IO_CHUNK", "2", 1);
+  save(QUDA_FULL_SITE_SUBSET, QUDA_SINGLE_PRECISION, false, QUDA_SPACE_COLOR_SPIN_FIELD_ORDER);
+  EXPECT_EQ(records(QUDA_FULL_SITE_SUBSET), (std::vector<int> {2, 2, 1}));
+  EXPECT_EQ(load(QUDA_SINGLE_PRECISION, false, QUDA_SPACE_COLOR_SPIN_FIELD_ORDER), 0);
+}
+
+TEST_F(VectorIOTest, parityInflate)
+{
+  save(QUDA_PARITY_SITE_SUBSET, QUDA_DOUBLE_PRECISION, true);
+  EXPECT_EQ(records(QUDA_FULL_SITE_SUBSET), std::vector<int> {n_vec});
+  EXPECT_EQ(inflated(), 0);
+  EXPECT_EQ(load(QUDA_DOUBLE_PRECISION, true), 0);
+
+  setenv("QUDA_VECTOR_IO_CHUNK", "3", 1);
+  EXPECT_EQ(load(QUDA_SINGLE_PRECISION, true), 0);
+  save(QUDA_PARITY_SITE_SUBSET, QUDA_SINGLE_PRECISION, true);
+  EXPECT_EQ(records(QUDA_FULL_SITE_SUBSET), (std::vector<int> {3, 2}));
+  EXPECT_EQ(inflated(), 0);
+  EXPECT_EQ(load(QUDA_DOUBLE_PRECISION, true), 0);
+}
+
+TEST_F(VectorIOTest, paritySubset)
+{
+  save(QUDA_PARITY_SITE_SUBSET, QUDA_SINGLE_PRECISION);
+  EXPECT_EQ(records(QUDA_PARITY_SITE_SUBSET), std::vector<int> {n_vec});
+  EXPECT_EQ(load(QUDA_DOUBLE_PRECISION), 0);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  initComms(argc, argv, gridsize_from_cmdline);
+  int result = RUN_ALL_TESTS();
+  finalizeComms();
+  return result;
+}
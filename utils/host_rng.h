@@ -0,0 +1,81 @@
+#pragma once
+
+/**
+   @file host_rng.h
+
+   @brief Counter-based random numbers for constructing host test
+   fields.  The Philox4x32-10 generator of Salmon et al. ("Parallel
+   random numbers: as easy as 1, 2, 3", SC11) maps a 128-bit counter
+   and a 64-bit key to four random 32-bit words, so each number is a
+   pure function of where it is used: the counter is formed from the
+   global lattice site, a stream that identifies the field and its
+   component, and the position in that stream.  Fields can therefore
+   be filled in any order by any number of threads, and are identical
+   regardless of the thread count and of the process grid.
+ */
+
+#include <cstdint>
+
+namespace host_rng
+{
+
+  /**
+     @brief Apply the ten Philox4x32 rounds to counter ctr with key
+     key, in place.
+   */
+  inline void philox4x32(uint32_t ctr[4], const uint32_t key_[2])
+  {
+    constexpr uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+    constexpr uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+    uint32_t key[2] = {key_[0], key_[1]};
+    for (int r = 0; r < 10; r++) {
+      uint64_t p0 = static_cast<uint64_t>(M0) * ctr[0];
+      uint64_t p1 = static_cast<uint64_t>(M1) * ctr[2];
+      uint32_t c[4] = {static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0], static_cast<uint32_t>(p1),
+                       static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1], static_cast<uint32_t>(p0)};
+      for (int i = 0; i < 4; i++) ctr[i] = c[i];
+      key[0] += W0;
+      key[1] += W1;
+    }
+  }
+
+  class RNG
+  {
+    uint32_t key[2];
+
+  public:
+    /**
+       @param[in] seed The seed, which forms the Philox key
+    */
+    constexpr RNG(uint64_t seed) : key {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)} { }
+
+    /**
+       @brief Fill out with n numbers uniformly distributed in the unit
+       interval, with 32-bit resolution
+       @param[out] out The random numbers
+       @param[in] n How many numbers
+       @param[in] site Global index of the lattice site
+       @param[in] stream The stream of the site to draw from
+    */
+    template <typename Float> void uniform(Float *out, int n, uint64_t site, uint32_t stream) const
+    {
+      for (int block = 0; block * 4 < n; block++) {
+        uint32_t ctr[4] = {static_cast<uint32_t>(block), stream, static_cast<uint32_t>(site),
+                           static_cast<uint32_t>(site >> 32)};
+        philox4x32(ctr, key);
+        for (int i = 0; i < 4 && block * 4 + i < n; i++) out[block * 4 + i] = ctr[i] * (1.0 / 4294967296.0);
+      }
+    }
+
+    /**
+       @return A single number uniformly distributed in the unit interval
+    */
+    double uniform(uint64_t site, uint32_t stream) const
+    {
+      double u;
+      uniform(&u, 1, site, stream);
+      return u;
+    }
+  };
+
+} // namespace host_rng
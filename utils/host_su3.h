@@ -0,0 +1,364 @@
+#pragma once
+
+/**
+   @file host_su3.h
+
+   @brief SU(3) x color-vector and SU(3) x SU(3) kernels shared by the
+   host reference operators.  All arguments are arrays of interleaved
+   (re, im) pairs, with 3x3 matrices stored row major, which matches
+   the raw link layout as well as the fcomplex and std::complex based
+   su3_matrix structs used in host_reference and utils.
+
+   The reference uses the portable scalar kernels, which the reference
+   and utility libraries compile without contracting to fused
+   multiply-adds, so that its results are bit-identical on every host.
+   When both arguments are double precision, setting the environment
+   variable QUDA_HOST_SIMD=avx2|avx512 opts in to the AVX2/FMA or
+   AVX-512 kernels, to the extent the host supports them.  These are
+   faster, but round differently from the scalar kernels, so their
+   results depend on the instruction set.
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HOST_SU3_X86
+#include <immintrin.h>
+#endif
+
+namespace host_su3
+{
+
+  enum class Isa { Scalar, AVX2, AVX512 };
+
+  /**
+     @brief Returns the instruction set used by the double-precision
+     kernels: scalar unless QUDA_HOST_SIMD requests a vector one.  This
+     is determined once on first call.
+   */
+  inline Isa isa()
+  {
+    static const Isa isa_ = []() {
+      Isa max_isa = Isa::Scalar;
+      const char *env = getenv("QUDA_HOST_SIMD");
+      if (env && strcmp(env, "avx512") == 0) max_isa = Isa::AVX512;
+      else if (env && strcmp(env, "avx2") == 0) max_isa = Isa::AVX2;
+#ifdef HOST_SU3_X86
+      __builtin_cpu_init();
+      bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+      bool avx512 = avx2 && __builtin_cpu_supports("avx512f");
+      if (avx512 && max_isa == Isa::AVX512) return Isa::AVX512;
+      if (avx2 && max_isa != Isa::Scalar) return Isa::AVX2;
+#endif
+      return Isa::Scalar;
+    }();
+    return isa_;
+  }
+
+  inline const char *isa_str()
+  {
+    switch (isa()) {
+    case Isa::AVX512: return "avx512";
+    case Isa::AVX2: return "avx2";
+    default: return "scalar";
+    }
+  }
+
+  // scalar kernels: generic in the precision of each argument
+
+  // res = mat * vec
+  template <typename Float, typename mFloat, typename vFloat>
+  inline void mat_vec_scalar(Float *res, const mFloat *mat, const vFloat *vec)
+  {
+    for (int i = 0; i < 3; i++) {
+      Float re = 0, im = 0;
+      for (int j = 0; j < 3; j++) {
+        Float a_re = mat[i * 6 + 2 * j + 0], a_im = mat[i * 6 + 2 * j + 1];
+        Float b_re = vec[2 * j + 0], b_im = vec[2 * j + 1];
+        re += a_re * b_re - a_im * b_im;
+        im += a_re * b_im + a_im * b_re;
+      }
+      res[2 * i + 0] = re;
+      res[2 * i + 1] = im;
+    }
+  }
+
+  // res = mat^dagger * vec
+  template <typename Float, typename mFloat, typename vFloat>
+  inline void adj_mat_vec_scalar(Float *res, const mFloat *mat, const vFloat *vec)
+  {
+    for (int i = 0; i < 3; i++) {
+      Float re = 0, im = 0;
+      for (int j = 0; j < 3; j++) {
+        Float a_re = mat[j * 6 + 2 * i + 0], a_im = mat[j * 6 + 2 * i + 1];
+        Float b_re = vec[2 * j + 0], b_im = vec[2 * j + 1];
+        re += a_re * b_re + a_im * b_im;
+        im += a_re * b_im - a_im * b_re;
+      }
+      res[2 * i + 0] = re;
+      res[2 * i + 1] = im;
+    }
+  }
+
+  // c = a * b, c = a^dagger * b, c = a * b^dagger
+  template <bool a_dag, bool b_dag, typename Float, typename aFloat, typename bFloat>
+  inline void mat_mat_scalar(Float *c, const aFloat *a, const bFloat *b)
+  {
+    Float tmp[18]; // allow c to alias a or b
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        Float re = 0, im = 0;
+        for (int k = 0; k < 3; k++) {
+          int ai = a_dag ? k * 3 + i : i * 3 + k;
+          int bi = b_dag ? j * 3 + k : k * 3 + j;
+          Float a_re = a[2 * ai + 0], a_im = a_dag ? -a[2 * ai + 1] : a[2 * ai + 1];
+          Float b_re = b[2 * bi + 0], b_im = b_dag ? -b[2 * bi + 1] : b[2 * bi + 1];
+          re += a_re * b_re - a_im * b_im;
+          im += a_re * b_im + a_im * b_re;
+        }
+        tmp[(i * 3 + j) * 2 + 0] = re;
+        tmp[(i * 3 + j) * 2 + 1] = im;
+      }
+    }
+    for (int i = 0; i < 18; i++) c[i] = tmp[i];
+  }
+
+#ifdef HOST_SU3_X86
+
+  // AVX2 kernels: a row of three complex numbers is held as a
+  // 256-bit register (elements 0, 1) plus a 128-bit register (element 2)
+
+#define HOST_SU3_AVX2 __attribute__((target("avx2,fma")))
+
+  // acc += s * row (conj_row = false) or acc += conj(row) * s (conj_row = true)
+  template <bool conj_row>
+  HOST_SU3_AVX2 inline void row_axpy_avx2(__m256d &lo, __m128d &hi, double s_re, double s_im, const double *row)
+  {
+    __m256d re4 = _mm256_set1_pd(s_re), im4 = _mm256_set1_pd(s_im);
+    __m128d re2 = _mm_set1_pd(s_re), im2 = _mm_set1_pd(s_im);
+    __m256d r4 = _mm256_loadu_pd(row);
+    __m128d r2 = _mm_loadu_pd(row + 4);
+    __m256d rs4 = _mm256_permute_pd(r4, 0x5);
+    __m128d rs2 = _mm_permute_pd(r2, 0x1);
+    if (conj_row) {
+      lo = _mm256_add_pd(lo, _mm256_fmsubadd_pd(rs4, im4, _mm256_mul_pd(r4, re4)));
+      hi = _mm_add_pd(hi, _mm_fmsubadd_pd(rs2, im2, _mm_mul_pd(r2, re2)));
+    } else {
+      lo = _mm256_add_pd(lo, _mm256_fmaddsub_pd(r4, re4, _mm256_mul_pd(rs4, im4)));
+      hi = _mm_add_pd(hi, _mm_fmaddsub_pd(r2, re2, _mm_mul_pd(rs2, im2)));
+    }
+  }
+
+  // returns sum_k a[k] * b[k] (conj_b = false) or sum_k a[k] * conj(b[k]) (conj_b = true)
+  template <bool conj_b> HOST_SU3_AVX2 inline __m128d row_dot_avx2(const double *a, const double *b)
+  {
+    __m256d a4 = _mm256_loadu_pd(a), b4 = _mm256_loadu_pd(b);
+    __m128d a2 = _mm_loadu_pd(a + 4), b2 = _mm_loadu_pd(b + 4);
+    __m256d are4 = _mm256_movedup_pd(a4), aim4 = _mm256_permute_pd(a4, 0xF), bs4 = _mm256_permute_pd(b4, 0x5);
+    __m128d are2 = _mm_movedup_pd(a2), aim2 = _mm_permute_pd(a2, 0x3), bs2 = _mm_permute_pd(b2, 0x1);
+    __m256d p4;
+    __m128d p2;
+    if (conj_b) {
+      p4 = _mm256_fmsubadd_pd(aim4, bs4, _mm256_mul_pd(are4, b4));
+      p2 = _mm_fmsubadd_pd(aim2, bs2, _mm_mul_pd(are2, b2));
+    } else {
+      p4 = _mm256_fmaddsub_pd(are4, b4, _mm256_mul_pd(aim4, bs4));
+      p2 = _mm_fmaddsub_pd(are2, b2, _mm_mul_pd(aim2, bs2));
+    }
+    return _mm_add_pd(_mm_add_pd(_mm256_castpd256_pd128(p4), _mm256_extractf128_pd(p4, 1)), p2);
+  }
+
+  HOST_SU3_AVX2 inline void mat_vec_avx2(double *res, const double *mat, const double *vec)
+  {
+    __m128d r[3];
+    for (int i = 0; i < 3; i++) r[i] = row_dot_avx2<false>(mat + i * 6, vec);
+    for (int i = 0; i < 3; i++) _mm_storeu_pd(res + 2 * i, r[i]);
+  }
+
+  HOST_SU3_AVX2 inline void adj_mat_vec_avx2(double *res, const double *mat, const double *vec)
+  {
+    __m256d lo = _mm256_setzero_pd();
+    __m128d hi = _mm_setzero_pd();
+    for (int j = 0; j < 3; j++) row_axpy_avx2<true>(lo, hi, vec[2 * j], vec[2 * j + 1], mat + j * 6);
+    _mm256_storeu_pd(res, lo);
+    _mm_storeu_pd(res + 4, hi);
+  }
+
+  template <bool a_dag, bool b_dag> HOST_SU3_AVX2 inline void mat_mat_avx2(double *c, const double *a, const double *b)
+  {
+    if (b_dag) {
+      __m128d r[9];
+      for (int i = 0; i < 3; i++) {
+        double a_row[6];
+        for (int k = 0; k < 3; k++) {
+          a_row[2 * k + 0] = a_dag ? a[(k * 3 + i) * 2 + 0] : a[(i * 3 + k) * 2 + 0];
+          a_row[2 * k + 1] = a_dag ? -a[(k * 3 + i) * 2 + 1] : a[(i * 3 + k) * 2 + 1];
+        }
+        for (int j = 0; j < 3; j++) r[i * 3 + j] = row_dot_avx2<true>(a_row, b + j * 6);
+      }
+      for (int i = 0; i < 9; i++) _mm_storeu_pd(c + 2 * i, r[i]);
+    } else {
+      __m256d lo[3];
+      __m128d hi[3];
+      for (int i = 0; i < 3; i++) {
+        lo[i] = _mm256_setzero_pd();
+        hi[i] = _mm_setzero_pd();
+        for (int k = 0; k < 3; k++) {
+          int ai = a_dag ? k * 3 + i : i * 3 + k;
+          row_axpy_avx2<false>(lo[i], hi[i], a[2 * ai], a_dag ? -a[2 * ai + 1] : a[2 * ai + 1], b + k * 6);
+        }
+      }
+      for (int i = 0; i < 3; i++) {
+        _mm256_storeu_pd(c + i * 6, lo[i]);
+        _mm_storeu_pd(c + i * 6 + 4, hi[i]);
+      }
+    }
+  }
+
+#undef HOST_SU3_AVX2
+
+  // AVX-512 kernels: a row of three complex numbers fits in the lower
+  // six lanes of a single 512-bit register.  Only the kernels that
+  // accumulate whole rows benefit; the rest use the AVX2 path.
+
+#define HOST_SU3_AVX512 __attribute__((target("avx512f")))
+
+  template <bool conj_row>
+  HOST_SU3_AVX512 inline __m512d row_axpy_avx512(__m512d acc, double s_re, double s_im, const double *row)
+  {
+    __m512d re = _mm512_set1_pd(s_re), im = _mm512_set1_pd(s_im);
+    __m512d r = _mm512_maskz_loadu_pd(0x3F, row);
+    __m512d rs = _mm512_mask_permute_pd(r, 0x3F, r, 0x55);
+    if (conj_row) return _mm512_add_pd(acc, _mm512_fmsubadd_pd(rs, im, _mm512_mul_pd(r, re)));
+    else return _mm512_add_pd(acc, _mm512_fmaddsub_pd(r, re, _mm512_mul_pd(rs, im)));
+  }
+
+  HOST_SU3_AVX512 inline void adj_mat_vec_avx512(double *res, const double *mat, const double *vec)
+  {
+    __m512d acc = _mm512_setzero_pd();
+    for (int j = 0; j < 3; j++) acc = row_axpy_avx512<true>(acc, vec[2 * j], vec[2 * j + 1], mat + j * 6);
+    _mm512_mask_storeu_pd(res, 0x3F, acc);
+  }
+
+  template <bool a_dag> HOST_SU3_AVX512 inline void mat_mat_avx512(double *c, const double *a, const double *b)
+  {
+    __m512d acc[3];
+    for (int i = 0; i < 3; i++) {
+      acc[i] = _mm512_setzero_pd();
+      for (int k = 0; k < 3; k++) {
+        int ai = a_dag ? k * 3 + i : i * 3 + k;
+        acc[i] = row_axpy_avx512<false>(acc[i], a[2 * ai], a_dag ? -a[2 * ai + 1] : a[2 * ai + 1], b + k * 6);
+      }
+    }
+    for (int i = 0; i < 3; i++) _mm512_mask_storeu_pd(c + i * 6, 0x3F, acc[i]);
+  }
+
+#undef HOST_SU3_AVX512
+
+#endif // HOST_SU3_X86
+
+  // dispatch: mixed or single precision always takes the scalar path
+
+  template <typename Float, typename mFloat, typename vFloat>
+  inline void mat_vec(Float *res, const mFloat *mat, const vFloat *vec)
+  {
+    mat_vec_scalar(res, mat, vec);
+  }
+
+  inline void mat_vec(double *res, const double *mat, const double *vec)
+  {
+#ifdef HOST_SU3_X86
+    if (isa() != Isa::Scalar) {
+      mat_vec_avx2(res, mat, vec);
+      return;
+    }
+#endif
+    mat_vec_scalar(res, mat, vec);
+  }
+
+  template <typename Float, typename mFloat, typename vFloat>
+  inline void adj_mat_vec(Float *res, const mFloat *mat, const vFloat *vec)
+  {
+    adj_mat_vec_scalar(res, mat, vec);
+  }
+
+  inline void adj_mat_vec(double *res, const double *mat, const double *vec)
+  {
+#ifdef HOST_SU3_X86
+    switch (isa()) {
+    case Isa::AVX512: adj_mat_vec_avx512(res, mat, vec); return;
+    case Isa::AVX2: adj_mat_vec_avx2(res, mat, vec); return;
+    default: break;
+    }
+#endif
+    adj_mat_vec_scalar(res, mat, vec);
+  }
+
+  template <bool a_dag, bool b_dag, typename Float, typename aFloat, typename bFloat>
+  inline void mat_mat(Float *c, const aFloat *a, const bFloat *b)
+  {
+    mat_mat_scalar<a_dag, b_dag>(c, a, b);
+  }
+
+  template <bool a_dag, bool b_dag> inline void mat_mat(double *c, const double *a, const double *b)
+  {
+#ifdef HOST_SU3_X86
+    // the vector kernels write c only after reading all of a and b
+    if (isa() == Isa::AVX512 && !b_dag) {
+      mat_mat_avx512<a_dag>(c, a, b);
+      return;
+    } else if (isa() != Isa::Scalar) {
+      mat_mat_avx2<a_dag, b_dag>(c, a, b);
+      return;
+    }
+#endif
+    mat_mat_scalar<a_dag, b_dag>(c, a, b);
+  }
+
+} // namespace host_su3
+
+/**
+   @brief res = mat * vec for a color vector
+ */
+template <typename Float, typename mFloat, typename vFloat>
+inline void su3_mat_vec(Float *res, const mFloat *mat, const vFloat *vec)
+{
+  host_su3::mat_vec(res, mat, vec);
+}
+
+/**
+   @brief res = mat^dagger * vec for a color vector
+ */
+template <typename Float, typename mFloat, typename vFloat>
+inline void su3_adj_mat_vec(Float *res, const mFloat *mat, const vFloat *vec)
+{
+  host_su3::adj_mat_vec(res, mat, vec);
+}
+
+/**
+   @brief c = a * b.  The output may alias either input.
+ */
+template <typename Float, typename aFloat, typename bFloat>
+inline void su3_mat_mat_nn(Float *c, const aFloat *a, const bFloat *b)
+{
+  host_su3::mat_mat<false, false>(c, a, b);
+}
+
+/**
+   @brief c = a^dagger * b.  The output may alias either input.
+ */
+template <typename Float, typename aFloat, typename bFloat>
+inline void su3_mat_mat_an(Float *c, const aFloat *a, const bFloat *b)
+{
+  host_su3::mat_mat<true, false>(c, a, b);
+}
+
+/**
+   @brief c = a * b^dagger.  The output may alias either input.
+ */
+template <typename Float, typename aFloat, typename bFloat>
+inline void su3_mat_mat_na(Float *c, const aFloat *a, const bFloat *b)
+{
+  host_su3::mat_mat<false, true>(c, a, b);
+}
@@ -22,6 +22,7 @@
 
 #include <misc.h>
 #include <qio_field.h>
+#include <host_rng.h>
 
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 
@@ -274,6 +275,11 @@ void initComms(int argc, char **argv, int *const commDims)
   }
 #elif defined(MPI_COMMS)
   MPI_Init(&argc, &argv);
+#elif defined(THREAD_COMMS)
+  // the test harnesses keep their state in globals that the threaded
+  // ranks would share, so they only run as a single rank
+  if (commDims[0] * commDims[1] * commDims[2] * commDims[3] != 1)
+    errorQuda("The tests run a single rank with QUDA_THREAD_COMMS; see comm_threads_test for a decomposed grid");
 #endif
 
   QudaCommsMap func = rank_order == 0 ? lex_rank_from_coords_t : lex_rank_from_coords_x;
@@ -308,6 +314,26 @@ void initRand()
   srand(17*rank + 137);
 }
 
+host_rng::RNG hostRNG(HostRNGStream kind)
+{
+  // the same seed on every rank: the numbers are keyed on the global
+  // site, and the key counts the fields of this kind constructed so
+  // far.  The count is per thread since with thread comms each rank
+  // is a thread.
+  static thread_local uint32_t count[HOST_RNG_STREAM_COUNT] = {};
+  return host_rng::RNG((static_cast<uint64_t>(count[kind]++) << 32) | 137);
+}
+
+uint64_t globalSiteIndex(int i, int oddBit)
+{
+  int X = fullLatticeIndex(i, oddBit);
+  int x[4] = {X % Z[0], (X / Z[0]) % Z[1], (X / (Z[1] * Z[0])) % Z[2], X / (Z[2] * Z[1] * Z[0])};
+  uint64_t index = 0;
+  for (int d = 3; d >= 0; d--)
+    index = index * (static_cast<uint64_t>(comm_dim(d)) * Z[d]) + comm_coord(d) * Z[d] + x[d];
+  return index;
+}
+
 void setDims(int *X) {
   V = 1;
   for (int d=0; d< 4; d++) {
@@ -925,7 +951,7 @@ int fullLatticeIndex_4d(int i, int oddBit) {
 // to oddBit = {0, 1}), returns the corresponding full lattice index.
 // Cf. GPGPU code in dslash_core_ante.h.
 // There, i is the thread index sid.
-// This function is used by neighborIndex_5d in dslash_reference.cpp.
+// The host stencil maps (stencil_map.cpp) use the same ordering.
 //ok
 int fullLatticeIndex_5d(int i, int oddBit) {
   int boundaryCrossings = i/(Z[0]/2) + i/(Z[1]*Z[0]/2) + i/(Z[2]*Z[1]*Z[0]/2) + i/(Z[3]*Z[2]*Z[1]*Z[0]/2);
@@ -1030,149 +1056,83 @@ static void orthogonalize(complex<Float> *a, complex<Float> *b, int len) {
   for (int i=0; i<len; i++) b[i] -= (complex<Float>)dot*a[i];
 }
 
-template <typename Float> void constructRandomGaugeField(Float **res, QudaGaugeParam *param, QudaDslashType dslash_type)
+// draw a random SU(3) matrix: the last two rows are drawn and
+// orthonormalized, and the first is their conjugate cross product
+template <typename Float>
+static void randomSU3(Float *link, const host_rng::RNG &rng, uint64_t site, uint32_t stream)
 {
-  Float *resOdd[4], *resEven[4];
-  for (int dir = 0; dir < 4; dir++) {
-    resEven[dir] = res[dir];
-    resOdd[dir] = res[dir] + Vh * gauge_site_size;
-  }
+  Float *w = link + 0 * 3 * 2;
+  Float *u = link + 1 * 3 * 2;
+  Float *v = link + 2 * 3 * 2;
 
-  for (int dir = 0; dir < 4; dir++) {
-    for (int i = 0; i < Vh; i++) {
-      for (int m = 1; m < 3; m++) { // last 2 rows
-	for (int n = 0; n < 3; n++) { // 3 columns
-	  resEven[dir][i*(3*3*2) + m*(3*2) + n*(2) + 0] = rand() / (Float)RAND_MAX;
-	  resEven[dir][i*(3*3*2) + m*(3*2) + n*(2) + 1] = rand() / (Float)RAND_MAX;
-	  resOdd[dir][i*(3*3*2) + m*(3*2) + n*(2) + 0] = rand() / (Float)RAND_MAX;
-          resOdd[dir][i * (3 * 3 * 2) + m * (3 * 2) + n * (2) + 1] = rand() / (Float)RAND_MAX;
-        }
-      }
-      normalize((complex<Float>*)(resEven[dir] + (i*3+1)*3*2), 3);
-      orthogonalize((complex<Float>*)(resEven[dir] + (i*3+1)*3*2), (complex<Float>*)(resEven[dir] + (i*3+2)*3*2), 3);
-      normalize((complex<Float>*)(resEven[dir] + (i*3 + 2)*3*2), 3);
-
-      normalize((complex<Float>*)(resOdd[dir] + (i*3+1)*3*2), 3);
-      orthogonalize((complex<Float>*)(resOdd[dir] + (i*3+1)*3*2), (complex<Float>*)(resOdd[dir] + (i*3+2)*3*2), 3);
-      normalize((complex<Float>*)(resOdd[dir] + (i*3 + 2)*3*2), 3);
-
-      {
-	Float *w = resEven[dir]+(i*3+0)*3*2;
-	Float *u = resEven[dir]+(i*3+1)*3*2;
-	Float *v = resEven[dir]+(i*3+2)*3*2;
-
-        for (int n = 0; n < 6; n++) w[n] = 0.0;
-	accumulateConjugateProduct(w+0*(2), u+1*(2), v+2*(2), +1);
-	accumulateConjugateProduct(w+0*(2), u+2*(2), v+1*(2), -1);
-	accumulateConjugateProduct(w+1*(2), u+2*(2), v+0*(2), +1);
-	accumulateConjugateProduct(w+1*(2), u+0*(2), v+2*(2), -1);
-	accumulateConjugateProduct(w+2*(2), u+0*(2), v+1*(2), +1);
-	accumulateConjugateProduct(w+2*(2), u+1*(2), v+0*(2), -1);
-      }
+  rng.uniform(u, 2 * 3 * 2, site, stream);
+  normalize((complex<Float> *)u, 3);
+  orthogonalize((complex<Float> *)u, (complex<Float> *)v, 3);
+  normalize((complex<Float> *)v, 3);
 
-      {
-	Float *w = resOdd[dir]+(i*3+0)*3*2;
-	Float *u = resOdd[dir]+(i*3+1)*3*2;
-	Float *v = resOdd[dir]+(i*3+2)*3*2;
-
-        for (int n = 0; n < 6; n++) w[n] = 0.0;
-	accumulateConjugateProduct(w+0*(2), u+1*(2), v+2*(2), +1);
-	accumulateConjugateProduct(w+0*(2), u+2*(2), v+1*(2), -1);
-	accumulateConjugateProduct(w+1*(2), u+2*(2), v+0*(2), +1);
-	accumulateConjugateProduct(w+1*(2), u+0*(2), v+2*(2), -1);
-	accumulateConjugateProduct(w+2*(2), u+0*(2), v+1*(2), +1);
-	accumulateConjugateProduct(w+2*(2), u+1*(2), v+0*(2), -1);
-      }
+  for (int n = 0; n < 6; n++) w[n] = 0.0;
+  accumulateConjugateProduct(w + 0 * (2), u + 1 * (2), v + 2 * (2), +1);
+  accumulateConjugateProduct(w + 0 * (2), u + 2 * (2), v + 1 * (2), -1);
+  accumulateConjugateProduct(w + 1 * (2), u + 2 * (2), v + 0 * (2), +1);
+  accumulateConjugateProduct(w + 1 * (2), u + 0 * (2), v + 2 * (2), -1);
+  accumulateConjugateProduct(w + 2 * (2), u + 0 * (2), v + 1 * (2), +1);
+  accumulateConjugateProduct(w + 2 * (2), u + 1 * (2), v + 0 * (2), -1);
+}
 
-    }
+// fill each link of res with a random SU(3) matrix
+template <typename Float> static void randomSU3Field(Float **res, HostRNGStream stream, int sub)
+{
+  const auto rng = hostRNG(stream);
+#pragma omp parallel for
+  for (int i = 0; i < V; i++) {
+    const uint64_t site = globalSiteIndex(i % Vh, i / Vh);
+    for (int dir = 0; dir < 4; dir++)
+      randomSU3(res[dir] + i * gauge_site_size, rng, site, hostRNGStream(stream, 4 * sub + dir));
   }
+}
+
+template <typename Float> void constructRandomGaugeField(Float **res, QudaGaugeParam *param, QudaDslashType dslash_type)
+{
+  randomSU3Field(res, HOST_RNG_GAUGE, param->type);
 
   if (param->type == QUDA_WILSON_LINKS) {
     applyGaugeFieldScaling(res, Vh, param);
   } else if (param->type == QUDA_ASQTAD_LONG_LINKS) {
     applyGaugeFieldScaling_long(res, Vh, param, dslash_type);
   } else if (param->type == QUDA_ASQTAD_FAT_LINKS) {
-    for (int dir = 0; dir < 4; dir++) {
-      for (int i = 0; i < Vh; i++) {
-	for (int m = 0; m < 3; m++) { // last 2 rows
-	  for (int n = 0; n < 3; n++) { // 3 columns
-	    resEven[dir][i*(3*3*2) + m*(3*2) + n*(2) + 0] =1.0* rand() / (Float)RAND_MAX;
-	    resEven[dir][i*(3*3*2) + m*(3*2) + n*(2) + 1] = 2.0* rand() / (Float)RAND_MAX;
-	    resOdd[dir][i*(3*3*2) + m*(3*2) + n*(2) + 0] = 3.0*rand() / (Float)RAND_MAX;
-	    resOdd[dir][i*(3*3*2) + m*(3*2) + n*(2) + 1] = 4.0*rand() / (Float)RAND_MAX;
-	  }
-	}
+    // the fat links are not unitary: replace them with uniform
+    // numbers scaled by 1 (2) for the real (imaginary) parts on even
+    // sites and 3 (4) on odd ones
+    const auto rng = hostRNG(HOST_RNG_FAT_GAUGE);
+#pragma omp parallel for
+    for (int i = 0; i < V; i++) {
+      const int parity = i / Vh;
+      const uint64_t site = globalSiteIndex(i % Vh, parity);
+      for (int dir = 0; dir < 4; dir++) {
+        Float *link = res[dir] + i * gauge_site_size;
+        rng.uniform(link, gauge_site_size, site, hostRNGStream(HOST_RNG_FAT_GAUGE, dir));
+        for (int j = 0; j < gauge_site_size; j++) link[j] *= 2 * parity + 1 + j % 2;
       }
     }
   }
 }
 
+// used by staggered_host_utils.cpp, while every call here may be inlined
+template void constructRandomGaugeField(double **res, QudaGaugeParam *param, QudaDslashType dslash_type);
+template void constructRandomGaugeField(float **res, QudaGaugeParam *param, QudaDslashType dslash_type);
+
 template <typename Float> void constructUnitaryGaugeField(Float **res)
 {
-  Float *resOdd[4], *resEven[4];
-  for (int dir = 0; dir < 4; dir++) {
-    resEven[dir] = res[dir];
-    resOdd[dir] = res[dir] + Vh * gauge_site_size;
-  }
-
-  for (int dir = 0; dir < 4; dir++) {
-    for (int i = 0; i < Vh; i++) {
-      for (int m = 1; m < 3; m++) { // last 2 rows
-	for (int n = 0; n < 3; n++) { // 3 columns
-	  resEven[dir][i*(3*3*2) + m*(3*2) + n*(2) + 0] = rand() / (Float)RAND_MAX;
-	  resEven[dir][i*(3*3*2) + m*(3*2) + n*(2) + 1] = rand() / (Float)RAND_MAX;
-	  resOdd[dir][i*(3*3*2) + m*(3*2) + n*(2) + 0] = rand() / (Float)RAND_MAX;
-          resOdd[dir][i * (3 * 3 * 2) + m * (3 * 2) + n * (2) + 1] = rand() / (Float)RAND_MAX;
-        }
-      }
-      normalize((complex<Float>*)(resEven[dir] + (i*3+1)*3*2), 3);
-      orthogonalize((complex<Float>*)(resEven[dir] + (i*3+1)*3*2), (complex<Float>*)(resEven[dir] + (i*3+2)*3*2), 3);
-      normalize((complex<Float>*)(resEven[dir] + (i*3 + 2)*3*2), 3);
-
-      normalize((complex<Float>*)(resOdd[dir] + (i*3+1)*3*2), 3);
-      orthogonalize((complex<Float>*)(resOdd[dir] + (i*3+1)*3*2), (complex<Float>*)(resOdd[dir] + (i*3+2)*3*2), 3);
-      normalize((complex<Float>*)(resOdd[dir] + (i*3 + 2)*3*2), 3);
-
-      {
-	Float *w = resEven[dir]+(i*3+0)*3*2;
-	Float *u = resEven[dir]+(i*3+1)*3*2;
-	Float *v = resEven[dir]+(i*3+2)*3*2;
-
-        for (int n = 0; n < 6; n++) w[n] = 0.0;
-	accumulateConjugateProduct(w+0*(2), u+1*(2), v+2*(2), +1);
-	accumulateConjugateProduct(w+0*(2), u+2*(2), v+1*(2), -1);
-	accumulateConjugateProduct(w+1*(2), u+2*(2), v+0*(2), +1);
-	accumulateConjugateProduct(w+1*(2), u+0*(2), v+2*(2), -1);
-	accumulateConjugateProduct(w+2*(2), u+0*(2), v+1*(2), +1);
-	accumulateConjugateProduct(w+2*(2), u+1*(2), v+0*(2), -1);
-      }
-
-      {
-	Float *w = resOdd[dir]+(i*3+0)*3*2;
-	Float *u = resOdd[dir]+(i*3+1)*3*2;
-	Float *v = resOdd[dir]+(i*3+2)*3*2;
-
-        for (int n = 0; n < 6; n++) w[n] = 0.0;
-	accumulateConjugateProduct(w+0*(2), u+1*(2), v+2*(2), +1);
-	accumulateConjugateProduct(w+0*(2), u+2*(2), v+1*(2), -1);
-	accumulateConjugateProduct(w+1*(2), u+2*(2), v+0*(2), +1);
-	accumulateConjugateProduct(w+1*(2), u+0*(2), v+2*(2), -1);
-	accumulateConjugateProduct(w+2*(2), u+0*(2), v+1*(2), +1);
-	accumulateConjugateProduct(w+2*(2), u+1*(2), v+0*(2), -1);
-      }
-    }
-  }
+  randomSU3Field(res, HOST_RNG_UNITARY_GAUGE, 0);
 }
 
 template <typename Float> void constructCloverField(Float *res, double norm, double diag)
 {
-
-  Float c = 2.0 * norm / RAND_MAX;
-
+  const auto rng = hostRNG(HOST_RNG_CLOVER);
+#pragma omp parallel for
   for(int i = 0; i < V; i++) {
-    for (int j = 0; j < 72; j++) {
-      res[i*72 + j] = c*rand() - norm;
-    }
+    rng.uniform(&res[i * 72], 72, globalSiteIndex(i % Vh, i / Vh), hostRNGStream(HOST_RNG_CLOVER));
+    for (int j = 0; j < 72; j++) res[i * 72 + j] = 2 * norm * res[i * 72 + j] - norm;
 
     //impose clover symmetry on each chiral block
     for (int ch=0; ch<2; ch++) {
@@ -1436,58 +1396,36 @@ int strong_check_link(void **linkA, const char *msgA, void **linkB, const char *
   return ret;
 }
 
-void createMomCPU(void *mom, QudaPrecision precision)
+// fill n reals per link of a site-major field, of which the last
+// zero_tail are set to zero
+template <typename Float> static void randomLinkData(Float *field, int n, int zero_tail, HostRNGStream stream)
 {
-  void* temp;
-
-  size_t gSize = (precision == QUDA_DOUBLE_PRECISION) ? sizeof(double) : sizeof(float);
-  temp = malloc(4 * V * gauge_site_size * gSize);
-  if (temp == NULL){
-    fprintf(stderr, "Error: malloc failed for temp in function %s\n", __FUNCTION__);
-    exit(1);
-  }
-
-  for(int i=0;i < V;i++){
-    if (precision == QUDA_DOUBLE_PRECISION){
-      for(int dir=0;dir < 4;dir++){
-        double *thismom = (double *)mom;
-        for (int k = 0; k < mom_site_size; k++) {
-          thismom[(4 * i + dir) * mom_site_size + k] = 1.0 * rand() / RAND_MAX;
-          if (k == mom_site_size - 1) thismom[(4 * i + dir) * mom_site_size + k] = 0.0;
-        }
-      }
-    }else{
-      for(int dir=0;dir < 4;dir++){
-	float* thismom=(float*)mom;
-        for (int k = 0; k < mom_site_size; k++) {
-          thismom[(4 * i + dir) * mom_site_size + k] = 1.0 * rand() / RAND_MAX;
-          if (k == mom_site_size - 1) thismom[(4 * i + dir) * mom_site_size + k] = 0.0;
-        }
-      }
+  const auto rng = hostRNG(stream);
+#pragma omp parallel for
+  for (int i = 0; i < V; i++) {
+    const uint64_t site = globalSiteIndex(i % Vh, i / Vh);
+    for (int dir = 0; dir < 4; dir++) {
+      Float *link = field + (4 * i + dir) * n;
+      rng.uniform(link, n - zero_tail, site, hostRNGStream(stream, dir));
+      for (int k = n - zero_tail; k < n; k++) link[k] = 0.0;
     }
   }
+}
 
-  free(temp);
-  return;
+void createMomCPU(void *mom, QudaPrecision precision)
+{
+  if (precision == QUDA_DOUBLE_PRECISION)
+    randomLinkData((double *)mom, mom_site_size, 1, HOST_RNG_MOM);
+  else
+    randomLinkData((float *)mom, mom_site_size, 1, HOST_RNG_MOM);
 }
 
 void createHwCPU(void *hw, QudaPrecision precision)
 {
-  for(int i=0;i < V;i++){
-    if (precision == QUDA_DOUBLE_PRECISION){
-      for(int dir=0;dir < 4;dir++){
-	double* thishw = (double*)hw;
-        for (int k = 0; k < hw_site_size; k++) { thishw[(4 * i + dir) * hw_site_size + k] = 1.0 * rand() / RAND_MAX; }
-      }
-    }else{
-      for(int dir=0;dir < 4;dir++){
-	float* thishw=(float*)hw;
-        for (int k = 0; k < hw_site_size; k++) { thishw[(4 * i + dir) * hw_site_size + k] = 1.0 * rand() / RAND_MAX; }
-      }
-    }
-  }
-
-  return;
+  if (precision == QUDA_DOUBLE_PRECISION)
+    randomLinkData((double *)hw, hw_site_size, 0, HOST_RNG_HW);
+  else
+    randomLinkData((float *)hw, hw_site_size, 0, HOST_RNG_HW);
 }
 
 
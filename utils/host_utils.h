@@ -4,6 +4,7 @@
 #include <random_quda.h>
 #include <vector>
 #include <color_spinor_field.h>
+#include <host_rng.h>
 
 #define gauge_site_size 18      // real numbers per link
 #define spinor_site_size 24     // real numbers per wilson spinor
@@ -115,6 +116,45 @@ void initComms(int argc, char **argv, int *const commDims);
 void finalizeComms();
 void initRand();
 
+/**
+   @brief The streams of hostRNG() drawn from by each kind of host
+   field, so that different fields are independent
+*/
+enum HostRNGStream : uint32_t {
+  HOST_RNG_GAUGE = 1,
+  HOST_RNG_FAT_GAUGE,
+  HOST_RNG_UNITARY_GAUGE,
+  HOST_RNG_CLOVER,
+  HOST_RNG_MOM,
+  HOST_RNG_HW,
+  HOST_RNG_LONG_PHASE,
+  HOST_RNG_STREAM_COUNT
+};
+
+/**
+   @brief The generator of a random host field.  It has the same seed
+   on every rank, and its numbers are keyed on the global site, so the
+   fields do not depend on the process grid or thread count.  Each
+   call for a kind of field returns a new generator, so that a field
+   constructed repeatedly, e.g., the clover field of each step of an
+   evolution, is redrawn each time, while the sequence of fields is
+   the same on every run.
+   @param[in] kind The kind of field to be constructed
+*/
+host_rng::RNG hostRNG(HostRNGStream kind);
+
+/**
+   @return The stream of hostRNG() for sub-stream sub, e.g., the link
+   direction, of a kind of field
+*/
+inline uint32_t hostRNGStream(HostRNGStream stream, int sub = 0) { return (stream << 16) | sub; }
+
+/**
+   @return The lexicographic index on the global lattice of a local
+   checkerboard site, which is independent of the process grid
+*/
+uint64_t globalSiteIndex(int i, int oddBit);
+
 int lex_rank_from_coords_t(const int *coords, void *fdata);
 int lex_rank_from_coords_x(const int *coords, void *fdata);
 
@@ -12,6 +12,7 @@
 
 #include <quda_internal.h>
 #include <complex>
+#include <vector>
 
 #define XUP 0
 #define YUP 1
@@ -23,14 +24,23 @@ using namespace quda;
 static int Vs[4];
 static int Vsh[4];
 
+/**
+   @brief Add coef[s] * mat to fatlink[s][mu] at site i for each of the
+   n_sets fat links built from the same staples
+*/
 template <typename su3_matrix, typename Real>
-void llfat_compute_gen_staple_field(su3_matrix *staple, int mu, int nu, su3_matrix *mulink, su3_matrix **sitelink,
-                                    void **fatlink, Real coef, int use_staple)
+static void llfat_add_to_fatlinks(int n_sets, void ***fatlink, const Real *coef, int mu, int i, su3_matrix *mat)
 {
-  su3_matrix tmat1, tmat2;
-  int i;
-  su3_matrix *fat1;
+  for (int s = 0; s < n_sets; s++) {
+    su3_matrix *fat1 = ((su3_matrix *)fatlink[s][mu]) + i;
+    llfat_scalar_mult_add_su3_matrix(fat1, mat, coef[s], fat1);
+  }
+}
 
+template <typename su3_matrix, typename Real>
+void llfat_compute_gen_staple_field(su3_matrix *staple, int mu, int nu, su3_matrix *mulink, su3_matrix **sitelink,
+                                    int n_sets, void ***fatlink, const Real *coef, int use_staple)
+{
   /* Upper staple */
   /* Computes the staple :
    *                mu (B)
@@ -41,16 +51,17 @@ void llfat_compute_gen_staple_field(su3_matrix *staple, int mu, int nu, su3_matr
    *
    * Where the mu link can be any su3_matrix. The result is saved in staple.
    * if staple==NULL then the result is not saved.
-   * It also adds the computed staple to the fatlink[mu] with weight coef.
+   * It also adds the computed staple to each fatlink[s][mu] with weight coef[s].
+   * The sites are independent, so each loop runs in parallel.
    */
 
-  int dx[4];
-
   /* upper staple */
 
-  for (i = 0; i < V; i++) {
+#pragma omp parallel for
+  for (int i = 0; i < V; i++) {
+    su3_matrix tmat1, tmat2;
+    int dx[4];
 
-    fat1 = ((su3_matrix *)fatlink[mu]) + i;
     su3_matrix *A = sitelink[nu] + i;
 
     memset(dx, 0, sizeof(dx));
@@ -74,7 +85,7 @@ void llfat_compute_gen_staple_field(su3_matrix *staple, int mu, int nu, su3_matr
       llfat_mult_su3_na(&tmat1, C, &staple[i]);
     } else { /* No need to save the staple. Add it to the fatlinks */
       llfat_mult_su3_na(&tmat1, C, &tmat2);
-      llfat_scalar_mult_add_su3_matrix(fat1, &tmat2, coef, fat1);
+      llfat_add_to_fatlinks(n_sets, fatlink, coef, mu, i, &tmat2);
     }
   }
   /***************lower staple****************
@@ -87,9 +98,11 @@ void llfat_compute_gen_staple_field(su3_matrix *staple, int mu, int nu, su3_matr
    *
    *********************************************/
 
-  for (i = 0; i < V; i++) {
+#pragma omp parallel for
+  for (int i = 0; i < V; i++) {
+    su3_matrix tmat1, tmat2;
+    int dx[4];
 
-    fat1 = ((su3_matrix *)fatlink[mu]) + i;
     memset(dx, 0, sizeof(dx));
     dx[nu] = -1;
     int nbr_idx = neighborIndexFullLattice(i, dx[3], dx[2], dx[1], dx[0]);
@@ -116,10 +129,10 @@ void llfat_compute_gen_staple_field(su3_matrix *staple, int mu, int nu, su3_matr
 
     if (staple != NULL) { /* Save the staple */
       llfat_add_su3_matrix(&staple[i], &tmat2, &staple[i]);
-      llfat_scalar_mult_add_su3_matrix(fat1, &staple[i], coef, fat1);
+      llfat_add_to_fatlinks(n_sets, fatlink, coef, mu, i, &staple[i]);
 
     } else { /* No need to save the staple. Add it to the fatlinks */
-      llfat_scalar_mult_add_su3_matrix(fat1, &tmat2, coef, fat1);
+      llfat_add_to_fatlinks(n_sets, fatlink, coef, mu, i, &tmat2);
     }
   }
 } /* compute_gen_staple_site */
@@ -135,50 +148,49 @@ void llfat_compute_gen_staple_field(su3_matrix *staple, int mu, int nu, su3_matr
  *
  */
 template <typename su3_matrix, typename Float>
-void llfat_cpu(void **fatlink, su3_matrix **sitelink, Float *act_path_coeff)
+void llfat_cpu(int n_sets, void ***fatlink, su3_matrix **sitelink, Float **act_path_coeff, llfat_scratch &scratch)
 {
-  su3_matrix *staple = (su3_matrix *)malloc(V * sizeof(su3_matrix));
-  if (staple == NULL) {
-    fprintf(stderr, "Error: malloc failed for staple in function %s\n", __FUNCTION__);
-    exit(1);
-  }
+  su3_matrix *staple = scratch.get<su3_matrix>(2 * V);
+  su3_matrix *tempmat1 = staple + V;
 
-  su3_matrix *tempmat1 = (su3_matrix *)malloc(V * sizeof(su3_matrix));
-  if (tempmat1 == NULL) {
-    fprintf(stderr, "ERROR:  malloc failed for tempmat1 in function %s\n", __FUNCTION__);
-    exit(1);
-  }
+  // the coefficients of each path, gathered over the sets
+  Float coeff[6][llfat_max_sets];
+  for (int s = 0; s < n_sets; s++)
+    for (int p = 0; p < 6; p++) coeff[p][s] = act_path_coeff[s][p];
 
-  // to fix up the Lepage term, included by a trick below
-  Float one_link = (act_path_coeff[0] - 6.0 * act_path_coeff[5]);
+  for (int s = 0; s < n_sets; s++) {
+    // to fix up the Lepage term, included by a trick below
+    Float one_link = (coeff[0][s] - 6.0 * coeff[5][s]);
 
-  for (int dir = XUP; dir <= TUP; dir++) {
+    for (int dir = XUP; dir <= TUP; dir++) {
 
-    // Intialize fat links with c_1*U_\mu(x)
-    for (int i = 0; i < V; i++) {
-      su3_matrix *fat1 = ((su3_matrix *)fatlink[dir]) + i;
-      llfat_scalar_mult_su3_matrix(sitelink[dir] + i, one_link, fat1);
+      // Intialize fat links with c_1*U_\mu(x)
+#pragma omp parallel for
+      for (int i = 0; i < V; i++) {
+        su3_matrix *fat1 = ((su3_matrix *)fatlink[s][dir]) + i;
+        llfat_scalar_mult_su3_matrix(sitelink[dir] + i, one_link, fat1);
+      }
     }
   }
 
   for (int dir = XUP; dir <= TUP; dir++) {
     for (int nu = XUP; nu <= TUP; nu++) {
       if (nu != dir) {
-        llfat_compute_gen_staple_field(staple, dir, nu, sitelink[dir], sitelink, fatlink, act_path_coeff[2], 0);
+        llfat_compute_gen_staple_field(staple, dir, nu, sitelink[dir], sitelink, n_sets, fatlink, coeff[2], 0);
 
         // The Lepage term
         // Note this also involves modifying c_1 (above)
 
-        llfat_compute_gen_staple_field((su3_matrix *)NULL, dir, nu, staple, sitelink, fatlink, act_path_coeff[5], 1);
+        llfat_compute_gen_staple_field((su3_matrix *)NULL, dir, nu, staple, sitelink, n_sets, fatlink, coeff[5], 1);
 
         for (int rho = XUP; rho <= TUP; rho++) {
           if ((rho != dir) && (rho != nu)) {
-            llfat_compute_gen_staple_field(tempmat1, dir, rho, staple, sitelink, fatlink, act_path_coeff[3], 1);
+            llfat_compute_gen_staple_field(tempmat1, dir, rho, staple, sitelink, n_sets, fatlink, coeff[3], 1);
 
             for (int sig = XUP; sig <= TUP; sig++) {
               if ((sig != dir) && (sig != nu) && (sig != rho)) {
-                llfat_compute_gen_staple_field((su3_matrix *)NULL, dir, sig, tempmat1, sitelink, fatlink,
-                                               act_path_coeff[4], 1);
+                llfat_compute_gen_staple_field((su3_matrix *)NULL, dir, sig, tempmat1, sitelink, n_sets, fatlink,
+                                               coeff[4], 1);
               }
             } // sig
           }
@@ -186,12 +198,9 @@ void llfat_cpu(void **fatlink, su3_matrix **sitelink, Float *act_path_coeff)
       }
     } // nu
   }   // dir
-
-  free(staple);
-  free(tempmat1);
 }
 
-void llfat_reference(void **fatlink, void **sitelink, QudaPrecision prec, void *act_path_coeff)
+static void llfat_set_face_volumes()
 {
   Vs[0] = Vs_x;
   Vs[1] = Vs_y;
@@ -202,14 +211,23 @@ void llfat_reference(void **fatlink, void **sitelink, QudaPrecision prec, void *
   Vsh[1] = Vsh_y;
   Vsh[2] = Vsh_z;
   Vsh[3] = Vsh_t;
+}
+
+void llfat_reference(int n_sets, void ***fatlink, void **sitelink, QudaPrecision prec, void **act_path_coeff,
+                     llfat_scratch *scratch)
+{
+  if (n_sets < 1 || n_sets > llfat_max_sets) errorQuda("Unsupported number of coefficient sets %d", n_sets);
+  llfat_set_face_volumes();
+  llfat_scratch local;
+  if (!scratch) scratch = &local;
 
   switch (prec) {
   case QUDA_DOUBLE_PRECISION:
-    llfat_cpu((void **)fatlink, (su3_matrix<double> **)sitelink, (double *)act_path_coeff);
+    llfat_cpu(n_sets, fatlink, (su3_matrix<double> **)sitelink, (double **)act_path_coeff, *scratch);
     break;
 
   case QUDA_SINGLE_PRECISION:
-    llfat_cpu((void **)fatlink, (su3_matrix<float> **)sitelink, (float *)act_path_coeff);
+    llfat_cpu(n_sets, fatlink, (su3_matrix<float> **)sitelink, (float **)act_path_coeff, *scratch);
     break;
 
   default:
@@ -220,17 +238,20 @@ void llfat_reference(void **fatlink, void **sitelink, QudaPrecision prec, void *
   return;
 }
 
+void llfat_reference(void **fatlink, void **sitelink, QudaPrecision prec, void *act_path_coeff,
+                     llfat_scratch *scratch)
+{
+  llfat_reference(1, &fatlink, sitelink, prec, &act_path_coeff, scratch);
+}
+
 #ifdef MULTI_GPU
 
 template <typename su3_matrix, typename Real>
 void llfat_compute_gen_staple_field_mg(su3_matrix *staple, int mu, int nu, su3_matrix *mulink,
                                        su3_matrix **ghost_mulink, su3_matrix **sitelink, su3_matrix **ghost_sitelink,
-                                       su3_matrix **ghost_sitelink_diag, void **fatlink, Real coef, int use_staple)
+                                       su3_matrix **ghost_sitelink_diag, int n_sets, void ***fatlink,
+                                       const Real *coef, int use_staple)
 {
-  su3_matrix tmat1, tmat2;
-  int i;
-  su3_matrix *fat1;
-
   int X1 = Z[0];
   int X2 = Z[1];
   int X3 = Z[2];
@@ -251,14 +272,16 @@ void llfat_compute_gen_staple_field_mg(su3_matrix *staple, int mu, int nu, su3_m
    *
    * Where the mu link can be any su3_matrix. The result is saved in staple.
    * if staple==NULL then the result is not saved.
-   * It also adds the computed staple to the fatlink[mu] with weight coef.
+   * It also adds the computed staple to each fatlink[s][mu] with weight coef[s].
+   * The sites are independent, so each loop runs in parallel.
    */
 
-  int dx[4];
-
   // upper staple
 
-  for (i = 0; i < V; i++) {
+#pragma omp parallel for
+  for (int i = 0; i < V; i++) {
+    su3_matrix tmat1, tmat2;
+    int dx[4];
 
     int half_index = i;
     int oddBit = 0;
@@ -281,7 +304,6 @@ void llfat_compute_gen_staple_field_mg(su3_matrix *staple, int mu, int nu, su3_m
     int space_con[4] = {(x4 * X3X2 + x3 * X2 + x2) / 2, (x4 * X3X1 + x3 * X1 + x1) / 2, (x4 * X2X1 + x2 * X1 + x1) / 2,
                         (x3 * X2X1 + x2 * X1 + x1) / 2};
 
-    fat1 = ((su3_matrix *)fatlink[mu]) + i;
     su3_matrix *A = sitelink[nu] + i;
 
     memset(dx, 0, sizeof(dx));
@@ -322,7 +344,7 @@ void llfat_compute_gen_staple_field_mg(su3_matrix *staple, int mu, int nu, su3_m
       llfat_mult_su3_na(&tmat1, C, &staple[i]);
     } else { /* No need to save the staple. Add it to the fatlinks */
       llfat_mult_su3_na(&tmat1, C, &tmat2);
-      llfat_scalar_mult_add_su3_matrix(fat1, &tmat2, coef, fat1);
+      llfat_add_to_fatlinks(n_sets, fatlink, coef, mu, i, &tmat2);
     }
   }
   /***************lower staple****************
@@ -335,7 +357,10 @@ void llfat_compute_gen_staple_field_mg(su3_matrix *staple, int mu, int nu, su3_m
    *
    *********************************************/
 
-  for (i = 0; i < V; i++) {
+#pragma omp parallel for
+  for (int i = 0; i < V; i++) {
+    su3_matrix tmat1, tmat2;
+    int dx[4];
 
     int half_index = i;
     int oddBit = 0;
@@ -359,8 +384,6 @@ void llfat_compute_gen_staple_field_mg(su3_matrix *staple, int mu, int nu, su3_m
 
     // int x4 = x4_from_full_index(i);
 
-    fat1 = ((su3_matrix *)fatlink[mu]) + i;
-
     // we could be in the ghost link area if nu is T and we are at low T boundary
     su3_matrix *A;
     memset(dx, 0, sizeof(dx));
@@ -434,18 +457,18 @@ void llfat_compute_gen_staple_field_mg(su3_matrix *staple, int mu, int nu, su3_m
 
     if (staple != NULL) { /* Save the staple */
       llfat_add_su3_matrix(&staple[i], &tmat2, &staple[i]);
-      llfat_scalar_mult_add_su3_matrix(fat1, &staple[i], coef, fat1);
+      llfat_add_to_fatlinks(n_sets, fatlink, coef, mu, i, &staple[i]);
 
     } else { /* No need to save the staple. Add it to the fatlinks */
-      llfat_scalar_mult_add_su3_matrix(fat1, &tmat2, coef, fat1);
+      llfat_add_to_fatlinks(n_sets, fatlink, coef, mu, i, &tmat2);
     }
   }
 
 } // compute_gen_staple_site
 
 template <typename su3_matrix, typename Float>
-void llfat_cpu_mg(void **fatlink, su3_matrix **sitelink, su3_matrix **ghost_sitelink, su3_matrix **ghost_sitelink_diag,
-                  Float *act_path_coeff)
+void llfat_cpu_mg(int n_sets, void ***fatlink, su3_matrix **sitelink, su3_matrix **ghost_sitelink,
+                  su3_matrix **ghost_sitelink_diag, Float **act_path_coeff, llfat_scratch &scratch)
 {
   QudaPrecision prec;
   if (sizeof(Float) == 4) {
@@ -454,44 +477,40 @@ void llfat_cpu_mg(void **fatlink, su3_matrix **sitelink, su3_matrix **ghost_site
     prec = QUDA_DOUBLE_PRECISION;
   }
 
-  su3_matrix *staple = (su3_matrix *)malloc(V * sizeof(su3_matrix));
-  if (staple == NULL) {
-    fprintf(stderr, "Error: malloc failed for staple in function %s\n", __FUNCTION__);
-    exit(1);
-  }
+  // the staple and 5-staple fields, each followed by its ghost zones
+  size_t ghost_size = 0;
+  for (int i = 0; i < 4; i++) ghost_size += 2 * Vs[i];
+
+  su3_matrix *staple = scratch.get<su3_matrix>(2 * (V + ghost_size));
+  su3_matrix *tempmat1 = staple + V + ghost_size;
 
   su3_matrix *ghost_staple[4];
   su3_matrix *ghost_staple1[4];
 
-  for (int i = 0; i < 4; i++) {
-    ghost_staple[i] = (su3_matrix *)malloc(2 * Vs[i] * sizeof(su3_matrix));
-    if (ghost_staple[i] == NULL) {
-      fprintf(stderr, "Error: malloc failed for ghost staple in function %s\n", __FUNCTION__);
-      exit(1);
-    }
-
-    ghost_staple1[i] = (su3_matrix *)malloc(2 * Vs[i] * sizeof(su3_matrix));
-    if (ghost_staple1[i] == NULL) {
-      fprintf(stderr, "Error: malloc failed for ghost staple1 in function %s\n", __FUNCTION__);
-      exit(1);
-    }
+  ghost_staple[0] = staple + V;
+  ghost_staple1[0] = tempmat1 + V;
+  for (int i = 1; i < 4; i++) {
+    ghost_staple[i] = ghost_staple[i - 1] + 2 * Vs[i - 1];
+    ghost_staple1[i] = ghost_staple1[i - 1] + 2 * Vs[i - 1];
   }
 
-  su3_matrix *tempmat1 = (su3_matrix *)malloc(V * sizeof(su3_matrix));
-  if (tempmat1 == NULL) {
-    fprintf(stderr, "ERROR:  malloc failed for tempmat1 in function %s\n", __FUNCTION__);
-    exit(1);
-  }
+  // the coefficients of each path, gathered over the sets
+  Float coeff[6][llfat_max_sets];
+  for (int s = 0; s < n_sets; s++)
+    for (int p = 0; p < 6; p++) coeff[p][s] = act_path_coeff[s][p];
 
-  // to fix up the Lepage term, included by a trick below
-  Float one_link = (act_path_coeff[0] - 6.0 * act_path_coeff[5]);
+  for (int s = 0; s < n_sets; s++) {
+    // to fix up the Lepage term, included by a trick below
+    Float one_link = (coeff[0][s] - 6.0 * coeff[5][s]);
 
-  for (int dir = XUP; dir <= TUP; dir++) {
+    for (int dir = XUP; dir <= TUP; dir++) {
 
-    // Intialize fat links with c_1*U_\mu(x)
-    for (int i = 0; i < V; i++) {
-      su3_matrix *fat1 = ((su3_matrix *)fatlink[dir]) + i;
-      llfat_scalar_mult_su3_matrix(sitelink[dir] + i, one_link, fat1);
+      // Intialize fat links with c_1*U_\mu(x)
+#pragma omp parallel for
+      for (int i = 0; i < V; i++) {
+        su3_matrix *fat1 = ((su3_matrix *)fatlink[s][dir]) + i;
+        llfat_scalar_mult_su3_matrix(sitelink[dir] + i, one_link, fat1);
+      }
     }
   }
 
@@ -499,19 +518,19 @@ void llfat_cpu_mg(void **fatlink, su3_matrix **sitelink, su3_matrix **ghost_site
     for (int nu = XUP; nu <= TUP; nu++) {
       if (nu != dir) {
         llfat_compute_gen_staple_field_mg(staple, dir, nu, sitelink[dir], (su3_matrix **)NULL, sitelink, ghost_sitelink,
-                                          ghost_sitelink_diag, fatlink, act_path_coeff[2], 0);
+                                          ghost_sitelink_diag, n_sets, fatlink, coeff[2], 0);
         // The Lepage term */
         // Note this also involves modifying c_1 (above)
 
         exchange_cpu_staple(Z, staple, (void **)ghost_staple, prec);
 
         llfat_compute_gen_staple_field_mg((su3_matrix *)NULL, dir, nu, staple, ghost_staple, sitelink, ghost_sitelink,
-                                          ghost_sitelink_diag, fatlink, act_path_coeff[5], 1);
+                                          ghost_sitelink_diag, n_sets, fatlink, coeff[5], 1);
 
         for (int rho = XUP; rho <= TUP; rho++) {
           if ((rho != dir) && (rho != nu)) {
             llfat_compute_gen_staple_field_mg(tempmat1, dir, rho, staple, ghost_staple, sitelink, ghost_sitelink,
-                                              ghost_sitelink_diag, fatlink, act_path_coeff[3], 1);
+                                              ghost_sitelink_diag, n_sets, fatlink, coeff[3], 1);
 
             exchange_cpu_staple(Z, tempmat1, (void **)ghost_staple1, prec);
 
@@ -519,7 +538,7 @@ void llfat_cpu_mg(void **fatlink, su3_matrix **sitelink, su3_matrix **ghost_site
               if ((sig != dir) && (sig != nu) && (sig != rho)) {
 
                 llfat_compute_gen_staple_field_mg((su3_matrix *)NULL, dir, sig, tempmat1, ghost_staple1, sitelink,
-                                                  ghost_sitelink, ghost_sitelink_diag, fatlink, act_path_coeff[4], 1);
+                                                  ghost_sitelink, ghost_sitelink_diag, n_sets, fatlink, coeff[4], 1);
                 // FIXME
                 // return;
               }
@@ -529,37 +548,26 @@ void llfat_cpu_mg(void **fatlink, su3_matrix **sitelink, su3_matrix **ghost_site
       }
     } // nu
   }   // dir
-
-  free(staple);
-  for (int i = 0; i < 4; i++) {
-    free(ghost_staple[i]);
-    free(ghost_staple1[i]);
-  }
-  free(tempmat1);
 }
 
-void llfat_reference_mg(void **fatlink, void **sitelink, void **ghost_sitelink, void **ghost_sitelink_diag,
-                        QudaPrecision prec, void *act_path_coeff)
+void llfat_reference_mg(int n_sets, void ***fatlink, void **sitelink, void **ghost_sitelink,
+                        void **ghost_sitelink_diag, QudaPrecision prec, void **act_path_coeff,
+                        llfat_scratch *scratch)
 {
-  Vs[0] = Vs_x;
-  Vs[1] = Vs_y;
-  Vs[2] = Vs_z;
-  Vs[3] = Vs_t;
-
-  Vsh[0] = Vsh_x;
-  Vsh[1] = Vsh_y;
-  Vsh[2] = Vsh_z;
-  Vsh[3] = Vsh_t;
+  if (n_sets < 1 || n_sets > llfat_max_sets) errorQuda("Unsupported number of coefficient sets %d", n_sets);
+  llfat_set_face_volumes();
+  llfat_scratch local;
+  if (!scratch) scratch = &local;
 
   switch (prec) {
   case QUDA_DOUBLE_PRECISION: {
-    llfat_cpu_mg((void **)fatlink, (su3_matrix<double> **)sitelink, (su3_matrix<double> **)ghost_sitelink,
-                 (su3_matrix<double> **)ghost_sitelink_diag, (double *)act_path_coeff);
+    llfat_cpu_mg(n_sets, fatlink, (su3_matrix<double> **)sitelink, (su3_matrix<double> **)ghost_sitelink,
+                 (su3_matrix<double> **)ghost_sitelink_diag, (double **)act_path_coeff, *scratch);
     break;
   }
   case QUDA_SINGLE_PRECISION: {
-    llfat_cpu_mg((void **)fatlink, (su3_matrix<float> **)sitelink, (su3_matrix<float> **)ghost_sitelink,
-                 (su3_matrix<float> **)ghost_sitelink_diag, (float *)act_path_coeff);
+    llfat_cpu_mg(n_sets, fatlink, (su3_matrix<float> **)sitelink, (su3_matrix<float> **)ghost_sitelink,
+                 (su3_matrix<float> **)ghost_sitelink_diag, (float **)act_path_coeff, *scratch);
     break;
   }
   default:
@@ -569,4 +577,10 @@ void llfat_reference_mg(void **fatlink, void **sitelink, void **ghost_sitelink,
   }
   return;
 }
+
+void llfat_reference_mg(void **fatlink, void **sitelink, void **ghost_sitelink, void **ghost_sitelink_diag,
+                        QudaPrecision prec, void *act_path_coeff, llfat_scratch *scratch)
+{
+  llfat_reference_mg(1, &fatlink, sitelink, ghost_sitelink, ghost_sitelink_diag, prec, &act_path_coeff, scratch);
+}
 #endif
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <complex>
+#include <type_traits>
+#include <vector>
+#include <host_su3.h>
+
 template <typename real> struct su3_matrix {
   std::complex<real> e[3][3];
 };
@@ -7,9 +12,44 @@ template <typename real> struct su3_vector {
   std::complex<real> e[3];
 };
 
-void llfat_reference(void **fatlink, void **sitelink, QudaPrecision prec, void *act_path_coeff);
+/**
+   @brief Scratch space of the fattening: the staple fields.  A caller
+   that fattens repeatedly, such as computeHISQLinksCPU, owns one and
+   passes it to each fattening so that they share one allocation,
+   which is freed with the owner.  Without one, each fattening
+   allocates its own.
+*/
+class llfat_scratch
+{
+  std::vector<char> arena;
+
+public:
+  /**
+     @return Space for n matrices, reused from the previous request if
+     it is large enough
+  */
+  template <typename su3_matrix> su3_matrix *get(size_t n)
+  {
+    if (arena.size() < n * sizeof(su3_matrix)) arena.resize(n * sizeof(su3_matrix));
+    return reinterpret_cast<su3_matrix *>(arena.data());
+  }
+};
+
+void llfat_reference(void **fatlink, void **sitelink, QudaPrecision prec, void *act_path_coeff,
+                     llfat_scratch *scratch = nullptr);
 void llfat_reference_mg(void **fatlink, void **sitelink, void **ghost_sitelink, void **ghost_sitelink_diag,
-                        QudaPrecision prec, void *act_path_coeff);
+                        QudaPrecision prec, void *act_path_coeff, llfat_scratch *scratch = nullptr);
+
+// The staples of a fattening depend only on the thin links, so
+// several sets of path coefficients applied to the same links can
+// share them: these build fatlink[s] with act_path_coeff[s] for each
+// of the n_sets (at most llfat_max_sets) sets in a single pass.
+constexpr int llfat_max_sets = 2;
+void llfat_reference(int n_sets, void ***fatlink, void **sitelink, QudaPrecision prec, void **act_path_coeff,
+                     llfat_scratch *scratch = nullptr);
+void llfat_reference_mg(int n_sets, void ***fatlink, void **sitelink, void **ghost_sitelink,
+                        void **ghost_sitelink_diag, QudaPrecision prec, void **act_path_coeff,
+                        llfat_scratch *scratch = nullptr);
 
 template <typename su3_matrix, typename Real> void llfat_scalar_mult_su3_matrix(su3_matrix *a, Real s, su3_matrix *b)
 {
@@ -26,44 +66,20 @@ void llfat_scalar_mult_add_su3_matrix(su3_matrix *a, su3_matrix *b, Real s, su3_
 
 template <typename su3_matrix> void llfat_mult_su3_na(su3_matrix *a, su3_matrix *b, su3_matrix *c)
 {
-  typename std::remove_reference<decltype(a->e[0][0])>::type x, y;
-  for (int i = 0; i < 3; i++)
-    for (int j = 0; j < 3; j++) {
-      x = 0.0;
-      for (int k = 0; k < 3; k++) {
-        y = a->e[i][k] * conj(b->e[j][k]);
-        x += y;
-      }
-      c->e[i][j] = x;
-    }
+  using real = typename std::remove_reference<decltype(a->e[0][0])>::type::value_type;
+  su3_mat_mat_na(reinterpret_cast<real *>(c), reinterpret_cast<real *>(a), reinterpret_cast<real *>(b));
 }
 
 template <typename su3_matrix> void llfat_mult_su3_nn(su3_matrix *a, su3_matrix *b, su3_matrix *c)
 {
-  typename std::remove_reference<decltype(a->e[0][0])>::type x, y;
-  for (int i = 0; i < 3; i++)
-    for (int j = 0; j < 3; j++) {
-      x = 0.0;
-      for (int k = 0; k < 3; k++) {
-        y = a->e[i][k] * b->e[k][j];
-        x += y;
-      }
-      c->e[i][j] = x;
-    }
+  using real = typename std::remove_reference<decltype(a->e[0][0])>::type::value_type;
+  su3_mat_mat_nn(reinterpret_cast<real *>(c), reinterpret_cast<real *>(a), reinterpret_cast<real *>(b));
 }
 
 template <typename su3_matrix> void llfat_mult_su3_an(su3_matrix *a, su3_matrix *b, su3_matrix *c)
 {
-  typename std::remove_reference<decltype(a->e[0][0])>::type x, y;
-  for (int i = 0; i < 3; i++)
-    for (int j = 0; j < 3; j++) {
-      x = 0.0;
-      for (int k = 0; k < 3; k++) {
-        y = conj(a->e[k][i]) * b->e[k][j];
-        x += y;
-      }
-      c->e[i][j] = x;
-    }
+  using real = typename std::remove_reference<decltype(a->e[0][0])>::type::value_type;
+  su3_mat_mat_an(reinterpret_cast<real *>(c), reinterpret_cast<real *>(a), reinterpret_cast<real *>(b));
 }
 
 template <typename su3_matrix> void llfat_add_su3_matrix(su3_matrix *a, su3_matrix *b, su3_matrix *c)
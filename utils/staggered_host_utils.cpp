@@ -173,7 +173,7 @@ void constructFatLongGaugeField(void **fatlink, void **longlink, int type, QudaP
 
     if (dslash_type == QUDA_ASQTAD_DSLASH) {
       // incorporate non-trivial phase into long links
-      const double phase = (M_PI * rand()) / RAND_MAX;
+      const double phase = M_PI * hostRNG(HOST_RNG_LONG_PHASE).uniform(0, hostRNGStream(HOST_RNG_LONG_PHASE));
       const complex<double> z = polar(1.0, phase);
       for (int dir = 0; dir < 4; ++dir) {
         for (int i = 0; i < V; ++i) {
@@ -263,10 +263,11 @@ template <typename su3_matrix, typename Float>
 void computeLongLinkCPU(void **longlink, su3_matrix **sitelink, Float *act_path_coeff)
 {
 
-  su3_matrix temp;
   for (int dir = XUP; dir <= TUP; ++dir) {
-    int dx[4] = {0, 0, 0, 0};
+#pragma omp parallel for
     for (int i = 0; i < V; ++i) {
+      su3_matrix temp;
+      int dx[4] = {0, 0, 0, 0};
       // Initialize the longlinks
       su3_matrix *llink = ((su3_matrix *)longlink[dir]) + i;
       llfat_scalar_mult_su3_matrix(sitelink[dir] + i, act_path_coeff[1], llink);
@@ -289,11 +290,12 @@ void computeLongLinkCPU(void **longlink, su3_matrix **sitelinkEx, Float *act_pat
   for (int dir = 0; dir < 4; ++dir) E[dir] = Z[dir] + 4;
   const int extended_volume = E[3] * E[2] * E[1] * E[0];
 
-  su3_matrix temp;
+#pragma omp parallel for collapse(2)
   for (int t = 0; t < Z[3]; ++t) {
     for (int z = 0; z < Z[2]; ++z) {
       for (int y = 0; y < Z[1]; ++y) {
         for (int x = 0; x < Z[0]; ++x) {
+          su3_matrix temp;
           const int oddBit = (x + y + z + t) & 1;
           int little_index = ((((t * Z[2] + z) * Z[1] + y) * Z[0] + x) / 2) + oddBit * Vh;
           int large_index
@@ -355,16 +357,12 @@ void computeHISQLinksCPU(void **fatlink, void **longlink, void **fatlink_eps, vo
   const QudaPrecision prec = qudaGaugeParam.cpu_prec;
   const size_t gSize = prec;
 
+  // the staple fields of both fattenings, freed on return
+  llfat_scratch scratch;
+
   // Compute n_naiks
   const int n_naiks = (eps_naik == 0.0 ? 1 : 2);
 
-  ///////////////////////////////
-  // Create extended CPU field //
-  ///////////////////////////////
-
-  void *sitelink_ex[4];
-  for (int i = 0; i < 4; i++) sitelink_ex[i] = pinned_malloc(V_ex * gauge_site_size * gSize);
-
 #ifdef MULTI_GPU
   void *ghost_sitelink[4];
   void *ghost_sitelink_diag[16];
@@ -375,43 +373,6 @@ void computeHISQLinksCPU(void **fatlink, void **longlink, void **fatlink_eps, vo
   int X3 = Z[2];
   int X4 = Z[3];
 
-  for (int i = 0; i < V_ex; i++) {
-    int sid = i;
-    int oddBit = 0;
-    if (i >= Vh_ex) {
-      sid = i - Vh_ex;
-      oddBit = 1;
-    }
-
-    int za = sid / E1h;
-    int x1h = sid - za * E1h;
-    int zb = za / E2;
-    int x2 = za - zb * E2;
-    int x4 = zb / E3;
-    int x3 = zb - x4 * E3;
-    int x1odd = (x2 + x3 + x4 + oddBit) & 1;
-    int x1 = 2 * x1h + x1odd;
-
-    if (x1 < 2 || x1 >= X1 + 2 || x2 < 2 || x2 >= X2 + 2 || x3 < 2 || x3 >= X3 + 2 || x4 < 2 || x4 >= X4 + 2) {
-#ifdef MULTI_GPU
-      continue;
-#endif
-    }
-
-    x1 = (x1 - 2 + X1) % X1;
-    x2 = (x2 - 2 + X2) % X2;
-    x3 = (x3 - 2 + X3) % X3;
-    x4 = (x4 - 2 + X4) % X4;
-
-    int idx = (x4 * X3 * X2 * X1 + x3 * X2 * X1 + x2 * X1 + x1) >> 1;
-    if (oddBit) { idx += Vh; }
-    for (int dir = 0; dir < 4; dir++) {
-      char *src = (char *)sitelink[dir];
-      char *dst = (char *)sitelink_ex[dir];
-      memcpy(dst + i * gauge_site_size * gSize, src + idx * gauge_site_size * gSize, gauge_site_size * gSize);
-    } // dir
-  }   // i
-
   /////////////////////////////////////
   // Allocate all CPU intermediaries //
   /////////////////////////////////////
@@ -438,6 +399,8 @@ void computeHISQLinksCPU(void **fatlink, void **longlink, void **fatlink_eps, vo
   void *coeff;
   double coeff_dp[6];
   float coeff_sp[6];
+  double coeff_dp_sets[2][6];
+  float coeff_sp_sets[2][6];
 
   /////////////////////////////////////////////////////
   // Create V links (fat7 links), 1st path table set //
@@ -477,9 +440,9 @@ void computeHISQLinksCPU(void **fatlink, void **longlink, void **fatlink_eps, vo
     }
   }
   exchange_cpu_sitelink(gParam.x, sitelink, ghost_sitelink, ghost_sitelink_diag, prec, &qudaGaugeParam, optflag);
-  llfat_reference_mg(v_reflink, sitelink, ghost_sitelink, ghost_sitelink_diag, prec, coeff);
+  llfat_reference_mg(v_reflink, sitelink, ghost_sitelink, ghost_sitelink_diag, prec, coeff, &scratch);
 #else
-  llfat_reference(v_reflink, sitelink, prec, coeff);
+  llfat_reference(v_reflink, sitelink, prec, coeff, &scratch);
 #endif
 
   /////////////////////////////////////////
@@ -514,6 +477,7 @@ void computeHISQLinksCPU(void **fatlink, void **longlink, void **fatlink_eps, vo
   // Prepare for extended W fields //
   ///////////////////////////////////
 
+#pragma omp parallel for
   for (int i = 0; i < V_ex; i++) {
     int sid = i;
     int oddBit = 0;
@@ -585,45 +549,21 @@ void computeHISQLinksCPU(void **fatlink, void **longlink, void **fatlink_eps, vo
   }
 #endif
 
-  ////////////////////////////////////////////
-  // Prepare to create Naiks, 3rd table set //
-  ////////////////////////////////////////////
-
-  if (n_naiks > 1) {
-
-    for (int i = 0; i < 6; i++) coeff_sp[i] = coeff_dp[i] = act_path_coeffs[2][i];
-    coeff = (prec == QUDA_DOUBLE_PRECISION) ? (void *)coeff_dp : (void *)coeff_sp;
-
-#ifdef MULTI_GPU
-
-    exchange_cpu_sitelink(qudaGaugeParam.X, w_reflink, ghost_wlink, ghost_wlink_diag, qudaGaugeParam.cpu_prec,
-                          &qudaGaugeParam, optflag);
-    llfat_reference_mg(fatlink, w_reflink, ghost_wlink, ghost_wlink_diag, qudaGaugeParam.cpu_prec, coeff);
-
-    {
-      int R[4] = {2, 2, 2, 2};
-      exchange_cpu_sitelink_ex(qudaGaugeParam.X, R, w_reflink_ex, QUDA_QDP_GAUGE_ORDER, qudaGaugeParam.cpu_prec, 0, 4);
-      computeLongLinkCPU(longlink, w_reflink_ex, qudaGaugeParam.cpu_prec, coeff);
-    }
-#else
-    llfat_reference(fatlink, w_reflink, qudaGaugeParam.cpu_prec, coeff);
-    computeLongLinkCPU(longlink, w_reflink, qudaGaugeParam.cpu_prec, coeff);
-#endif
-
-    // Rescale fat and long links into eps links
-    for (int i = 0; i < 4; i++) {
-      cpu_axy(prec, eps_naik, fatlink[i], fatlink_eps[i], V * gauge_site_size);
-      cpu_axy(prec, eps_naik, longlink[i], longlink_eps[i], V * gauge_site_size);
-    }
+  //////////////////////////////////////////////////////////////
+  // Create X links and long links, 2nd table set, together   //
+  // with the Naiks, 3rd table set                            //
+  //////////////////////////////////////////////////////////////
+
+  // Both table sets fatten the W links, so they are built in one
+  // pass sharing the staples, with the Naiks going straight into the
+  // eps links.
+  void **fat_sets[2] = {fatlink, fatlink_eps};
+  void *coeff_sets[2];
+  for (int n = 0; n < n_naiks; n++) {
+    for (int i = 0; i < 6; i++) coeff_sp_sets[n][i] = coeff_dp_sets[n][i] = act_path_coeffs[1 + n][i];
+    coeff_sets[n] = (prec == QUDA_DOUBLE_PRECISION) ? (void *)coeff_dp_sets[n] : (void *)coeff_sp_sets[n];
   }
 
-  /////////////////////////////////////////////////////////////
-  // Prepare to create X links and long links, 2nd table set //
-  /////////////////////////////////////////////////////////////
-
-  for (int i = 0; i < 6; i++) coeff_sp[i] = coeff_dp[i] = act_path_coeffs[1][i];
-  coeff = (prec == QUDA_DOUBLE_PRECISION) ? (void *)coeff_dp : (void *)coeff_sp;
-
 #ifdef MULTI_GPU
   optflag = 0;
 
@@ -631,21 +571,26 @@ void computeHISQLinksCPU(void **fatlink, void **longlink, void **fatlink_eps, vo
 
   exchange_cpu_sitelink(qudaGaugeParam.X, w_reflink, ghost_wlink, ghost_wlink_diag, qudaGaugeParam.cpu_prec,
                         &qudaGaugeParam, optflag);
-  llfat_reference_mg(fatlink, w_reflink, ghost_wlink, ghost_wlink_diag, qudaGaugeParam.cpu_prec, coeff);
+  llfat_reference_mg(n_naiks, fat_sets, w_reflink, ghost_wlink, ghost_wlink_diag, qudaGaugeParam.cpu_prec,
+                     coeff_sets, &scratch);
 
   {
     int R[4] = {2, 2, 2, 2};
     exchange_cpu_sitelink_ex(qudaGaugeParam.X, R, w_reflink_ex, QUDA_QDP_GAUGE_ORDER, qudaGaugeParam.cpu_prec, 0, 4);
-    computeLongLinkCPU(longlink, w_reflink_ex, qudaGaugeParam.cpu_prec, coeff);
+    computeLongLinkCPU(longlink, w_reflink_ex, qudaGaugeParam.cpu_prec, coeff_sets[0]);
+    if (n_naiks > 1) computeLongLinkCPU(longlink_eps, w_reflink_ex, qudaGaugeParam.cpu_prec, coeff_sets[1]);
   }
 #else
-  llfat_reference(fatlink, w_reflink, qudaGaugeParam.cpu_prec, coeff);
-  computeLongLinkCPU(longlink, w_reflink, qudaGaugeParam.cpu_prec, coeff);
+  llfat_reference(n_naiks, fat_sets, w_reflink, qudaGaugeParam.cpu_prec, coeff_sets, &scratch);
+  computeLongLinkCPU(longlink, w_reflink, qudaGaugeParam.cpu_prec, coeff_sets[0]);
+  if (n_naiks > 1) computeLongLinkCPU(longlink_eps, w_reflink, qudaGaugeParam.cpu_prec, coeff_sets[1]);
 #endif
 
   if (n_naiks > 1) {
-    // Accumulate into eps links.
+    // Rescale the Naiks into eps links and accumulate the X links.
     for (int i = 0; i < 4; i++) {
+      cpu_axy(prec, eps_naik, fatlink_eps[i], fatlink_eps[i], V * gauge_site_size);
+      cpu_axy(prec, eps_naik, longlink_eps[i], longlink_eps[i], V * gauge_site_size);
       cpu_xpy(prec, fatlink[i], fatlink_eps[i], V * gauge_site_size);
       cpu_xpy(prec, longlink[i], longlink_eps[i], V * gauge_site_size);
     }
@@ -656,7 +601,6 @@ void computeHISQLinksCPU(void **fatlink, void **longlink, void **fatlink_eps, vo
   //////////////
 
   for (int i = 0; i < 4; i++) {
-    host_free(sitelink_ex[i]);
     host_free(v_reflink[i]);
     host_free(w_reflink[i]);
     host_free(w_reflink_ex[i]);